@@ -0,0 +1,100 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include "audio_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include "dsp_profiler.h"
+#endif
+
+namespace webamp {
+namespace bench {
+
+// Allocations (operator new) de tout le processus, comptées par bench_main.cpp
+extern std::atomic<uint64_t> g_allocations;
+
+// Tailles de bloc et fréquences couvertes par les microbenchmarks
+constexpr int64_t MIN_FRAMES = 32;
+constexpr int64_t MAX_FRAMES = 2048;
+const std::vector<int64_t> SAMPLE_RATES = {44100, 48000, 88200, 96000, 192000};
+
+// Compteur de cycles pour le pire cas (TSC sur x86, compteur virtuel sur
+// ARM64, nanosecondes ailleurs)
+inline uint64_t readCycles() {
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+    #elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+    #else
+    return DSPProfiler::now();
+    #endif
+}
+
+// Mesure d'un appel par itération : pire cas en cycles et allocations dans
+// la boucle chronométrée (le chemin temps réel ne doit pas allouer)
+class CallMeter {
+public:
+    template <typename Fn>
+    void measure(Fn&& fn) {
+        const uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+        const uint64_t start = readCycles();
+        fn();
+        const uint64_t elapsed = readCycles() - start;
+        allocations_ += g_allocations.load(std::memory_order_relaxed) - allocations;
+        worst_cycles_ = std::max(worst_cycles_, elapsed);
+    }
+    
+    // Compteurs publiés : ns_per_sample (temps par échantillon traité, par
+    // canal), allocs_per_call, worst_cycles. samplesPerCall : échantillons
+    // traités par appel, tous canaux confondus (canaux x frames).
+    void report(benchmark::State& state, int64_t samplesPerCall) const {
+        state.counters["ns_per_sample"] = benchmark::Counter(
+            static_cast<double>(samplesPerCall) * 1e-9,
+            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+        state.counters["allocs_per_call"] = benchmark::Counter(
+            static_cast<double>(allocations_), benchmark::Counter::kAvgIterations);
+        state.counters["worst_cycles"] = static_cast<double>(worst_cycles_);
+        state.SetItemsProcessed(state.iterations() * samplesPerCall);
+    }
+    
+private:
+    uint64_t allocations_ = 0;
+    uint64_t worst_cycles_ = 0;
+};
+
+// Signal de test : sinus + bruit, planaire
+inline void fillSignal(AudioBuffer& buffer, uint32_t sampleRate, unsigned seed = 1) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    for (uint32_t ch = 0; ch < buffer.getChannelCount(); ++ch) {
+        float* samples = buffer.getChannel(ch);
+        for (uint32_t i = 0; i < buffer.getFrameCapacity(); ++i) {
+            samples[i] = 0.4f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * 220.0 * (ch + 1) * i / sampleRate)) + noise(gen);
+        }
+    }
+}
+
+inline void fillSignal(std::vector<float>& buffer, unsigned seed = 1) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    for (auto& sample : buffer) {
+        sample = dist(gen);
+    }
+}
+
+} // namespace bench
+} // namespace webamp
@@ -0,0 +1,176 @@
+#include "bench_common.h"
+#include "buffer_pool.h"
+#include "fft_helper.h"
+#include "ring_buffer.h"
+#include "simd_helper.h"
+#include <complex>
+#include <vector>
+
+// Briques DSP partagées : la fréquence d'échantillonnage n'y intervient
+// pas, seules les tailles de bloc (32 à 2048) sont balayées.
+
+namespace webamp {
+namespace bench {
+
+namespace {
+
+void blockArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgName("frames")->RangeMultiplier(2)->Range(MIN_FRAMES, MAX_FRAMES)->MinTime(0.05);
+}
+
+// FFT réelle aller-retour de 2 x frames points (une partition de convolution)
+void BM_FFTPlanReal(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0)) * 2;
+    FFTPlan plan(size);
+    std::vector<float> input(size);
+    std::vector<float> output(size);
+    std::vector<float> re(size / 2 + 1);
+    std::vector<float> im(size / 2 + 1);
+    fillSignal(input);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] {
+            plan.forwardReal(input.data(), re.data(), im.data());
+            plan.inverseReal(re.data(), im.data(), output.data());
+        });
+        benchmark::DoNotOptimize(output.data());
+    }
+    meter.report(state, static_cast<int64_t>(size));
+}
+
+void BM_FFTPlanComplex(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    FFTPlan plan(size);
+    std::vector<float> re(size);
+    std::vector<float> im(size);
+    fillSignal(re, 2);
+    fillSignal(im, 3);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] {
+            plan.forward(re.data(), im.data());
+            plan.inverse(re.data(), im.data());
+        });
+        benchmark::DoNotOptimize(re.data());
+    }
+    meter.report(state, static_cast<int64_t>(size));
+}
+
+// API historique (alloue ses tables à chaque appel)
+void BM_FFTHelper(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    std::vector<float> signal(size);
+    fillSignal(signal);
+    std::vector<std::complex<float>> data(size);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = std::complex<float>(signal[i], 0.0f);
+        }
+        meter.measure([&] {
+            FFTHelper::fft(data);
+            FFTHelper::ifft(data);
+        });
+        benchmark::DoNotOptimize(data.data());
+    }
+    meter.report(state, static_cast<int64_t>(size));
+}
+
+template <void (*Operation)(const float*, const float*, float*, size_t)>
+void BM_SIMDBinary(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::vector<float> a(count);
+    std::vector<float> b(count);
+    std::vector<float> output(count);
+    fillSignal(a, 1);
+    fillSignal(b, 2);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] { Operation(a.data(), b.data(), output.data(), count); });
+        benchmark::DoNotOptimize(output.data());
+    }
+    meter.report(state, static_cast<int64_t>(count));
+}
+
+void BM_SIMDApplyGain(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::vector<float> input(count);
+    std::vector<float> output(count);
+    fillSignal(input);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] { SIMDHelper::applyGain(input.data(), 0.7f, output.data(), count); });
+        benchmark::DoNotOptimize(output.data());
+    }
+    meter.report(state, static_cast<int64_t>(count));
+}
+
+void BM_SIMDMixBuffers(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::vector<float> a(count);
+    std::vector<float> b(count);
+    std::vector<float> output(count);
+    fillSignal(a, 1);
+    fillSignal(b, 2);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] { SIMDHelper::mixBuffers(a.data(), b.data(), 0.3f, output.data(), count); });
+        benchmark::DoNotOptimize(output.data());
+    }
+    meter.report(state, static_cast<int64_t>(count));
+}
+
+// Écriture puis lecture d'un bloc stéréo entrelacé (échange driver/pipeline)
+void BM_RingBuffer(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0)) * 2;
+    RingBuffer<float> ring(8192);
+    std::vector<float> input(count);
+    std::vector<float> output(count);
+    fillSignal(input);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] {
+            ring.write(input.data(), count);
+            ring.read(output.data(), count);
+        });
+        benchmark::DoNotOptimize(output.data());
+    }
+    meter.report(state, static_cast<int64_t>(count));
+}
+
+// Cycle emprunt/retour d'un buffer, remise à zéro comprise
+void BM_BufferPool(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0)) * 2;
+    BufferPool pool(count, 4);
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] {
+            BufferPool::Buffer buffer = pool.borrow(true);
+            benchmark::DoNotOptimize(buffer.get());
+        });
+    }
+    meter.report(state, static_cast<int64_t>(count));
+}
+
+} // namespace
+
+BENCHMARK(BM_FFTPlanReal)->Apply(blockArguments);
+BENCHMARK(BM_FFTPlanComplex)->Apply(blockArguments);
+BENCHMARK(BM_FFTHelper)->Apply(blockArguments);
+BENCHMARK_TEMPLATE(BM_SIMDBinary, SIMDHelper::multiplyBuffers)->Name("BM_SIMDMultiplyBuffers")->Apply(blockArguments);
+BENCHMARK_TEMPLATE(BM_SIMDBinary, SIMDHelper::addBuffers)->Name("BM_SIMDAddBuffers")->Apply(blockArguments);
+BENCHMARK(BM_SIMDApplyGain)->Apply(blockArguments);
+BENCHMARK(BM_SIMDMixBuffers)->Apply(blockArguments);
+BENCHMARK(BM_RingBuffer)->Apply(blockArguments);
+BENCHMARK(BM_BufferPool)->Apply(blockArguments);
+
+} // namespace bench
+} // namespace webamp
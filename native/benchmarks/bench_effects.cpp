@@ -0,0 +1,193 @@
+#include "bench_common.h"
+#include "effect_manager.h"
+#include "ir_convolution.h"
+#include "ir_loader.h"
+#include "json_parser.h"
+#include "nam_inference.h"
+#include "nam_effect.h"
+#include "parallel_effect.h"
+#include "effects/delay.h"
+#include "effects/overdrive.h"
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace webamp {
+namespace bench {
+
+namespace {
+
+// IR de cabinet synthétique : bruit à décroissance exponentielle, 500 ms
+std::shared_ptr<IRLoader> makeCabinetIR(uint32_t sampleRate) {
+    std::vector<float> samples(sampleRate / 2);
+    fillSignal(samples, 3);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] *= std::exp(-8.0f * static_cast<float>(i) / static_cast<float>(samples.size()));
+    }
+    auto loader = std::make_shared<IRLoader>();
+    loader->loadIRFromSamples(samples.data(), samples.size(), sampleRate);
+    return loader;
+}
+
+// Modèle NAM "Linear" (FIR de 512 coefficients) : le format minimal que
+// NAMEffect accepte, sans dépendre d'un fichier .nam
+std::string makeLinearModel() {
+    std::vector<float> weights(513);
+    fillSignal(weights, 4);
+    std::ostringstream out;
+    out << "{\"version\":\"0.5.2\",\"architecture\":\"Linear\",\"config\":{\"receptive_field\":512,\"bias\":true},"
+        << "\"metadata\":{\"name\":\"Benchmark\"},\"sample_rate\":48000,\"weights\":[";
+    for (size_t i = 0; i < weights.size(); ++i) {
+        out << (i ? "," : "") << weights[i] * 0.05f;
+    }
+    out << "]}";
+    return out.str();
+}
+
+// WaveNet NAM "standard" : 16 puis 8 canaux, noyau 3, dilatations 1..512
+// (l'architecture des captures d'amplis courantes), poids aléatoires
+std::string makeStandardWaveNetModel() {
+    struct Array { size_t inputSize, channels, headSize; bool headBias; };
+    const Array arrays[] = {{1, 16, 8, false}, {16, 8, 1, true}};
+    const size_t kernelSize = 3;
+    const char* dilations = "[1,2,4,8,16,32,64,128,256,512]";
+    const size_t layers = 10;
+    
+    std::ostringstream config;
+    size_t count = 1; // head_scale
+    config << "{\"layers\":[";
+    for (size_t a = 0; a < 2; ++a) {
+        const Array& array = arrays[a];
+        const size_t c = array.channels;
+        // Réarrangement, puis par couche : conv dilatée + biais, mix de la
+        // condition, projection 1x1 + biais ; puis la tête
+        count += c * array.inputSize + layers * (c * c * kernelSize + 2 * c + c * c + c) + array.headSize * c;
+        count += array.headBias ? array.headSize : 0;
+        config << (a ? "," : "") << "{\"input_size\":" << array.inputSize << ",\"condition_size\":1"
+               << ",\"head_size\":" << array.headSize << ",\"channels\":" << c << ",\"kernel_size\":" << kernelSize
+               << ",\"dilations\":" << dilations << ",\"activation\":\"Tanh\",\"gated\":false"
+               << ",\"head_bias\":" << (array.headBias ? "true" : "false") << "}";
+    }
+    config << "],\"head\":null,\"head_scale\":0.02}";
+    
+    std::vector<float> weights(count);
+    fillSignal(weights, 8);
+    std::ostringstream out;
+    out << "{\"version\":\"0.5.2\",\"architecture\":\"WaveNet\",\"config\":" << config.str()
+        << ",\"metadata\":{\"name\":\"Benchmark\"},\"sample_rate\":48000,\"weights\":[";
+    for (size_t i = 0; i < weights.size(); ++i) {
+        out << (i ? "," : "") << weights[i] * 0.2f;
+    }
+    out << "]}";
+    return out.str();
+}
+
+std::shared_ptr<EffectBase> createEffect(const std::string& type, uint32_t sampleRate) {
+    if (type == "ir_convolution") {
+        auto ir = std::make_shared<IRConvolution>();
+        ir->setSampleRate(sampleRate);
+        ir->loadIR(makeCabinetIR(sampleRate));
+        return ir;
+    }
+    if (type == "nam") {
+        static const std::string model = makeLinearModel();
+        auto nam = std::make_shared<NAMEffect>();
+        nam->setSampleRate(sampleRate);
+        nam->loadModelFromMemory(reinterpret_cast<const uint8_t*>(model.data()), model.size());
+        return nam;
+    }
+    if (type == "parallel") {
+        // Deux branches typiques (drive / delay) sur le pool temps réel
+        auto parallel = std::make_shared<ParallelEffect>(2);
+        parallel->addEffect(0, std::make_shared<OverdriveEffect>());
+        parallel->addEffect(1, std::make_shared<DelayEffect>());
+        return parallel;
+    }
+    return EffectManager::createEffect(type);
+}
+
+// Un appel process() par itération, stéréo, frames x sampleRate
+void BM_Effect(benchmark::State& state, const char* type) {
+    const uint32_t frames = static_cast<uint32_t>(state.range(0));
+    const uint32_t sampleRate = static_cast<uint32_t>(state.range(1));
+    
+    auto effect = createEffect(type, sampleRate);
+    if (!effect) {
+        state.SkipWithError("effet inconnu");
+        return;
+    }
+    effect->setSampleRate(sampleRate);
+    effect->setMaxBlockSize(frames);
+    
+    constexpr uint32_t channels = 2;
+    AudioBuffer input(channels, frames);
+    AudioBuffer output(channels, frames);
+    fillSignal(input, sampleRate);
+    
+    // Préchauffage : premiers blocs (caches, états paresseux) hors mesure
+    for (int i = 0; i < 8; ++i) {
+        effect->process(input.getReadPointers(), output.getWritePointers(), channels, frames);
+    }
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] {
+            effect->process(input.getReadPointers(), output.getWritePointers(), channels, frames);
+        });
+        benchmark::DoNotOptimize(output.getChannel(0)[frames - 1]);
+    }
+    meter.report(state, static_cast<int64_t>(channels) * frames);
+}
+
+// Inférence NAM seule (mono, 48 kHz), sans le rééchantillonnage de
+// NAMEffect : coût de référence du WaveNet standard par bloc
+void BM_NAMWaveNetStandard(benchmark::State& state) {
+    const size_t frames = static_cast<size_t>(state.range(0));
+    auto dsp = NAMDSP::create(JsonParser::parseDocument(makeStandardWaveNetModel()), frames);
+    
+    std::vector<float> input(frames);
+    std::vector<float> output(frames);
+    fillSignal(input, 7);
+    for (int i = 0; i < 8; ++i) {
+        dsp->process(input.data(), output.data(), frames);
+    }
+    
+    CallMeter meter;
+    for (auto _ : state) {
+        meter.measure([&] {
+            dsp->process(input.data(), output.data(), frames);
+        });
+        benchmark::DoNotOptimize(output[frames - 1]);
+    }
+    meter.report(state, static_cast<int64_t>(frames));
+}
+
+void effectArguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"frames", "rate"});
+    for (int64_t frames = MIN_FRAMES; frames <= MAX_FRAMES; frames *= 2) {
+        for (int64_t sampleRate : SAMPLE_RATES) {
+            benchmark->Args({frames, sampleRate});
+        }
+    }
+    // Temps réel (échéance audio) ; courtes mesures, 35 combinaisons par effet
+    benchmark->UseRealTime()->MinTime(0.05);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Effect, distortion, "distortion")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, overdrive, "overdrive")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, fuzz, "fuzz")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, chorus, "chorus")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, flanger, "flanger")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, tremolo, "tremolo")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, eq, "eq")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, delay, "delay")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, reverb, "reverb")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, ir_convolution, "ir_convolution")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, nam, "nam")->Apply(effectArguments);
+BENCHMARK_CAPTURE(BM_Effect, parallel, "parallel")->Apply(effectArguments);
+BENCHMARK(BM_NAMWaveNetStandard)->ArgName("frames")->RangeMultiplier(2)->Range(MIN_FRAMES, MAX_FRAMES)->UseRealTime();
+
+} // namespace bench
+} // namespace webamp
@@ -0,0 +1,212 @@
+#include "bench_common.h"
+#include "json_parser.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Point d'entrée des microbenchmarks. En plus des options de Google
+// Benchmark (--benchmark_filter, --benchmark_out=f.json, ...) :
+//
+//   --baseline=<fichier.json>        Compare aux résultats d'un run précédent
+//                                    (sortie --benchmark_out_format=json)
+//   --regression_threshold=<pct>     Tolérance sur ns_per_sample (défaut 10 %)
+//
+// Un benchmark régresse si ns_per_sample dépasse la référence de plus que
+// la tolérance, ou s'il alloue alors que la référence n'allouait pas. Le
+// code de sortie vaut 1 en cas de régression (utilisable en CI).
+
+namespace webamp {
+namespace bench {
+
+std::atomic<uint64_t> g_allocations{0};
+
+} // namespace bench
+} // namespace webamp
+
+// Comptage des allocations : toutes les formes de operator new passent par
+// ces deux surcharges (les versions tableau et nothrow les appellent)
+void* operator new(std::size_t size) {
+    webamp::bench::g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using namespace webamp;
+
+struct Measurement {
+    double nsPerSample = 0.0;
+    double allocsPerCall = 0.0;
+    double worstCycles = 0.0;
+};
+
+// Meilleur run par benchmark (répétitions : le minimum est le plus stable)
+void keepBest(std::map<std::string, Measurement>& results, const std::string& name, const Measurement& measurement) {
+    auto found = results.find(name);
+    if (found == results.end() || measurement.nsPerSample < found->second.nsPerSample) {
+        results[name] = measurement;
+    }
+}
+
+// Affichage console habituel, en gardant les mesures pour la comparaison
+class RecordingReporter : public benchmark::ConsoleReporter {
+public:
+    std::map<std::string, Measurement> results;
+    
+    void ReportRuns(const std::vector<Run>& runs) override {
+        for (const auto& run : runs) {
+            if (run.run_type != Run::RT_Iteration || run.error_occurred) {
+                continue;
+            }
+            Measurement measurement;
+            auto counter = [&run](const char* name) {
+                auto found = run.counters.find(name);
+                return found != run.counters.end() ? found->second.value : 0.0;
+            };
+            measurement.nsPerSample = counter("ns_per_sample");
+            measurement.allocsPerCall = counter("allocs_per_call");
+            measurement.worstCycles = counter("worst_cycles");
+            keepBest(results, run.benchmark_name(), measurement);
+        }
+        ConsoleReporter::ReportRuns(runs);
+    }
+};
+
+bool loadBaseline(const std::string& path, std::map<std::string, Measurement>& baseline) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'ouvrir la référence: " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    
+    try {
+        const JsonValue document = JsonParser::parseDocument(buffer.str());
+        for (const JsonValue& entry : document["benchmarks"].getArray()) {
+            if (entry["run_type"].asString("iteration") != "iteration" || !entry.has("ns_per_sample")) {
+                continue;
+            }
+            Measurement measurement;
+            measurement.nsPerSample = entry["ns_per_sample"].asNumber();
+            measurement.allocsPerCall = entry["allocs_per_call"].asNumber();
+            measurement.worstCycles = entry["worst_cycles"].asNumber();
+            keepBest(baseline, entry["name"].asString(), measurement);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Référence invalide (" << path << "): " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Renvoie le nombre de régressions
+int compareWithBaseline(const std::map<std::string, Measurement>& baseline,
+                        const std::map<std::string, Measurement>& current, double threshold) {
+    int regressions = 0;
+    int improvements = 0;
+    int compared = 0;
+    
+    std::cout << "\nComparaison avec la référence (tolérance " << threshold * 100.0 << " %)\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto& item : current) {
+        auto reference = baseline.find(item.first);
+        if (reference == baseline.end() || reference->second.nsPerSample <= 0.0) {
+            continue;
+        }
+        ++compared;
+        const Measurement& before = reference->second;
+        const Measurement& after = item.second;
+        const double ratio = after.nsPerSample / before.nsPerSample;
+        const bool slower = ratio > 1.0 + threshold;
+        const bool allocates = after.allocsPerCall > 0.0 && before.allocsPerCall == 0.0;
+        
+        if (slower || allocates) {
+            ++regressions;
+            std::cout << "REGRESSION " << item.first << ": "
+                      << before.nsPerSample << " -> " << after.nsPerSample << " ns/échantillon ("
+                      << std::showpos << (ratio - 1.0) * 100.0 << std::noshowpos << " %)";
+            if (allocates) {
+                std::cout << ", " << after.allocsPerCall << " allocations/appel";
+            }
+            std::cout << "\n";
+        } else if (ratio < 1.0 - threshold) {
+            ++improvements;
+            std::cout << "amélioration " << item.first << ": "
+                      << before.nsPerSample << " -> " << after.nsPerSample << " ns/échantillon\n";
+        }
+    }
+    
+    std::cout << compared << " benchmarks comparés, " << regressions << " régression(s), "
+              << improvements << " amélioration(s)\n";
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string baselinePath;
+    double threshold = 0.10;
+    
+    // Options propres retirées avant Initialize (qui refuse les inconnues)
+    std::vector<char*> arguments;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--baseline=", 11) == 0) {
+            baselinePath = argv[i] + 11;
+        } else if (std::strncmp(argv[i], "--regression_threshold=", 23) == 0) {
+            threshold = std::atof(argv[i] + 23) / 100.0;
+        } else {
+            arguments.push_back(argv[i]);
+        }
+    }
+    int count = static_cast<int>(arguments.size());
+    
+    benchmark::Initialize(&count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(count, arguments.data())) {
+        return 1;
+    }
+    
+    std::map<std::string, Measurement> baseline;
+    if (!baselinePath.empty() && !loadBaseline(baselinePath, baseline)) {
+        return 1;
+    }
+    
+    RecordingReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    
+    if (!baselinePath.empty()) {
+        return compareWithBaseline(baseline, reporter.results, threshold) > 0 ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace webamp {
+
+// Allocateur aligné (32 octets par défaut : chargements AVX alignés)
+template<typename T, size_t Alignment = 32>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t count) {
+        if (count == 0) {
+            return nullptr;
+        }
+        void* ptr = ::operator new(count * sizeof(T), std::align_val_t(Alignment));
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+// Buffer de samples aligné
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace webamp
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "aligned_allocator.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace webamp {
+
+// Buffer audio planaire : un tableau contigu par canal, chaque canal aligné
+// sur 32 octets (AVX). Format interne de la chaîne d'effets ; l'entrelacement
+// du driver n'est converti qu'à l'entrée et à la sortie du pipeline.
+class AudioBuffer {
+public:
+    static constexpr uint32_t MAX_CHANNELS = 2;
+
+    AudioBuffer() : channel_count_(0), frame_capacity_(0), stride_(0), channels_{} {}
+    AudioBuffer(uint32_t channels, uint32_t frames) : AudioBuffer() { resize(channels, frames); }
+
+    AudioBuffer(const AudioBuffer&) = delete;
+    AudioBuffer& operator=(const AudioBuffer&) = delete;
+
+    // Thread de contrôle : alloue channels x frames (contenu remis à zéro)
+    void resize(uint32_t channels, uint32_t frames) {
+        channel_count_ = std::min(channels, MAX_CHANNELS);
+        frame_capacity_ = frames;
+        // Pas multiple de 8 floats : chaque canal reste aligné sur 32 octets
+        stride_ = (static_cast<size_t>(frames) + 7) & ~static_cast<size_t>(7);
+        data_.assign(stride_ * channel_count_, 0.0f);
+        for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+            channels_[ch] = ch < channel_count_ ? data_.data() + ch * stride_ : nullptr;
+        }
+    }
+
+    uint32_t getChannelCount() const { return channel_count_; }
+    uint32_t getFrameCapacity() const { return frame_capacity_; }
+
+    float* getChannel(uint32_t channel) { return channels_[channel]; }
+    const float* getChannel(uint32_t channel) const { return channels_[channel]; }
+    float* const* getWritePointers() { return channels_; }
+    const float* const* getReadPointers() const { return channels_; }
+
+    void clear() { std::fill(data_.begin(), data_.end(), 0.0f); }
+
+    // Conversions et copies (thread audio, sans allocation)
+    static void deinterleave(const float* interleaved, float* const* planar, uint32_t channels, uint32_t frames) {
+        if (channels == 2) {
+            float* left = planar[0];
+            float* right = planar[1];
+            for (uint32_t i = 0; i < frames; ++i) {
+                left[i] = interleaved[i * 2];
+                right[i] = interleaved[i * 2 + 1];
+            }
+            return;
+        }
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            for (uint32_t i = 0; i < frames; ++i) {
+                planar[ch][i] = interleaved[i * channels + ch];
+            }
+        }
+    }
+
+    static void interleave(const float* const* planar, float* interleaved, uint32_t channels, uint32_t frames) {
+        if (channels == 2) {
+            const float* left = planar[0];
+            const float* right = planar[1];
+            for (uint32_t i = 0; i < frames; ++i) {
+                interleaved[i * 2] = left[i];
+                interleaved[i * 2 + 1] = right[i];
+            }
+            return;
+        }
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            for (uint32_t i = 0; i < frames; ++i) {
+                interleaved[i * channels + ch] = planar[ch][i];
+            }
+        }
+    }
+
+    static void copy(const float* const* input, float* const* output, uint32_t channels, uint32_t frames) {
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            if (input[ch] != output[ch]) {
+                std::copy(input[ch], input[ch] + frames, output[ch]);
+            }
+        }
+    }
+
+private:
+    uint32_t channel_count_;
+    uint32_t frame_capacity_;
+    size_t stride_;
+    AlignedVector<float> data_;
+    float* channels_[MAX_CHANNELS];
+};
+
+} // namespace webamp
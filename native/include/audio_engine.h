@@ -2,6 +2,7 @@
 
 #include "audio_driver.h"
 #include "dsp_pipeline.h"
+#include "realtime_thread.h"
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -30,9 +31,12 @@ public:
     uint32_t getSampleRate() const;
     uint32_t getBufferSize() const;
     
-    // Driver audio
+    // Driver audio ("auto", nom de driver, "null" ou "file:<chemin.wav>"
+    // pour fonctionner sans matériel)
     std::vector<std::string> getAvailableDrivers() const;
     bool setDriver(const std::string& driverName);
+    const std::string& getDriverName() const { return current_driver_name_; }
+    AudioDriver* getDriver() const { return driver_.get(); }
     
     // Pipeline DSP
     std::shared_ptr<DSPPipeline> getPipeline() const { return pipeline_; }
@@ -40,6 +44,13 @@ public:
     // Latence
     double getTotalLatency() const;  // en secondes
     
+    // Durcissement temps réel (opt-in, settings.enabled) appliqué au
+    // prochain start() : mémoire verrouillée depuis le thread de contrôle,
+    // threads de travail du RTWorkerPool partagé, puis thread audio du driver
+    // à son premier callback. L'état appliqué est rapporté par getStats().
+    bool setRealtimeSettings(const RealtimeThread::Settings& settings);
+    const RealtimeThread::Settings& getRealtimeSettings() const { return realtime_settings_; }
+    
     // Stats
     DSPPipeline::Stats getStats() const;
     
@@ -61,6 +72,15 @@ private:
     // Configuration
     uint32_t sample_rate_;
     uint32_t buffer_size_;
+    
+    // Durcissement temps réel : audio_thread_state_ est écrit par le thread
+    // audio avant la publication de audio_thread_ready_
+    RealtimeThread::Settings realtime_settings_;
+    std::atomic<bool> audio_thread_setup_pending_;
+    std::atomic<bool> audio_thread_ready_;
+    RealtimeThread::State audio_thread_state_;
+    RealtimeThread::State worker_threads_state_;
+    bool memory_locked_;
 };
 
 } // namespace webamp
@@ -1,40 +1,121 @@
 #pragma once
 
+#include "aligned_allocator.h"
+#include <atomic>
 #include <cstdint>
-#include <vector>
 #include <memory>
-#include <mutex>
-#include <queue>
+#include <vector>
 
 namespace webamp {
 
 // Pool de buffers audio réutilisables pour éviter les allocations
+//
+// Capacité fixe : tous les blocs (alignés sur 64 octets) sont alloués à la
+// construction, en une seule zone. acquire() et release() sont sans verrou
+// ni allocation (pile libre intrusive, O(1)) et utilisables depuis le
+// thread audio comme depuis les threads de travail. Pool épuisé : acquire()
+// renvoie nullptr et le compte dans getExhaustedCount().
+//
+// La remise à zéro est paresseuse : un bloc rendu n'est effacé qu'au
+// prochain acquire(true) (jamais pour un bloc qui n'a pas encore servi).
+// Chaque buffer ne doit être rendu qu'une fois : un second release() (ou
+// celui d'un bloc qui n'est pas emprunté) est ignoré et compté dans
+// getInvalidReleaseCount(), le bloc n'entre jamais deux fois dans la pile.
 class BufferPool {
 public:
+    static constexpr size_t ALIGNMENT = 64;
+    
+    // Buffer emprunté, rendu au pool à la destruction (déplaçable)
+    class Buffer {
+    public:
+        Buffer() = default;
+        Buffer(BufferPool* pool, float* data) : pool_(pool), data_(data) {}
+        ~Buffer() { reset(); }
+        
+        Buffer(Buffer&& other) noexcept : pool_(other.pool_), data_(other.data_) {
+            other.pool_ = nullptr;
+            other.data_ = nullptr;
+        }
+        Buffer& operator=(Buffer&& other) noexcept {
+            if (this != &other) {
+                reset();
+                pool_ = other.pool_;
+                data_ = other.data_;
+                other.pool_ = nullptr;
+                other.data_ = nullptr;
+            }
+            return *this;
+        }
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+        
+        float* get() const { return data_; }
+        explicit operator bool() const { return data_ != nullptr; }
+        
+        // Rend le buffer avant la fin de la portée
+        void reset() {
+            if (data_) {
+                pool_->release(data_);
+                data_ = nullptr;
+            }
+        }
+    
+    private:
+        BufferPool* pool_ = nullptr;
+        float* data_ = nullptr;
+    };
+    
+    // bufferSize : floats par buffer, poolSize : capacité (fixe)
     BufferPool(size_t bufferSize, size_t poolSize = 4);
     ~BufferPool();
     
-    // Obtenir un buffer du pool
-    float* acquire();
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
     
-    // Libérer un buffer dans le pool
+    // Obtenir un buffer du pool (nullptr si épuisé). zeroed : contenu à zéro
+    float* acquire(bool zeroed = false);
+    
+    // Libérer un buffer dans le pool (ignoré s'il n'en vient pas ou s'il
+    // n'est pas emprunté)
     void release(float* buffer);
     
+    // Emprunt RAII (faux si le pool est épuisé)
+    Buffer borrow(bool zeroed = false) { return Buffer(this, acquire(zeroed)); }
+    
     // Obtenir la taille des buffers
     size_t getBufferSize() const { return buffer_size_; }
+    size_t getCapacity() const { return capacity_; }
     
     // Statistiques
     size_t getAvailableCount() const;
     size_t getUsedCount() const;
+    // Nombre d'acquire() ayant trouvé le pool vide
+    uint64_t getExhaustedCount() const { return exhausted_.load(std::memory_order_relaxed); }
+    // Nombre de release() ignorés : pointeur étranger, bloc déjà rendu
+    uint64_t getInvalidReleaseCount() const { return invalid_releases_.load(std::memory_order_relaxed); }
     
 private:
     size_t buffer_size_;
-    std::vector<std::unique_ptr<float[]>> buffers_;
-    std::queue<float*> available_buffers_;
-    mutable std::mutex mutex_;
+    size_t stride_;         // Floats entre deux blocs (multiple de ALIGNMENT)
+    size_t capacity_;
+    std::vector<float, AlignedAllocator<float, ALIGNMENT>> storage_;
+    
+    // Pile libre : index + 1 du sommet (0 : vide) dans les 32 bits bas,
+    // compteur de modifications dans les 32 bits hauts (ABA)
+    std::atomic<uint64_t> head_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;
+    // Bloc emprunté depuis sa dernière remise à zéro (lu et écrit par le
+    // seul détenteur du bloc)
+    std::unique_ptr<bool[]> dirty_;
+    // Bloc hors de la pile : levé par acquire(), consommé par le seul
+    // release() accepté (échange atomique)
+    std::unique_ptr<std::atomic<bool>[]> borrowed_;
     
-    void initializePool(size_t poolSize);
+    std::atomic<size_t> used_;
+    std::atomic<uint64_t> exhausted_;
+    std::atomic<uint64_t> invalid_releases_;
+    
+    void push(uint32_t index);
 };
 
 } // namespace webamp
-
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "audio_buffer.h"
+#include "buffer_pool.h"
+#include <atomic>
+#include <cstdint>
+
+namespace webamp {
+
+// Retard de compensation de latence (voir EffectBase::getLatency)
+//
+// Aligne un chemin de signal sur un chemin plus lent, par ex. la branche
+// sèche d'un ParallelEffect sur une branche NAM rééchantillonnée. Les lignes
+// à retard (une par canal) sont réservées par le thread de contrôle
+// (reserve()) : le thread audio n'emprunte ni ne rend jamais de ligne.
+class CompensationDelay {
+public:
+    // Retard maximal en échantillons (~170 ms à 48 kHz), puissance de 2
+    static constexpr uint32_t MAX_DELAY = 8192;
+    static constexpr uint32_t MAX_CHANNELS = AudioBuffer::MAX_CHANNELS;
+    
+    // Pool de lignes partagé par tout le processus (alloué au premier appel,
+    // à faire hors du thread audio)
+    static constexpr size_t SHARED_POOL_LINES = 32;
+    static BufferPool& getSharedPool();
+    
+    // pool == nullptr : pool partagé
+    explicit CompensationDelay(BufferPool* pool = nullptr);
+    ~CompensationDelay() = default;
+    
+    CompensationDelay(const CompensationDelay&) = delete;
+    CompensationDelay& operator=(const CompensationDelay&) = delete;
+    
+    // Thread de contrôle, hors traitement : emprunte les lignes (à zéro).
+    // Faux si le pool est épuisé (aucune ligne gardée).
+    bool reserve();
+    void release();
+    bool isReserved() const { return static_cast<bool>(lines_[0]); }
+    
+    // Thread audio, in-place autorisé. delay borné à MAX_DELAY - 1. Les
+    // lignes enregistrent l'entrée même sans retard : un changement de
+    // retard relit l'historique réel (saut de lecture). Lignes non
+    // réservées : signal recopié sans retard, bloc compté dans
+    // getFailureCount() et renvoie false.
+    bool process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount,
+                 uint32_t delay);
+    
+    uint32_t getDelay() const { return delay_; }
+    // Blocs traités sans le retard demandé (tout thread)
+    uint64_t getFailureCount() const { return failures_.load(std::memory_order_relaxed); }
+
+private:
+    BufferPool* pool_;
+    BufferPool::Buffer lines_[MAX_CHANNELS];
+    uint32_t delay_;
+    uint32_t write_position_;
+    std::atomic<uint64_t> failures_;
+};
+
+} // namespace webamp
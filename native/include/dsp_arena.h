@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace webamp {
+
+// Bloc de mémoire DSP contigu, aligné sur 64 octets (ligne de cache) et
+// initialisé à zéro. EffectChain y dispose l'état de tous ses effets
+// (lignes à retard, filtres) dans l'ordre de traitement : un bloc audio
+// parcourt la mémoire de la chaîne de façon séquentielle au lieu de sauter
+// entre des vecteurs dispersés dans le tas.
+//
+// Avec hugePages, les grands blocs sont adossés à des pages de 2 Mo quand
+// le système le permet (Linux : hugetlbfs puis transparent huge pages,
+// Windows : MEM_LARGE_PAGES avec le privilège SeLockMemoryPrivilege), ce
+// qui réduit les défauts de TLB. Sinon, allocation alignée ordinaire.
+//
+// Alloué et libéré par le thread de contrôle uniquement.
+class DSPArena {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    
+    explicit DSPArena(size_t size, bool hugePages = false);
+    ~DSPArena();
+    
+    DSPArena(const DSPArena&) = delete;
+    DSPArena& operator=(const DSPArena&) = delete;
+    
+    unsigned char* getData() const { return data_; }
+    size_t getSize() const { return size_; }
+    bool usesHugePages() const { return huge_pages_; }
+    
+    // Taille arrondie au multiple de ALIGNMENT supérieur
+    static size_t alignSize(size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+private:
+    enum class Backing { Heap, Mapped, LargePages };
+    
+    unsigned char* data_;
+    size_t size_;
+    size_t reserved_;       // Taille réellement réservée (arrondie aux pages)
+    Backing backing_;
+    bool huge_pages_;
+};
+
+// Disposition d'une zone de l'arène. Sans base, mesure seulement la taille
+// nécessaire ; avec une base, affecte aussi les pointeurs. Chaque
+// allocation commence sur une ligne de cache. Les tailles dépendent de
+// getSampleRate(), fixé par le thread de contrôle à l'attribution de la
+// zone : la disposition faite par le thread audio reprend la mesure.
+class ArenaLayout {
+public:
+    explicit ArenaLayout(unsigned char* base = nullptr, uint32_t sampleRate = 0)
+        : base_(base), offset_(0), sample_rate_(sampleRate) {}
+    
+    template<typename T>
+    void allocate(T*& pointer, size_t count) {
+        if (base_) {
+            pointer = reinterpret_cast<T*>(base_ + offset_);
+        }
+        offset_ += DSPArena::alignSize(count * sizeof(T));
+    }
+    
+    bool isMeasuring() const { return base_ == nullptr; }
+    size_t getSize() const { return offset_; }
+    uint32_t getSampleRate() const { return sample_rate_; }
+
+private:
+    unsigned char* base_;
+    size_t offset_;
+    uint32_t sample_rate_;
+};
+
+// Zone d'arène liée à un effet (voir EffectBase::assignMemory)
+//
+// Le thread de contrôle attribue une nouvelle zone (assign), le thread
+// audio la prend en compte au début du bloc suivant (takePending puis
+// setBound). Les zones remplacées, et avec elles les arènes, sont libérées
+// par le thread de contrôle lors d'une attribution suivante, une fois que
+// le thread audio ne peut plus les lire.
+class EffectMemory {
+public:
+    struct Block {
+        std::shared_ptr<DSPArena> arena;
+        unsigned char* data = nullptr;
+        size_t size = 0;
+        // Sample rate de la mesure (voir ArenaLayout::getSampleRate())
+        uint32_t sampleRate = 0;
+    };
+    
+    EffectMemory();
+    ~EffectMemory();
+    
+    // Thread de contrôle
+    void assign(std::shared_ptr<DSPArena> arena, unsigned char* data, size_t size, uint32_t sampleRate);
+    // Thread de contrôle : dernière zone attribuée, liée ou non (nullptr si aucune)
+    const unsigned char* getAssigned() const;
+    
+    // Thread audio : zone attribuée depuis le dernier appel (nullptr sinon)
+    Block* takePending() {
+        if (!pending_.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return pending_.exchange(nullptr, std::memory_order_acquire);
+    }
+    // Thread audio : zone en service
+    void setBound(Block* block) { bound_.store(block, std::memory_order_release); }
+    
+    const Block* getBound() const { return bound_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<Block*> pending_;
+    std::atomic<Block*> bound_;
+    
+    // Thread de contrôle : zones de la plus ancienne à la plus récente
+    std::vector<std::unique_ptr<Block>> blocks_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace webamp
@@ -1,10 +1,16 @@
 #pragma once
 
+#include "audio_buffer.h"
+#include "dsp_profiler.h"
 #include "effect_chain.h"
 #include "ring_buffer.h"
 #include "test_tone_generator.h"
-#include "buffer_pool.h"
+#include "nam_effect.h"
 #include "nam_loader.h"
+#include "quality_controller.h"
+#include "realtime_thread.h"
+#include "snapshot_publisher.h"
+#include "seqlock.h"
 #include <cstdint>
 #include <vector>
 #include <atomic>
@@ -15,6 +21,12 @@
 namespace webamp {
 
 // Pipeline DSP principal : gère la chaîne d'effets et le traitement audio
+//
+// process() est appelé depuis le callback audio : il ne prend aucun verrou et
+// ne libère aucune mémoire. Le traitement interne est planaire (un buffer par
+// canal) ; seules l'entrée et la sortie du driver sont entrelacées. La chaîne et le modèle NAM sont publiés par le
+// thread de contrôle sous forme d'instantané (SnapshotPublisher), les stats
+// sont exposées via un seqlock.
 class DSPPipeline {
 public:
     DSPPipeline();
@@ -24,6 +36,9 @@ public:
     bool initialize(uint32_t sampleRate, uint32_t bufferSize);
     void shutdown();
     
+    uint32_t getSampleRate() const { return sample_rate_; }
+    uint32_t getBufferSize() const { return buffer_size_; }
+    
     // Traitement audio (appelé depuis le callback audio)
     void process(float* input, float* output, uint32_t frameCount);
     
@@ -31,17 +46,50 @@ public:
     void setEffectChain(std::shared_ptr<EffectChain> chain);
     std::shared_ptr<EffectChain> getEffectChain() const;
     
+    // Callback audio en service (AudioEngine::start()/stop()), transmis à
+    // la chaîne (voir EffectChain::setAudioThreadActive)
+    void setAudioThreadActive(bool active);
+    
     // Monitoring
     struct Stats {
         double cpuUsage = 0.0;        // % CPU
         double peakInput = 0.0;       // dB
         double peakOutput = 0.0;      // dB
-        double latency = 0.0;         // ms
+        double latency = 0.0;         // ms, bloc + traitement (de bout en bout via AudioEngine)
+        double processingLatency = 0.0; // ms, latences rapportées par le NAM et la chaîne
         uint64_t samplesProcessed = 0;
+        uint32_t qualityLevel = 0;    // Niveau de dégradation adaptative (0 : nominal)
+        
+        // Durcissement temps réel (rempli par AudioEngine, voir
+        // AudioEngine::setRealtimeSettings) : thread audio du driver et
+        // threads de travail (réglage appliqué sur tous les threads)
+        RealtimeThread::State audioThread;
+        RealtimeThread::State workerThreads;
     };
     
     Stats getStats() const;
-    void resetStats();
+    void resetStats();  // Appliqué par le thread audio au bloc suivant
+    
+    // Profil détaillé : coût par effet et par étage, dépassements d'échéance
+    DSPProfiler::Profile getProfile() const { return profiler_.getProfile(); }
+    void resetProfile() { profiler_.reset(); }
+    void setProfilingEnabled(bool enabled);
+    bool isProfilingEnabled() const { return profiler_.isEnabled(); }
+    
+    // Dégradation adaptative : niveau de qualité de la chaîne piloté par la
+    // charge de chaque bloc (désactivée par défaut). Les changements de
+    // niveau sont lus par le thread de contrôle, dans l'ordre.
+    void setAdaptiveQuality(const QualityController::Settings& settings) { quality_controller_.setSettings(settings); }
+    QualityController::Settings getAdaptiveQuality() const { return quality_controller_.getSettings(); }
+    uint32_t getQualityLevel() const { return quality_controller_.getLevel(); }
+    size_t readQualityEvents(QualityController::Event* events, size_t maxCount) {
+        return quality_controller_.readEvents(events, maxCount);
+    }
+    
+    // Étages du pipeline hors chaîne d'effets (id et libellé dans le profil)
+    static const char* const STAGE_INPUT;
+    static const char* const STAGE_NAM;
+    static const char* const STAGE_OUTPUT;
     
     // Configuration
     void setInputGain(float gain);    // dB
@@ -49,6 +97,12 @@ public:
     float getInputGain() const;
     float getOutputGain() const;
     
+    // Entrée mono (guitare sur l'entrée 1) : seul le canal gauche est lu et
+    // la chaîne reste mono jusqu'à son premier effet stéréo (voir
+    // EffectChain::processMono). Désactivé par défaut (entrée stéréo).
+    void setMonoInput(bool mono) { mono_input_.store(mono, std::memory_order_relaxed); }
+    bool isMonoInput() const { return mono_input_.load(std::memory_order_relaxed); }
+    
     // Générateur de signal de test
     void enableTestTone(bool enabled);
     void setTestToneFrequency(float frequency);
@@ -58,32 +112,62 @@ public:
     // Neural Amp Modeler (NAM) - Support des modèles d'amplis/pédales par IA
     bool loadNAMModel(const std::string& filePath);
     bool loadNAMModelFromMemory(const uint8_t* data, size_t size);
+    // Modèle allégé de la même capture (lite, feather, nano), utilisé par
+    // l'ampli quand la dégradation adaptative atteint le niveau 1 (voir
+    // NAMEffect::loadLightModel). Nécessite le modèle complet pour servir.
+    bool loadLightNAMModel(const std::string& filePath);
+    bool loadLightNAMModelFromMemory(const uint8_t* data, size_t size);
+    bool hasLightNAMModel() const;
     void setNAMModelActive(bool active);
-    bool isNAMModelActive() const { return nam_model_active_; }
-    std::shared_ptr<NAMModel> getNAMModel() const { return nam_model_; }
-    
+    bool isNAMModelActive() const;
+    std::shared_ptr<NAMModel> getNAMModel() const;
+
 private:
-    // Buffer de travail (alloué une fois, réutilisé)
-    std::vector<float> work_buffer_;
+    // État de traitement publié vers le thread audio. Le buffer de travail
+    // en fait partie : le thread audio n'utilise que celui de son
+    // instantané, libéré avec lui hors du thread audio.
+    struct ProcessingState {
+        std::shared_ptr<EffectChain> chain;
+        std::shared_ptr<NAMEffect> nam;      // nullptr si inactif
+        // Buffer de travail planaire stéréo de bufferSize frames : l'entrée
+        // entrelacée du driver n'est désentrelacée qu'une fois par bloc.
+        // Partagé par les instantanés successifs tant que la taille ne
+        // change pas (un seul lecteur). nullptr après shutdown().
+        std::shared_ptr<AudioBuffer> work;
+        uint32_t sampleRate = 0;
+        uint32_t bufferSize = 0;
+    };
     
-    // Pool de buffers pour éviter les allocations
-    std::unique_ptr<BufferPool> buffer_pool_;
+    // Buffer de travail du prochain instantané (thread de contrôle, protégé
+    // par chain_mutex_)
+    std::shared_ptr<AudioBuffer> work_buffer_;
     
-    // Chaîne d'effets
+    // Chaîne d'effets (état côté contrôle, protégé par chain_mutex_)
     std::shared_ptr<EffectChain> effect_chain_;
+    bool audio_thread_active_;
     mutable std::mutex chain_mutex_;
     
+    // État lu par le thread audio
+    SnapshotPublisher<ProcessingState> state_publisher_;
+    
     // Gains
     std::atomic<float> input_gain_;
     std::atomic<float> output_gain_;
+    std::atomic<bool> mono_input_;
     
-    // Stats
-    mutable std::mutex stats_mutex_;
+    // Stats : accumulées par le thread audio, publiées via seqlock
     Stats stats_;
+    SeqLock<Stats> published_stats_;
+    std::atomic<bool> reset_stats_requested_;
     
-    // Configuration
-    uint32_t sample_rate_;
-    uint32_t buffer_size_;
+    // Profileur temps réel (chaîne enregistrée via setProfiler)
+    DSPProfiler profiler_;
+    
+    QualityController quality_controller_;
+    
+    // Configuration (écrite sous chain_mutex_, publiée dans ProcessingState)
+    std::atomic<uint32_t> sample_rate_;
+    std::atomic<uint32_t> buffer_size_;
     
     // Générateur de signal de test
     TestToneGenerator test_tone_generator_;
@@ -92,11 +176,19 @@ private:
     std::shared_ptr<NAMModel> nam_model_;
     std::unique_ptr<NAMLoader> nam_loader_;
     bool nam_model_active_;
+    // Le modèle tourne dans un NAMEffect : à sa fréquence d'entraînement,
+    // rééchantillonné si le flux est à une autre fréquence
+    std::shared_ptr<NAMEffect> nam_effect_;
+    
+    // Latence de traitement (échantillons) du dernier bloc, thread audio
+    uint32_t processing_latency_;
     
     // Helpers
     float dbToLinear(float db) const;
     float linearToDb(float linear) const;
-    void updateStats(const float* input, const float* output, uint32_t frameCount);
+    void updateStats(const ProcessingState& state, const float* input, const float* output, uint32_t frameCount);
+    void processBlock(const ProcessingState& state, float* input, float* output, uint32_t frameCount, bool profiling);
+    void publishStateLocked();
 };
 
 } // namespace webamp
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "seqlock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace webamp {
+
+// Profilage temps réel du pipeline : coût CPU par étage (effet de la chaîne,
+// conversion d'entrée, NAM, sortie) et par bloc complet, sous forme
+// d'histogrammes dont on tire p50/p99/max côté contrôle.
+//
+// Le thread audio mesure et accumule sans verrou ni allocation ; le profil
+// est publié périodiquement via un seqlock.
+class DSPProfiler {
+public:
+    // Étages mesurés par bloc : effets de la chaîne + étages du pipeline
+    static constexpr size_t MAX_STAGES = 24;
+    
+    // Histogramme logarithmique : 4 classes par octave de 256 ns à ~16 ms
+    static constexpr size_t HISTOGRAM_BUCKETS = 64;
+    static constexpr uint32_t BUCKETS_PER_OCTAVE = 4;
+    static constexpr uint32_t MIN_OCTAVE = 8;
+    
+    // Intervalle de publication du profil (en temps audio)
+    static constexpr uint32_t PUBLISH_INTERVAL_MS = 10;
+    
+    struct StageProfile {
+        uint64_t id = 0;                 // EffectBase::getInstanceId() de l'effet mesuré, 0 pour un étage du pipeline
+        const char* label = nullptr;     // Nom statique des étages du pipeline, nullptr pour un effet
+        uint64_t count = 0;              // Blocs mesurés
+        uint64_t fusedCount = 0;         // Dont blocs dans un groupe fusionné (part égale du coût du groupe)
+        uint64_t totalNs = 0;
+        uint32_t lastNs = 0;
+        uint32_t maxNs = 0;
+        uint32_t histogram[HISTOGRAM_BUCKETS] = {};
+    };
+    
+    struct Profile {
+        uint64_t blocks = 0;
+        uint64_t xruns = 0;              // Blocs traités en plus de leur durée audio
+        uint32_t budgetNs = 0;           // Durée audio du dernier bloc
+        uint32_t stageCount = 0;
+        StageProfile block;              // Bloc complet
+        StageProfile stages[MAX_STAGES]; // Ordre de traitement du dernier bloc
+    };
+    
+    DSPProfiler();
+    
+    // Horloge monotone en nanosecondes (clock_gettime / QueryPerformanceCounter)
+    static uint64_t now();
+    
+    // Thread audio : coût d'un étage dans le bloc en cours (cumulé si le
+    // même étage est mesuré plusieurs fois, par ex. traitement par sous-blocs).
+    // Un étage est identifié par (id, label) : identifiant d'instance d'un
+    // effet, jamais réutilisé contrairement à son adresse, ou 0 et le nom
+    // d'un étage du pipeline. fused : part du coût d'un groupe fusionné
+    // (FusedChain), mesuré d'un bloc pour tous ses effets.
+    void recordStage(uint64_t id, const char* label, uint64_t elapsedNs, bool fused = false);
+    
+    // Thread audio : clôt le bloc, met à jour les histogrammes et publie
+    void endBlock(uint64_t elapsedNs, uint32_t frameCount, uint32_t sampleRate);
+    
+    // Threads de contrôle
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+    Profile getProfile() const { return published_.load(); }
+    void reset();  // Appliqué par le thread audio au bloc suivant
+    
+    // Quantile (0..1) d'un histogramme, borne haute de la classe en ns
+    static uint64_t getPercentile(const StageProfile& stage, double quantile);
+    static size_t getBucket(uint64_t ns);
+    static uint64_t getBucketUpperBound(size_t bucket);
+    
+private:
+    struct PendingStage {
+        uint64_t id;
+        const char* label;
+        uint64_t elapsedNs;
+        bool fused;
+    };
+    
+    std::atomic<bool> enabled_;
+    std::atomic<bool> reset_requested_;
+    
+    // État du thread audio
+    PendingStage pending_[MAX_STAGES];
+    size_t pending_count_;
+    uint64_t frames_since_publish_;
+    Profile working_;
+    
+    SeqLock<Profile> published_;
+    
+    static void accumulate(StageProfile& stage, uint64_t elapsedNs);
+};
+
+} // namespace webamp
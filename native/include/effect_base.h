@@ -1,19 +1,64 @@
 #pragma once
 
+#include "audio_buffer.h"
+#include "dsp_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <memory>
 
 namespace webamp {
 
+class EffectBase;
+
+// Changement de paramètre transmis au thread audio (file SPSC, voir EffectChain)
+// effect n'est jamais déréférencé par le thread audio : il est comparé,
+// avec effectId, aux effets de l'instantané courant. Un effet libéré dont
+// l'adresse est réutilisée par un nouvel effet a un autre identifiant.
+struct ParameterChange {
+    EffectBase* effect;
+    uint64_t effectId;
+    uint32_t index;
+    float value;
+};
+
 // Interface de base pour tous les effets
 class EffectBase {
 public:
+    static constexpr size_t INVALID_PARAMETER = static_cast<size_t>(-1);
+    static constexpr uint32_t MAX_CHANNELS = AudioBuffer::MAX_CHANNELS;
+    
     virtual ~EffectBase() = default;
     
-    // Traitement audio (appelé dans le callback audio)
-    virtual void process(float* input, float* output, uint32_t frameCount) = 0;
+    // Traitement audio planaire (appelé dans le callback audio) : un buffer
+    // par canal, channels <= MAX_CHANNELS, input[ch] == output[ch] autorisé.
+    // Les classes dérivées ajoutent "using EffectBase::process;" pour garder
+    // la version entrelacée visible.
+    virtual void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) = 0;
+    
+    // Stéréo entrelacé (compatibilité, tests) : désentrelacé par tranches sur
+    // la pile puis traité par la version planaire
+    void process(float* input, float* output, uint32_t frameCount) {
+        static constexpr uint32_t CHUNK = 256;
+        alignas(32) float left[CHUNK];
+        alignas(32) float right[CHUNK];
+        float* planar[2] = {left, right};
+        
+        uint32_t offset = 0;
+        while (offset < frameCount) {
+            const uint32_t chunk = std::min(frameCount - offset, CHUNK);
+            AudioBuffer::deinterleave(input + offset * 2, planar, 2, chunk);
+            process(planar, planar, 2, chunk);
+            AudioBuffer::interleave(planar, output + offset * 2, 2, chunk);
+            offset += chunk;
+        }
+    }
     
     // Configuration
     virtual void setBypass(bool bypass) { bypass_ = bypass; }
@@ -22,6 +67,132 @@ public:
     virtual void setSampleRate(uint32_t sampleRate) { sample_rate_ = sampleRate; }
     virtual uint32_t getSampleRate() const { return sample_rate_; }
     
+    // Taille de bloc maximale passée à process() (thread de contrôle) :
+    // les effets y dimensionnent leurs buffers internes
+    virtual void setMaxBlockSize(uint32_t maxFrameCount) { max_block_size_ = maxFrameCount; }
+    uint32_t getMaxBlockSize() const { return max_block_size_; }
+    
+    // Traitement en place (input[ch] == output[ch]) : autorisé par le
+    // contrat de process() pour tous les effets du dépôt. Un effet qui
+    // écrirait output avant d'avoir lu l'entrée correspondante (lecture
+    // anticipée, mélange entre canaux) renvoie false : EffectChain lui
+    // donne alors un buffer de sortie distinct.
+    virtual bool canProcessInPlace() const { return true; }
+    
+    // Négociation des canaux pour une entrée mono (EffectChain::processMono) :
+    // un effet MonoToMono rend un signal mono et peut être traité sur un
+    // seul canal (drive, ampli, EQ, IR) ; un effet MonoToStereo reçoit
+    // toujours deux canaux, le signal mono est dupliqué juste avant lui
+    // (chorus, reverb, delay). Par défaut MonoToStereo, sûr pour un effet
+    // qui ne se déclare pas.
+    enum class ChannelLayout { MonoToMono, MonoToStereo };
+    virtual ChannelLayout getChannelLayout() const { return ChannelLayout::MonoToStereo; }
+    
+    // Fusion (voir FusedChain) : un effet réduit à des étages par
+    // échantillon (gain, écrêtage, filtre à un pôle, modulation d'amplitude)
+    // renvoie son type ; EffectChain exécute alors les effets fusionnables
+    // consécutifs en une seule boucle au lieu d'un process() chacun. None
+    // (défaut) : l'effet passe par process(). Thread audio, une fois par
+    // bloc : la réponse peut dépendre des paramètres (suréchantillonnage).
+    enum class FusedKind : uint32_t { None = 0, Distortion, Overdrive, Fuzz, Tremolo };
+    virtual FusedKind getFusedKind() const { return FusedKind::None; }
+    
+    // Latence de traitement en échantillons au taux du flux : retard du
+    // signal traité par rapport à l'entrée (suréchantillonnage, îlot
+    // rééchantillonné...). Sommée par EffectChain, compensée entre les
+    // branches d'un ParallelEffect. Lue par le thread de contrôle comme par
+    // le thread audio (une fois par bloc) : sans verrou ni calcul coûteux.
+    virtual uint32_t getLatency() const { return 0; }
+    
+    // Détection de silence (EffectChain) : un bloc dont le pic reste sous
+    // SILENCE_THRESHOLD (-90 dBFS) est considéré comme silencieux
+    static constexpr float SILENCE_THRESHOLD = 3.1623e-5f;
+    static constexpr uint32_t INFINITE_TAIL = UINT32_MAX;
+    
+    // Durée de la queue en échantillons (hors getLatency()) : temps pendant
+    // lequel la sortie peut rester audible une fois l'entrée silencieuse
+    // (réverb, échos). INFINITE_TAIL : l'effet n'est jamais mis en veille.
+    // Thread audio, une fois par bloc tant que l'entrée est silencieuse.
+    virtual uint32_t getTailLength() const { return 0; }
+    
+    // Veille : entrée silencieuse depuis plus de getLatency() +
+    // getTailLength() échantillons et dernière sortie silencieuse.
+    // EffectChain ne traite plus l'effet jusqu'au retour d'un signal.
+    bool isSilent() const { return silent_.load(std::memory_order_relaxed); }
+    
+    // Thread audio (EffectChain) : entrée non silencieuse, ou bloc traité sur
+    // une entrée silencieuse (outputSilent : pic de la sortie produite)
+    void resetSilence() {
+        silent_frames_ = 0;
+        if (silent_.load(std::memory_order_relaxed)) {
+            silent_.store(false, std::memory_order_relaxed);
+        }
+    }
+    void advanceSilence(uint32_t frameCount, bool outputSilent) {
+        silent_frames_ += frameCount;
+        const uint32_t tail = getTailLength();
+        if (outputSilent && tail != INFINITE_TAIL && silent_frames_ >= static_cast<uint64_t>(getLatency()) + tail) {
+            silent_.store(true, std::memory_order_relaxed);
+        }
+    }
+    
+    // Niveaux de qualité (dégradation adaptative, voir QualityController) :
+    // 0 = qualité nominale, getQualityTierCount() - 1 = le moins coûteux.
+    // Appelé par le thread audio entre deux blocs, sans allocation ; le
+    // niveau est borné au dernier niveau de l'effet.
+    virtual uint32_t getQualityTierCount() const { return 1; }
+    void setQualityTier(uint32_t tier) {
+        tier = std::min(tier, getQualityTierCount() - 1);
+        if (tier != quality_tier_) {
+            quality_tier_ = tier;
+            applyQualityTier(tier);
+        }
+    }
+    uint32_t getQualityTier() const { return quality_tier_; }
+    
+    // Mémoire DSP (lignes à retard, état des filtres) disposée par
+    // layoutMemory(), dimensionnée d'après le sample rate et les plages
+    // maximales des paramètres. Chaque effet s'alloue sa propre zone ;
+    // EffectChain regroupe celles de ses effets dans une arène contiguë.
+    //
+    // Thread de contrôle : taille nécessaire, attribution d'une zone de
+    // getMemorySize() octets alignée sur DSPArena::ALIGNMENT, à zéro (prise
+    // en compte au début du prochain process(), l'état repart de zéro : le
+    // thread audio ne recopie jamais l'ancienne zone)
+    size_t getMemorySize() {
+        ArenaLayout layout(nullptr, sample_rate_);
+        layoutMemory(layout);
+        return layout.getSize();
+    }
+    void assignMemory(std::shared_ptr<DSPArena> arena, unsigned char* data) {
+        memory_.assign(std::move(arena), data, getMemorySize(), sample_rate_);
+    }
+    // Zone en service (nullptr si l'effet n'a pas de mémoire ou n'a pas
+    // encore été traité)
+    const void* getMemoryData() const {
+        const EffectMemory::Block* block = memory_.getBound();
+        return block ? block->data : nullptr;
+    }
+    // Thread de contrôle : dernière zone attribuée, en service ou non
+    const void* getAssignedMemoryData() const { return memory_.getAssigned(); }
+    
+    // Effets dont la mémoire doit être disposée dans l'arène de la chaîne,
+    // dans l'ordre de traitement (les effets composites y ajoutent ceux de
+    // leurs branches)
+    virtual void collectMemoryEffects(std::vector<EffectBase*>& effects) { effects.push_back(this); }
+    
+    // Effets composites : un effet ajouté ou retiré d'une branche est signalé
+    // au conteneur (EffectChain, ou effet composite parent), qui redispose
+    // son arène et republie. Thread de contrôle ; nullptr pour détacher.
+    void setStructureListener(std::function<void()> listener) {
+        std::lock_guard<std::mutex> lock(structure_mutex_);
+        structure_listener_ = std::move(listener);
+    }
+    
+    // Durée de la rampe appliquée aux changements de paramètres (secondes)
+    void setSmoothingTime(float seconds) { smoothing_time_ = seconds > 0.0f ? seconds : 0.0f; }
+    float getSmoothingTime() const { return smoothing_time_; }
+    
     // Paramètres
     struct Parameter {
         std::string name;
@@ -33,17 +204,141 @@ public:
     };
     
     virtual std::vector<Parameter> getParameters() const = 0;
+    // Application directe : uniquement quand l'effet n'est pas traité en
+    // parallèle (sinon passer par EffectChain::queueParameterChange)
     virtual void setParameter(const std::string& name, float value) = 0;
     virtual float getParameter(const std::string& name) const = 0;
     
+    // Index d'un paramètre dans getParameters() (thread de contrôle)
+    size_t getParameterIndex(const std::string& name) const {
+        auto parameters = getParameters();
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            if (parameters[i].name == name) {
+                return i;
+            }
+        }
+        return INVALID_PARAMETER;
+    }
+    
+    // Application d'un paramètre par index : appelé par le thread audio en
+    // début de bloc. Les effets le surchargent sans allocation ; la valeur
+    // devient une cible lissée sur getSmoothingTime().
+    virtual void setParameterByIndex(size_t index, float value) {
+        auto parameters = getParameters();
+        if (index < parameters.size()) {
+            setParameter(parameters[index].name, value);
+        }
+    }
+    
+    // Effets composites (branches parallèles) : un effet contenu peut être la
+    // cible d'un changement de paramètre. containsEffect() est appelé par le
+    // thread de contrôle, applyParameterChange() par le thread audio (renvoie
+    // true si le changement a été appliqué par cet effet ou l'un des siens).
+    virtual bool containsEffect(const EffectBase* effect) const { return effect == this; }
+    
+    // Identifiant unique de l'instance (jamais réutilisé, contrairement à
+    // son adresse)
+    uint64_t getInstanceId() const { return instance_id_; }
+    virtual bool applyParameterChange(const ParameterChange& change) {
+        if (change.effect != this || change.effectId != instance_id_) {
+            return false;
+        }
+        setParameterByIndex(change.index, change.value);
+        return true;
+    }
+
     // Métadonnées
     virtual std::string getName() const = 0;
     virtual std::string getType() const = 0;
-    
+
 protected:
-    bool bypass_ = false;
+    std::atomic<bool> bypass_{false};
     uint32_t sample_rate_ = 44100;
+    uint32_t max_block_size_ = 1024;
+    float smoothing_time_ = 0.02f; // 20 ms
+    uint32_t quality_tier_ = 0;
+    
+    // Veille (voir isSilent()) : échantillons d'entrée silencieuse consécutifs
+    uint64_t silent_frames_ = 0;
+    std::atomic<bool> silent_{false};
+    
+    // Queue d'une boucle à réinjection de loopLength échantillons : passages
+    // nécessaires pour que feedback^n descende sous SILENCE_THRESHOLD
+    static uint32_t getFeedbackTail(double loopLength, float feedback) {
+        if (feedback >= 1.0f) {
+            return INFINITE_TAIL;
+        }
+        double passes = 1.0;
+        if (feedback > 0.0f) {
+            passes += std::ceil(std::log(SILENCE_THRESHOLD) / std::log(feedback));
+        }
+        return static_cast<uint32_t>(std::min(passes * loopLength, static_cast<double>(INFINITE_TAIL - 1)));
+    }
+    
+    // Thread audio : bascule vers le niveau de qualité tier (déjà borné)
+    virtual void applyQualityTier(uint32_t tier) { (void)tier; }
+    
+    // Disposition de la mémoire DSP : uniquement des layout.allocate(), en
+    // fonction de layout.getSampleRate() et jamais de sample_rate_ (appelé
+    // pour mesurer par le thread de contrôle, puis par le thread audio pour
+    // affecter les pointeurs avec le sample rate de la mesure)
+    virtual void layoutMemory(ArenaLayout& layout) { (void)layout; }
+    // Thread audio : pointeurs affectés dans une zone à zéro (réinitialiser
+    // les positions de lecture et d'écriture)
+    virtual void onMemoryBound() {}
+    
+    // Thread de contrôle : zone propre à l'effet (constructeur, setSampleRate)
+    void allocateMemory() {
+        const size_t size = getMemorySize();
+        if (size > 0) {
+            auto arena = std::make_shared<DSPArena>(size);
+            unsigned char* data = arena->getData();
+            memory_.assign(std::move(arena), data, size, sample_rate_);
+        }
+    }
+    
+    // Thread de contrôle, sans tenir de verrou de l'effet : le conteneur
+    // reparcourt ses branches (collectMemoryEffects())
+    void notifyStructureChanged() {
+        std::function<void()> listener;
+        {
+            std::lock_guard<std::mutex> lock(structure_mutex_);
+            listener = structure_listener_;
+        }
+        if (listener) {
+            listener();
+        }
+    }
+    
+    // Thread audio, en tête de process() : lie la zone attribuée depuis le
+    // bloc précédent
+    void updateMemory() {
+        if (EffectMemory::Block* block = memory_.takePending()) {
+            bindMemory(block);
+        }
+    }
+    
+    uint32_t getSmoothingSamples() const {
+        return static_cast<uint32_t>(smoothing_time_ * static_cast<float>(sample_rate_));
+    }
+
+private:
+    EffectMemory memory_;
+    const uint64_t instance_id_ = nextInstanceId();
+    std::function<void()> structure_listener_;
+    std::mutex structure_mutex_;
+    
+    static uint64_t nextInstanceId() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void bindMemory(EffectMemory::Block* block) {
+        ArenaLayout layout(block->data, block->sampleRate);
+        layoutMemory(layout);
+        memory_.setBound(block);
+        onMemoryBound();
+    }
 };
 
 } // namespace webamp
-
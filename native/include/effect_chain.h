@@ -1,6 +1,12 @@
 #pragma once
 
+#include "dsp_arena.h"
+#include "dsp_profiler.h"
 #include "effect_base.h"
+#include "fused_chain.h"
+#include "snapshot_publisher.h"
+#include "ring_buffer.h"
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -9,6 +15,15 @@
 namespace webamp {
 
 // Chaîne d'effets : ordre modifiable
+//
+// Les modifications (thread de contrôle) sont sérialisées par mutex_ puis
+// publiées sous forme d'instantané immuable. process() (thread audio) lit
+// l'instantané courant sans verrou ni allocation.
+//
+// Les changements de paramètres passent par une file SPSC vidée par le
+// thread audio en début de bloc : l'effet n'est jamais modifié pendant
+// son process(). Sans thread audio (setAudioThreadActive(false)), ils sont
+// appliqués directement par le thread de contrôle.
 class EffectChain {
 public:
     EffectChain();
@@ -27,21 +42,167 @@ public:
     std::shared_ptr<EffectBase> getEffect(size_t index) const;
     size_t getEffectCount() const;
     
+    // Taille de bloc maximale (alloue les buffers de travail, thread de contrôle)
+    void prepare(uint32_t maxFrameCount);
+    uint32_t getMaxFrameCount() const;
+    
+    // Mémoire DSP des effets (thread de contrôle), dans des arènes contiguës
+    // propres à la chaîne (voir DSPArena). Tant que le thread audio n'a lié
+    // aucune zone, toute la chaîne est redisposée en une seule arène, dans
+    // l'ordre de traitement. Ensuite, un effet garde sa zone tant qu'il
+    // reste dans la chaîne (aucune recopie sur le thread audio) : les effets
+    // ajoutés sont disposés dans un nouveau segment, un segment est libéré
+    // quand plus aucun effet de la chaîne n'y réside. hugePages : adosser
+    // les arènes à des pages de 2 Mo quand le système le permet ; le
+    // changement redispose toute la chaîne et remet l'état des effets à zéro.
+    void setHugePages(bool enabled);
+    bool getHugePages() const;
+    size_t getArenaSize() const;
+    size_t getArenaSegmentCount() const;
+    bool usesHugePages() const;
+    
+    // Changement de paramètre (thread de contrôle) appliqué au début du
+    // prochain bloc audio, ou aussitôt si aucun thread audio ne traite la
+    // chaîne. Renvoie false si l'effet n'appartient pas à la chaîne ou si
+    // la file est pleine.
+    bool queueParameterChange(EffectBase* effect, size_t parameterIndex, float value);
+    
+    // Un thread audio appelle process() et vide la file (AudioEngine, via
+    // DSPPipeline, entre start() et stop()). Désactivé par défaut : les
+    // changements sont appliqués par le thread de contrôle, qui appelle
+    // alors lui-même process() s'il traite la chaîne (rendu hors ligne,
+    // tests). La désactivation applique les changements encore en file ;
+    // le thread audio doit être arrêté.
+    void setAudioThreadActive(bool active);
+    bool isAudioThreadActive() const { return audio_thread_active_.load(std::memory_order_acquire); }
+    
+    // Niveau de qualité appliqué à chaque effet au début du prochain bloc
+    // (dégradation adaptative, voir QualityController). Tout thread.
+    void setQualityLevel(uint32_t level) { quality_level_.store(level, std::memory_order_relaxed); }
+    uint32_t getQualityLevel() const { return quality_level_.load(std::memory_order_relaxed); }
+    
+    // Fusion des effets simples consécutifs en une seule boucle (voir
+    // FusedChain), activée par défaut. Tout thread, prise en compte au
+    // début du prochain bloc.
+    void setFusionEnabled(bool enabled) { fusion_enabled_.store(enabled, std::memory_order_relaxed); }
+    bool isFusionEnabled() const { return fusion_enabled_.load(std::memory_order_relaxed); }
+    
     // Traitement (applique tous les effets dans l'ordre)
     // Optimisé pour supporter jusqu'à 20 effets simultanés
+    // Temps réel : aucun verrou, aucune allocation ni libération
+    // Entrée silencieuse : un effet dont la queue est écoulée est mis en
+    // veille (EffectBase::isSilent()) et n'est plus traité jusqu'au retour
+    // d'un signal
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount);
+    
+    // Variante stéréo entrelacée : désentrelace dans un buffer de l'instantané
     void process(float* input, float* output, uint32_t frameCount);
     
+    // Entrée mono (guitare) : les effets sont traités sur un seul canal
+    // jusqu'au premier effet MonoToStereo (voir EffectBase::ChannelLayout),
+    // avant lequel le signal est dupliqué sur deux canaux. output doit
+    // avoir deux canaux ; renvoie le nombre de canaux produits (1 : seul
+    // output[0] est écrit). Temps réel, comme process().
+    uint32_t processMono(const float* input, float* const* output, uint32_t frameCount);
+    
+    // Nombre d'effets en tête de chaîne traités en mono par processMono()
+    // (thread de contrôle)
+    size_t getMonoEffectCount() const;
+    
+    // Latence de la chaîne en échantillons : somme des EffectBase::getLatency()
+    // des effets non contournés, mise à jour à chaque publication et en début
+    // de bloc. Tout thread.
+    uint32_t getLatency() const { return latency_.load(std::memory_order_relaxed); }
+    
+    // Mesure du coût de chaque effet (nullptr : désactivé). Le profileur
+    // doit survivre à son enregistrement.
+    void setProfiler(DSPProfiler* profiler) { profiler_.store(profiler, std::memory_order_release); }
+    
     // Limite maximale d'effets pour performance
     static constexpr size_t MAX_EFFECTS = 20;
     
-    // Thread-safety
+    // Capacité de la file de changements de paramètres
+    static constexpr size_t PARAMETER_QUEUE_CAPACITY = 256;
+    
+    // Thread-safety (côté contrôle uniquement, process() ne verrouille pas)
     void lock() const { mutex_.lock(); }
     void unlock() const { mutex_.unlock(); }
     
 private:
+    // Instantané immuable lu par le thread audio
+    struct Snapshot {
+        std::vector<std::shared_ptr<EffectBase>> effects;
+        uint32_t maxFrameCount = 0;
+        // Index du premier effet MonoToStereo (effects.size() si aucun)
+        size_t widenAt = 0;
+        // Liste d'exécution reconstruite en début de bloc (thread audio) :
+        // effets non contournés, dans l'ordre, et leur nombre avant widenAt
+        EffectBase* execution[MAX_EFFECTS] = {};
+        size_t executionCount = 0;
+        size_t executionWidenAt = 0;
+        // Groupes d'effets fusionnables consécutifs, compilés avec la liste
+        // d'exécution : fused[i] est compilé si un groupe commence à
+        // execution[i] (jamais à cheval sur executionWidenAt)
+        FusedChain fused[MAX_EFFECTS];
+        // Buffer de travail planaire unique : sortie des effets qui ne
+        // peuvent pas être traités en place (voir processBlock())
+        AudioBuffer scratch;
+        // Conversion de la variante entrelacée
+        AudioBuffer interleavedIO;
+    };
+    
     std::vector<std::shared_ptr<EffectBase>> effects_;
+    uint32_t max_frame_count_;
+    bool huge_pages_;
+    // Segments de l'arène et zones de la chaîne qui y résident (les effets
+    // retiennent aussi leur arène jusqu'à ce que le thread audio ait basculé
+    // sur la suivante)
+    struct ArenaZone {
+        uint64_t effectId;
+        const unsigned char* data;
+        size_t size;
+    };
+    struct ArenaSegment {
+        std::shared_ptr<DSPArena> arena;
+        std::vector<ArenaZone> zones;
+    };
+    std::vector<ArenaSegment> arena_segments_;
     mutable std::mutex mutex_;
     
+    SnapshotPublisher<Snapshot> publisher_;
+    std::atomic<DSPProfiler*> profiler_;
+    std::atomic<uint32_t> quality_level_;
+    std::atomic<bool> fusion_enabled_;
+    std::atomic<uint32_t> latency_;
+    std::atomic<bool> audio_thread_active_;
+    
+    // Producteur unique (sous mutex_), consommateur unique (thread audio,
+    // ou thread de contrôle sous mutex_ sans thread audio)
+    RingBuffer<ParameterChange> parameter_queue_;
+    
+    // Reconstruit et publie l'instantané (mutex_ doit être tenu)
+    void publishLocked();
+    // relayout : disposer toute la chaîne dans une nouvelle arène, même si
+    // le thread audio utilise déjà des zones
+    void layoutMemoryLocked(bool relayout = false);
+    bool isArenaBoundLocked(const std::vector<EffectBase*>& effects) const;
+    // Début de bloc (thread audio) : changements de paramètres, niveau de
+    // qualité, liste d'exécution, groupes fusionnés et latence
+    void beginBlock(Snapshot& snapshot);
+    void applyParameterChanges(const std::vector<std::shared_ptr<EffectBase>>& effects);
+    void applyQualityLevel(const Snapshot& snapshot);
+    // Groupes fusionnés reconstruits à chaque bloc avec la liste
+    // d'exécution : suivent les changements de chaîne, de bypass et de
+    // suréchantillonnage
+    void compileFusion(Snapshot& snapshot);
+    static uint32_t computeLatency(const std::vector<std::shared_ptr<EffectBase>>& effects);
+    // Pic de tous les canaux sous EffectBase::SILENCE_THRESHOLD
+    static bool isSilentBlock(const float* const* buffers, uint32_t channels, uint32_t frameCount);
+    void processBlock(Snapshot& snapshot, size_t begin, size_t end, const float* const* input,
+                      float* const* output, uint32_t channels, uint32_t frameCount);
+    uint32_t processMonoBlock(Snapshot& snapshot, const float* input, float* const* output, uint32_t frameCount);
+    static size_t findWidenIndex(const std::vector<std::shared_ptr<EffectBase>>& effects);
+    
     // Factory pour créer des effets
     std::shared_ptr<EffectBase> createEffect(const std::string& type) const;
 };
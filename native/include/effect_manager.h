@@ -29,16 +29,19 @@ public:
     // Accès
     std::shared_ptr<EffectBase> getEffect(const std::string& effectId) const;
     size_t getEffectIndex(const std::string& effectId) const;
+    std::string getEffectId(uint64_t instanceId) const;  // EffectBase::getInstanceId(), "" si inconnu
     std::shared_ptr<EffectChain> getChain() const { return chain_; }
     
+    // Factory des effets de pédale par type ("distortion", "delay"...),
+    // nullptr si le type est inconnu
+    static std::shared_ptr<EffectBase> createEffect(const std::string& type);
+    
 private:
     std::shared_ptr<EffectChain> chain_;
     std::unordered_map<std::string, std::shared_ptr<EffectBase>> effects_by_id_;
     std::unordered_map<std::string, size_t> effect_positions_;
     mutable std::mutex mutex_;
     
-    // Factory pour créer des effets
-    std::shared_ptr<EffectBase> createEffect(const std::string& type) const;
     std::string generateEffectId() const;
 };
 
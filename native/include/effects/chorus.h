@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
 #include <cstdint>
 #include <vector>
 #include <cmath>
@@ -10,27 +11,48 @@ namespace webamp {
 // Effet de chorus (modulation avec delay variable)
 class ChorusEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_RATE = 0,
+        PARAM_DEPTH,
+        PARAM_MIX
+    };
+    
     ChorusEffect();
     ~ChorusEffect() override = default;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Chorus"; }
     std::string getType() const override { return "chorus"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToStereo; }
     
     void setSampleRate(uint32_t sampleRate) override;
+    // Ligne à retard sans feedback
+    uint32_t getTailLength() const override {
+        return static_cast<uint32_t>(std::ceil(MAX_DELAY_SECONDS * sample_rate_));
+    }
+    
+    // Retard maximal atteint par la modulation (10 ms + 5 ms de modulation à depth = 1)
+    static constexpr float MAX_DELAY_SECONDS = 0.015f;
+    
+protected:
+    void layoutMemory(ArenaLayout& layout) override;
+    void onMemoryBound() override;
     
 private:
-    float rate_;      // Hz (0.1 - 10)
-    float depth_;     // 0-1
-    float mix_;       // 0-1 (dry/wet)
+    SmoothedParameter rate_;  // Hz (0.1 - 10)
+    SmoothedParameter depth_; // 0-1
+    SmoothedParameter mix_;   // 0-1 (dry/wet)
     
-    // Buffer de delay
-    std::vector<float> delay_buffer_;
+    // Buffer de delay (mémoire DSP de l'effet)
+    float* delay_buffer_[MAX_CHANNELS];
     size_t delay_buffer_size_;
     size_t write_index_;
     
@@ -39,8 +61,9 @@ private:
     float lfo_increment_;
     
     void updateLFO();
+    void advanceLFO();
     float getLFOValue() const;
-    float getDelayTime() const;
+    float getDelayTime(float depth) const;
 };
 
 } // namespace webamp
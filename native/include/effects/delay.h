@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
 #include <cstdint>
 #include <vector>
 
@@ -9,28 +10,50 @@ namespace webamp {
 // Effet de delay (echo)
 class DelayEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_TIME = 0,
+        PARAM_FEEDBACK,
+        PARAM_MIX
+    };
+    
     DelayEffect();
     ~DelayEffect() override;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Delay"; }
     std::string getType() const override { return "delay"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToStereo; }
     
     void setSampleRate(uint32_t sampleRate) override;
     
+    // Échos jusqu'à -90 dB (infinie à 100 % de feedback)
+    uint32_t getTailLength() const override;
+    
+    // Durée maximale du paramètre time (ms), dimensionne la ligne à retard
+    static constexpr float MAX_DELAY_MS = 2000.0f;
+    
+protected:
+    void layoutMemory(ArenaLayout& layout) override;
+    void onMemoryBound() override;
+    
 private:
-    float time_;      // 0-100 (ms)
-    float feedback_;  // 0-100 (%)
-    float mix_;       // 0-100 (%)
+    SmoothedParameter time_;     // 0-100 (ms)
+    SmoothedParameter feedback_; // 0-100 (%)
+    SmoothedParameter mix_;      // 0-100 (%)
     
-    std::vector<float> delay_buffer_[2]; // Stéréo
+    // Lignes à retard (mémoire DSP de l'effet)
+    float* delay_buffer_[MAX_CHANNELS];
+    size_t delay_length_;
     size_t delay_buffer_size_;
-    size_t write_pos_[2];
+    size_t write_pos_[MAX_CHANNELS];
     
     void updateDelayBuffer();
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
 #include <cstdint>
 #include <vector>
 
@@ -9,31 +10,42 @@ namespace webamp {
 // Effet d'equalizer (filtres paramétriques)
 class EQEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_LOW = 0,
+        PARAM_MID,
+        PARAM_HIGH,
+        PARAM_LEVEL
+    };
+    
     EQEffect();
     ~EQEffect() override = default;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "EQ"; }
     std::string getType() const override { return "eq"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToMono; }
     
     void setSampleRate(uint32_t sampleRate) override;
     
 private:
     // Bands EQ (peut être étendu pour plus de bandes)
-    float low_;       // dB (-12 à +12)
-    float mid_;       // dB (-12 à +12)
-    float high_;      // dB (-12 à +12)
-    float level_;     // 0-1
+    SmoothedParameter low_;   // dB (-12 à +12)
+    SmoothedParameter mid_;   // dB (-12 à +12)
+    SmoothedParameter high_;  // dB (-12 à +12)
+    SmoothedParameter level_; // 0-1
     
-    // Filtres biquad simples
+    // Filtres biquad simples (coefficients communs, état par canal)
     struct BiquadFilter {
         float b0, b1, b2, a1, a2;
-        float x1, x2, y1, y2;
+        float x1[MAX_CHANNELS], x2[MAX_CHANNELS], y1[MAX_CHANNELS], y2[MAX_CHANNELS];
     };
     
     BiquadFilter low_filter_;
@@ -41,7 +53,7 @@ private:
     BiquadFilter high_filter_;
     
     void updateFilters();
-    void processBiquad(BiquadFilter& filter, float* input, float* output, uint32_t frameCount);
+    void processBiquad(BiquadFilter& filter, uint32_t channel, const float* input, float* output, uint32_t frameCount);
     void setBiquadPeak(BiquadFilter& filter, float freq, float gain, float q, float sampleRate);
 };
 
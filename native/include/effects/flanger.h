@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
 #include <cstdint>
 #include <vector>
 #include <cmath>
@@ -10,29 +11,50 @@ namespace webamp {
 // Effet de flanger (modulation avec feedback)
 class FlangerEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_RATE = 0,
+        PARAM_DEPTH,
+        PARAM_FEEDBACK,
+        PARAM_MANUAL,
+        PARAM_RESONANCE
+    };
+    
     FlangerEffect();
     ~FlangerEffect() override = default;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Flanger"; }
     std::string getType() const override { return "flanger"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToStereo; }
     
     void setSampleRate(uint32_t sampleRate) override;
+    // Boucle de feedback jusqu'à -90 dB
+    uint32_t getTailLength() const override;
+    
+    // Retard maximal atteint par la modulation (5 ms (manual = 1) + 2 ms de modulation à depth = 1)
+    static constexpr float MAX_DELAY_SECONDS = 0.007f;
+    
+protected:
+    void layoutMemory(ArenaLayout& layout) override;
+    void onMemoryBound() override;
     
 private:
-    float rate_;         // Hz (0.1 - 5)
-    float depth_;        // 0-1
-    float feedback_;     // 0-1
-    float manual_;       // 0-1 (delay offset)
+    SmoothedParameter rate_;     // Hz (0.1 - 5)
+    SmoothedParameter depth_;    // 0-1
+    SmoothedParameter feedback_; // 0-1
+    SmoothedParameter manual_;   // 0-1 (delay offset)
     float resonance_;    // 0-1
     
-    // Buffer de delay
-    std::vector<float> delay_buffer_;
+    // Buffer de delay (mémoire DSP de l'effet)
+    float* delay_buffer_[MAX_CHANNELS];
     size_t delay_buffer_size_;
     size_t write_index_;
     
@@ -41,8 +63,9 @@ private:
     float lfo_increment_;
     
     void updateLFO();
+    void advanceLFO();
     float getLFOValue() const;
-    float getDelayTime() const;
+    float getDelayTime(float depth, float manual) const;
 };
 
 } // namespace webamp
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
+#include "../oversampler.h"
+#include "../waveshaper.h"
+#include "../fused_stage.h"
 #include <cstdint>
 #include <vector>
 #include <algorithm>
@@ -10,33 +14,77 @@ namespace webamp {
 // Effet de fuzz (distortion extrême)
 class FuzzEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_FUZZ = 0,
+        PARAM_TONE,
+        PARAM_VOLUME,
+        PARAM_OVERSAMPLING,
+        PARAM_OVERSAMPLING_PHASE,
+        PARAM_ANTIALIASING
+    };
+    
     FuzzEffect();
     ~FuzzEffect() override = default;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Fuzz"; }
     std::string getType() const override { return "fuzz"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToMono; }
     
     void setSampleRate(uint32_t sampleRate) override;
     
+    // Suréchantillonnage du clipping (paramètres "oversampling" : 1, 2, 4, 8
+    // et "oversamplingPhase" : 0 = phase linéaire, 1 = phase minimale) et
+    // anti-repliement par primitives ("antialiasing" : 0, ADAA 1 ou 2)
+    Oversampler& getOversampler() { return oversampler_; }
+    Waveshaper& getWaveshaper() { return shaper_; }
+    
+    // Suréchantillonnage + ADAA (au taux suréchantillonné), arrondis
+    uint32_t getLatency() const override;
+    
+    // Niveaux de qualité : facteur de suréchantillonnage divisé par deux
+    // à chaque niveau
+    uint32_t getQualityTierCount() const override { return Oversampler::QUALITY_TIERS; }
+    
+    // Courses des potentiomètres (communes à process() et à la fusion)
+    static float fuzzGain(float fuzz) { return fuzz * 10.0f + 1.0f; }  // 1x à 11x
+    static float volumeGain(float volume) { return volume * 2.0f; }
+    
+    // Fusion (voir FusedChain) : sans suréchantillonnage ni ADAA, gain,
+    // écrêtage, tone et niveau s'enchaînent échantillon par échantillon
+    FusedKind getFusedKind() const override;
+    using FusedStage = FusedSeries<FusedGain<&FuzzEffect::fuzzGain>, FusedShape<Waveshaper::Curve::Fuzz>, FusedTone,
+                                   FusedGain<&FuzzEffect::volumeGain>>;
+    // Début de bloc de process() (rampe du tone) et étages du bloc
+    FusedStage beginFused(uint32_t frameCount);
+
+protected:
+    void applyQualityTier(uint32_t tier) override { oversampler_.setQualityTier(tier); }
+    
 private:
-    float fuzz_;      // 0-1
-    float tone_;      // 0-1
-    float volume_;    // 0-1
+    SmoothedParameter fuzz_;   // 0-1
+    SmoothedParameter tone_;   // 0-1
+    SmoothedParameter volume_; // 0-1
     
     // Filtre passe-bas pour le tone
-    float lowpass_state_[2];
+    float lowpass_state_[MAX_CHANNELS][2];  // Deux pôles par canal
     float lowpass_coeff_;
     
-    void updateToneFilter();
+    Oversampler oversampler_;
+    Waveshaper shaper_;
     
-    // Fuzz avec hard clipping extrême
-    float fuzzClip(float x) const;
+    void updateToneFilter();
+    // Coefficients du filtre recalculés une fois par bloc pendant la rampe,
+    // renvoie le mix du tone
+    float beginTone(uint32_t frameCount);
 };
 
 } // namespace webamp
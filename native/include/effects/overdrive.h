@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
+#include "../oversampler.h"
+#include "../waveshaper.h"
+#include "../fused_stage.h"
 #include <cstdint>
 #include <vector>
 
@@ -9,33 +13,77 @@ namespace webamp {
 // Effet d'overdrive (soft clipping)
 class OverdriveEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_DRIVE = 0,
+        PARAM_TONE,
+        PARAM_LEVEL,
+        PARAM_OVERSAMPLING,
+        PARAM_OVERSAMPLING_PHASE,
+        PARAM_ANTIALIASING
+    };
+    
     OverdriveEffect();
     ~OverdriveEffect() override = default;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Overdrive"; }
     std::string getType() const override { return "overdrive"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToMono; }
     
     void setSampleRate(uint32_t sampleRate) override;
     
+    // Suréchantillonnage du clipping (paramètres "oversampling" : 1, 2, 4, 8
+    // et "oversamplingPhase" : 0 = phase linéaire, 1 = phase minimale) et
+    // anti-repliement par primitives ("antialiasing" : 0, ADAA 1 ou 2)
+    Oversampler& getOversampler() { return oversampler_; }
+    Waveshaper& getWaveshaper() { return shaper_; }
+    
+    // Suréchantillonnage + ADAA (au taux suréchantillonné), arrondis
+    uint32_t getLatency() const override;
+    
+    // Niveaux de qualité : facteur de suréchantillonnage divisé par deux
+    // à chaque niveau
+    uint32_t getQualityTierCount() const override { return Oversampler::QUALITY_TIERS; }
+    
+    // Courses des potentiomètres (communes à process() et à la fusion)
+    static float driveGain(float drive) { return drive * 3.0f + 1.0f; }  // 1x à 4x
+    static float levelGain(float level) { return level * 2.0f; }
+    
+    // Fusion (voir FusedChain) : sans suréchantillonnage ni ADAA, gain,
+    // écrêtage, tone et niveau s'enchaînent échantillon par échantillon
+    FusedKind getFusedKind() const override;
+    using FusedStage = FusedSeries<FusedGain<&OverdriveEffect::driveGain>, FusedShape<Waveshaper::Curve::Tanh>, FusedTone,
+                                   FusedGain<&OverdriveEffect::levelGain>>;
+    // Début de bloc de process() (rampe du tone) et étages du bloc
+    FusedStage beginFused(uint32_t frameCount);
+
+protected:
+    void applyQualityTier(uint32_t tier) override { oversampler_.setQualityTier(tier); }
+    
 private:
-    float drive_;
-    float tone_;
-    float level_;
+    SmoothedParameter drive_;
+    SmoothedParameter tone_;
+    SmoothedParameter level_;
     
     // Filtre passe-bas pour le tone
-    float lowpass_state_[2];
+    float lowpass_state_[MAX_CHANNELS][2];  // Deux pôles par canal
     float lowpass_coeff_;
     
-    void updateToneFilter();
+    Oversampler oversampler_;
+    Waveshaper shaper_;
     
-    // Soft clipping avec tanh
-    float softClip(float x) const;
+    void updateToneFilter();
+    // Coefficients du filtre recalculés une fois par bloc pendant la rampe,
+    // renvoie le mix du tone
+    float beginTone(uint32_t frameCount);
 };
 
 } // namespace webamp
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
 #include <cstdint>
 #include <vector>
 
@@ -9,37 +10,69 @@ namespace webamp {
 // Effet de reverb (comb filters + allpass)
 class ReverbEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_ROOM = 0,
+        PARAM_DECAY,
+        PARAM_MIX
+    };
+    
+    // Topologie : comb filters et allpass filters par canal
+    static constexpr int NUM_COMBS = 4;
+    static constexpr int NUM_ALLPASS = 2;
+    
     ReverbEffect();
     ~ReverbEffect() override;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Reverb"; }
     std::string getType() const override { return "reverb"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToStereo; }
     
     void setSampleRate(uint32_t sampleRate) override;
     
+    // Décroissance du plus long comb puis des allpass
+    uint32_t getTailLength() const override;
+    
+    // Niveaux de qualité (densité) : 4 combs + 2 allpass, 2 + 2, puis 1 + 1
+    static constexpr uint32_t QUALITY_TIERS = 3;
+    uint32_t getQualityTierCount() const override { return QUALITY_TIERS; }
+    int getActiveCombCount() const { return active_combs_; }
+    int getActiveAllpassCount() const { return active_allpass_; }
+    
+protected:
+    void applyQualityTier(uint32_t tier) override;
+    void layoutMemory(ArenaLayout& layout) override;
+    void onMemoryBound() override;
+    
 private:
-    float room_;   // 0-100 (taille de la pièce)
-    float decay_; // 0-100 (durée de la réverb)
-    float mix_;   // 0-100 (%)
+    SmoothedParameter room_; // 0-100 (taille de la pièce)
+    SmoothedParameter decay_; // 0-100 (durée de la réverb)
+    SmoothedParameter mix_; // 0-100 (%)
     
-    // Comb filters (4 par canal)
-    static constexpr int NUM_COMBS = 4;
-    std::vector<float> comb_buffers_[2][NUM_COMBS];
+    // Comb filters (4 par canal), lignes dans la mémoire DSP de l'effet
+    float* comb_buffers_[MAX_CHANNELS][NUM_COMBS];
+    size_t comb_lengths_[NUM_COMBS];
     size_t comb_delays_[NUM_COMBS];
-    size_t comb_write_pos_[2][NUM_COMBS];
+    size_t comb_write_pos_[MAX_CHANNELS][NUM_COMBS];
     float comb_feedback_[NUM_COMBS];
     
     // Allpass filters (2 par canal)
-    static constexpr int NUM_ALLPASS = 2;
-    std::vector<float> allpass_buffers_[2][NUM_ALLPASS];
+    float* allpass_buffers_[MAX_CHANNELS][NUM_ALLPASS];
+    size_t allpass_lengths_[NUM_ALLPASS];
     size_t allpass_delays_[NUM_ALLPASS];
-    size_t allpass_write_pos_[2][NUM_ALLPASS];
+    size_t allpass_write_pos_[MAX_CHANNELS][NUM_ALLPASS];
+    
+    // Filtres traités (niveau de qualité)
+    int active_combs_;
+    int active_allpass_;
     
     void updateReverbParameters();
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../effect_base.h"
+#include "../smoothed_value.h"
+#include "../fused_stage.h"
 #include <cstdint>
 #include <cmath>
 
@@ -9,33 +11,105 @@ namespace webamp {
 // Effet de tremolo (modulation d'amplitude)
 class TremoloEffect : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_RATE = 0,
+        PARAM_DEPTH,
+        PARAM_VOLUME,
+        PARAM_WAVE
+    };
+    
     TremoloEffect();
     ~TremoloEffect() override = default;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "Tremolo"; }
     std::string getType() const override { return "tremolo"; }
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToMono; }
     
     void setSampleRate(uint32_t sampleRate) override;
     
+    // Fusion (voir FusedChain) : modulation d'amplitude, toujours fusionnable
+    FusedKind getFusedKind() const override { return FusedKind::Tremolo; }
+    
+    class FusedStage {
+    public:
+        explicit FusedStage(TremoloEffect& effect)
+            : effect_(&effect), depth_(effect.depth_), volume_(effect.volume_), wave_(effect.wave_),
+              phase_(effect.lfo_phase_), increment_(effect.lfo_increment_), gain_(0.0f) {}
+        
+        WEBAMP_FUSED_INLINE void frame() {
+            gain_ = getModulationGain(phase_, wave_.getNextValue(), depth_.getNextValue(), volume_.getNextValue());
+            phase_ = advanceLFO(phase_, increment_);
+        }
+        WEBAMP_FUSED_INLINE float sample(uint32_t, float x) const { return x * gain_; }
+        WEBAMP_FUSED_INLINE void finish() {
+            effect_->depth_ = depth_;
+            effect_->volume_ = volume_;
+            effect_->wave_ = wave_;
+            effect_->lfo_phase_ = phase_;
+        }
+    
+    private:
+        TremoloEffect* effect_;
+        SmoothedValue depth_;
+        SmoothedValue volume_;
+        SmoothedValue wave_;
+        float phase_;
+        float increment_;
+        float gain_;
+    };
+    // Début de bloc de process() (rampe du rate) et étage du bloc
+    FusedStage beginFused(uint32_t frameCount);
+
 private:
-    float rate_;      // Hz (0.1 - 20)
-    float depth_;     // 0-1
-    float volume_;    // 0-1
-    float wave_;      // 0-1 (sine/square)
+    SmoothedParameter rate_;   // Hz (0.1 - 20)
+    SmoothedParameter depth_;  // 0-1
+    SmoothedParameter volume_; // 0-1
+    SmoothedParameter wave_;   // 0-1 (sine/square)
     
     // LFO pour la modulation
     float lfo_phase_;
     float lfo_increment_;
     
     void updateLFO();
-    float getLFOValue() const;
+    // Incrément du LFO recalculé une fois par bloc pendant la rampe
+    void beginRate(uint32_t frameCount);
+    
+    // Gain d'une frame, commun à process() et à la fusion (en ligne)
+    static float advanceLFO(float phase, float increment);
+    static float getLFOValue(float phase, float wave);
+    static float getModulationGain(float phase, float wave, float depth, float volume);
 };
 
+WEBAMP_FUSED_INLINE float TremoloEffect::advanceLFO(float phase, float increment) {
+    phase += increment;
+    if (phase >= 2.0f * 3.14159f) {
+        phase -= 2.0f * 3.14159f;
+    }
+    return phase;
+}
+
+WEBAMP_FUSED_INLINE float TremoloEffect::getLFOValue(float phase, float wave) {
+    // Mix entre sine (0) et square (1)
+    float sine = sinf(phase);
+    float square = (phase < 3.14159f) ? 1.0f : -1.0f;
+    return sine * (1.0f - wave) + square * wave;
+}
+
+WEBAMP_FUSED_INLINE float TremoloEffect::getModulationGain(float phase, float wave, float depth, float volume) {
+    // Modulation d'amplitude
+    float mod = 1.0f - (depth * getLFOValue(phase, wave));
+    mod = std::max(0.0f, std::min(1.0f, mod));
+    return mod * (volume * 2.0f);
+}
+
 } // namespace webamp
 
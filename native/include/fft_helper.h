@@ -1,5 +1,6 @@
 #pragma once
 
+#include "aligned_allocator.h"
 #include <cstdint>
 #include <vector>
 #include <complex>
@@ -7,7 +8,53 @@
 
 namespace webamp {
 
+// Plan FFT pour une taille fixe (puissance de 2)
+//
+// Tables de twiddles et de bit-reverse précalculées à la construction
+// (thread de contrôle). Les transformées opèrent en place sur des buffers
+// fournis par l'appelant, au format séparé (parties réelles / imaginaires),
+// sans allocation : utilisables dans le callback audio. Premier passage en
+// radix-4, passages suivants en radix-2 vectorisés (AVX/SSE/NEON).
+class FFTPlan {
+public:
+    // size : nombre de points (complexes pour forward/inverse, réels pour
+    // forwardReal/inverseReal)
+    explicit FFTPlan(size_t size);
+    
+    size_t getSize() const { return size_; }
+    
+    // FFT complexe en place de taille getSize()
+    void forward(float* re, float* im) const;
+    // FFT inverse normalisée (1/N)
+    void inverse(float* re, float* im) const;
+    
+    // FFT réelle : input (getSize() réels) -> getSize()/2 + 1 bins
+    // (re, im de taille getSize()/2 + 1), coût d'une FFT complexe de moitié
+    void forwardReal(const float* input, float* re, float* im) const;
+    // FFT réelle inverse normalisée : re/im (getSize()/2 + 1 bins, modifiés
+    // en place) -> output (getSize() réels)
+    void inverseReal(float* re, float* im, float* output) const;
+
+private:
+    size_t size_;
+    size_t complex_size_;                  // Taille de la FFT complexe du chemin réel
+    
+    // Tables de la FFT complexe de taille size_
+    std::vector<uint32_t> bitrev_;
+    AlignedVector<float> twiddle_re_;      // [m + j] = exp(-i*pi*j/m)
+    AlignedVector<float> twiddle_im_;
+    
+    // Tables du chemin réel (FFT complexe de taille size_/2)
+    std::vector<uint32_t> half_bitrev_;
+    AlignedVector<float> real_twiddle_re_; // exp(-2i*pi*k/size_)
+    AlignedVector<float> real_twiddle_im_;
+    
+    static void buildBitReverse(std::vector<uint32_t>& table, size_t n);
+    void transform(float* re, float* im, size_t n, const std::vector<uint32_t>& bitrev) const;
+};
+
 // Helper FFT simple pour convolution (Radix-2)
+// API historique (alloue) : préférer FFTPlan dans le thread audio
 class FFTHelper {
 public:
     static void fft(std::vector<std::complex<float>>& data, bool inverse = false);
@@ -20,9 +67,7 @@ public:
         std::vector<float>& output
     );
     
-private:
     static size_t nextPowerOf2(size_t n);
-    static void bitReverse(std::vector<std::complex<float>>& data);
 };
 
 } // namespace webamp
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "effect_base.h"
+#include <cstdint>
+
+namespace webamp {
+
+// Effets simples consécutifs compilés en une seule boucle
+//
+// Les effets fusionnables (EffectBase::getFusedKind() : distortion,
+// overdrive, fuzz sans suréchantillonnage ni ADAA, tremolo) décrivent leur
+// traitement comme une suite d'étages par échantillon (fused_stage.h).
+// compile() choisit, d'après la suite de types, l'instanciation du modèle
+// qui enchaîne tous leurs étages : une boucle par frame, un seul passage
+// sur les buffers, aucun appel virtuel ni buffer intermédiaire, l'état des
+// effets gardé en registres. Toutes les suites de 1 à MAX_STAGES effets
+// sont instanciées ; les suites plus longues sont découpées par l'appelant.
+//
+// Une suite compilée produit la même sortie que les process() successifs
+// (à l'arrondi près) : courses des potentiomètres, courbes et LFO sont
+// partagés avec process().
+class FusedChain {
+public:
+    static constexpr uint32_t MAX_STAGES = 3;
+    
+    // Thread audio, sans allocation : effects[i] renvoie kinds[i] (différent
+    // de None). Compile les min(count, MAX_STAGES) premiers effets, renvoie
+    // leur nombre (0 si count == 0).
+    uint32_t compile(EffectBase* const* effects, const EffectBase::FusedKind* kinds, uint32_t count);
+    void clear();
+    
+    bool isCompiled() const { return runner_ != nullptr; }
+    uint32_t getStageCount() const { return stage_count_; }
+    // nullptr au-delà de getStageCount()
+    EffectBase* getStage(uint32_t index) const {
+        return index < stage_count_ && index < MAX_STAGES ? stages_[index] : nullptr;
+    }
+    
+    // Thread audio : applique les effets compilés, in-place autorisé
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) const;
+
+private:
+    using Runner = void (*)(EffectBase* const* effects, const float* const* input, float* const* output,
+                            uint32_t channels, uint32_t frameCount);
+    
+    EffectBase* stages_[MAX_STAGES] = {};
+    uint32_t stage_count_ = 0;
+    Runner runner_ = nullptr;
+};
+
+} // namespace webamp
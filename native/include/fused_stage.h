@@ -0,0 +1,135 @@
+#pragma once
+
+#include "audio_buffer.h"
+#include "smoothed_value.h"
+#include "waveshaper.h"
+#include <cstdint>
+#include <utility>
+
+// Mise en ligne imposée des étages : sans elle, le compilateur y renonce
+// dans les nombreuses instanciations de FusedChain et l'état des effets
+// repasse en mémoire à chaque échantillon
+#ifdef _MSC_VER
+#define WEBAMP_FUSED_INLINE __forceinline
+#else
+#define WEBAMP_FUSED_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace webamp {
+
+// Étages élémentaires des boucles fusionnées (voir FusedChain)
+//
+// Un effet fusionnable décrit son traitement comme une suite d'étages par
+// échantillon (FusedSeries). Chaque étage expose :
+//   frame()         avance d'une frame (paramètres lissés, LFO)
+//   sample(ch, x)   traite un échantillon du canal ch
+//   finish()        recopie son état dans l'effet en fin de bloc
+// L'état (lisseurs, filtres) est copié dans l'étage en début de bloc : une
+// fois la boucle instanciée, le compilateur le garde en registres, sans
+// aliasing possible avec les buffers audio.
+
+// Gain lissé, converti par Map (course du potentiomètre -> gain linéaire)
+template<float (*Map)(float)>
+class FusedGain {
+public:
+    explicit FusedGain(SmoothedValue& value)
+        : target_(&value), value_(value), gain_(0.0f) {}
+    
+    WEBAMP_FUSED_INLINE void frame() { gain_ = Map(value_.getNextValue()); }
+    WEBAMP_FUSED_INLINE float sample(uint32_t, float x) const { return x * gain_; }
+    WEBAMP_FUSED_INLINE void finish() { *target_ = value_; }
+
+private:
+    SmoothedValue* target_;
+    SmoothedValue value_;
+    float gain_;
+};
+
+// Courbe de saturation sans anti-repliement (Waveshaper::Mode::Naive)
+template<Waveshaper::Curve C>
+class FusedShape {
+public:
+    WEBAMP_FUSED_INLINE void frame() {}
+    WEBAMP_FUSED_INLINE float sample(uint32_t, float x) const { return Waveshaper::applyNaive<C>(x); }
+    WEBAMP_FUSED_INLINE void finish() {}
+};
+
+// Tone des pédales de drive : deux pôles passe-bas par canal, mélangés au
+// signal direct (mix = 0 : signal direct seul)
+class FusedTone {
+public:
+    static constexpr uint32_t MAX_CHANNELS = AudioBuffer::MAX_CHANNELS;
+    
+    FusedTone(float (&state)[MAX_CHANNELS][2], float coeff, float mix)
+        : target_(state), coeff_(coeff), mix_(mix) {
+        for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+            state_[ch][0] = state[ch][0];
+            state_[ch][1] = state[ch][1];
+        }
+    }
+    
+    WEBAMP_FUSED_INLINE void frame() {}
+    WEBAMP_FUSED_INLINE float sample(uint32_t ch, float x) {
+        float* state = state_[ch];
+        float filtered = x;
+        filtered = filtered + coeff_ * (state[0] - filtered);
+        state[0] = filtered;
+        filtered = filtered + coeff_ * (state[1] - filtered);
+        state[1] = filtered;
+        return x * (1.0f - mix_) + filtered * mix_;
+    }
+    WEBAMP_FUSED_INLINE void finish() {
+        for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+            target_[ch][0] = state_[ch][0];
+            target_[ch][1] = state_[ch][1];
+        }
+    }
+
+private:
+    float (*target_)[2];
+    float state_[MAX_CHANNELS][2];
+    float coeff_;
+    float mix_;
+};
+
+// Étages en série : c'est lui-même un étage, ce qui permet d'enchaîner les
+// effets comme leurs étages. Composition récursive (tête, reste) plutôt
+// qu'un tuple : de simples appels de membres, que le compilateur met en
+// ligne jusque dans la boucle fusionnée.
+template<typename... Stages>
+class FusedSeries;
+
+template<typename Stage>
+class FusedSeries<Stage> {
+public:
+    explicit FusedSeries(Stage stage) : stage_(std::move(stage)) {}
+    
+    WEBAMP_FUSED_INLINE void frame() { stage_.frame(); }
+    WEBAMP_FUSED_INLINE float sample(uint32_t ch, float x) { return stage_.sample(ch, x); }
+    WEBAMP_FUSED_INLINE void finish() { stage_.finish(); }
+
+private:
+    Stage stage_;
+};
+
+template<typename Stage, typename... Rest>
+class FusedSeries<Stage, Rest...> {
+public:
+    explicit FusedSeries(Stage stage, Rest... rest) : stage_(std::move(stage)), rest_(std::move(rest)...) {}
+    
+    WEBAMP_FUSED_INLINE void frame() {
+        stage_.frame();
+        rest_.frame();
+    }
+    WEBAMP_FUSED_INLINE float sample(uint32_t ch, float x) { return rest_.sample(ch, stage_.sample(ch, x)); }
+    WEBAMP_FUSED_INLINE void finish() {
+        stage_.finish();
+        rest_.finish();
+    }
+
+private:
+    Stage stage_;
+    FusedSeries<Rest...> rest_;
+};
+
+} // namespace webamp
@@ -2,7 +2,11 @@
 
 #include "ir_loader.h"
 #include "effect_base.h"
-#include "fft_helper.h"
+#include "partitioned_convolver.h"
+#include "nonuniform_convolver.h"
+#include "smoothed_value.h"
+#include "snapshot_publisher.h"
+#include <atomic>
 #include <cstdint>
 #include <vector>
 #include <memory>
@@ -10,45 +14,91 @@
 namespace webamp {
 
 // Convolution en temps réel pour appliquer un IR
+//
+// loadIR() (thread de contrôle) précalcule les spectres des partitions de
+// l'IR puis publie l'état de convolution ; process() le lit sans verrou ni
+// allocation. Les IR de cabinet utilisent une partition uniforme, les IR
+// longues (salles, plates) une partition non uniforme dont la queue est
+// calculée en arrière-plan. Une IR enregistrée à une autre fréquence que
+// le flux est convertie au chargement (et à chaque setSampleRate()).
 class IRConvolution : public EffectBase {
 public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_MIX = 0
+    };
+    
+    // Taille de partition minimale (les petits blocs restent sans latence)
+    static constexpr size_t MIN_PARTITION_SIZE = 64;
+    
+    // Au-delà de cette longueur (échantillons), partition non uniforme
+    static constexpr size_t LONG_IR_THRESHOLD = 16384;
+    
     IRConvolution();
     ~IRConvolution() override;
     
-    void process(float* input, float* output, uint32_t frameCount) override;
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
     
     std::vector<Parameter> getParameters() const override;
     void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
     float getParameter(const std::string& name) const override;
     
     std::string getName() const override { return "IR Convolution"; }
     std::string getType() const override { return "ir_convolution"; }
+    // Même IR sur les deux canaux
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToMono; }
     
     void setSampleRate(uint32_t sampleRate) override;
+    void setMaxBlockSize(uint32_t maxFrameCount) override;
+    
+    // Longueur de l'IR à la fréquence du flux (+ un bloc)
+    uint32_t getTailLength() const override { return tail_length_.load(std::memory_order_relaxed); }
     
     // Charger un IR
     bool loadIR(const std::string& filePath);
     bool loadIR(std::shared_ptr<IRLoader> irLoader);
     
     // Mix dry/wet
-    void setMix(float mix) { mix_ = mix; }
-    float getMix() const { return mix_; }
+    void setMix(float mix) { setParameterByIndex(PARAM_MIX, mix); }
+    float getMix() const { return mix_.getRequestedValue(); }
+    
+    // Taille de partition utilisée (0 si aucun IR)
+    size_t getPartitionSize() const;
+    bool isUsingNonUniformPartition() const { return non_uniform_; }
     
+    // Queue des IR longues sur un thread de travail (sinon dans le callback)
+    void setBackgroundTail(bool enabled);
+    
+    // Niveaux de qualité : IR tronquée à la moitié, puis au quart de ses
+    // partitions. Sans effet sur les IR longues (partition non uniforme),
+    // dont la queue est déjà calculée hors du callback.
+    static constexpr uint32_t QUALITY_TIERS = 3;
+    uint32_t getQualityTierCount() const override { return QUALITY_TIERS; }
+
 private:
-    std::shared_ptr<IRLoader> ir_loader_;
-    float mix_; // 0-100
+    // État de convolution publié vers le thread audio
+    struct ConvolutionState {
+        std::shared_ptr<IRLoader> irLoader;     // IR à la fréquence du flux
+        PartitionedConvolver convolvers[2];
+        std::unique_ptr<NonUniformConvolver> longConvolvers[2];
+        size_t blockSize = 0;
+        // Sortie des convolveurs par canal, dimensionnée à blockSize
+        std::vector<float> wet[2];
+    };
     
-    // Buffers de convolution (overlap-add)
-    std::vector<float> input_buffer_[2];
-    std::vector<float> output_buffer_[2];
-    size_t buffer_pos_[2];
+    std::shared_ptr<IRLoader> ir_loader_;
+    SmoothedParameter mix_; // 0-100
     
-    // Convolution FFT optimisée (overlap-add)
-    void processConvolutionFFT(int channel, uint32_t frameCount, float dryMix, float mixLinear);
+    SnapshotPublisher<ConvolutionState> state_publisher_;
+    size_t partition_size_;
+    bool non_uniform_;
+    bool background_tail_;
+    std::atomic<uint32_t> tail_length_;
     
-    // Convolution directe (fallback)
-    void processDirectConvolution(int channel, uint32_t frameCount, float dryMix, float mixLinear);
+    // Construit et publie l'état pour l'IR et la taille de bloc courantes
+    bool rebuildState();
 };
 
 } // namespace webamp
-
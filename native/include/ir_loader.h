@@ -7,6 +7,8 @@
 
 namespace webamp {
 
+struct WavAudio;
+
 // Chargeur d'Impulse Responses (IR) pour simulation de cabinets
 class IRLoader {
 public:
@@ -34,13 +36,18 @@ public:
     // Normaliser l'IR
     void normalize();
     
+    // Convertir l'IR à la fréquence sampleRate (polyphasé, sans retard
+    // ajouté) en conservant sa réponse en fréquence. Hors thread audio.
+    bool resample(uint32_t sampleRate);
+
 private:
     std::vector<float> ir_samples_;
     uint32_t ir_sample_rate_;
     
-    // Helpers pour parser WAV
+    // Helpers pour parser WAV (décodage par WavFile)
     bool parseWAV(const void* data, size_t size);
     bool parseWAVFile(const std::string& filePath);
+    bool loadWAV(const WavAudio& audio);
 };
 
 } // namespace webamp
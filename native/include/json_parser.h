@@ -2,10 +2,52 @@
 
 #include <string>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace webamp {
 
+// Valeur JSON complète (objets et tableaux imbriqués)
+// Utilisée pour les documents structurés (fichiers .nam), hors thread audio
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    
+    JsonValue() : type_(Type::Null), number_(0.0) {}
+    
+    Type getType() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isBool() const { return type_ == Type::Bool; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray() const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+    
+    bool asBool(bool defaultValue = false) const { return type_ == Type::Bool ? number_ != 0.0 : defaultValue; }
+    double asNumber(double defaultValue = 0.0) const { return type_ == Type::Number ? number_ : defaultValue; }
+    std::string asString(const std::string& defaultValue = "") const { return type_ == Type::String ? string_ : defaultValue; }
+    
+    // Tableaux
+    size_t size() const { return array_.size(); }
+    const JsonValue& operator[](size_t index) const;
+    const std::vector<JsonValue>& getArray() const { return array_; }
+    
+    // Objets (valeur nulle si la clé est absente)
+    bool has(const std::string& key) const { return find(key) != nullptr; }
+    const JsonValue* find(const std::string& key) const;
+    const JsonValue& operator[](const std::string& key) const;
+    const std::vector<std::pair<std::string, JsonValue>>& getMembers() const { return members_; }
+    
+private:
+    friend class JsonParser;
+    
+    Type type_;
+    double number_;
+    std::string string_;
+    std::vector<JsonValue> array_;
+    std::vector<std::pair<std::string, JsonValue>> members_;
+};
+
 // Parser JSON simple pour extraire les valeurs des messages WebSocket
 class JsonParser {
 public:
@@ -15,10 +57,14 @@ public:
     static int getInt(const std::map<std::string, std::string>& data, const std::string& key, int defaultValue = 0);
     static bool getBool(const std::map<std::string, std::string>& data, const std::string& key, bool defaultValue = false);
     
+    // Document JSON complet (lève std::runtime_error si la syntaxe est invalide)
+    static JsonValue parseDocument(const std::string& json);
+    
 private:
     static void skipWhitespace(const std::string& json, size_t& pos);
     static std::string parseString(const std::string& json, size_t& pos);
     static std::string parseValue(const std::string& json, size_t& pos);
+    static void parseDocumentValue(const std::string& json, size_t& pos, JsonValue& value, int depth);
 };
 
 } // namespace webamp
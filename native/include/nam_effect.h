@@ -0,0 +1,127 @@
+#pragma once
+
+#include "effect_base.h"
+#include "nam_loader.h"
+#include "resampler.h"
+#include "smoothed_value.h"
+#include "snapshot_publisher.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace webamp {
+
+// Modèle NAM (ampli, pédale) utilisable comme effet de chaîne
+//
+// Chaque instance possède son propre modèle et donc son propre état : deux
+// amplis peuvent tourner dans deux branches d'un ParallelEffect. Le modèle
+// chargé (thread de contrôle) est publié vers le thread audio comme l'état
+// de IRConvolution. Le modèle est mono : entrée = moyenne des canaux,
+// sortie recopiée sur chaque canal.
+//
+// Le modèle tourne à sa fréquence d'entraînement (métadonnée sample_rate) :
+// si le flux est à une autre fréquence, il est converti à l'entrée et à la
+// sortie du modèle (îlot rééchantillonné, Resampler temps réel) et la
+// latence des deux conversions est rapportée par getLatency().
+class NAMEffect : public EffectBase {
+public:
+    // Index des paramètres (ordre de getParameters())
+    enum ParameterIndex : size_t {
+        PARAM_INPUT = 0,
+        PARAM_OUTPUT
+    };
+    
+    NAMEffect();
+    ~NAMEffect() override = default;
+    
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
+    
+    std::vector<Parameter> getParameters() const override;
+    void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
+    float getParameter(const std::string& name) const override;
+    
+    std::string getName() const override { return "NAM"; }
+    std::string getType() const override { return "nam"; }
+    // Modèle mono : le signal reste mono
+    ChannelLayout getChannelLayout() const override { return ChannelLayout::MonoToMono; }
+    
+    void setSampleRate(uint32_t sampleRate) override;
+    void setMaxBlockSize(uint32_t maxFrameCount) override;
+    
+    // Latence ajoutée par l'îlot rééchantillonné, en échantillons au taux
+    // du flux (0 si le modèle tourne à la fréquence du flux)
+    uint32_t getLatency() const override { return latency_.load(std::memory_order_relaxed); }
+    bool isResampling() const { return resampling_.load(std::memory_order_relaxed); }
+    // Blocs de l'îlot rendus avec moins de sorties que d'entrées, complétés
+    // de silence plutôt que du signal sec (0 tant que l'amorce suffit)
+    uint64_t getIslandUnderrunCount() const { return island_underruns_.load(std::memory_order_relaxed); }
+    
+    // Queue forfaitaire de 100 ms : couvre le champ récepteur des
+    // architectures WaveNet publiées (~4100 échantillons) et l'extinction
+    // de l'état des LSTM
+    uint32_t getTailLength() const override { return sample_rate_ / 10; }
+    
+    // Chargement du modèle (thread de contrôle)
+    bool loadModel(const std::string& filePath);
+    bool loadModelFromMemory(const uint8_t* data, size_t size);
+    // Modèle déjà chargé : l'effet en devient le seul utilisateur (état de
+    // traitement)
+    bool setModel(std::shared_ptr<NAMModel> model);
+    bool hasModel() const { return model_ != nullptr; }
+    const NAMModelMetadata* getMetadata() const { return model_ ? &model_->getMetadata() : nullptr; }
+    
+    // Modèle allégé (même capture entraînée dans une architecture plus
+    // petite : lite, feather, nano), utilisé au niveau de qualité 1
+    bool loadLightModel(const std::string& filePath);
+    bool loadLightModelFromMemory(const uint8_t* data, size_t size);
+    bool hasLightModel() const { return light_model_ != nullptr; }
+    
+    // Niveaux de qualité : modèle complet, puis modèle allégé s'il est chargé
+    uint32_t getQualityTierCount() const override { return 2; }
+    
+private:
+    struct ModelState {
+        std::shared_ptr<NAMModel> model;
+        std::shared_ptr<NAMModel> lightModel;   // nullptr si absent
+        std::vector<float> buffer;      // Mono, max_block_size_ échantillons
+        
+        // Îlot rééchantillonné (modelRate != sample_rate_)
+        int modelRate = 0;
+        bool island = false;
+        Resampler upsampler;            // Flux -> modèle
+        Resampler downsampler;          // Modèle -> flux
+        std::vector<float> modelBuffer; // Échantillons au taux du modèle
+        // Sorties de l'îlot en attente : après N entrées, au moins N sorties
+        // (arrondis supérieurs des deux conversions), l'excédent est rendu
+        // au bloc suivant. Amorcées de zéros à la publication (latence).
+        std::vector<float> pending;
+        size_t pendingCount = 0;
+    };
+    
+    std::shared_ptr<NAMModel> model_;
+    std::shared_ptr<NAMModel> light_model_;
+    SnapshotPublisher<ModelState> publisher_;
+    
+    // Gains en dB (-24 à +24), lissés en linéaire
+    // Valeurs demandées, lues par le thread de contrôle
+    std::atomic<float> input_db_;
+    std::atomic<float> output_db_;
+    SmoothedValue input_gain_;
+    SmoothedValue output_gain_;
+    
+    std::atomic<uint32_t> latency_;
+    std::atomic<bool> resampling_;
+    std::atomic<uint64_t> island_underruns_;
+    
+    bool installModel(std::shared_ptr<NAMModel> model, bool light);
+    void publishState();
+    
+    // Thread audio : count échantillons (mono) traités au taux du modèle
+    void processIsland(ModelState& state, NAMModel* model, float* buffer, uint32_t count);
+};
+
+} // namespace webamp
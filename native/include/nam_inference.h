@@ -0,0 +1,216 @@
+#pragma once
+
+#include "json_parser.h"
+#include "nam_kernels.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace webamp {
+
+// Lecture séquentielle du tableau "weights" d'un fichier .nam, dans l'ordre
+// de sérialisation de NAM (lève std::runtime_error s'il est trop court)
+class NAMWeightReader {
+public:
+    explicit NAMWeightReader(const std::vector<float>& weights) : weights_(weights), pos_(0) {}
+    
+    float next();
+    // Matrice sérialisée ligne par ligne (rows x cols), stockée transposée
+    void readMatrix(NAMMatrix& matrix, size_t rows, size_t cols);
+    void readVector(AlignedVector<float>& vector, size_t count, size_t paddedCount);
+    
+    size_t remaining() const { return weights_.size() - pos_; }
+
+private:
+    const std::vector<float>& weights_;
+    size_t pos_;
+};
+
+// Moteur d'inférence d'un modèle NAM
+//
+// Une instance contient l'état du modèle (historiques des convolutions,
+// états LSTM) : une instance par flux audio. Tout est alloué à la création ;
+// process() n'alloue pas et accepte input == output.
+class NAMDSP {
+public:
+    static constexpr size_t DEFAULT_MAX_BLOCK_SIZE = 512;
+    
+    virtual ~NAMDSP() = default;
+    
+    // Thread de contrôle : construit le modèle décrit par un document .nam
+    // (architectures WaveNet, LSTM, ConvNet, Linear). Lève std::runtime_error
+    // si l'architecture n'est pas supportée ou si les poids sont incohérents.
+    static std::unique_ptr<NAMDSP> create(const JsonValue& document, size_t maxBlockSize = DEFAULT_MAX_BLOCK_SIZE);
+    
+    // Thread audio : numFrames quelconque (découpé en blocs de getMaxBlockSize())
+    void process(const float* input, float* output, size_t numFrames);
+    
+    // Remet l'état initial du modèle
+    virtual void reset() = 0;
+    
+    // Traite du silence pour stabiliser l'état (biais des couches) avant usage
+    void prewarm();
+    
+    virtual const char* getArchitecture() const = 0;
+    size_t getMaxBlockSize() const { return max_block_size_; }
+    
+    static NAMActivation parseActivation(const std::string& name);
+
+protected:
+    explicit NAMDSP(size_t maxBlockSize) : max_block_size_(maxBlockSize) {}
+    
+    virtual void processBlock(const float* input, float* output, size_t numFrames) = 0;
+    virtual size_t getPrewarmSamples() const = 0;
+    
+    size_t max_block_size_;
+};
+
+// Modèle linéaire : FIR de receptive_field coefficients
+class NAMLinear : public NAMDSP {
+public:
+    NAMLinear(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize);
+    
+    void reset() override;
+    const char* getArchitecture() const override { return "Linear"; }
+
+protected:
+    void processBlock(const float* input, float* output, size_t numFrames) override;
+    size_t getPrewarmSamples() const override { return receptive_field_; }
+
+private:
+    size_t receptive_field_;
+    float bias_;
+    AlignedVector<float> weights_;    // Ordre chronologique (plus ancien en premier)
+    AlignedVector<float> history_;    // receptive_field - 1 échantillons + bloc courant
+};
+
+// ConvNet : convolutions dilatées (noyau 2), batchnorm repliée dans les poids
+class NAMConvNet : public NAMDSP {
+public:
+    NAMConvNet(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize);
+    
+    void reset() override;
+    const char* getArchitecture() const override { return "ConvNet"; }
+
+protected:
+    void processBlock(const float* input, float* output, size_t numFrames) override;
+    size_t getPrewarmSamples() const override { return receptive_field_; }
+
+private:
+    static constexpr size_t KERNEL_SIZE = 2;
+    
+    struct Block {
+        size_t dilation = 1;
+        NAMMatrix conv[KERNEL_SIZE];
+        AlignedVector<float> bias;
+        AlignedVector<float> history;   // Anneau des entrées [frame][stride]
+        size_t historyMask = 0;
+        size_t inputStride = 0;
+    };
+    
+    size_t channels_;
+    size_t stride_;
+    NAMActivation activation_;
+    std::vector<Block> blocks_;
+    AlignedVector<float> head_weights_;
+    float head_bias_;
+    AlignedVector<float> last_output_;  // Sortie du dernier bloc [frame][stride]
+    uint64_t time_;
+    size_t receptive_field_;
+};
+
+// LSTM multi-couches + tête linéaire
+class NAMLSTM : public NAMDSP {
+public:
+    NAMLSTM(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize);
+    
+    void reset() override;
+    const char* getArchitecture() const override { return "LSTM"; }
+
+protected:
+    void processBlock(const float* input, float* output, size_t numFrames) override;
+    size_t getPrewarmSamples() const override { return 24000; }
+
+private:
+    struct Cell {
+        size_t inputSize = 0;
+        NAMMatrix weights;              // 4H x (inputSize + H), portes i, f, g, o
+        AlignedVector<float> bias;
+        AlignedVector<float> xh;        // [x, h]
+        AlignedVector<float> cell;
+        AlignedVector<float> initialHidden;
+        AlignedVector<float> initialCell;
+        AlignedVector<float> gates;
+    };
+    
+    size_t hidden_size_;
+    std::vector<Cell> cells_;
+    AlignedVector<float> head_weights_;
+    float head_bias_;
+};
+
+// WaveNet : piles de convolutions causales dilatées à connexions résiduelles
+// et accumulation vers une tête (architecture standard des captures NAM).
+// Chaque étage utilise le noyau spécialisé de sa forme s'il existe
+// (NAMKernels::findWaveNetLayerKernel), le noyau générique sinon.
+class NAMWaveNet : public NAMDSP {
+public:
+    NAMWaveNet(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize);
+    
+    void reset() override;
+    const char* getArchitecture() const override { return "WaveNet"; }
+    
+    // "standard", "lite", "feather", "nano" ou "custom"
+    const char* getPreset() const { return preset_; }
+    // Vrai si tous les étages utilisent un noyau spécialisé
+    bool isSpecialised() const;
+
+protected:
+    void processBlock(const float* input, float* output, size_t numFrames) override;
+    size_t getPrewarmSamples() const override { return receptive_field_; }
+
+private:
+    struct Layer {
+        size_t dilation = 1;
+        std::vector<NAMMatrix> conv;        // Un par tap du noyau
+        AlignedVector<float> convBias;
+        NAMMatrix mixin;                    // Condition -> sortie de la convolution
+        NAMMatrix oneByOne;                 // Canaux -> canaux (résiduel)
+        AlignedVector<float> oneByOneBias;
+        AlignedVector<float> history;       // Anneau des entrées [frame][stride]
+        size_t historyMask = 0;
+    };
+    
+    struct LayerArray {
+        size_t inputSize = 0;
+        size_t channels = 0;
+        size_t stride = 0;                  // channels arrondi à NAM_SIMD_WIDTH
+        size_t headSize = 0;
+        size_t kernelSize = 0;
+        bool gated = false;
+        NAMActivation activation = NAMActivation::Tanh;
+        NAMMatrix rechannel;                // Entrée -> canaux
+        std::vector<Layer> layers;
+        NAMMatrix headRechannel;            // Canaux -> tête
+        AlignedVector<float> headBias;
+        AlignedVector<float> output;        // Anneau de sortie de la dernière couche [frame][stride]
+        size_t outputMask = 0;
+        AlignedVector<float> head;          // Accumulateur de tête [frame][stride]
+        NAMWaveNetLayerKernel kernel = nullptr;
+    };
+    
+    std::vector<LayerArray> arrays_;
+    AlignedVector<float> condition_;        // Entrée du bloc [frame][NAM_SIMD_WIDTH]
+    AlignedVector<float> head_output_;      // Sortie de tête finale [frame][NAM_SIMD_WIDTH]
+    AlignedVector<float> z_;                // Sortie de convolution d'une frame
+    float head_scale_;
+    uint64_t time_;
+    size_t receptive_field_;
+    const char* preset_;
+    
+    void processLayer(LayerArray& array, size_t layerIndex, size_t numFrames);
+    const char* detectPreset() const;
+};
+
+} // namespace webamp
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "aligned_allocator.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace webamp {
+
+// Largeur de padding des vecteurs de canaux (un registre AVX)
+constexpr size_t NAM_SIMD_WIDTH = 8;
+
+inline size_t namPaddedSize(size_t n) {
+    return (n + NAM_SIMD_WIDTH - 1) & ~(NAM_SIMD_WIDTH - 1);
+}
+
+// Fonctions d'activation des modèles NAM
+enum class NAMActivation {
+    Identity,
+    Tanh,
+    FastTanh,
+    HardTanh,
+    ReLU,
+    LeakyReLU,
+    Sigmoid
+};
+
+// Matrice de poids pré-transposée : la colonne j (coefficients appliqués à
+// l'entrée j) est contiguë à data[j * stride]. stride = rows arrondi à
+// NAM_SIMD_WIDTH, lignes de padding nulles : un produit matrice-vecteur est
+// une suite de FMA sur des colonnes alignées, sans reste.
+struct NAMMatrix {
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t stride = 0;
+    AlignedVector<float> data;
+    
+    void resize(size_t rowCount, size_t colCount) {
+        rows = rowCount;
+        cols = colCount;
+        stride = namPaddedSize(rowCount);
+        data.assign(stride * colCount, 0.0f);
+    }
+    
+    float& at(size_t row, size_t col) { return data[col * stride + row]; }
+    float at(size_t row, size_t col) const { return data[col * stride + row]; }
+    const float* column(size_t col) const { return data.data() + col * stride; }
+};
+
+// Couche WaveNet vue par les noyaux : pointeurs sur les poids et les tampons
+// du modèle. Les anneaux sont indexés par le temps absolu (masque = taille - 1),
+// condition et head par la frame du bloc.
+struct NAMWaveNetLayerView {
+    size_t channels = 0;
+    size_t stride = 0;                      // channels arrondi à NAM_SIMD_WIDTH
+    size_t kernelSize = 0;
+    size_t dilation = 1;
+    bool gated = false;
+    NAMActivation activation = NAMActivation::Tanh;
+    const NAMMatrix* conv = nullptr;        // kernelSize matrices (une par tap)
+    const float* convBias = nullptr;
+    const NAMMatrix* mixin = nullptr;
+    const NAMMatrix* oneByOne = nullptr;
+    const float* oneByOneBias = nullptr;
+    const float* input = nullptr;           // Anneau d'entrée [frame][stride]
+    size_t inputMask = 0;
+    float* output = nullptr;                // Anneau de sortie [frame][stride]
+    size_t outputMask = 0;
+    const float* condition = nullptr;       // [frame][NAM_SIMD_WIDTH]
+    float* head = nullptr;                  // Accumulateur de tête [frame][stride]
+    float* scratch = nullptr;               // Sortie de convolution (version générique)
+};
+
+// Traitement de numFrames frames d'une couche à partir du temps absolu time
+using NAMWaveNetLayerKernel = void (*)(const NAMWaveNetLayerView& layer, uint64_t time, size_t numFrames);
+
+// Noyaux de calcul de l'inférence NAM
+// AVX2/FMA sur x86, NEON sur ARM, version scalaire sinon. Les vecteurs de
+// sortie (y) sont alignés et de taille stride (multiple de NAM_SIMD_WIDTH).
+class NAMKernels {
+public:
+    // y[0, stride) += M * x (x de taille M.cols)
+    static void gemvAccumulate(const NAMMatrix& m, const float* x, float* y);
+    
+    // y[0, count) += x[0, count)
+    static void add(const float* x, float* y, size_t count);
+    
+    // Activation en place sur x[0, count)
+    static void activate(NAMActivation activation, float* x, size_t count);
+    
+    // Activation à porte : x[i] = act(x[i]) * sigmoid(x[channels + i])
+    static void gatedActivate(NAMActivation activation, float* x, size_t channels);
+    
+    // y = dot(a, b) sur count éléments
+    static float dot(const float* a, const float* b, size_t count);
+    
+    // Couche WaveNet, toutes formes (tailles lues dans la vue)
+    static void waveNetLayer(const NAMWaveNetLayerView& layer, uint64_t time, size_t numFrames);
+    
+    // Couche WaveNet spécialisée à la compilation (canaux et taille de noyau
+    // constants : boucles déroulées, accumulateurs en registres) pour les formes
+    // des architectures standard, lite, feather et nano. nullptr si la forme
+    // n'est pas couverte : utiliser waveNetLayer.
+    static NAMWaveNetLayerKernel findWaveNetLayerKernel(size_t channels, size_t kernelSize,
+                                                        bool gated, NAMActivation activation);
+    
+    // Approximations utilisées par les noyaux (exposées pour les références)
+    static float tanhApprox(float x);
+    static float fastTanh(float x);
+    static float sigmoidApprox(float x);
+};
+
+} // namespace webamp
@@ -10,6 +10,7 @@
 #ifndef NAM_LOADER_H
 #define NAM_LOADER_H
 
+#include "nam_inference.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -35,6 +36,10 @@ struct NAMModelMetadata {
 
 /**
  * Modèle NAM chargé en mémoire
+ *
+ * Le document .nam (JSON) est analysé au chargement : métadonnées et moteur
+ * d'inférence (WaveNet, LSTM, ConvNet, Linear) avec poids pré-transposés.
+ * Le modèle contient l'état de traitement : un seul flux audio à la fois.
  */
 class NAMModel {
 public:
@@ -52,16 +57,23 @@ public:
     
     // Validation
     bool isValid() const { return valid_; }
+    const char* getArchitecture() const { return dsp_ ? dsp_->getArchitecture() : ""; }
     
-    // Traitement audio (à implémenter avec le moteur NAM)
+    // Traitement audio mono (thread audio, sans allocation, input == output autorisé)
     void processAudio(float* input, float* output, size_t numSamples, int sampleRate);
+    
+    // Remet l'état du modèle à zéro (hors thread audio)
+    void reset();
 
 private:
     NAMModelMetadata metadata_;
     std::vector<uint8_t> modelData_;
     bool valid_;
     
-    bool parseMetadata(const uint8_t* data, size_t size);
+    std::unique_ptr<NAMDSP> dsp_;
+    AlignedVector<float> scratch_;  // Entrée après gain d'entrée
+    
+    void parseMetadata(const JsonValue& document);
 };
 
 /**
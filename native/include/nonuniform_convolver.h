@@ -0,0 +1,114 @@
+#pragma once
+
+#include "partitioned_convolver.h"
+#include "rt_semaphore.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace webamp {
+
+// Convolution partitionnée non uniforme, sans latence, pour IR longues
+// (réverbérations de plusieurs secondes)
+//
+// L'IR est découpée en segments de taille croissante :
+// - tête [0, H) : FIR direct, échantillon par échantillon ;
+// - étages FFT de blocs H, 4H, 16H... : chaque étage commence à un décalage
+//   au moins égal à sa taille de bloc, ce qui masque sa latence de bloc ;
+// - dernier étage (la queue, blocs les plus grands) : calculé par un thread de
+//   travail temps réel (RealtimeThread). Il commence à 3x sa taille de bloc :
+//   un bloc de queue n'est requis que deux blocs de queue après sa remise au
+//   thread, qui traite ainsi deux blocs à la fois (double tampon) et rend
+//   normalement son résultat un bloc d'avance. Le thread audio n'attend que
+//   si le thread de travail a pris plus d'un bloc de retard.
+//
+// Toutes les contributions différées sont accumulées dans un anneau de sortie
+// commun, lu échantillon par échantillon.
+class NonUniformConvolver {
+public:
+    struct Config {
+        size_t headSize = 64;          // Bloc de tête (taille de bloc du driver)
+        size_t maxBlockSize = 8192;    // Bloc maximal (queue)
+        bool backgroundTail = true;    // Queue sur thread de travail
+    };
+    
+    NonUniformConvolver();
+    ~NonUniformConvolver();
+    
+    NonUniformConvolver(const NonUniformConvolver&) = delete;
+    NonUniformConvolver& operator=(const NonUniformConvolver&) = delete;
+    
+    // Thread de contrôle : découpe l'IR, précalcule les spectres et démarre le
+    // thread de travail si nécessaire
+    bool init(const float* ir, size_t irLength, const Config& config);
+    
+    // Thread audio : aucune allocation ni verrou, count quelconque
+    void process(const float* input, float* output, size_t count);
+    
+    void reset();
+    
+    // Informations sur le découpage
+    size_t getHeadSize() const { return head_size_; }
+    size_t getStageCount() const { return stages_.size(); }
+    size_t getStageBlockSize(size_t stage) const { return stages_[stage]->blockSize; }
+    size_t getStageOffset(size_t stage) const { return stages_[stage]->offset; }
+    bool hasBackgroundStage() const { return worker_.joinable(); }
+    
+    // Nombre de blocs où le thread audio a dû attendre le thread de travail
+    // (plus d'un bloc de queue de retard)
+    uint64_t getWorkerWaitCount() const { return worker_waits_.load(std::memory_order_relaxed); }
+
+private:
+    // Étage FFT : segment [offset, offset + length) de l'IR, blocs de blockSize
+    struct Stage {
+        size_t blockSize = 0;
+        size_t offset = 0;
+        bool background = false;
+        PartitionedConvolver convolver;
+        std::vector<float> input;     // Bloc d'entrée en cours de remplissage
+        std::vector<float> output;    // Résultat du dernier bloc
+    };
+    
+    size_t head_size_;
+    std::vector<float> head_reversed_;   // Tête de l'IR inversée (produit scalaire)
+    std::vector<float> head_history_;    // Historique doublé (lecture contiguë)
+    size_t head_history_size_;
+    size_t head_pos_;
+    
+    std::vector<std::unique_ptr<Stage>> stages_;
+    
+    std::vector<float> accumulator_;     // Anneau de sortie des étages FFT
+    size_t accumulator_mask_;
+    uint64_t time_;                      // Échantillons traités depuis reset()
+    
+    // Bloc de queue confié au thread de travail (deux en vol, alternés)
+    struct TailJob {
+        std::vector<float> input;
+        std::vector<float> output;
+        uint64_t blockTime = 0;          // Fin du bloc d'entrée
+        bool pending = false;            // Remis, pas encore récupéré (thread audio)
+        std::atomic<bool> done{true};
+    };
+    static constexpr size_t TAIL_JOBS = 2;
+    
+    // Thread de travail (dernier étage)
+    std::thread worker_;
+    RTSemaphore worker_wake_;
+    std::atomic<bool> worker_stop_;
+    TailJob tail_jobs_[TAIL_JOBS];
+    size_t tail_next_;                   // Prochain bloc remis (thread audio)
+    size_t worker_next_;                 // Prochain bloc traité (thread de travail)
+    std::atomic<uint64_t> worker_waits_;
+    
+    void stopWorker();
+    void workerLoop();
+    void completeBlock(Stage& stage);
+    // Thread audio : ajoute le résultat du bloc job (attend s'il est en retard)
+    void collectBackground(TailJob& job);
+    void accumulate(const std::vector<float>& block, uint64_t startTime);
+};
+
+} // namespace webamp
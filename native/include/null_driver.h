@@ -0,0 +1,155 @@
+#pragma once
+
+#include "audio_driver.h"
+#include "wav_file.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace webamp {
+
+// Driver sans matériel : un thread appelle le callback sur une horloge
+// précise (Clock::Realtime) ou aussi vite que possible (Clock::Freewheel),
+// avec une entrée silencieuse. Sert aux tests d'endurance et aux mesures
+// CPU/xruns sur des machines sans carte son ni serveur audio.
+//
+// Pour reproduire les conditions d'un vrai driver, il peut faire varier la
+// taille des blocs, décaler les réveils (jitter) et retarder certains
+// callbacks. Tous les tirages viennent d'un générateur initialisé par
+// Options::seed : deux runs avec les mêmes options voient la même suite de
+// tailles et de retards.
+class NullDriver : public AudioDriver {
+public:
+    enum class Clock {
+        Realtime,   // Un bloc par période (frames / sampleRate)
+        Freewheel   // Enchaîne les callbacks sans attendre
+    };
+    
+    struct Options {
+        Clock clock = Clock::Realtime;
+        uint32_t minFrames = 0;             // Tailles de bloc tirées dans [min, max]
+        uint32_t maxFrames = 0;             // 0 : taille fixe (getBufferSize())
+        double jitterSeconds = 0.0;         // Décalage aléatoire des réveils (± jitter)
+        double lateProbability = 0.0;       // Probabilité qu'un callback soit retardé
+        double lateSeconds = 0.0;           // Retard appliqué à ces callbacks
+        uint64_t totalFrames = 0;           // Arrêt après ce nombre de frames (0 : illimité)
+        uint32_t seed = 1;
+    };
+    
+    // Compteurs lus depuis le thread de contrôle
+    struct Stats {
+        uint64_t callbacks = 0;
+        uint64_t frames = 0;
+        uint64_t xruns = 0;                 // Callbacks terminés après leur échéance
+        uint64_t lateCallbacks = 0;         // Retards simulés
+        uint64_t maxCallbackNs = 0;         // Durée du callback le plus long
+        uint64_t totalCallbackNs = 0;
+        uint32_t minBlockFrames = 0;
+        uint32_t maxBlockFrames = 0;
+    };
+    
+    NullDriver();
+    ~NullDriver() override;
+    
+    bool initialize(uint32_t sampleRate, uint32_t bufferSize) override;
+    void shutdown() override;
+    
+    bool start() override;
+    bool stop() override;
+    
+    uint32_t getSampleRate() const override { return sample_rate_; }
+    uint32_t getBufferSize() const override { return buffer_size_; }
+    uint32_t getInputChannels() const override { return CHANNELS; }
+    uint32_t getOutputChannels() const override { return CHANNELS; }
+    
+    // Pas de matériel : latence d'un bloc dans chaque sens
+    double getInputLatency() const override;
+    double getOutputLatency() const override;
+    
+    // Avant start()
+    void setOptions(const Options& options) { options_ = options; }
+    const Options& getOptions() const { return options_; }
+    
+    Stats getStats() const;
+    
+    // Vrai quand Options::totalFrames (ou la fin du fichier) est atteint
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+    // Attend la fin du rendu ; false si timeoutSeconds est écoulé avant
+    bool waitUntilFinished(double timeoutSeconds) const;
+    
+    static constexpr uint32_t CHANNELS = 2;
+    
+protected:
+    // Thread audio : entrée du bloc (stéréo entrelacé). Renvoie false quand
+    // la source est épuisée (arrêt du rendu).
+    virtual bool fillInput(float* input, uint32_t frameCount);
+    // Thread audio : sortie du bloc après le callback
+    virtual void consumeOutput(const float* output, uint32_t frameCount);
+    // Thread de contrôle : préparation avant le démarrage du thread audio
+    virtual bool prepare() { return true; }
+    
+    uint32_t sample_rate_;
+    uint32_t buffer_size_;
+    
+private:
+    Options options_;
+    
+    std::vector<float> input_;
+    std::vector<float> output_;
+    
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> finished_;
+    bool initialized_;
+    
+    // Stats (écrites par le thread audio uniquement)
+    std::atomic<uint64_t> callbacks_;
+    std::atomic<uint64_t> frames_;
+    std::atomic<uint64_t> xruns_;
+    std::atomic<uint64_t> late_callbacks_;
+    std::atomic<uint64_t> max_callback_ns_;
+    std::atomic<uint64_t> total_callback_ns_;
+    std::atomic<uint32_t> min_block_frames_;
+    std::atomic<uint32_t> max_block_frames_;
+    
+    void audioLoop();
+};
+
+// NullDriver alimenté par un fichier WAV (mono dupliqué ou stéréo), lu à
+// la fréquence du fichier. Sans boucle, le rendu s'arrête à la fin du
+// fichier ; la sortie peut être enregistrée (même durée que l'entrée) et
+// est écrite au stop().
+class FileDriver : public NullDriver {
+public:
+    explicit FileDriver(std::string inputPath, std::string outputPath = "");
+    ~FileDriver() override;  // Arrête le thread avant la destruction des buffers
+    
+    // La fréquence d'échantillonnage est celle du fichier
+    bool initialize(uint32_t sampleRate, uint32_t bufferSize) override;
+    bool stop() override;
+    
+    void setLooping(bool loop) { loop_ = loop; }
+    bool isLooping() const { return loop_; }
+    
+    const std::string& getInputPath() const { return input_path_; }
+    
+protected:
+    bool fillInput(float* input, uint32_t frameCount) override;
+    void consumeOutput(const float* output, uint32_t frameCount) override;
+    bool prepare() override;
+    
+private:
+    std::string input_path_;
+    std::string output_path_;
+    WavAudio source_;
+    WavAudio recording_;
+    bool loop_;
+    size_t read_position_;
+    size_t record_position_;
+    
+    bool writeRecording();
+};
+
+} // namespace webamp
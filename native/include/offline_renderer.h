@@ -0,0 +1,96 @@
+#pragma once
+
+#include "wav_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace webamp {
+
+class EffectChain;
+
+// Description d'une chaîne de rendu hors ligne (fichier JSON) :
+//
+// {
+//   "blockSize": 256,
+//   "inputGain": 0, "outputGain": 0,       (dB)
+//   "tail": 2.0,                           (secondes rendues après l'entrée)
+//   "bitDepth": 24,                        (16, 24 ou 32 = float)
+//   "nam": "amp.nam",                      (modèle NAM du pipeline, après la chaîne)
+//   "effects": [
+//     {"type": "overdrive", "parameters": {"drive": 0.7, "antialiasing": 1}},
+//     {"type": "nam", "path": "pedal.nam"},
+//     {"type": "ir", "path": "cab.wav", "parameters": {"mix": 100}},
+//     {"type": "delay", "bypassed": true}
+//   ]
+// }
+//
+// Les types d'effet sont ceux d'EffectManager, plus "nam" et "ir". Les
+// chemins relatifs sont résolus par rapport au fichier de description.
+struct ChainDescription {
+    struct Effect {
+        std::string type;
+        std::string path;       // Modèle NAM ou IR
+        std::vector<std::pair<std::string, float>> parameters;
+        bool bypassed = false;
+    };
+    
+    std::vector<Effect> effects;
+    std::string namModel;
+    float inputGain = 0.0f;
+    float outputGain = 0.0f;
+    double tailSeconds = 0.0;
+    uint32_t blockSize = 256;
+    uint16_t bitDepth = 24;
+    
+    // Renvoie false et renseigne error si le JSON est invalide
+    static bool parse(const std::string& json, ChainDescription& description, std::string& error, const std::string& baseDirectory = "");
+    static bool load(const std::string& filePath, ChainDescription& description, std::string& error);
+};
+
+// Rendu de fichiers audio à travers DSPPipeline/EffectChain sans driver,
+// aussi vite que le CPU le permet. Chaque rendu construit son propre
+// pipeline et ses effets (état indépendant) : les rendus d'un lot tournent
+// en parallèle sur un WorkStealingPool.
+class OfflineRenderer {
+public:
+    struct Result {
+        std::string inputPath;
+        std::string outputPath;
+        bool success = false;
+        std::string error;
+        uint64_t frames = 0;
+        uint32_t sampleRate = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;     // Traitement seul, hors lecture/écriture
+        
+        // Débit en multiple du temps réel (xRT)
+        double getRealtimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+    };
+    
+    explicit OfflineRenderer(ChainDescription description);
+    
+    const ChainDescription& getDescription() const { return description_; }
+    
+    // Rendu en mémoire (mono ou stéréo, même nombre de canaux en sortie)
+    bool render(const WavAudio& input, WavAudio& output, std::string& error, double* renderSeconds = nullptr) const;
+    
+    Result renderFile(const std::string& inputPath, const std::string& outputPath) const;
+    
+    // Un fichier par tâche (entrée, sortie) ; threadCount = 0 : un par cœur.
+    // Résultats dans l'ordre des tâches.
+    std::vector<Result> renderFiles(const std::vector<std::pair<std::string, std::string>>& jobs, size_t threadCount = 0) const;
+    
+    // Fichiers .wav d'un répertoire, triés par nom
+    static std::vector<std::string> listWavFiles(const std::string& directory);
+    
+private:
+    ChainDescription description_;
+    
+    std::shared_ptr<EffectChain> buildChain(uint32_t sampleRate, std::string& error) const;
+};
+
+} // namespace webamp
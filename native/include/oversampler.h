@@ -0,0 +1,184 @@
+#pragma once
+
+#include "aligned_allocator.h"
+#include "audio_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace webamp {
+
+// Suréchantillonnage 2x/4x/8x pour le cœur non linéaire d'un effet
+//
+// Cascade d'étages demi-bande polyphasés (un étage par facteur 2) :
+// - Phase::Linear : FIR demi-bande symétriques (fenêtre de Kaiser), phase
+//   linéaire, latence de l'ordre de 63 échantillons au taux de base ;
+//   branche paire vectorisée (AVX/SSE/NEON) sur les échantillons de sortie
+// - Phase::Minimum : passe-tout IIR polyphasés (cellules du premier ordre
+//   en z^-2), phase non linéaire, latence de quelques échantillons
+//
+// Un effet possède un Oversampler et y passe son waveshaper :
+//   oversampler_.process(in, out, channels, frames, [](uint32_t ch, float* x, uint32_t n) { ... });
+// Le noyau est appliqué à chaque canal au taux suréchantillonné, dans l'ordre
+// des canaux.
+class Oversampler {
+public:
+    enum class Phase : uint32_t {
+        Linear = 0,
+        Minimum
+    };
+    
+    static constexpr uint32_t MAX_FACTOR = 8;
+    static constexpr uint32_t MAX_STAGES = 3;
+    static constexpr uint32_t MAX_CHANNELS = AudioBuffer::MAX_CHANNELS;
+    static constexpr uint32_t MAX_IIR_COEFS = 8;
+    
+    // Taille des sous-blocs par défaut : process() découpe les blocs plus
+    // longs, un effet peut donc préparer une fois pour toutes
+    static constexpr uint32_t DEFAULT_BLOCK_SIZE = 256;
+    
+    Oversampler();
+    
+    // Thread de contrôle : buffers pour des sous-blocs de maxFrameCount
+    // frames (taux de base) et tous les facteurs
+    void prepare(uint32_t maxFrameCount = DEFAULT_BLOCK_SIZE);
+    uint32_t getMaxFrameCount() const { return max_frame_count_; }
+    
+    // Sans allocation (utilisable depuis setParameterByIndex) : appliqué au
+    // bloc suivant, l'état des filtres est remis à zéro. Facteur arrondi à
+    // 1, 2, 4 ou 8.
+    void setFactor(uint32_t factor);
+    uint32_t getFactor() const { return requested_factor_.load(std::memory_order_relaxed); }
+    void setPhase(Phase phase) { requested_phase_.store(phase, std::memory_order_relaxed); }
+    Phase getPhase() const { return requested_phase_.load(std::memory_order_relaxed); }
+    
+    // Dégradation adaptative (thread audio) : chaque niveau divise par deux
+    // le facteur demandé (8 -> 4 -> 2 -> 1), appliqué au bloc suivant comme
+    // un changement de facteur. getFactor() reste le facteur demandé.
+    static constexpr uint32_t QUALITY_TIERS = MAX_STAGES + 1;
+    void setQualityTier(uint32_t tier) {
+        quality_tier_.store(std::min(tier, QUALITY_TIERS - 1), std::memory_order_relaxed);
+    }
+    uint32_t getActiveFactor() const { return factor_; }
+    // Facteur demandé après dégradation, celui du prochain bloc (tout thread)
+    uint32_t getEffectiveFactor() const {
+        return std::max(1u, requested_factor_.load(std::memory_order_relaxed) >>
+                                quality_tier_.load(std::memory_order_relaxed));
+    }
+    
+    // Facteur 1 appliqué et demandé (thread audio) : process() se réduit au
+    // noyau, que l'effet peut alors appeler directement (voir FusedChain)
+    bool isPassthrough() const { return factor_ == 1 && getEffectiveFactor() == 1; }
+    
+    // Latence ajoutée en échantillons au taux de base (retard de groupe en
+    // basse fréquence, fractionnaire). La version membre lit une table
+    // calculée à la construction (utilisable depuis le thread audio), pour
+    // le facteur effectif : elle suit le niveau de qualité.
+    float getLatency() const;
+    static float getLatency(uint32_t factor, Phase phase);
+    
+    // Thread audio : in-place autorisé
+    template<typename Kernel>
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount, Kernel&& kernel);
+    
+    // Coût mesuré du suréchantillonnage + décimation (noyau identité), en
+    // nanosecondes par frame stéréo au taux de base
+    struct Cost {
+        uint32_t factor;
+        Phase phase;
+        double nsPerFrame;
+        float latency;
+    };
+    static Cost measureCost(uint32_t factor, Phase phase);
+    static std::vector<Cost> measureCosts();
+    
+private:
+    // Étage FIR demi-bande : seuls les coefficients pairs sont non nuls
+    // (hors centre = 0.5), soit 2K coefficients par branche polyphasée
+    struct FIRStage {
+        uint32_t halfTaps = 0;                         // K
+        AlignedVector<float> taps;                     // h[2j], j < 2K
+        AlignedVector<float> upHistory[MAX_CHANNELS];  // 2K-1 + bloc
+        AlignedVector<float> downEven[MAX_CHANNELS];   // 2K-1 + bloc
+        AlignedVector<float> downOdd[MAX_CHANNELS];    // K + bloc
+        AlignedVector<float> sums;                     // branche paire, un bloc
+    };
+    
+    // Étage IIR : deux chaînes de passe-tout (coefficients pairs / impairs)
+    struct IIRStage {
+        uint32_t coefCount = 0;
+        float coefs[MAX_IIR_COEFS] = {};
+        float upX[MAX_CHANNELS][MAX_IIR_COEFS] = {};
+        float upY[MAX_CHANNELS][MAX_IIR_COEFS] = {};
+        float downX[MAX_CHANNELS][MAX_IIR_COEFS] = {};
+        float downY[MAX_CHANNELS][MAX_IIR_COEFS] = {};
+    };
+    
+    std::atomic<uint32_t> requested_factor_;
+    std::atomic<Phase> requested_phase_;
+    
+    // getLatency(2^stages, phase), indexée par [phase][stages]
+    float latencies_[2][MAX_STAGES + 1];
+    
+    // Écrit par le thread audio, lu par getLatency() depuis tout thread
+    std::atomic<uint32_t> quality_tier_;
+    
+    // État du thread audio
+    uint32_t factor_;
+    Phase phase_;
+    uint32_t max_frame_count_;
+    FIRStage fir_[MAX_STAGES];
+    IIRStage iir_[MAX_STAGES];
+    AudioBuffer work_[2];
+    
+    // Applique le facteur/la phase demandés, renvoie le facteur du bloc
+    uint32_t beginBlock();
+    void resetState();
+    
+    // Renvoie les canaux suréchantillonnés (frameCount * factor_ échantillons)
+    float* const* upsample(const float* const* input, uint32_t channels, uint32_t frameCount);
+    void downsample(float* const* output, uint32_t channels, uint32_t frameCount);
+    
+    void upsampleFIR(FIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count);
+    void downsampleFIR(FIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count);
+    static void upsampleIIR(IIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count);
+    static void downsampleIIR(IIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count);
+    
+    static uint32_t getStageCount(uint32_t factor);
+};
+
+template<typename Kernel>
+void Oversampler::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount, Kernel&& kernel) {
+    channels = std::min(channels, MAX_CHANNELS);
+    const uint32_t factor = beginBlock();
+    
+    if (factor == 1 || max_frame_count_ == 0) {
+        AudioBuffer::copy(input, output, channels, frameCount);
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            kernel(ch, output[ch], frameCount);
+        }
+        return;
+    }
+    
+    // Buffers dimensionnés par prepare() : traitement par sous-blocs
+    const float* in[MAX_CHANNELS];
+    float* out[MAX_CHANNELS];
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        const uint32_t chunk = std::min(frameCount - offset, max_frame_count_);
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            in[ch] = input[ch] + offset;
+            out[ch] = output[ch] + offset;
+        }
+        
+        float* const* oversampled = upsample(in, channels, chunk);
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            kernel(ch, oversampled[ch], chunk * factor);
+        }
+        downsample(out, channels, chunk);
+        offset += chunk;
+    }
+}
+
+} // namespace webamp
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "compensation_delay.h"
+#include "effect_base.h"
+#include "rt_worker_pool.h"
+#include "smoothed_value.h"
+#include "snapshot_publisher.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace webamp {
+
+// Nœud de graphe : sépare le signal vers plusieurs branches (chacune une
+// chaîne d'effets en série, par ex. un ampli NAM suivi d'un IR de cabinet)
+// puis les somme avec un niveau par branche.
+//
+// S'insère dans une EffectChain comme n'importe quel effet. Les branches
+// étant indépendantes, elles sont traitées en parallèle sur un RTWorkerPool ;
+// la topologie est publiée sous forme d'instantané comme dans EffectChain.
+//
+// Les branches sont alignées avant la somme : chacune est retardée de
+// l'écart entre sa latence et celle de la branche la plus lente (une branche
+// vide sert ainsi de chemin sec aligné sur un ampli NAM rééchantillonné).
+// Les lignes à retard viennent d'un pool propre au nœud, réservées à la
+// construction ; elles ne font pas partie de l'instantané et gardent leur
+// historique quand la topologie change.
+class ParallelEffect : public EffectBase {
+public:
+    static constexpr size_t MAX_BRANCHES = 4;
+    
+    // pool == nullptr : pool partagé du processus
+    explicit ParallelEffect(size_t branchCount = 2, RTWorkerPool* pool = nullptr);
+    ~ParallelEffect() override;
+    
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override;
+    
+    // Branches (thread de contrôle). Une modification est signalée au
+    // conteneur (voir EffectBase::setStructureListener()) : dans une
+    // EffectChain, la mémoire des effets ajoutés est disposée dans l'arène
+    // de la chaîne.
+    size_t getBranchCount() const { return branch_count_; }
+    void addEffect(size_t branch, std::shared_ptr<EffectBase> effect, size_t position = static_cast<size_t>(-1));
+    void removeEffect(size_t branch, size_t index);
+    void clearBranch(size_t branch);
+    std::shared_ptr<EffectBase> getEffect(size_t branch, size_t index) const;
+    size_t getEffectCount(size_t branch) const;
+    
+    // Traitement des branches sur le pool (sinon en série sur le thread audio)
+    void setParallel(bool enabled) { parallel_.store(enabled); }
+    bool isParallel() const { return parallel_.load(); }
+    
+    // Niveau de sortie d'une branche (paramètre "level<N>", N à partir de 1)
+    void setBranchLevel(size_t branch, float level) { setParameterByIndex(branch, level); }
+    
+    std::vector<Parameter> getParameters() const override;
+    void setParameter(const std::string& name, float value) override;
+    void setParameterByIndex(size_t index, float value) override;
+    float getParameter(const std::string& name) const override;
+    
+    bool containsEffect(const EffectBase* effect) const override;
+    // Effets des branches, branche après branche (arène de la chaîne)
+    void collectMemoryEffects(std::vector<EffectBase*>& effects) override;
+    bool applyParameterChange(const ParameterChange& change) override;
+    
+    std::string getName() const override { return "Parallel"; }
+    std::string getType() const override { return "parallel"; }
+    // MonoToStereo dès qu'un effet d'une branche l'est
+    ChannelLayout getChannelLayout() const override;
+    
+    void setSampleRate(uint32_t sampleRate) override;
+    void setMaxBlockSize(uint32_t maxFrameCount) override;
+    
+    // Latence de la branche la plus lente (les autres sont compensées)
+    uint32_t getLatency() const override { return latency_.load(std::memory_order_relaxed); }
+    // Lignes de compensation réservées pour toutes les branches, et blocs
+    // de branche traités sans leur retard (désalignés)
+    bool isCompensationReserved() const;
+    uint64_t getCompensationFailureCount() const;
+    // Plus longue somme des queues d'une branche
+    uint32_t getTailLength() const override { return tail_length_.load(std::memory_order_relaxed); }
+    
+    // Niveau de qualité transmis aux effets des branches, qui le bornent
+    // à leurs propres niveaux
+    uint32_t getQualityTierCount() const override { return std::numeric_limits<uint32_t>::max(); }
+    
+protected:
+    // Niveau transmis aux branches et compensation recalculée aussitôt :
+    // EffectChain somme la latence du nœud juste après, dans le même bloc
+    void applyQualityTier(uint32_t tier) override;
+    
+private:
+    struct Branch {
+        std::vector<std::shared_ptr<EffectBase>> effects;
+        // Buffers de travail planaires : copie de l'entrée traitée en place,
+        // et sortie des effets qui ne peuvent pas l'être
+        AudioBuffer work[2];
+        // Sortie du dernier bloc (canaux de l'un des buffers de travail)
+        const float* const* result = nullptr;
+        // Alignement sur la branche la plus lente (ligne du nœud, hors
+        // instantané)
+        CompensationDelay* compensation = nullptr;
+        uint32_t delay = 0;
+    };
+    
+    // Instantané immuable (hormis les buffers) lu par le thread audio
+    struct Snapshot {
+        std::vector<Branch> branches;
+        uint32_t maxFrameCount = 0;
+        // Bloc en cours, renseigné par process() avant la distribution
+        const float* input[MAX_CHANNELS] = {};
+        uint32_t channels = 0;
+        uint32_t frameCount = 0;
+    };
+    
+    size_t branch_count_;
+    RTWorkerPool* pool_;
+    std::atomic<bool> parallel_;
+    SmoothedParameter levels_[MAX_BRANCHES];
+    std::atomic<uint32_t> latency_;
+    std::atomic<uint32_t> tail_length_;
+    
+    // Lignes de compensation : une par canal et par branche
+    BufferPool compensation_pool_;
+    std::unique_ptr<CompensationDelay> compensation_[MAX_BRANCHES];
+    
+    std::vector<std::vector<std::shared_ptr<EffectBase>>> branches_;
+    mutable std::mutex mutex_;
+    SnapshotPublisher<Snapshot> publisher_;
+    
+    void publishLocked();
+    // Retards de compensation des branches et queue du nœud, renvoie la
+    // latence du nœud
+    uint32_t updateCompensation(Snapshot& snapshot);
+    static uint32_t getBranchLatency(const std::vector<std::shared_ptr<EffectBase>>& effects);
+    static void processBranch(void* context, size_t index);
+};
+
+} // namespace webamp
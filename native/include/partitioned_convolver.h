@@ -0,0 +1,80 @@
+#pragma once
+
+#include "fft_helper.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace webamp {
+
+// Convolution partitionnée uniforme (overlap-add fréquentiel, sans latence)
+//
+// L'IR est découpée en partitions de blockSize échantillons dont les spectres
+// sont calculés une seule fois dans init(). Les spectres des blocs d'entrée
+// précédents forment une ligne à retard fréquentielle : leur contribution est
+// accumulée une fois par bloc. Chaque appel à process() coûte une FFT réelle
+// directe et une FFT réelle inverse, quel que soit le nombre d'échantillons
+// reçus (un bloc incomplet est complété par des zéros, d'où l'absence de
+// latence). Les spectres (blockSize + 1 bins) sont stockés au format séparé
+// re/im aligné pour la multiplication-accumulation vectorisée.
+class PartitionedConvolver {
+public:
+    PartitionedConvolver();
+    
+    // Thread de contrôle : alloue et précalcule les spectres de l'IR
+    // (blockSize est arrondi à la puissance de 2 supérieure)
+    bool init(size_t blockSize, const float* ir, size_t irLength);
+    
+    // Remet à zéro l'historique (l'IR est conservée)
+    void reset();
+    
+    // Thread audio : aucune allocation, count quelconque
+    void process(const float* input, float* output, size_t count);
+    
+    size_t getBlockSize() const { return block_size_; }
+    size_t getPartitionCount() const { return ir_partitions_.size(); }
+    
+    // Thread audio : seules les count premières partitions sont convoluées
+    // (IR tronquée, dégradation adaptative). Borné à [1, getPartitionCount()],
+    // effectif dès le bloc suivant.
+    void setActivePartitionCount(size_t count);
+    size_t getActivePartitionCount() const { return active_partitions_; }
+    bool isInitialized() const { return !ir_partitions_.empty(); }
+
+private:
+    struct Spectrum {
+        AlignedVector<float> re;
+        AlignedVector<float> im;
+        
+        void assign(size_t bins) {
+            re.assign(bins, 0.0f);
+            im.assign(bins, 0.0f);
+        }
+        void clear() {
+            std::fill(re.begin(), re.end(), 0.0f);
+            std::fill(im.begin(), im.end(), 0.0f);
+        }
+    };
+    
+    size_t block_size_;
+    size_t fft_size_;
+    size_t bins_;                             // fft_size_ / 2 + 1
+    std::unique_ptr<FFTPlan> plan_;
+    
+    std::vector<Spectrum> ir_partitions_;     // Spectres des partitions de l'IR
+    std::vector<Spectrum> input_partitions_;  // Ligne à retard fréquentielle
+    size_t current_;                          // Partition d'entrée courante
+    size_t active_partitions_;                // Partitions convoluées
+    
+    Spectrum accumulated_;                    // Contribution des blocs précédents
+    Spectrum fft_buffer_;
+    AlignedVector<float> input_block_;        // Bloc courant + moitié haute nulle
+    AlignedVector<float> output_block_;       // Résultat temporel de la FFT inverse
+    std::vector<float> overlap_;
+    size_t input_fill_;
+    
+    static void multiplyAccumulate(Spectrum& acc, const Spectrum& a, const Spectrum& b, size_t bins);
+};
+
+} // namespace webamp
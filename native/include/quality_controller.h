@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ring_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace webamp {
+
+// Dégradation adaptative de la qualité quand l'échéance du bloc est menacée
+//
+// Le thread audio appelle update() après chaque bloc avec sa charge (temps
+// de traitement / durée du bloc). Au-dessus de highWater pendant downBlocks
+// blocs consécutifs, ou dès qu'un bloc dépasse son échéance, le niveau
+// augmente d'un cran. Il ne redescend qu'après upSeconds passées sous
+// lowWater (hystérésis), un cran à la fois. Le niveau est appliqué aux
+// effets par EffectChain::setQualityLevel : chaque effet le borne à ses
+// propres niveaux (densité de la reverb, suréchantillonnage, modèle NAM
+// allégé, longueur d'IR).
+//
+// Chaque changement est déposé dans une file SPSC lue par le thread de
+// contrôle (readEvents), qui le relaie au client.
+class QualityController {
+public:
+    struct Settings {
+        bool enabled = false;
+        double highWater = 0.8;         // Charge déclenchant une dégradation
+        double lowWater = 0.5;          // Charge sous laquelle la qualité remonte
+        uint32_t downBlocks = 3;        // Blocs consécutifs au-dessus de highWater
+        double upSeconds = 2.0;         // Durée sous lowWater avant de remonter d'un cran
+        uint32_t maxLevel = 3;
+    };
+    
+    // Changement de niveau
+    struct Event {
+        uint32_t level;
+        uint32_t previousLevel;
+        double load;                    // Charge du bloc déclencheur
+        uint64_t frame;                 // Position (frames traitées depuis le démarrage)
+    };
+    
+    static constexpr size_t EVENT_QUEUE_CAPACITY = 64;
+    
+    QualityController();
+    
+    // Thread de contrôle (champs publiés un à un, lus sans attente par le
+    // thread audio). Désactiver ramène le niveau à 0 au bloc suivant.
+    void setSettings(const Settings& settings);
+    Settings getSettings() const;
+    
+    // Thread audio : charge du bloc de frameCount frames, renvoie le niveau
+    // à appliquer au bloc suivant
+    uint32_t update(double load, uint32_t frameCount, uint32_t sampleRate);
+    
+    uint32_t getLevel() const { return level_.load(std::memory_order_relaxed); }
+    
+    // Thread de contrôle (consommateur unique) : changements depuis le
+    // dernier appel, dans l'ordre. Renvoie le nombre d'événements lus.
+    size_t readEvents(Event* events, size_t maxCount) { return events_.read(events, maxCount); }
+    
+private:
+    std::atomic<bool> enabled_;
+    std::atomic<double> high_water_;
+    std::atomic<double> low_water_;
+    std::atomic<uint32_t> down_blocks_;
+    std::atomic<double> up_seconds_;
+    std::atomic<uint32_t> max_level_;
+    std::atomic<uint32_t> level_;
+    RingBuffer<Event> events_;
+    
+    // État du thread audio
+    uint32_t blocks_over_;
+    uint64_t frames_under_;
+    uint64_t frames_;
+    
+    void changeLevel(uint32_t level, double load);
+};
+
+} // namespace webamp
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace webamp {
+
+// Durcissement des threads temps réel (thread audio du driver, threads de
+// travail du RTWorkerPool) : priorité SCHED_FIFO, affinité CPU, mémoire
+// verrouillée, pile préchargée et flush-to-zero des dénormaux.
+//
+// Chaque réglage est facultatif et son échec n'est jamais bloquant (droits
+// insuffisants, conteneur, plateforme) : State indique ce qui a réellement
+// été appliqué. Les réglages par thread (priorité, affinité, pile, FTZ)
+// doivent être appliqués depuis le thread concerné.
+class RealtimeThread {
+public:
+    struct Settings {
+        bool enabled = false;               // Opt-in (AudioEngine)
+        int priority = -1;                  // Priorité SCHED_FIFO (-1 : max - 1)
+        bool lockMemory = true;             // mlockall (processus entier)
+        size_t prefaultStackBytes = 256 * 1024;   // 0 : pas de préchargement
+        bool flushDenormals = true;         // FTZ/DAZ (x86), FZ (ARM)
+        bool setAffinity = true;
+        std::vector<int> cpus;              // Vide : cœurs isolés (isolcpus)
+    };
+    
+    // Réglages effectivement appliqués
+    struct State {
+        bool priority = false;
+        bool affinity = false;
+        bool memoryLocked = false;
+        bool stackPrefaulted = false;
+        bool denormalsFlushed = false;
+        int priorityValue = 0;              // Priorité obtenue (peut être bornée par RLIMIT_RTPRIO)
+        int cpu = -1;                       // Cœur assigné (-1 : aucun)
+    };
+    
+    // Thread courant : tous les réglages par thread de settings. threadIndex
+    // choisit le cœur dans la liste (0 : thread audio, 1..n : threads de
+    // travail), en tournant si la liste est plus courte.
+    static State setupCurrentThread(const Settings& settings, size_t threadIndex);
+    
+    // Priorité temps réel. Sur Linux, un refus (EPERM) est retenté à la
+    // priorité maximale permise par RLIMIT_RTPRIO. Renvoie la priorité
+    // obtenue, 0 en cas d'échec.
+    static int setCurrentThreadPriority(int priority = -1);
+    static int setThreadPriority(std::thread& thread, int priority = -1);
+    
+    static bool setCurrentThreadAffinity(int cpu);
+    
+    // Cœurs isolés du noyau (/sys/devices/system/cpu/isolated), vide ailleurs
+    static std::vector<int> getIsolatedCpus();
+    // Liste de cœurs au format du noyau ("2-3,6")
+    static std::vector<int> parseCpuList(const std::string& list);
+    
+    // Processus : verrouille les pages en mémoire (pas de page fault ni de
+    // swap sur le thread audio). unlockMemory() annule le verrouillage.
+    static bool lockMemory();
+    static void unlockMemory();
+    
+    // Touche bytes octets de pile sous l'appelant pour que les pages soient
+    // présentes avant le premier bloc (et verrouillées si lockMemory a pu
+    // activer MCL_FUTURE)
+    static bool prefaultStack(size_t bytes);
+    
+    // Flush-to-zero / denormals-are-zero pour le thread courant
+    static bool disableDenormals();
+    static bool areDenormalsDisabled();
+};
+
+} // namespace webamp
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "aligned_allocator.h"
+#include <cstdint>
+#include <vector>
+
+namespace webamp {
+
+// Conversion de fréquence d'échantillonnage polyphasée, rapport rationnel
+// quelconque (outputRate / inputRate réduit à L / M)
+//
+// Prototype passe-bas unique (sinus cardinal fenêtré par Kaiser, coupure à
+// 0.9 x la plus petite des deux fréquences de Nyquist) découpé en L branches
+// de getTapsPerPhase() coefficients : chaque échantillon de sortie est un
+// seul produit scalaire (AVX2/FMA, NEON ou scalaire). Peu de coefficients
+// par branche = faible latence (temps réel), beaucoup = meilleure
+// atténuation des images (conversion hors ligne).
+//
+// Thread de contrôle : init(). Thread audio : process(), sans allocation.
+class Resampler {
+public:
+    // Coefficients par branche pour le temps réel (~8 échantillons de
+    // latence) et pour la conversion hors ligne (latence compensée)
+    static constexpr uint32_t REALTIME_TAPS = 16;
+    static constexpr uint32_t OFFLINE_TAPS = 64;
+    
+    // Nombre maximal de branches (L après réduction) : couvre toutes les
+    // paires de fréquences audio usuelles (44.1k <-> 48k : L = 147 ou 160)
+    static constexpr uint32_t MAX_PHASES = 4096;
+    
+    Resampler();
+    
+    // taps arrondi au multiple de 8 supérieur. maxInputCount : plus grand
+    // bloc passé à process(). false si le rapport n'est pas représentable.
+    bool init(uint32_t inputRate, uint32_t outputRate, uint32_t maxInputCount, uint32_t taps = REALTIME_TAPS);
+    bool isInitialized() const { return phases_ > 0; }
+    
+    uint32_t getInputRate() const { return input_rate_; }
+    uint32_t getOutputRate() const { return output_rate_; }
+    uint32_t getTapsPerPhase() const { return taps_; }
+    
+    // Retard de groupe en échantillons d'entrée (phase linéaire) :
+    // getTapsPerPhase() / 2
+    double getLatency() const;
+    
+    // Sorties maximales produites par process() pour inputCount entrées
+    uint32_t getMaxOutputCount(uint32_t inputCount) const;
+    
+    // Thread audio : inputCount <= maxInputCount, output dimensionné par
+    // getMaxOutputCount(). Renvoie le nombre d'échantillons produits ; après
+    // N entrées au total, ceil(N * L / M) sorties au total.
+    uint32_t process(const float* input, uint32_t inputCount, float* output);
+    
+    // Remet l'historique à zéro
+    void reset();
+    
+    // Conversion complète d'un signal (hors thread audio) : retard de groupe
+    // retiré, round(count * outputRate / inputRate) échantillons
+    static std::vector<float> resample(const float* input, size_t count, uint32_t inputRate, uint32_t outputRate,
+                                       uint32_t taps = OFFLINE_TAPS);
+
+private:
+    uint32_t input_rate_;
+    uint32_t output_rate_;
+    uint32_t interpolation_;    // L
+    uint32_t decimation_;       // M
+    uint32_t taps_;
+    uint32_t phases_;
+    uint32_t max_input_count_;
+    
+    // Branche p : taps_ coefficients h[j * L + p] * L, dans l'ordre inverse
+    // (produit scalaire direct avec la fenêtre d'entrée)
+    AlignedVector<float> coefs_;
+    // taps_ - 1 échantillons d'historique suivis du bloc courant
+    AlignedVector<float> buffer_;
+    
+    // Position de la prochaine sortie : échantillon d'entrée (relatif au
+    // bloc courant) et branche
+    uint32_t index_;
+    uint32_t phase_;
+};
+
+} // namespace webamp
@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __APPLE__
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#include <cerrno>
+#endif
+
+namespace webamp {
+
+// Sémaphore léger pour réveiller un thread de travail depuis le thread audio.
+// post() ne prend aucun verrou et n'alloue pas (appel système de réveil
+// uniquement) : utilisable dans le callback audio.
+class RTSemaphore {
+public:
+    RTSemaphore() {
+        #ifdef _WIN32
+        handle_ = CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+        #elif __APPLE__
+        handle_ = dispatch_semaphore_create(0);
+        #else
+        sem_init(&handle_, 0, 0);
+        #endif
+    }
+    
+    ~RTSemaphore() {
+        #ifdef _WIN32
+        CloseHandle(handle_);
+        #elif __APPLE__
+        dispatch_release(handle_);
+        #else
+        sem_destroy(&handle_);
+        #endif
+    }
+    
+    RTSemaphore(const RTSemaphore&) = delete;
+    RTSemaphore& operator=(const RTSemaphore&) = delete;
+    
+    // Thread audio
+    void post() {
+        #ifdef _WIN32
+        ReleaseSemaphore(handle_, 1, nullptr);
+        #elif __APPLE__
+        dispatch_semaphore_signal(handle_);
+        #else
+        sem_post(&handle_);
+        #endif
+    }
+    
+    // Thread de travail (bloquant)
+    void wait() {
+        #ifdef _WIN32
+        WaitForSingleObject(handle_, INFINITE);
+        #elif __APPLE__
+        dispatch_semaphore_wait(handle_, DISPATCH_TIME_FOREVER);
+        #else
+        while (sem_wait(&handle_) == -1 && errno == EINTR) {
+        }
+        #endif
+    }
+
+private:
+    #ifdef _WIN32
+    HANDLE handle_;
+    #elif __APPLE__
+    dispatch_semaphore_t handle_;
+    #else
+    sem_t handle_;
+    #endif
+};
+
+} // namespace webamp
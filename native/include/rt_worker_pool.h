@@ -0,0 +1,78 @@
+#pragma once
+
+#include "realtime_thread.h"
+#include "rt_semaphore.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace webamp {
+
+// Pool de threads de travail pour répartir un bloc audio sur plusieurs cœurs.
+//
+// run() est appelé par le thread audio : il distribue des tâches indexées,
+// en exécute lui-même une partie puis attend les autres (barrière par
+// compteurs atomiques). Ni verrou ni allocation ; les threads de travail
+// sont réveillés par sémaphore et tournent en priorité temps réel quand le
+// système l'autorise.
+class RTWorkerPool {
+public:
+    using Task = void (*)(void* context, size_t index);
+    
+    explicit RTWorkerPool(size_t workerCount);
+    ~RTWorkerPool();
+    
+    RTWorkerPool(const RTWorkerPool&) = delete;
+    RTWorkerPool& operator=(const RTWorkerPool&) = delete;
+    
+    // Pool partagé du processus (créé au premier appel, thread de contrôle) :
+    // un thread par cœur disponible hors thread audio, au plus MAX_SHARED_WORKERS
+    static RTWorkerPool& getShared();
+    static constexpr size_t MAX_SHARED_WORKERS = 3;
+    
+    // Thread audio : exécute task(context, i) pour i dans [0, count) et
+    // revient quand toutes les tâches sont terminées. Si le pool est déjà
+    // occupé (appel imbriqué, autre flux), les tâches s'exécutent sur le
+    // thread appelant.
+    void run(Task task, void* context, size_t count);
+    
+    size_t getWorkerCount() const { return workers_.size(); }
+    
+    // Thread de contrôle : chaque thread de travail applique settings depuis
+    // son propre thread, à son prochain réveil. Attend au plus timeoutSeconds
+    // et renvoie l'état cumulé (réglage appliqué sur tous les threads).
+    // Pas d'appels concurrents.
+    RealtimeThread::State configureThreads(const RealtimeThread::Settings& settings, double timeoutSeconds = 1.0);
+    RealtimeThread::State getThreadState() const;
+    
+private:
+    std::vector<std::thread> workers_;
+    RTSemaphore wake_;
+    std::atomic<bool> stop_;
+    
+    // Tâche courante : écrite par run() avant l'ouverture (open_)
+    Task task_;
+    void* context_;
+    size_t count_;
+    
+    std::atomic<bool> busy_;            // run() en cours
+    std::atomic<bool> open_;            // Tâches distribuables
+    std::atomic<size_t> next_;          // Prochain index à prendre
+    std::atomic<size_t> remaining_;     // Tâches non terminées
+    std::atomic<size_t> active_;        // Threads de travail entrés dans la tâche
+    
+    // Durcissement temps réel : settings_ est écrit avant la publication de
+    // settings_generation_ ; thread_states_[i] est écrit par le thread i
+    // avant l'incrément de configured_
+    RealtimeThread::Settings settings_;
+    std::atomic<uint32_t> settings_generation_;
+    std::atomic<size_t> configured_;
+    std::vector<RealtimeThread::State> thread_states_;
+    
+    void workerLoop(size_t index);
+    void executeTasks();
+};
+
+} // namespace webamp
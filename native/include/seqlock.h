@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace webamp {
+
+// Seqlock : un écrivain temps réel (jamais bloqué), plusieurs lecteurs qui
+// réessaient si une écriture est en cours. Les données sont stockées dans des
+// mots atomiques pour éviter toute lecture concurrente non définie.
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requiert un type trivialement copiable");
+
+public:
+    SeqLock() : sequence_(0) {
+        store(T{});
+    }
+    
+    // Écrivain unique (thread audio)
+    void store(const T& value) {
+        uint64_t words[WORD_COUNT] = {};
+        std::memcpy(words, &value, sizeof(T));
+        
+        const uint32_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORD_COUNT; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+    
+    // Lecteurs (threads de contrôle)
+    T load() const {
+        uint64_t words[WORD_COUNT];
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORD_COUNT; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence_.load(std::memory_order_relaxed);
+        } while ((before & 1u) != 0 || before != after);
+        
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    
+    std::atomic<uint32_t> sequence_;
+    std::atomic<uint64_t> words_[WORD_COUNT];
+};
+
+} // namespace webamp
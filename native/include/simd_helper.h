@@ -53,6 +53,9 @@ public:
         size_t count
     );
     
+    // Pic d'un buffer (max |input[i]|), détection de silence
+    static float peak(const float* input, size_t count);
+
 private:
     // Détection des capacités CPU
     static bool hasSSE();
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace webamp {
+
+// Valeur de paramètre lissée (rampe linéaire) pour éviter le zipper noise.
+// Écrite et lue uniquement par le thread audio : aucune synchronisation.
+class SmoothedValue {
+public:
+    explicit SmoothedValue(float initial = 0.0f)
+        : current_(initial), target_(initial), step_(0.0f), steps_remaining_(0) {}
+    
+    // Nouvelle cible atteinte en rampSamples échantillons (0 = immédiat)
+    void setTarget(float target, uint32_t rampSamples) {
+        target_ = target;
+        if (rampSamples == 0 || target_ == current_) {
+            setImmediate(target);
+            return;
+        }
+        steps_remaining_ = rampSamples;
+        step_ = (target_ - current_) / static_cast<float>(rampSamples);
+    }
+    
+    void setImmediate(float value) {
+        current_ = value;
+        target_ = value;
+        step_ = 0.0f;
+        steps_remaining_ = 0;
+    }
+    
+    // Avance d'un échantillon (lissage par échantillon)
+    float getNextValue() {
+        if (steps_remaining_ == 0) {
+            return target_;
+        }
+        if (--steps_remaining_ == 0) {
+            current_ = target_;
+        } else {
+            current_ += step_;
+        }
+        return current_;
+    }
+    
+    // Avance d'un bloc (paramètres recalculés une fois par bloc)
+    void skip(uint32_t samples) {
+        if (samples >= steps_remaining_) {
+            current_ = target_;
+            steps_remaining_ = 0;
+        } else {
+            steps_remaining_ -= samples;
+            current_ += step_ * static_cast<float>(samples);
+        }
+    }
+    
+    bool isSmoothing() const { return steps_remaining_ > 0; }
+    float getCurrentValue() const { return current_; }
+    float getTargetValue() const { return target_; }
+
+private:
+    float current_;
+    float target_;
+    float step_;
+    uint32_t steps_remaining_;
+};
+
+// Paramètre d'effet lissé : la dernière valeur demandée est aussi conservée
+// dans un atomique, seule lecture permise au thread de contrôle
+// (getParameters(), getParameter()) pendant que le thread audio modifie la
+// rampe. Les étages fusionnés copient la partie SmoothedValue seulement.
+class SmoothedParameter : public SmoothedValue {
+public:
+    explicit SmoothedParameter(float initial = 0.0f)
+        : SmoothedValue(initial), requested_(initial) {}
+    
+    void setTarget(float target, uint32_t rampSamples) {
+        requested_.store(target, std::memory_order_relaxed);
+        SmoothedValue::setTarget(target, rampSamples);
+    }
+    
+    void setImmediate(float value) {
+        requested_.store(value, std::memory_order_relaxed);
+        SmoothedValue::setImmediate(value);
+    }
+    
+    // État de rampe recopié d'un étage fusionné (valeur demandée inchangée)
+    SmoothedParameter& operator=(const SmoothedValue& state) {
+        SmoothedValue::operator=(state);
+        return *this;
+    }
+    
+    // Tout thread
+    float getRequestedValue() const { return requested_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> requested_;
+};
+
+} // namespace webamp
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace webamp {
+
+// Publication d'instantanés immuables du thread de contrôle vers le thread audio.
+//
+// - Écrivain (thread de contrôle) : publish() remplace l'instantané courant.
+//   Les anciens instantanés sont retirés puis libérés par collect(), toujours
+//   hors du thread audio.
+// - Lecteur (thread audio, unique) : acquire()/release() sans verrou ni
+//   allocation. Le lecteur annonce l'instantané qu'il utilise (pointeur de
+//   danger) : l'écrivain ne libère jamais cet instantané.
+template<typename T>
+class SnapshotPublisher {
+public:
+    SnapshotPublisher() : current_(nullptr), hazard_(nullptr) {}
+    
+    ~SnapshotPublisher() {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        delete current_.load();
+        for (T* snapshot : retired_) {
+            delete snapshot;
+        }
+        retired_.clear();
+    }
+    
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+    
+    // Thread de contrôle : publier un nouvel instantané
+    void publish(std::unique_ptr<T> snapshot) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        T* previous = current_.exchange(snapshot.release());
+        if (previous) {
+            retired_.push_back(previous);
+        }
+        collectLocked();
+    }
+    
+    // Thread de contrôle : libérer les instantanés qui ne sont plus lus
+    void collect() {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        collectLocked();
+    }
+    
+    size_t getRetiredCount() const {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        return retired_.size();
+    }
+    
+    // Thread audio : obtenir l'instantané courant (nullptr si aucun)
+    // Chaque acquire() doit être suivi d'un release().
+    T* acquire() {
+        T* snapshot = current_.load();
+        for (;;) {
+            hazard_.store(snapshot);
+            T* check = current_.load();
+            if (check == snapshot) {
+                return snapshot;
+            }
+            snapshot = check;
+        }
+    }
+    
+    void release() {
+        hazard_.store(nullptr, std::memory_order_release);
+    }
+    
+    // Portée de lecture RAII pour le thread audio
+    class ReadScope {
+    public:
+        explicit ReadScope(SnapshotPublisher& publisher)
+            : publisher_(publisher), snapshot_(publisher.acquire()) {}
+        ~ReadScope() { publisher_.release(); }
+        
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+        
+        T* get() const { return snapshot_; }
+        T* operator->() const { return snapshot_; }
+        explicit operator bool() const { return snapshot_ != nullptr; }
+    
+    private:
+        SnapshotPublisher& publisher_;
+        T* snapshot_;
+    };
+
+private:
+    // Ordre séquentiel (seq_cst) requis entre hazard_ et current_ :
+    // soit le lecteur voit le nouvel instantané, soit l'écrivain voit le danger.
+    std::atomic<T*> current_;
+    std::atomic<T*> hazard_;
+    
+    std::vector<T*> retired_;
+    mutable std::mutex writer_mutex_;
+    
+    void collectLocked() {
+        T* inUse = hazard_.load();
+        size_t kept = 0;
+        for (T* snapshot : retired_) {
+            if (snapshot == inUse) {
+                retired_[kept++] = snapshot;
+            } else {
+                delete snapshot;
+            }
+        }
+        retired_.resize(kept);
+    }
+};
+
+} // namespace webamp
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace webamp {
+
+// Audio décodé d'un fichier WAV : échantillons float entrelacés
+struct WavAudio {
+    uint32_t sampleRate = 44100;
+    uint32_t channels = 0;
+    std::vector<float> samples;
+    
+    size_t getFrameCount() const { return channels ? samples.size() / channels : 0; }
+    double getDuration() const { return sampleRate ? static_cast<double>(getFrameCount()) / sampleRate : 0.0; }
+};
+
+// Lecture/écriture de fichiers WAV (hors thread audio)
+//
+// Lecture : PCM 8/16/24/32 bits et float 32/64 bits, y compris
+// WAVE_FORMAT_EXTENSIBLE ; les chunks inconnus (LIST, bext...) sont ignorés.
+// Écriture : PCM 16/24 bits ou float 32 bits.
+class WavFile {
+public:
+    static bool read(const std::string& filePath, WavAudio& audio);
+    static bool parse(const void* data, size_t size, WavAudio& audio);
+    
+    // bitsPerSample : 16, 24 (PCM, écrêté à +-1) ou 32 (float)
+    static bool write(const std::string& filePath, const WavAudio& audio, uint16_t bitsPerSample = 24);
+    static std::vector<uint8_t> encode(const WavAudio& audio, uint16_t bitsPerSample = 24);
+};
+
+} // namespace webamp
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "audio_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace webamp {
+
+// Courbes de saturation des pédales avec anti-repliement par primitives
+// (ADAA, antiderivative anti-aliasing) : la sortie est la moyenne de la
+// courbe sur le segment entre deux échantillons (ordre 1) ou sur un noyau
+// triangulaire de trois échantillons (ordre 2), calculée à partir des
+// primitives F1 et F2 de la courbe. Beaucoup moins cher qu'un
+// suréchantillonnage ; combinable avec Oversampler.
+//
+// Les primitives sont analytiques (écrêtage dur, fuzz) ou tabulées au
+// premier usage (F2 de tanh). Calcul en double, par tranches, sans
+// dépendance entre échantillons dans les boucles (vectorisables).
+class Waveshaper {
+public:
+    enum class Curve : uint32_t {
+        HardClip = 0,   // clamp(x, -1, 1) (DistortionEffect)
+        Tanh,           // tanh(2x) / 2 (OverdriveEffect)
+        Fuzz            // u (1 - 0.3 |u|), u = clamp(x, -1, 1) (FuzzEffect)
+    };
+    
+    enum class Mode : uint32_t {
+        Naive = 0,      // Courbe appliquée directement
+        ADAA1,          // Latence 0.5 échantillon
+        ADAA2           // Latence 1 échantillon
+    };
+    
+    static constexpr uint32_t MAX_CHANNELS = AudioBuffer::MAX_CHANNELS;
+    
+    explicit Waveshaper(Curve curve);
+    
+    Curve getCurve() const { return curve_; }
+    
+    // Sans allocation ni verrou : appliqué au bloc suivant de chaque canal
+    void setMode(Mode mode) { requested_mode_.store(mode, std::memory_order_relaxed); }
+    Mode getMode() const { return requested_mode_.load(std::memory_order_relaxed); }
+    
+    // Latence en échantillons au taux où process() est appelé
+    float getLatency() const { return getLatency(getMode()); }
+    static float getLatency(Mode mode);
+    
+    // Thread audio : in-place, état propre à chaque canal
+    void process(uint32_t channel, float* samples, uint32_t count);
+    void reset();
+    
+    // Courbe et primitives (F1' = courbe, F2' = F1, F2(0) = 0)
+    static double apply(Curve curve, double x);
+    static double antiderivative1(Curve curve, double x);
+    static double antiderivative2(Curve curve, double x);
+    
+    // Courbe en simple précision, sans état (mode Naive, boucles fusionnées)
+    template<Curve C>
+    static float applyNaive(float x);
+
+private:
+    struct ChannelState {
+        Mode mode = Mode::Naive;
+        bool primed = false;
+        double x1 = 0.0;   // x[n-1]
+        double x2 = 0.0;   // x[n-2]
+        double f1 = 0.0;   // F1(x[n-1]) (ordre 1) ou F2(x[n-1]) (ordre 2)
+        double d1 = 0.0;   // Différence divisée de F2 entre x[n-2] et x[n-1]
+    };
+    
+    Curve curve_;
+    std::atomic<Mode> requested_mode_;
+    ChannelState state_[MAX_CHANNELS];
+    
+    template<typename Shape>
+    static void processNaive(float* samples, uint32_t count);
+    template<typename Shape>
+    static void processADAA1(ChannelState& state, float* samples, uint32_t count);
+    template<typename Shape>
+    static void processADAA2(ChannelState& state, float* samples, uint32_t count);
+    template<typename Shape>
+    void dispatch(ChannelState& state, float* samples, uint32_t count);
+};
+
+template<Waveshaper::Curve C>
+inline float Waveshaper::applyNaive(float x) {
+    if constexpr (C == Curve::HardClip) {
+        return std::max(-1.0f, std::min(1.0f, x));
+    } else if constexpr (C == Curve::Tanh) {
+        return tanhf(x * 2.0f) * 0.5f;
+    } else {
+        x = std::max(-1.0f, std::min(1.0f, x));
+        return x * (1.0f - 0.3f * std::fabs(x));
+    }
+}
+
+} // namespace webamp
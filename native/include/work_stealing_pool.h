@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace webamp {
+
+// Pool de threads à vol de tâches pour les traitements hors ligne (rendu
+// par lots) : pas de contrainte temps réel, contrairement à RTWorkerPool.
+//
+// Chaque thread possède sa file : il prend ses propres tâches par la fin
+// (les plus récentes, encore en cache) et, quand elle est vide, vole les
+// plus anciennes des autres files par le début. Les tâches soumises depuis
+// un thread du pool vont dans sa propre file, les autres sont réparties en
+// tourniquet. Une tâche ne doit pas lever d'exception.
+class WorkStealingPool {
+public:
+    using Job = std::function<void()>;
+    
+    // threadCount = 0 : un thread par cœur
+    explicit WorkStealingPool(size_t threadCount = 0);
+    ~WorkStealingPool();  // Termine les tâches en attente
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    void submit(Job job);
+    
+    // Attend que toutes les tâches soumises (y compris celles soumises par
+    // des tâches) soient terminées. Ne pas appeler depuis une tâche.
+    void wait();
+    
+    size_t getThreadCount() const { return threads_.size(); }
+    uint64_t getStealCount() const { return steals_.load(std::memory_order_relaxed); }
+    
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+    
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    
+    std::mutex mutex_;                  // Protège l'attente (wake_, done_)
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::atomic<size_t> queued_;        // Tâches en file, non prises
+    std::atomic<size_t> pending_;       // Tâches non terminées
+    std::atomic<size_t> next_queue_;
+    std::atomic<uint64_t> steals_;
+    bool stop_;
+    
+    bool popLocal(size_t index, Job& job);
+    bool steal(size_t index, Job& job);
+    void workerLoop(size_t index);
+};
+
+} // namespace webamp
@@ -1,8 +1,16 @@
 #include "audio_engine.h"
+#include "null_driver.h"
+#include "rt_worker_pool.h"
+#ifdef _WIN32
 #include "wasapi_driver.h"
 #include "asio_driver.h"
+#endif
+#ifdef __APPLE__
 #include "coreaudio_driver.h"
+#endif
+#ifdef WEBAMP_HAS_PIPEWIRE
 #include "pipewire_driver.h"
+#endif
 #include <algorithm>
 #include <chrono>
 #include <iostream>
@@ -15,6 +23,9 @@ AudioEngine::AudioEngine()
     , initialized_(false)
     , sample_rate_(48000)
     , buffer_size_(64)  // Optimisé pour latence < 5ms (64 samples @ 48kHz = 1.33ms)
+    , audio_thread_setup_pending_(false)
+    , audio_thread_ready_(false)
+    , memory_locked_(false)
 {
     pipeline_ = std::make_shared<DSPPipeline>();
 }
@@ -53,7 +64,7 @@ bool AudioEngine::initialize(const std::string& driverName) {
             return false;
         }
         current_driver_name_ = "CoreAudio";
-        #elif __linux__
+        #elif defined(__linux__) && defined(WEBAMP_HAS_PIPEWIRE)
         // Linux: PipeWire puis ALSA (fallback)
         driver_ = std::make_unique<PipeWireDriver>();
         if (!driver_->initialize(sample_rate_, buffer_size_)) {
@@ -62,12 +73,21 @@ bool AudioEngine::initialize(const std::string& driverName) {
             return false;
         }
         current_driver_name_ = "PipeWire";
+        #elif __linux__
+        std::cerr << "Erreur: compilé sans PipeWire, aucun driver audio (driver \"null\" disponible)\n";
+        return false;
         #else
         std::cerr << "Plateforme non supportée\n";
         return false;
         #endif
     } else {
-        if (driverName == "WASAPI") {
+        if (driverName == "null") {
+            // Sans matériel : horloge simulée, entrée silencieuse
+            driver_ = std::make_unique<NullDriver>();
+        } else if (driverName.rfind("file:", 0) == 0) {
+            // Entrée lue depuis un fichier WAV ("file:<chemin>")
+            driver_ = std::make_unique<FileDriver>(driverName.substr(5));
+        } else if (driverName == "WASAPI") {
             #ifdef _WIN32
             driver_ = std::make_unique<WASAPIDriver>();
             #else
@@ -89,10 +109,10 @@ bool AudioEngine::initialize(const std::string& driverName) {
             return false;
             #endif
         } else if (driverName == "PipeWire") {
-            #ifdef __linux__
+            #ifdef WEBAMP_HAS_PIPEWIRE
             driver_ = std::make_unique<PipeWireDriver>();
             #else
-            std::cerr << "PipeWire uniquement disponible sur Linux\n";
+            std::cerr << "PipeWire uniquement disponible sur Linux (libpipewire)\n";
             return false;
             #endif
         } else {
@@ -154,7 +174,24 @@ bool AudioEngine::start() {
         return true;
     }
     
+    // Durcissement avant le premier bloc : pages verrouillées (processus),
+    // threads de travail, puis thread audio au premier callback
+    audio_thread_ready_.store(false, std::memory_order_release);
+    worker_threads_state_ = RealtimeThread::State{};
+    if (realtime_settings_.enabled) {
+        if (realtime_settings_.lockMemory && !memory_locked_) {
+            memory_locked_ = RealtimeThread::lockMemory();
+        }
+        worker_threads_state_ = RTWorkerPool::getShared().configureThreads(realtime_settings_);
+        worker_threads_state_.memoryLocked = memory_locked_;
+        audio_thread_setup_pending_.store(true, std::memory_order_release);
+    }
+    
+    // Changements de paramètres confiés au thread audio avant son premier bloc
+    pipeline_->setAudioThreadActive(true);
     if (!driver_->start()) {
+        audio_thread_setup_pending_.store(false);
+        pipeline_->setAudioThreadActive(false);
         return false;
     }
     
@@ -170,12 +207,35 @@ bool AudioEngine::stop() {
     if (!driver_->stop()) {
         return false;
     }
+    pipeline_->setAudioThreadActive(false);
+    
+    if (memory_locked_) {
+        RealtimeThread::unlockMemory();
+        memory_locked_ = false;
+    }
     
     running_ = false;
     return true;
 }
 
+bool AudioEngine::setRealtimeSettings(const RealtimeThread::Settings& settings) {
+    if (running_) {
+        return false;
+    }
+    realtime_settings_ = settings;
+    return true;
+}
+
 void AudioEngine::audioCallback(float* input, float* output, uint32_t frameCount, double sampleRate) {
+    // Premier callback après start() : réglages du thread audio, appliqués
+    // depuis ce thread (le driver le crée lui-même)
+    if (audio_thread_setup_pending_.load(std::memory_order_relaxed) &&
+        audio_thread_setup_pending_.exchange(false, std::memory_order_acquire)) {
+        audio_thread_state_ = RealtimeThread::setupCurrentThread(realtime_settings_, 0);
+        audio_thread_state_.memoryLocked = memory_locked_;
+        audio_thread_ready_.store(true, std::memory_order_release);
+    }
+    
     // Traitement dans le pipeline DSP
     pipeline_->process(input, output, frameCount);
 }
@@ -184,14 +244,25 @@ double AudioEngine::getTotalLatency() const {
     if (!driver_) {
         return 0.0;
     }
-    return driver_->getInputLatency() + driver_->getOutputLatency();
+    // Buffers du driver + latence rapportée par les effets (dernier bloc)
+    const double processing = pipeline_ ? pipeline_->getStats().processingLatency / 1000.0 : 0.0;
+    return driver_->getInputLatency() + driver_->getOutputLatency() + processing;
 }
 
 DSPPipeline::Stats AudioEngine::getStats() const {
+    DSPPipeline::Stats stats;
     if (pipeline_) {
-        return pipeline_->getStats();
+        stats = pipeline_->getStats();
+    }
+    if (audio_thread_ready_.load(std::memory_order_acquire)) {
+        stats.audioThread = audio_thread_state_;
+    }
+    stats.workerThreads = worker_threads_state_;
+    // Latence de bout en bout : le pipeline ne connaît que la taille de bloc
+    if (driver_) {
+        stats.latency = (driver_->getInputLatency() + driver_->getOutputLatency()) * 1000.0 + stats.processingLatency;
     }
-    return DSPPipeline::Stats{};
+    return stats;
 }
 
 std::vector<std::string> AudioEngine::getAvailableDrivers() const {
@@ -201,6 +272,7 @@ std::vector<std::string> AudioEngine::getAvailableDrivers() const {
     auto asioDrivers = ASIODriver::getAvailableDrivers();
     drivers.insert(drivers.end(), asioDrivers.begin(), asioDrivers.end());
     #endif
+    drivers.push_back("null");
     return drivers;
 }
 
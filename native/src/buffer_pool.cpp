@@ -3,47 +3,73 @@
 
 namespace webamp {
 
+namespace {
+
+constexpr uint64_t INDEX_MASK = 0xFFFFFFFFull;
+
+uint64_t makeHead(uint64_t tag, uint32_t top) {
+    return (tag << 32) | top;
+}
+
+} // namespace
+
 BufferPool::BufferPool(size_t bufferSize, size_t poolSize)
     : buffer_size_(bufferSize)
+    , stride_(0)
+    , capacity_(std::min<size_t>(poolSize, INDEX_MASK - 1))
+    , head_(0)
+    , used_(0)
+    , exhausted_(0)
+    , invalid_releases_(0)
 {
-    initializePool(poolSize);
+    // Chaque bloc commence sur une ligne de cache
+    const size_t floatsPerLine = ALIGNMENT / sizeof(float);
+    stride_ = std::max<size_t>(1, (buffer_size_ + floatsPerLine - 1) / floatsPerLine) * floatsPerLine;
+    storage_.assign(stride_ * capacity_, 0.0f);
+    
+    next_ = std::make_unique<std::atomic<uint32_t>[]>(capacity_);
+    dirty_ = std::make_unique<bool[]>(capacity_);
+    borrowed_ = std::make_unique<std::atomic<bool>[]>(capacity_);
+    
+    // Pile initiale : le bloc 0 au sommet
+    for (size_t i = 0; i < capacity_; ++i) {
+        next_[i].store(i + 1 < capacity_ ? static_cast<uint32_t>(i + 2) : 0, std::memory_order_relaxed);
+        dirty_[i] = false;
+        borrowed_[i].store(false, std::memory_order_relaxed);
+    }
+    head_.store(makeHead(0, capacity_ > 0 ? 1 : 0), std::memory_order_release);
 }
 
 BufferPool::~BufferPool() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    buffers_.clear();
-    while (!available_buffers_.empty()) {
-        available_buffers_.pop();
-    }
 }
 
-void BufferPool::initializePool(size_t poolSize) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    buffers_.reserve(poolSize);
-    for (size_t i = 0; i < poolSize; ++i) {
-        auto buffer = std::make_unique<float[]>(buffer_size_);
-        std::fill(buffer.get(), buffer.get() + buffer_size_, 0.0f);
-        float* rawPtr = buffer.get();
-        buffers_.push_back(std::move(buffer));
-        available_buffers_.push(rawPtr);
+float* BufferPool::acquire(bool zeroed) {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint32_t top;
+    for (;;) {
+        top = static_cast<uint32_t>(head & INDEX_MASK);
+        if (top == 0) {
+            exhausted_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        // next_ peut avoir été réécrit si le bloc a été pris entre-temps :
+        // le compteur de head fait alors échouer l'échange
+        const uint32_t next = next_[top - 1].load(std::memory_order_relaxed);
+        if (head_.compare_exchange_weak(head, makeHead((head >> 32) + 1, next),
+                                        std::memory_order_acquire, std::memory_order_acquire)) {
+            break;
+        }
     }
-}
-
-float* BufferPool::acquire() {
-    std::lock_guard<std::mutex> lock(mutex_);
     
-    if (available_buffers_.empty()) {
-        // Créer un nouveau buffer si le pool est vide
-        auto buffer = std::make_unique<float[]>(buffer_size_);
-        std::fill(buffer.get(), buffer.get() + buffer_size_, 0.0f);
-        float* rawPtr = buffer.get();
-        buffers_.push_back(std::move(buffer));
-        return rawPtr;
+    used_.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t index = top - 1;
+    float* buffer = storage_.data() + index * stride_;
+    if (zeroed && dirty_[index]) {
+        std::fill(buffer, buffer + buffer_size_, 0.0f);
     }
-    
-    float* buffer = available_buffers_.front();
-    available_buffers_.pop();
+    // Considéré comme modifié dès qu'il est emprunté
+    dirty_[index] = true;
+    borrowed_[index].store(true, std::memory_order_release);
     return buffer;
 }
 
@@ -52,33 +78,40 @@ void BufferPool::release(float* buffer) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Vérifier que le buffer appartient à ce pool
-    bool found = false;
-    for (const auto& ownedBuffer : buffers_) {
-        if (ownedBuffer.get() == buffer) {
-            found = true;
-            break;
-        }
+    // Vérifier que le buffer appartient à ce pool (début de bloc)
+    const float* base = storage_.data();
+    if (capacity_ == 0 || buffer < base || buffer >= base + stride_ * capacity_ ||
+        static_cast<size_t>(buffer - base) % stride_ != 0) {
+        invalid_releases_.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
     
-    if (found) {
-        // Réinitialiser le buffer
-        std::fill(buffer, buffer + buffer_size_, 0.0f);
-        available_buffers_.push(buffer);
+    // Double rendu ou bloc jamais emprunté : l'empiler à nouveau le
+    // donnerait à deux acquire()
+    const uint32_t index = static_cast<uint32_t>(static_cast<size_t>(buffer - base) / stride_);
+    if (!borrowed_[index].exchange(false, std::memory_order_acq_rel)) {
+        invalid_releases_.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
+    
+    push(index);
+    used_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void BufferPool::push(uint32_t index) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    do {
+        next_[index].store(static_cast<uint32_t>(head & INDEX_MASK), std::memory_order_relaxed);
+    } while (!head_.compare_exchange_weak(head, makeHead((head >> 32) + 1, index + 1),
+                                          std::memory_order_release, std::memory_order_relaxed));
 }
 
 size_t BufferPool::getAvailableCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return available_buffers_.size();
+    return capacity_ - getUsedCount();
 }
 
 size_t BufferPool::getUsedCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return buffers_.size() - available_buffers_.size();
+    return std::min(used_.load(std::memory_order_relaxed), capacity_);
 }
 
 } // namespace webamp
-
@@ -0,0 +1,71 @@
+#include "../include/compensation_delay.h"
+#include <algorithm>
+
+namespace webamp {
+
+BufferPool& CompensationDelay::getSharedPool() {
+    static BufferPool pool(MAX_DELAY, SHARED_POOL_LINES);
+    return pool;
+}
+
+CompensationDelay::CompensationDelay(BufferPool* pool)
+    : pool_(pool ? pool : &getSharedPool())
+    , delay_(0)
+    , write_position_(0)
+    , failures_(0)
+{
+}
+
+bool CompensationDelay::reserve() {
+    if (isReserved()) {
+        return true;
+    }
+    // Lignes à zéro : le début du retard est silencieux
+    for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+        lines_[ch] = pool_->borrow(true);
+        if (!lines_[ch]) {
+            release();
+            return false;
+        }
+    }
+    write_position_ = 0;
+    return true;
+}
+
+void CompensationDelay::release() {
+    for (auto& line : lines_) {
+        line.reset();
+    }
+    delay_ = 0;
+}
+
+bool CompensationDelay::process(const float* const* input, float* const* output, uint32_t channels,
+                                uint32_t frameCount, uint32_t delay) {
+    delay = std::min(delay, MAX_DELAY - 1);
+    channels = std::min(channels, MAX_CHANNELS);
+    
+    if (!isReserved()) {
+        AudioBuffer::copy(input, output, channels, frameCount);
+        if (delay > 0) {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+    
+    delay_ = delay;
+    constexpr uint32_t MASK = MAX_DELAY - 1;
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+        float* line = lines_[ch].get();
+        uint32_t position = write_position_;
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            line[position] = input[ch][i];
+            output[ch][i] = line[(position - delay_) & MASK];
+            position = (position + 1) & MASK;
+        }
+    }
+    write_position_ = (write_position_ + frameCount) & MASK;
+    return true;
+}
+
+} // namespace webamp
@@ -0,0 +1,130 @@
+#include "../include/dsp_arena.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace webamp {
+
+DSPArena::DSPArena(size_t size, bool hugePages)
+    : data_(nullptr)
+    , size_(alignSize(size))
+    , reserved_(0)
+    , backing_(Backing::Heap)
+    , huge_pages_(false)
+{
+    if (size_ == 0) {
+        return;
+    }
+    
+    // Pages de 2 Mo seulement si le bloc en occupe au moins une
+    if (hugePages && size_ >= HUGE_PAGE_SIZE) {
+        #if defined(_WIN32)
+        const SIZE_T largePage = GetLargePageMinimum();
+        if (largePage > 0) {
+            const size_t reserved = (size_ + largePage - 1) / largePage * largePage;
+            void* memory = VirtualAlloc(nullptr, reserved, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (memory) {
+                data_ = static_cast<unsigned char*>(memory);
+                reserved_ = reserved;
+                backing_ = Backing::LargePages;
+                huge_pages_ = true;
+            }
+        }
+        #elif defined(__linux__)
+        const size_t reserved = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        // hugetlbfs (pages réservées par l'administrateur), puis mapping
+        // ordinaire proposé aux transparent huge pages
+        void* memory = mmap(nullptr, reserved, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            huge_pages_ = true;
+        } else {
+            memory = mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED) {
+                huge_pages_ = madvise(memory, reserved, MADV_HUGEPAGE) == 0;
+            }
+        }
+        if (memory != MAP_FAILED) {
+            // Pages anonymes : déjà à zéro
+            data_ = static_cast<unsigned char*>(memory);
+            reserved_ = reserved;
+            backing_ = Backing::Mapped;
+        }
+        #endif
+    }
+    
+    if (!data_) {
+        data_ = static_cast<unsigned char*>(::operator new(size_, std::align_val_t(ALIGNMENT)));
+        std::memset(data_, 0, size_);
+        reserved_ = size_;
+        backing_ = Backing::Heap;
+    }
+}
+
+DSPArena::~DSPArena() {
+    if (!data_) {
+        return;
+    }
+    switch (backing_) {
+        case Backing::Heap:
+            ::operator delete(data_, std::align_val_t(ALIGNMENT));
+            break;
+        case Backing::Mapped:
+            #ifndef _WIN32
+            munmap(data_, reserved_);
+            #endif
+            break;
+        case Backing::LargePages:
+            #ifdef _WIN32
+            VirtualFree(data_, 0, MEM_RELEASE);
+            #endif
+            break;
+    }
+}
+
+EffectMemory::EffectMemory()
+    : pending_(nullptr)
+    , bound_(nullptr)
+{
+}
+
+EffectMemory::~EffectMemory() = default;
+
+void EffectMemory::assign(std::shared_ptr<DSPArena> arena, unsigned char* data, size_t size, uint32_t sampleRate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto block = std::make_unique<Block>();
+    block->arena = std::move(arena);
+    block->data = data;
+    block->size = size;
+    block->sampleRate = sampleRate;
+    
+    // Une zone encore en attente n'a jamais été vue par le thread audio
+    Block* previous = pending_.exchange(block.get(), std::memory_order_acq_rel);
+    blocks_.push_back(std::move(block));
+    if (previous) {
+        blocks_.erase(std::find_if(blocks_.begin(), blocks_.end(),
+                                   [previous](const std::unique_ptr<Block>& b) { return b.get() == previous; }));
+    }
+    
+    // Les zones antérieures à celle en service ne seront plus lues
+    const Block* bound = bound_.load(std::memory_order_acquire);
+    auto it = std::find_if(blocks_.begin(), blocks_.end(),
+                           [bound](const std::unique_ptr<Block>& b) { return b.get() == bound; });
+    if (it != blocks_.end()) {
+        blocks_.erase(blocks_.begin(), it);
+    }
+}
+
+const unsigned char* EffectMemory::getAssigned() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_.empty() ? nullptr : blocks_.back()->data;
+}
+
+} // namespace webamp
@@ -1,25 +1,34 @@
 #include "dsp_pipeline.h"
-#include "buffer_pool.h"
 #include "../include/simd_helper.h"
 #include <algorithm>
 #include <cmath>
-#include <chrono>
 #include <iostream>
 #include <memory>
 
 namespace webamp {
 
+const char* const DSPPipeline::STAGE_INPUT = "input";
+const char* const DSPPipeline::STAGE_NAM = "nam";
+const char* const DSPPipeline::STAGE_OUTPUT = "output";
+
 DSPPipeline::DSPPipeline()
-    : input_gain_(0.0f)
+    : audio_thread_active_(false)
+    , input_gain_(0.0f)
     , output_gain_(0.0f)
+    , mono_input_(false)
+    , reset_stats_requested_(false)
     , sample_rate_(48000)  // Support jusqu'à 192kHz
     , buffer_size_(64)      // Optimisé pour latence < 5ms
     , nam_model_active_(false)
+    , nam_effect_(std::make_shared<NAMEffect>())
+    , processing_latency_(0)
 {
     stats_ = Stats{};
-    // Initialiser le pool de buffers (taille pour stéréo)
-    buffer_pool_ = std::make_unique<BufferPool>(buffer_size_ * 2, 4);
+    work_buffer_ = std::make_shared<AudioBuffer>(2, buffer_size_); // Stéréo planaire
     nam_loader_ = std::make_unique<NAMLoader>();
+    nam_effect_->setSampleRate(sample_rate_);
+    nam_effect_->setMaxBlockSize(buffer_size_);
+    publishStateLocked();
 }
 
 DSPPipeline::~DSPPipeline() {
@@ -27,24 +36,29 @@ DSPPipeline::~DSPPipeline() {
 }
 
 bool DSPPipeline::initialize(uint32_t sampleRate, uint32_t bufferSize) {
-    sample_rate_ = sampleRate;
-    buffer_size_ = bufferSize;
-    
-    // Allocation du buffer de travail (taille maximale)
-    work_buffer_.resize(buffer_size_ * 2); // Stéréo
-    
-    // Réinitialiser le pool de buffers avec la nouvelle taille
-    buffer_pool_ = std::make_unique<BufferPool>(buffer_size_ * 2, 4);
-    
     // Initialisation du générateur de signal de test
     test_tone_generator_.setSampleRate(sampleRate);
     test_tone_generator_.setFrequency(440.0f);  // La4
     test_tone_generator_.setAmplitude(0.3f);    // 30%
     test_tone_generator_.setEnabled(false);
     
-    // Initialisation de la chaîne d'effets si elle existe
-    if (effect_chain_) {
-        // Les effets seront initialisés individuellement
+    {
+        std::lock_guard<std::mutex> lock(chain_mutex_);
+        sample_rate_ = sampleRate;
+        buffer_size_ = bufferSize;
+        
+        // Nouveau buffer de travail (taille maximale), publié avec l'état :
+        // le thread audio garde l'ancien jusqu'à la fin de son bloc
+        work_buffer_ = std::make_shared<AudioBuffer>(2, bufferSize); // Stéréo planaire
+        
+        // Initialisation de la chaîne d'effets si elle existe
+        if (effect_chain_) {
+            // Les effets seront initialisés individuellement
+            effect_chain_->prepare(bufferSize);
+        }
+        nam_effect_->setSampleRate(sampleRate);
+        nam_effect_->setMaxBlockSize(bufferSize);
+        publishStateLocked();
     }
     
     resetStats();
@@ -53,9 +67,26 @@ bool DSPPipeline::initialize(uint32_t sampleRate, uint32_t bufferSize) {
 
 void DSPPipeline::shutdown() {
     std::lock_guard<std::mutex> lock(chain_mutex_);
+    if (effect_chain_) {
+        effect_chain_->setProfiler(nullptr);
+    }
     effect_chain_.reset();
-    work_buffer_.clear();
-    buffer_pool_.reset();
+    // Sans buffer de travail, process() ne traite plus rien ; l'ancien est
+    // libéré avec le dernier instantané qui le référence
+    work_buffer_.reset();
+    publishStateLocked();
+}
+
+void DSPPipeline::publishStateLocked() {
+    auto state = std::make_unique<ProcessingState>();
+    state->chain = effect_chain_;
+    if (nam_model_active_ && nam_model_ && nam_model_->isValid()) {
+        state->nam = nam_effect_;
+    }
+    state->work = work_buffer_;
+    state->sampleRate = sample_rate_;
+    state->bufferSize = buffer_size_;
+    state_publisher_.publish(std::move(state));
 }
 
 void DSPPipeline::process(float* input, float* output, uint32_t frameCount) {
@@ -63,46 +94,157 @@ void DSPPipeline::process(float* input, float* output, uint32_t frameCount) {
         return;
     }
     
-    auto startTime = std::chrono::high_resolution_clock::now();
+    // Instantané chaîne + NAM + buffer de travail, sans verrou, conservé
+    // jusqu'à la fin du bloc
+    SnapshotPublisher<ProcessingState>::ReadScope state(state_publisher_);
+    if (!state || !state->work) {
+        return;
+    }
+    
+    const uint64_t startTime = DSPProfiler::now();
+    const bool profiling = profiler_.isEnabled();
+    const uint32_t sampleRate = state->sampleRate;
+    
+    if (reset_stats_requested_.exchange(false, std::memory_order_acq_rel)) {
+        stats_ = Stats{};
+    }
+    
+    // Niveau de qualité décidé à la fin du bloc précédent : chaîne et ampli
+    // NAM (modèle allégé au niveau 1 s'il est chargé)
+    const uint32_t qualityLevel = quality_controller_.getLevel();
+    if (state->chain) {
+        state->chain->setQualityLevel(qualityLevel);
+    }
+    if (state->nam) {
+        state->nam->setQualityTier(qualityLevel);
+    }
+    // Latence du bloc précédent (celle de la chaîne est mise à jour à
+    // chaque début de bloc, après ses changements de paramètres)
+    processing_latency_ = state->nam ? state->nam->getLatency() : 0;
+    if (state->chain) {
+        processing_latency_ += state->chain->getLatency();
+    }
+    
+    // Le buffer de travail est dimensionné à l'initialisation : traiter par
+    // sous-blocs si le driver livre plus de frames que prévu
+    const uint32_t maxChunk = state->work->getFrameCapacity();
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        uint32_t chunk = std::min(frameCount - offset, maxChunk);
+        processBlock(*state.get(), input + offset * 2, output + offset * 2, chunk, profiling);
+        offset += chunk;
+    }
+    
+    // Mise à jour des stats
+    updateStats(*state.get(), input, output, frameCount);
+    
+    // Calcul CPU (optimisé avec moyenne glissante pour stabilité)
+    const uint64_t elapsedNs = DSPProfiler::now() - startTime;
+    double cpuTime = (elapsedNs / 1e6) / (frameCount / (double)sampleRate * 1000.0);
+    profiler_.endBlock(elapsedNs, frameCount, sampleRate);
+    
+    // Dégradation adaptative : charge brute du bloc (sans lissage, pour
+    // réagir avant le dépassement d'échéance)
+    stats_.qualityLevel = quality_controller_.update(cpuTime, frameCount, sampleRate);
+    
+    // Moyenne glissante pour lisser les variations (facteur 0.9)
+    stats_.cpuUsage = stats_.cpuUsage * 0.9 + (cpuTime * 100.0) * 0.1;
+    stats_.samplesProcessed += frameCount;
+    published_stats_.store(stats_);
+}
+
+void DSPPipeline::processBlock(const ProcessingState& state, float* input, float* output, uint32_t frameCount, bool profiling) {
+    uint64_t stageStart = profiling ? DSPProfiler::now() : 0;
+    AudioBuffer& work = *state.work;
+    float* left = work.getChannel(0);
+    float* right = work.getChannel(1);
+    const float inputGainLinear = dbToLinear(input_gain_.load());
+    const bool mono = mono_input_.load(std::memory_order_relaxed);
+    const bool testTone = test_tone_generator_.isEnabled();
     
     // Générer un signal de test si activé, sinon utiliser l'entrée
-    if (test_tone_generator_.isEnabled()) {
-        // Générer le signal de test dans le buffer de travail
-        test_tone_generator_.generate(work_buffer_.data(), frameCount, 2);
-        
-        // Application du gain d'entrée sur le signal généré
-        float inputGainLinear = dbToLinear(input_gain_.load());
-        for (uint32_t i = 0; i < frameCount * 2; ++i) {
-            work_buffer_[i] *= inputGainLinear;
+    if (testTone) {
+        // Signal de test mono généré sur le canal gauche
+        test_tone_generator_.generate(left, frameCount, 1);
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            left[i] *= inputGainLinear;
+        }
+    } else if (mono) {
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            left[i] = input[i * 2] * inputGainLinear;
         }
     } else {
-        // Application du gain d'entrée sur l'entrée réelle (optimisé avec SIMD si disponible)
-        float inputGainLinear = dbToLinear(input_gain_.load());
-        if (SIMDHelper::isAvailable()) {
-            SIMDHelper::multiplyScalar(input, inputGainLinear, work_buffer_.data(), frameCount * 2);
-        } else {
-            for (uint32_t i = 0; i < frameCount * 2; ++i) { // Stéréo
-                work_buffer_[i] = input[i] * inputGainLinear;
-            }
+        // Désentrelacement unique de l'entrée, gain d'entrée appliqué au passage
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            left[i] = input[i * 2] * inputGainLinear;
+            right[i] = input[i * 2 + 1] * inputGainLinear;
         }
     }
     
-    // Traitement par la chaîne d'effets
-    {
-        std::lock_guard<std::mutex> lock(chain_mutex_);
-        if (effect_chain_) {
-            effect_chain_->process(work_buffer_.data(), output, frameCount);
+    // Canaux valides dans le buffer de travail (signal de test et entrée
+    // mono : le gauche seulement)
+    uint32_t channels = (mono || testTone) ? 1 : 2;
+    
+    if (profiling) {
+        const uint64_t now = DSPProfiler::now();
+        profiler_.recordStage(0, STAGE_INPUT, now - stageStart);
+        stageStart = now;
+    }
+    
+    // Traitement par la chaîne d'effets (planaire, en place, mesurée par effet).
+    // Signal mono : la chaîne n'élargit qu'à son premier effet stéréo.
+    if (state.chain) {
+        if (channels == 1) {
+            channels = state.chain->processMono(left, work.getWritePointers(), frameCount);
         } else {
-            // Pas d'effets : copie directe
-            std::copy(work_buffer_.begin(), work_buffer_.begin() + frameCount * 2, output);
+            state.chain->process(work.getReadPointers(), work.getWritePointers(), 2, frameCount);
         }
     }
     
     // Appliquer le modèle NAM si actif (après les effets)
-    if (nam_model_active_ && nam_model_ && nam_model_->isValid()) {
-        nam_model_->processAudio(output, output, frameCount, sample_rate_);
+    // Le modèle est mono : NAMEffect traite la moyenne des canaux valides
+    // (effets stéréo de la chaîne inclus) et recopie sa sortie sur chacun.
+    // Veille sur entrée silencieuse comme dans EffectChain.
+    if (state.nam) {
+        if (profiling) {
+            stageStart = DSPProfiler::now();
+        }
+        NAMEffect& nam = *state.nam;
+        float* const* buffers = work.getWritePointers();
+        const auto peak = [&] {
+            float value = 0.0f;
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                value = std::max(value, SIMDHelper::peak(buffers[ch], frameCount));
+            }
+            return value;
+        };
+        const bool silent = peak() < EffectBase::SILENCE_THRESHOLD;
+        if (!silent || !nam.isSilent()) {
+            if (!silent) {
+                nam.resetSilence();
+            }
+            nam.process(buffers, buffers, channels, frameCount);
+            if (silent) {
+                nam.advanceSilence(frameCount, peak() < EffectBase::SILENCE_THRESHOLD);
+            }
+        }
+        if (profiling) {
+            profiler_.recordStage(0, STAGE_NAM, DSPProfiler::now() - stageStart);
+        }
     }
     
+    // Signal resté mono : dupliqué une seule fois, avant la sortie
+    if (channels == 1) {
+        std::copy(left, left + frameCount, right);
+    }
+    
+    if (profiling) {
+        stageStart = DSPProfiler::now();
+    }
+    
+    // Réentrelacement unique vers la sortie du driver
+    AudioBuffer::interleave(work.getReadPointers(), output, 2, frameCount);
+    
     // Application du gain de sortie (optimisé avec SIMD si disponible)
     float outputGainLinear = dbToLinear(output_gain_.load());
     if (SIMDHelper::isAvailable()) {
@@ -113,25 +255,39 @@ void DSPPipeline::process(float* input, float* output, uint32_t frameCount) {
         }
     }
     
-    // Mise à jour des stats
-    updateStats(input, output, frameCount);
-    
-    // Calcul CPU (optimisé avec moyenne glissante pour stabilité)
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
-    double cpuTime = (duration / 1000.0) / (frameCount / (double)sample_rate_ * 1000.0);
-    
-    {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        // Moyenne glissante pour lisser les variations (facteur 0.9)
-        stats_.cpuUsage = stats_.cpuUsage * 0.9 + (cpuTime * 100.0) * 0.1;
-        stats_.samplesProcessed += frameCount;
+    if (profiling) {
+        profiler_.recordStage(0, STAGE_OUTPUT, DSPProfiler::now() - stageStart);
     }
 }
 
 void DSPPipeline::setEffectChain(std::shared_ptr<EffectChain> chain) {
     std::lock_guard<std::mutex> lock(chain_mutex_);
+    if (effect_chain_ && effect_chain_ != chain) {
+        effect_chain_->setProfiler(nullptr);
+    }
+    if (chain) {
+        chain->prepare(buffer_size_);
+        chain->setProfiler(profiler_.isEnabled() ? &profiler_ : nullptr);
+        chain->setAudioThreadActive(audio_thread_active_);
+    }
     effect_chain_ = chain;
+    publishStateLocked();
+}
+
+void DSPPipeline::setAudioThreadActive(bool active) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    audio_thread_active_ = active;
+    if (effect_chain_) {
+        effect_chain_->setAudioThreadActive(active);
+    }
+}
+
+void DSPPipeline::setProfilingEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    profiler_.setEnabled(enabled);
+    if (effect_chain_) {
+        effect_chain_->setProfiler(enabled ? &profiler_ : nullptr);
+    }
 }
 
 std::shared_ptr<EffectChain> DSPPipeline::getEffectChain() const {
@@ -140,13 +296,11 @@ std::shared_ptr<EffectChain> DSPPipeline::getEffectChain() const {
 }
 
 DSPPipeline::Stats DSPPipeline::getStats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    return stats_;
+    return published_stats_.load();
 }
 
 void DSPPipeline::resetStats() {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_ = Stats{};
+    reset_stats_requested_.store(true, std::memory_order_release);
 }
 
 void DSPPipeline::setInputGain(float gain) {
@@ -176,7 +330,7 @@ float DSPPipeline::linearToDb(float linear) const {
     return 20.0f * std::log10(linear);
 }
 
-void DSPPipeline::updateStats(const float* input, const float* output, uint32_t frameCount) {
+void DSPPipeline::updateStats(const ProcessingState& state, const float* input, const float* output, uint32_t frameCount) {
     float peakIn = 0.0f;
     float peakOut = 0.0f;
     
@@ -185,10 +339,11 @@ void DSPPipeline::updateStats(const float* input, const float* output, uint32_t
         peakOut = std::max(peakOut, std::abs(output[i]));
     }
     
-    std::lock_guard<std::mutex> lock(stats_mutex_);
     stats_.peakInput = linearToDb(peakIn);
     stats_.peakOutput = linearToDb(peakOut);
-    stats_.latency = (buffer_size_ / (double)sample_rate_) * 1000.0; // ms
+    // Bloc du driver + îlot rééchantillonné du modèle NAM + effets de la chaîne
+    stats_.processingLatency = (processing_latency_ / (double)state.sampleRate) * 1000.0; // ms
+    stats_.latency = ((state.bufferSize + processing_latency_) / (double)state.sampleRate) * 1000.0; // ms
 }
 
 void DSPPipeline::enableTestTone(bool enabled) {
@@ -208,37 +363,58 @@ bool DSPPipeline::isTestToneEnabled() const {
 }
 
 bool DSPPipeline::loadNAMModel(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
     if (!nam_loader_) {
         nam_loader_ = std::make_unique<NAMLoader>();
     }
     
     nam_model_ = nam_loader_->loadModel(filePath);
-    if (nam_model_ && nam_model_->isValid()) {
-        nam_model_active_ = true;
-        return true;
-    }
-    
-    nam_model_active_ = false;
-    return false;
+    nam_model_active_ = nam_model_ && nam_effect_->setModel(nam_model_);
+    publishStateLocked();
+    return nam_model_active_;
 }
 
 bool DSPPipeline::loadNAMModelFromMemory(const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
     if (!nam_loader_) {
         nam_loader_ = std::make_unique<NAMLoader>();
     }
     
     nam_model_ = nam_loader_->loadModelFromMemory(data, size);
-    if (nam_model_ && nam_model_->isValid()) {
-        nam_model_active_ = true;
-        return true;
-    }
-    
-    nam_model_active_ = false;
-    return false;
+    nam_model_active_ = nam_model_ && nam_effect_->setModel(nam_model_);
+    publishStateLocked();
+    return nam_model_active_;
+}
+
+bool DSPPipeline::loadLightNAMModel(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    return nam_effect_->loadLightModel(filePath);
+}
+
+bool DSPPipeline::loadLightNAMModelFromMemory(const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    return nam_effect_->loadLightModelFromMemory(data, size);
+}
+
+bool DSPPipeline::hasLightNAMModel() const {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    return nam_effect_->hasLightModel();
 }
 
 void DSPPipeline::setNAMModelActive(bool active) {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
     nam_model_active_ = active && nam_model_ && nam_model_->isValid();
+    publishStateLocked();
+}
+
+bool DSPPipeline::isNAMModelActive() const {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    return nam_model_active_;
+}
+
+std::shared_ptr<NAMModel> DSPPipeline::getNAMModel() const {
+    std::lock_guard<std::mutex> lock(chain_mutex_);
+    return nam_model_;
 }
 
 } // namespace webamp
@@ -0,0 +1,161 @@
+#include "../include/dsp_profiler.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace webamp {
+
+DSPProfiler::DSPProfiler()
+    : enabled_(true)
+    , reset_requested_(false)
+    , pending_{}
+    , pending_count_(0)
+    , frames_since_publish_(0)
+{
+}
+
+uint64_t DSPProfiler::now() {
+    #ifdef _WIN32
+    static const uint64_t frequency = [] {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        return static_cast<uint64_t>(value.QuadPart);
+    }();
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const uint64_t ticks = static_cast<uint64_t>(counter.QuadPart);
+    return (ticks / frequency) * 1000000000ull + (ticks % frequency) * 1000000000ull / frequency;
+    #else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    #endif
+}
+
+void DSPProfiler::recordStage(uint64_t id, const char* label, uint64_t elapsedNs, bool fused) {
+    for (size_t i = 0; i < pending_count_; ++i) {
+        if (pending_[i].id == id && pending_[i].label == label) {
+            pending_[i].elapsedNs += elapsedNs;
+            pending_[i].fused = pending_[i].fused || fused;
+            return;
+        }
+    }
+    if (pending_count_ < MAX_STAGES) {
+        pending_[pending_count_++] = {id, label, elapsedNs, fused};
+    }
+}
+
+void DSPProfiler::endBlock(uint64_t elapsedNs, uint32_t frameCount, uint32_t sampleRate) {
+    if (reset_requested_.exchange(false, std::memory_order_acq_rel)) {
+        working_ = Profile{};
+        frames_since_publish_ = 0;
+    }
+    
+    if (!enabled_.load(std::memory_order_relaxed) || sampleRate == 0) {
+        pending_count_ = 0;
+        return;
+    }
+    
+    // Les emplacements suivent l'ordre de traitement ; un effet déplacé dans
+    // la chaîne conserve son historique, un nouvel effet (même à l'adresse
+    // d'un effet retiré) repart d'un historique vide
+    auto isStage = [](const StageProfile& profile, const PendingStage& stage) {
+        return profile.id == stage.id && profile.label == stage.label;
+    };
+    for (size_t k = 0; k < pending_count_; ++k) {
+        const PendingStage& stage = pending_[k];
+        if (!isStage(working_.stages[k], stage)) {
+            size_t j = k + 1;
+            while (j < MAX_STAGES && !isStage(working_.stages[j], stage)) {
+                ++j;
+            }
+            if (j < MAX_STAGES) {
+                std::swap(working_.stages[k], working_.stages[j]);
+            } else {
+                working_.stages[k] = StageProfile{};
+                working_.stages[k].id = stage.id;
+                working_.stages[k].label = stage.label;
+            }
+        }
+        accumulate(working_.stages[k], stage.elapsedNs);
+        if (stage.fused) {
+            ++working_.stages[k].fusedCount;
+        }
+    }
+    working_.stageCount = static_cast<uint32_t>(pending_count_);
+    pending_count_ = 0;
+    
+    // Dépassement d'échéance : bloc traité plus lentement que sa durée audio
+    const uint64_t budgetNs = static_cast<uint64_t>(frameCount) * 1000000000ull / sampleRate;
+    working_.budgetNs = static_cast<uint32_t>(std::min<uint64_t>(budgetNs, UINT32_MAX));
+    if (elapsedNs > budgetNs) {
+        ++working_.xruns;
+    }
+    accumulate(working_.block, elapsedNs);
+    ++working_.blocks;
+    
+    frames_since_publish_ += frameCount;
+    if (working_.blocks == 1 ||
+        frames_since_publish_ * 1000 >= static_cast<uint64_t>(sampleRate) * PUBLISH_INTERVAL_MS) {
+        published_.store(working_);
+        frames_since_publish_ = 0;
+    }
+}
+
+void DSPProfiler::reset() {
+    reset_requested_.store(true, std::memory_order_release);
+}
+
+void DSPProfiler::accumulate(StageProfile& stage, uint64_t elapsedNs) {
+    const uint32_t ns = static_cast<uint32_t>(std::min<uint64_t>(elapsedNs, UINT32_MAX));
+    ++stage.count;
+    stage.totalNs += ns;
+    stage.lastNs = ns;
+    stage.maxNs = std::max(stage.maxNs, ns);
+    ++stage.histogram[getBucket(ns)];
+}
+
+size_t DSPProfiler::getBucket(uint64_t ns) {
+    if (ns < (1ull << MIN_OCTAVE)) {
+        return 0;
+    }
+    
+    // Octave (position du bit de poids fort) puis 2 bits de mantisse
+    uint32_t octave = 63;
+    while ((ns >> octave) == 0) {
+        --octave;
+    }
+    const uint32_t fraction = static_cast<uint32_t>((ns >> (octave - 2)) & 3u);
+    const size_t bucket = static_cast<size_t>(octave - MIN_OCTAVE) * BUCKETS_PER_OCTAVE + fraction;
+    return std::min(bucket, HISTOGRAM_BUCKETS - 1);
+}
+
+uint64_t DSPProfiler::getBucketUpperBound(size_t bucket) {
+    const uint32_t octave = MIN_OCTAVE + static_cast<uint32_t>(bucket / BUCKETS_PER_OCTAVE);
+    const uint64_t fraction = bucket % BUCKETS_PER_OCTAVE;
+    return (1ull << octave) + ((fraction + 1) << (octave - 2));
+}
+
+uint64_t DSPProfiler::getPercentile(const StageProfile& stage, double quantile) {
+    if (stage.count == 0) {
+        return 0;
+    }
+    
+    const uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(stage.count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+        seen += stage.histogram[b];
+        if (seen >= rank) {
+            // La borne de classe ne dépasse jamais le maximum observé
+            return std::min<uint64_t>(getBucketUpperBound(b), stage.maxNs);
+        }
+    }
+    return stage.maxNs;
+}
+
+} // namespace webamp
@@ -15,13 +15,174 @@
 
 namespace webamp {
 
-EffectChain::EffectChain() {
+// Taille de bloc par défaut si prepare() n'a pas été appelé
+static constexpr uint32_t DEFAULT_MAX_FRAME_COUNT = 1024;
+
+EffectChain::EffectChain()
+    : max_frame_count_(DEFAULT_MAX_FRAME_COUNT)
+    , huge_pages_(false)
+    , profiler_(nullptr)
+    , quality_level_(0)
+    , fusion_enabled_(true)
+    , latency_(0)
+    , audio_thread_active_(false)
+    , parameter_queue_(PARAMETER_QUEUE_CAPACITY)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    publishLocked();
 }
 
 EffectChain::~EffectChain() {
     clear();
 }
 
+void EffectChain::publishLocked() {
+    layoutMemoryLocked();
+    
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->effects = effects_;
+    snapshot->maxFrameCount = max_frame_count_;
+    snapshot->widenAt = findWidenIndex(effects_);
+    snapshot->scratch.resize(EffectBase::MAX_CHANNELS, max_frame_count_);
+    snapshot->interleavedIO.resize(EffectBase::MAX_CHANNELS, max_frame_count_);
+    latency_.store(computeLatency(effects_), std::memory_order_relaxed);
+    publisher_.publish(std::move(snapshot));
+}
+
+void EffectChain::layoutMemoryLocked(bool relayout) {
+    // Effets dans l'ordre de traitement (branches des effets composites
+    // comprises)
+    std::vector<EffectBase*> effects;
+    for (const auto& effect : effects_) {
+        effect->collectMemoryEffects(effects);
+    }
+    std::vector<size_t> sizes(effects.size());
+    for (size_t i = 0; i < effects.size(); ++i) {
+        sizes[i] = effects[i]->getMemorySize();
+    }
+    
+    // Aucune zone de la chaîne en service : rien à préserver, disposition
+    // complète et contiguë
+    if (!relayout) {
+        relayout = !isArenaBoundLocked(effects);
+    }
+    
+    // Sinon, zones conservées : effet toujours dans la chaîne, même taille,
+    // zone toujours attribuée (setSampleRate() lui en donne une autre)
+    std::vector<ArenaSegment> segments;
+    std::vector<bool> placed(effects.size(), false);
+    if (!relayout) {
+        for (auto& segment : arena_segments_) {
+            std::vector<ArenaZone> zones;
+            for (const ArenaZone& zone : segment.zones) {
+                for (size_t i = 0; i < effects.size(); ++i) {
+                    if (!placed[i] && effects[i]->getInstanceId() == zone.effectId && sizes[i] == zone.size &&
+                        effects[i]->getAssignedMemoryData() == zone.data) {
+                        placed[i] = true;
+                        zones.push_back(zone);
+                        break;
+                    }
+                }
+            }
+            if (!zones.empty()) {
+                segment.zones = std::move(zones);
+                segments.push_back(std::move(segment));
+            }
+        }
+    }
+    
+    // Effets restants (nouveaux, ou tous) : un segment, dans l'ordre de
+    // traitement, chacun dans sa zone alignée
+    size_t total = 0;
+    for (size_t i = 0; i < effects.size(); ++i) {
+        if (!placed[i]) {
+            total += sizes[i];
+        }
+    }
+    if (total > 0) {
+        ArenaSegment segment;
+        segment.arena = std::make_shared<DSPArena>(total, huge_pages_);
+        unsigned char* data = segment.arena->getData();
+        for (size_t i = 0; i < effects.size(); ++i) {
+            if (!placed[i] && sizes[i] > 0) {
+                effects[i]->assignMemory(segment.arena, data);
+                segment.zones.push_back({effects[i]->getInstanceId(), data, sizes[i]});
+                data += sizes[i];
+            }
+        }
+        segments.push_back(std::move(segment));
+    }
+    arena_segments_ = std::move(segments);
+}
+
+bool EffectChain::isArenaBoundLocked(const std::vector<EffectBase*>& effects) const {
+    for (const EffectBase* effect : effects) {
+        const unsigned char* bound = static_cast<const unsigned char*>(effect->getMemoryData());
+        for (const auto& segment : arena_segments_) {
+            const unsigned char* begin = segment.arena->getData();
+            if (bound >= begin && bound < begin + segment.arena->getSize()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void EffectChain::setHugePages(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled != huge_pages_) {
+        huge_pages_ = enabled;
+        layoutMemoryLocked(true);
+    }
+}
+
+bool EffectChain::getHugePages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return huge_pages_;
+}
+
+size_t EffectChain::getArenaSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t size = 0;
+    for (const auto& segment : arena_segments_) {
+        size += segment.arena->getSize();
+    }
+    return size;
+}
+
+size_t EffectChain::getArenaSegmentCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return arena_segments_.size();
+}
+
+bool EffectChain::usesHugePages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (arena_segments_.empty()) {
+        return false;
+    }
+    return std::all_of(arena_segments_.begin(), arena_segments_.end(),
+                       [](const ArenaSegment& segment) { return segment.arena->usesHugePages(); });
+}
+
+void EffectChain::prepare(uint32_t maxFrameCount) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (maxFrameCount == 0 || maxFrameCount == max_frame_count_) {
+        return;
+    }
+    
+    max_frame_count_ = maxFrameCount;
+    for (auto& effect : effects_) {
+        effect->setMaxBlockSize(max_frame_count_);
+    }
+    publishLocked();
+}
+
+uint32_t EffectChain::getMaxFrameCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_frame_count_;
+}
+
 void EffectChain::addEffect(std::shared_ptr<EffectBase> effect, size_t position) {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -29,24 +190,40 @@ void EffectChain::addEffect(std::shared_ptr<EffectBase> effect, size_t position)
         return;
     }
     
+    effect->setMaxBlockSize(max_frame_count_);
+    // Effet composite modifié (branches) : nouvelle disposition et nouvel
+    // instantané, comme pour un effet ajouté à la chaîne
+    effect->setStructureListener([this] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        publishLocked();
+    });
+    
     if (position == static_cast<size_t>(-1) || position >= effects_.size()) {
         effects_.push_back(effect);
     } else {
         effects_.insert(effects_.begin() + position, effect);
     }
+    
+    publishLocked();
 }
 
 void EffectChain::removeEffect(size_t index) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (index < effects_.size()) {
+        effects_[index]->setStructureListener(nullptr);
         effects_.erase(effects_.begin() + index);
+        publishLocked();
     }
 }
 
 void EffectChain::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& effect : effects_) {
+        effect->setStructureListener(nullptr);
+    }
     effects_.clear();
+    publishLocked();
 }
 
 void EffectChain::moveEffect(size_t from, size_t to) {
@@ -68,6 +245,7 @@ void EffectChain::moveEffect(size_t from, size_t to) {
     }
     
     effects_.insert(effects_.begin() + to, effect);
+    publishLocked();
 }
 
 void EffectChain::swapEffects(size_t index1, size_t index2) {
@@ -82,6 +260,40 @@ void EffectChain::swapEffects(size_t index1, size_t index2) {
     }
     
     std::swap(effects_[index1], effects_[index2]);
+    publishLocked();
+}
+
+bool EffectChain::queueParameterChange(EffectBase* effect, size_t parameterIndex, float value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!effect || parameterIndex == EffectBase::INVALID_PARAMETER) {
+        return false;
+    }
+    
+    // L'effet peut être dans une branche d'un effet composite (ParallelEffect)
+    auto it = std::find_if(effects_.begin(), effects_.end(),
+                           [effect](const std::shared_ptr<EffectBase>& e) { return e->containsEffect(effect); });
+    if (it == effects_.end()) {
+        return false;
+    }
+    
+    ParameterChange change{effect, effect->getInstanceId(), static_cast<uint32_t>(parameterIndex), value};
+    if (!audio_thread_active_.load(std::memory_order_acquire)) {
+        // Personne ne viderait la file : appliqué ici, après les changements
+        // encore en attente
+        applyParameterChanges(effects_);
+        (*it)->applyParameterChange(change);
+        return true;
+    }
+    return parameter_queue_.write(&change, 1) == 1;
+}
+
+void EffectChain::setAudioThreadActive(bool active) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    audio_thread_active_.store(active, std::memory_order_release);
+    if (!active) {
+        applyParameterChanges(effects_);
+    }
 }
 
 std::shared_ptr<EffectBase> EffectChain::getEffect(size_t index) const {
@@ -98,71 +310,303 @@ size_t EffectChain::getEffectCount() const {
     return effects_.size();
 }
 
-void EffectChain::process(float* input, float* output, uint32_t frameCount) {
+size_t EffectChain::getMonoEffectCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    return std::min(findWidenIndex(effects_), MAX_EFFECTS);
+}
+
+size_t EffectChain::findWidenIndex(const std::vector<std::shared_ptr<EffectBase>>& effects) {
+    for (size_t i = 0; i < effects.size(); ++i) {
+        if (effects[i]->getChannelLayout() == EffectBase::ChannelLayout::MonoToStereo) {
+            return i;
+        }
+    }
+    return effects.size();
+}
+
+void EffectChain::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    SnapshotPublisher<Snapshot>::ReadScope snapshot(publisher_);
+    channels = std::min(channels, EffectBase::MAX_CHANNELS);
     
-    if (effects_.empty()) {
-        // Pas d'effets : copie directe (optimisé avec SIMD si disponible)
-        #ifdef USE_SIMD
-        if (SIMDHelper::isAvailable()) {
-            SIMDHelper::copy(input, output, frameCount * 2);
-        } else {
-            std::copy(input, input + frameCount * 2, output);
+    if (!snapshot) {
+        AudioBuffer::copy(input, output, channels, frameCount);
+        return;
+    }
+    
+    beginBlock(*snapshot.get());
+    
+    // Les buffers de travail sont dimensionnés par prepare() : traiter par
+    // sous-blocs si le driver livre plus de frames que prévu
+    const float* in[EffectBase::MAX_CHANNELS];
+    float* out[EffectBase::MAX_CHANNELS];
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        uint32_t chunk = std::min(frameCount - offset, snapshot->maxFrameCount);
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            in[ch] = input[ch] + offset;
+            out[ch] = output[ch] + offset;
         }
-        #else
+        processBlock(*snapshot.get(), 0, snapshot->effects.size(), in, out, channels, chunk);
+        offset += chunk;
+    }
+}
+
+void EffectChain::process(float* input, float* output, uint32_t frameCount) {
+    SnapshotPublisher<Snapshot>::ReadScope snapshot(publisher_);
+    
+    if (!snapshot) {
         std::copy(input, input + frameCount * 2, output);
-        #endif
         return;
     }
     
-    // Optimisation : utiliser buffers alternés pour éviter allocations
-    // Support jusqu'à 20 effets avec seulement 2 buffers de travail
-    static thread_local std::vector<float> workBuffer1;
-    static thread_local std::vector<float> workBuffer2;
+    beginBlock(*snapshot.get());
     
-    if (workBuffer1.size() < frameCount * 2) {
-        workBuffer1.resize(frameCount * 2);
-        workBuffer2.resize(frameCount * 2);
+    AudioBuffer& io = snapshot->interleavedIO;
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        uint32_t chunk = std::min(frameCount - offset, snapshot->maxFrameCount);
+        AudioBuffer::deinterleave(input + offset * 2, io.getWritePointers(), 2, chunk);
+        processBlock(*snapshot.get(), 0, snapshot->effects.size(), io.getReadPointers(), io.getWritePointers(), 2, chunk);
+        AudioBuffer::interleave(io.getReadPointers(), output + offset * 2, 2, chunk);
+        offset += chunk;
     }
+}
+
+uint32_t EffectChain::processMono(const float* input, float* const* output, uint32_t frameCount) {
+    SnapshotPublisher<Snapshot>::ReadScope snapshot(publisher_);
     
-    float* currentInput = input;
-    float* currentOutput = workBuffer1.data();
-    bool useBuffer1 = true;
+    if (!snapshot) {
+        std::copy(input, input + frameCount, output[0]);
+        return 1;
+    }
     
-    // Application de chaque effet dans l'ordre (optimisé pour 20 effets max)
-    size_t activeEffects = 0;
-    for (size_t i = 0; i < effects_.size() && i < 20; ++i) {  // Limite à 20 effets
-        auto& effect = effects_[i];
-        
+    beginBlock(*snapshot.get());
+    
+    // Le nombre de canaux ne dépend que de l'instantané : identique pour
+    // tous les sous-blocs
+    uint32_t channels = 1;
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        uint32_t chunk = std::min(frameCount - offset, snapshot->maxFrameCount);
+        float* out[2] = {output[0] + offset, output[1] + offset};
+        channels = processMonoBlock(*snapshot.get(), input + offset, out, chunk);
+        offset += chunk;
+    }
+    return channels;
+}
+
+uint32_t EffectChain::processMonoBlock(Snapshot& snapshot, const float* input, float* const* output,
+                                       uint32_t frameCount) {
+    // Élargissement au premier effet MonoToStereo, même contourné
+    const size_t widenAt = snapshot.executionWidenAt;
+    const bool widen = snapshot.widenAt < std::min(snapshot.effects.size(), MAX_EFFECTS);
+    
+    // Étages mono (drive, ampli, cabinet...) sur un seul canal
+    const float* monoInput[1] = {input};
+    processBlock(snapshot, 0, widenAt, monoInput, output, 1, frameCount);
+    if (!widen) {
+        return 1;
+    }
+    
+    // Élargissement au premier effet stéréo, traité en place ensuite
+    std::copy(output[0], output[0] + frameCount, output[1]);
+    processBlock(snapshot, widenAt, snapshot.executionCount, output, output, 2, frameCount);
+    return 2;
+}
+
+void EffectChain::beginBlock(Snapshot& snapshot) {
+    applyParameterChanges(snapshot.effects);
+    applyQualityLevel(snapshot);
+    
+    // Après les changements : un bypass ou un facteur de suréchantillonnage
+    // modifié dans ce bloc est déjà pris en compte. Les effets contournés
+    // sont retirés de la liste au lieu d'être recopiés.
+    const size_t count = std::min(snapshot.effects.size(), MAX_EFFECTS);
+    size_t active = 0;
+    uint32_t latency = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == snapshot.widenAt) {
+            snapshot.executionWidenAt = active;
+        }
+        EffectBase* effect = snapshot.effects[i].get();
         if (!effect->isBypassed()) {
-            effect->process(currentInput, currentOutput, frameCount);
-            activeEffects++;
-        } else {
-            // Bypass : copie directe (optimisé)
-            #ifdef USE_SIMD
-            if (SIMDHelper::isAvailable()) {
-                SIMDHelper::copy(currentInput, currentOutput, frameCount * 2);
+            snapshot.execution[active++] = effect;
+            latency += effect->getLatency();
+        }
+    }
+    if (snapshot.widenAt >= count) {
+        snapshot.executionWidenAt = active;
+    }
+    snapshot.executionCount = active;
+    latency_.store(latency, std::memory_order_relaxed);
+    
+    compileFusion(snapshot);
+}
+
+void EffectChain::compileFusion(Snapshot& snapshot) {
+    const size_t count = snapshot.executionCount;
+    for (size_t i = 0; i < count; ++i) {
+        snapshot.fused[i].clear();
+    }
+    if (!fusion_enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    EffectBase::FusedKind kinds[MAX_EFFECTS];
+    for (size_t i = 0; i < count; ++i) {
+        kinds[i] = snapshot.execution[i]->getFusedKind();
+    }
+    
+    // Suites d'effets fusionnables découpées en groupes de
+    // FusedChain::MAX_STAGES au plus, de part et d'autre de l'élargissement
+    // stéréo (processMono() traite les deux segments séparément)
+    size_t i = 0;
+    while (i < count) {
+        const size_t segmentEnd = i < snapshot.executionWidenAt ? snapshot.executionWidenAt : count;
+        size_t run = 0;
+        while (i + run < segmentEnd && kinds[i + run] != EffectBase::FusedKind::None) {
+            ++run;
+        }
+        if (run == 0) {
+            ++i;
+            continue;
+        }
+        const uint32_t fused = snapshot.fused[i].compile(&snapshot.execution[i], &kinds[i], static_cast<uint32_t>(run));
+        i += std::max<uint32_t>(fused, 1);
+    }
+}
+
+bool EffectChain::isSilentBlock(const float* const* buffers, uint32_t channels, uint32_t frameCount) {
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+        if (SIMDHelper::peak(buffers[ch], frameCount) >= EffectBase::SILENCE_THRESHOLD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t EffectChain::computeLatency(const std::vector<std::shared_ptr<EffectBase>>& effects) {
+    uint32_t latency = 0;
+    const size_t count = std::min(effects.size(), MAX_EFFECTS);
+    for (size_t i = 0; i < count; ++i) {
+        if (!effects[i]->isBypassed()) {
+            latency += effects[i]->getLatency();
+        }
+    }
+    return latency;
+}
+
+void EffectChain::applyQualityLevel(const Snapshot& snapshot) {
+    // Chaque effet borne le niveau à ses propres niveaux (sans effet s'il
+    // n'a pas changé)
+    const uint32_t level = quality_level_.load(std::memory_order_relaxed);
+    for (const auto& effect : snapshot.effects) {
+        effect->setQualityTier(level);
+    }
+}
+
+void EffectChain::applyParameterChanges(const std::vector<std::shared_ptr<EffectBase>>& effects) {
+    // Vider la file par lots (pile, aucune allocation). Un effet retiré de la
+    // chaîne entre l'envoi et l'application est absent de l'instantané (ou
+    // de effects_) : son changement est ignoré, même si un nouvel effet
+    // occupe son adresse (identifiant d'instance différent).
+    ParameterChange changes[32];
+    size_t count;
+    while ((count = parameter_queue_.read(changes, 32)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            for (const auto& effect : effects) {
+                if (effect->applyParameterChange(changes[i])) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void EffectChain::processBlock(Snapshot& snapshot, size_t begin, size_t end, const float* const* input,
+                               float* const* output, uint32_t channels, uint32_t frameCount) {
+    end = std::min(end, snapshot.executionCount);
+    
+    // Exécution directe de input vers output : le premier effet lit input,
+    // les suivants travaillent en place dans output. Un effet qui ne peut
+    // pas être traité en place (EffectBase::canProcessInPlace()) écrit dans
+    // le buffer scratch, relu par l'effet suivant : aucune copie par effet,
+    // au plus une à la fin.
+    float* const* scratch = snapshot.scratch.getWritePointers();
+    DSPProfiler* profiler = profiler_.load(std::memory_order_acquire);
+    const float* const* current = input;
+    
+    // Détection de silence : pic de l'entrée, puis de chaque sortie tant que
+    // le signal reste silencieux (queues des effets). Le premier bloc non
+    // silencieux réveille tous les effets.
+    bool silent = isSilentBlock(input, channels, frameCount);
+    
+    for (size_t i = begin; i < end; ++i) {
+        EffectBase* effect = snapshot.execution[i];
+        
+        // Groupe fusionné (FusedChain) : toujours en place dans output. Sur
+        // une entrée silencieuse, ses effets sont traités un par un pour
+        // décider de leur veille. Le profileur répartit le coût du groupe à
+        // parts égales entre ses effets, marqués fusionnés (chaque effet
+        // exécuté a un échantillon par bloc).
+        const FusedChain& fused = snapshot.fused[i];
+        if (!silent && fused.isCompiled() && i + fused.getStageCount() <= end) {
+            for (uint32_t k = 0; k < fused.getStageCount(); ++k) {
+                fused.getStage(k)->resetSilence();
+            }
+            if (profiler) {
+                const uint64_t start = DSPProfiler::now();
+                fused.process(current, output, channels, frameCount);
+                const uint64_t elapsed = DSPProfiler::now() - start;
+                const uint32_t stages = fused.getStageCount();
+                for (uint32_t k = 0; k < stages; ++k) {
+                    const uint64_t share = elapsed / stages + (k == 0 ? elapsed % stages : 0);
+                    profiler->recordStage(fused.getStage(k)->getInstanceId(), nullptr, share, true);
+                }
             } else {
-                std::copy(currentInput, currentInput + frameCount * 2, currentOutput);
+                fused.process(current, output, channels, frameCount);
             }
-            #else
-            std::copy(currentInput, currentInput + frameCount * 2, currentOutput);
-            #endif
+            current = output;
+            i += fused.getStageCount() - 1;
+            continue;
+        }
+        
+        if (silent && effect->isSilent()) {
+            // Veille : le signal silencieux traverse l'effet sans traitement
+            // (bloc sans coût pour le profileur)
+            if (profiler) {
+                profiler->recordStage(effect->getInstanceId(), nullptr, 0);
+            }
+            continue;
+        }
+        if (!silent) {
+            effect->resetSilence();
         }
         
-        // Échange des buffers pour l'effet suivant
-        if (useBuffer1) {
-            currentInput = workBuffer1.data();
-            currentOutput = workBuffer2.data();
+        float* const* target = output;
+        if (current[0] == output[0] && !effect->canProcessInPlace()) {
+            target = scratch;
+        }
+        
+        if (profiler) {
+            const uint64_t start = DSPProfiler::now();
+            effect->process(current, target, channels, frameCount);
+            profiler->recordStage(effect->getInstanceId(), nullptr, DSPProfiler::now() - start);
         } else {
-            currentInput = workBuffer2.data();
-            currentOutput = workBuffer1.data();
+            effect->process(current, target, channels, frameCount);
+        }
+        current = target;
+        
+        if (silent) {
+            // Queue en cours : sa sortie décide du silence des suivants
+            silent = isSilentBlock(current, channels, frameCount);
+            effect->advanceSilence(frameCount, silent);
         }
-        useBuffer1 = !useBuffer1;
     }
     
-    // Copie finale vers la sortie
-    std::copy(currentInput, currentInput + frameCount * 2, output);
+    // Aucun effet traité (copie sautée si input est output) ou dernier
+    // effet traité hors place
+    AudioBuffer::copy(current, output, channels, frameCount);
 }
 
 std::shared_ptr<EffectBase> EffectChain::createEffect(const std::string& type) const {
@@ -51,7 +51,7 @@ std::string EffectManager::generateEffectId() const {
     return oss.str();
 }
 
-std::shared_ptr<EffectBase> EffectManager::createEffect(const std::string& type) const {
+std::shared_ptr<EffectBase> EffectManager::createEffect(const std::string& type) {
     if (type == "distortion") {
         return std::make_shared<DistortionEffect>();
     } else if (type == "overdrive") {
@@ -168,12 +168,17 @@ bool EffectManager::setParameter(const std::string& effectId, const std::string&
     std::lock_guard<std::mutex> lock(mutex_);
     
     auto it = effects_by_id_.find(effectId);
-    if (it == effects_by_id_.end()) {
+    if (it == effects_by_id_.end() || !chain_) {
         return false;
     }
     
-    it->second->setParameter(parameter, value);
-    return true;
+    // Appliqué par le thread audio au début du prochain bloc (lissé), ou
+    // aussitôt si le moteur est arrêté
+    size_t index = it->second->getParameterIndex(parameter);
+    if (index == EffectBase::INVALID_PARAMETER) {
+        return false;
+    }
+    return chain_->queueParameterChange(it->second.get(), index, value);
 }
 
 bool EffectManager::moveEffect(const std::string& effectId, size_t toPosition) {
@@ -268,5 +273,16 @@ size_t EffectManager::getEffectIndex(const std::string& effectId) const {
     return static_cast<size_t>(-1);
 }
 
+std::string EffectManager::getEffectId(uint64_t instanceId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (const auto& [id, e] : effects_by_id_) {
+        if (e->getInstanceId() == instanceId) {
+            return id;
+        }
+    }
+    return "";
+}
+
 } // namespace webamp
 
@@ -8,29 +8,50 @@ ChorusEffect::ChorusEffect()
     : rate_(1.0f), depth_(0.5f), mix_(0.5f),
       delay_buffer_size_(0), write_index_(0),
       lfo_phase_(0.0f), lfo_increment_(0.0f) {
+    for (auto& buffer : delay_buffer_) {
+        buffer = nullptr;
+    }
+    allocateMemory();
 }
 
 void ChorusEffect::setSampleRate(uint32_t sampleRate) {
     EffectBase::setSampleRate(sampleRate);
-    
-    // Buffer de delay pour ~50ms max
-    delay_buffer_size_ = static_cast<size_t>(sampleRate * 0.05f);
-    delay_buffer_.resize(delay_buffer_size_, 0.0f);
-    write_index_ = 0;
-    
+    allocateMemory();
     updateLFO();
 }
 
-void ChorusEffect::process(float* input, float* output, uint32_t frameCount) {
+void ChorusEffect::layoutMemory(ArenaLayout& layout) {
+    // Retard maximal + 2 samples (interpolation entre index1 et index2)
+    const size_t size = static_cast<size_t>(std::ceil(MAX_DELAY_SECONDS * layout.getSampleRate())) + 2;
+    for (auto& buffer : delay_buffer_) {
+        layout.allocate(buffer, size);
+    }
+    if (!layout.isMeasuring()) {
+        delay_buffer_size_ = size;
+    }
+}
+
+void ChorusEffect::onMemoryBound() {
+    write_index_ = 0;
+}
+
+void ChorusEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    updateMemory();
+    
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
+    // Incrément du LFO recalculé une fois par bloc pendant la rampe
+    if (rate_.isSmoothing()) {
+        rate_.skip(frameCount);
+        updateLFO();
+    }
+    
     for (uint32_t i = 0; i < frameCount; ++i) {
-        float delayTime = getDelayTime();
+        float delayTime = getDelayTime(depth_.getNextValue());
+        const float mix = mix_.getNextValue();
         float delaySamples = delayTime * sample_rate_;
         
         // Lire depuis le buffer de delay avec interpolation
@@ -41,21 +62,28 @@ void ChorusEffect::process(float* input, float* output, uint32_t frameCount) {
         size_t index2 = (index1 + 1) % delay_buffer_size_;
         float frac = readIndex - index1;
         
-        float delayed = delay_buffer_[index1] * (1.0f - frac) + delay_buffer_[index2] * frac;
-        
-        // Écrire dans le buffer
-        delay_buffer_[write_index_] = input[i];
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            float* buffer = delay_buffer_[ch];
+            const float delayed = buffer[index1] * (1.0f - frac) + buffer[index2] * frac;
+            const float sample = input[ch][i];
+            
+            // Écrire dans le buffer
+            buffer[write_index_] = sample;
+            
+            // Mix dry/wet
+            output[ch][i] = sample * (1.0f - mix) + delayed * mix;
+        }
         write_index_ = (write_index_ + 1) % delay_buffer_size_;
         
-        // Mix dry/wet
-        output[i] = input[i] * (1.0f - mix_) + delayed * mix_;
-        
-        updateLFO();
+        advanceLFO();
     }
 }
 
 void ChorusEffect::updateLFO() {
-    lfo_increment_ = (2.0f * 3.14159f * rate_) / sample_rate_;
+    lfo_increment_ = (2.0f * 3.14159f * rate_.getCurrentValue()) / sample_rate_;
+}
+
+void ChorusEffect::advanceLFO() {
     lfo_phase_ += lfo_increment_;
     if (lfo_phase_ >= 2.0f * 3.14159f) {
         lfo_phase_ -= 2.0f * 3.14159f;
@@ -66,36 +94,52 @@ float ChorusEffect::getLFOValue() const {
     return sinf(lfo_phase_);
 }
 
-float ChorusEffect::getDelayTime() const {
+float ChorusEffect::getDelayTime(float depth) const {
     // Delay de base: 10ms, modulation: ±5ms
     float baseDelay = 0.010f; // 10ms
-    float modRange = 0.005f * depth_; // ±5ms
+    float modRange = 0.005f * depth; // ±5ms
     return baseDelay + modRange * getLFOValue();
 }
 
 std::vector<EffectBase::Parameter> ChorusEffect::getParameters() const {
     return {
-        {"rate", "Rate", 0.1f, 10.0f, 1.0f, rate_},
-        {"depth", "Depth", 0.0f, 1.0f, 0.5f, depth_},
-        {"mix", "Mix", 0.0f, 1.0f, 0.5f, mix_}
+        {"rate", "Rate", 0.1f, 10.0f, 1.0f, rate_.getRequestedValue()},
+        {"depth", "Depth", 0.0f, 1.0f, 0.5f, depth_.getRequestedValue()},
+        {"mix", "Mix", 0.0f, 1.0f, 0.5f, mix_.getRequestedValue()}
     };
 }
 
 void ChorusEffect::setParameter(const std::string& name, float value) {
     if (name == "rate") {
-        rate_ = std::max(0.1f, std::min(10.0f, value));
-        updateLFO();
+        setParameterByIndex(PARAM_RATE, value);
     } else if (name == "depth") {
-        depth_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_DEPTH, value);
     } else if (name == "mix") {
-        mix_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_MIX, value);
+    }
+}
+
+void ChorusEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_RATE:
+            rate_.setTarget(std::max(0.1f, std::min(10.0f, value)), ramp);
+            break;
+        case PARAM_DEPTH:
+            depth_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_MIX:
+            mix_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        default:
+            break;
     }
 }
 
 float ChorusEffect::getParameter(const std::string& name) const {
-    if (name == "rate") return rate_;
-    if (name == "depth") return depth_;
-    if (name == "mix") return mix_;
+    if (name == "rate") return rate_.getRequestedValue();
+    if (name == "depth") return depth_.getRequestedValue();
+    if (name == "mix") return mix_.getRequestedValue();
     return 0.0f;
 }
 
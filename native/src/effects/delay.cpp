@@ -9,14 +9,14 @@ DelayEffect::DelayEffect()
     : time_(50.0f)
     , feedback_(50.0f)
     , mix_(50.0f)
-    , delay_buffer_size_(0)
+    , delay_length_(1)
+    , delay_buffer_size_(1)
 {
-    write_pos_[0] = 0;
-    write_pos_[1] = 0;
-    delay_buffer_[0].resize(44100 * 2); // Max 2 secondes @ 44.1kHz
-    delay_buffer_[1].resize(44100 * 2);
-    std::fill(delay_buffer_[0].begin(), delay_buffer_[0].end(), 0.0f);
-    std::fill(delay_buffer_[1].begin(), delay_buffer_[1].end(), 0.0f);
+    for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+        delay_buffer_[ch] = nullptr;
+        write_pos_[ch] = 0;
+    }
+    allocateMemory();
 }
 
 DelayEffect::~DelayEffect() {
@@ -24,16 +24,33 @@ DelayEffect::~DelayEffect() {
 
 void DelayEffect::setSampleRate(uint32_t sampleRate) {
     EffectBase::setSampleRate(sampleRate);
+    allocateMemory();
+}
+
+void DelayEffect::layoutMemory(ArenaLayout& layout) {
+    // Time maximal au sample rate courant (+1 : lecture à writePos - delaySize)
+    const size_t length = static_cast<size_t>(MAX_DELAY_MS / 1000.0f * layout.getSampleRate()) + 1;
+    for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+        layout.allocate(delay_buffer_[ch], length);
+    }
+    if (!layout.isMeasuring()) {
+        delay_length_ = length;
+    }
+}
+
+void DelayEffect::onMemoryBound() {
+    write_pos_[0] = 0;
+    write_pos_[1] = 0;
     updateDelayBuffer();
 }
 
 void DelayEffect::updateDelayBuffer() {
     // Time: 0-100 correspond à 0-2000ms
-    float delayMs = (time_ / 100.0f) * 2000.0f;
+    float delayMs = (time_.getCurrentValue() / 100.0f) * MAX_DELAY_MS;
     delay_buffer_size_ = static_cast<size_t>((delayMs / 1000.0f) * sample_rate_);
     
-    if (delay_buffer_size_ > delay_buffer_[0].size()) {
-        delay_buffer_size_ = delay_buffer_[0].size();
+    if (delay_buffer_size_ >= delay_length_) {
+        delay_buffer_size_ = delay_length_ - 1;
     }
     
     if (delay_buffer_size_ == 0) {
@@ -41,66 +58,95 @@ void DelayEffect::updateDelayBuffer() {
     }
 }
 
-void DelayEffect::process(float* input, float* output, uint32_t frameCount) {
+uint32_t DelayEffect::getTailLength() const {
+    // Valeurs les plus longues pendant une rampe
+    const float time = std::max(time_.getCurrentValue(), time_.getTargetValue()) / 100.0f;
+    const float feedback = std::max(feedback_.getCurrentValue(), feedback_.getTargetValue()) / 100.0f;
+    const double delaySamples = std::max(1.0, time * MAX_DELAY_MS / 1000.0 * sample_rate_);
+    return getFeedbackTail(delaySamples, feedback);
+}
+
+void DelayEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    updateMemory();
+    
     if (bypass_) {
-        std::copy(input, input + frameCount * 2, output);
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    float feedbackLinear = feedback_ / 100.0f;
-    float mixLinear = mix_ / 100.0f;
-    float dryMix = 1.0f - mixLinear;
+    // Longueur du delay recalculée une fois par bloc pendant la rampe
+    if (time_.isSmoothing()) {
+        time_.skip(frameCount);
+        updateDelayBuffer();
+    }
     
     for (uint32_t i = 0; i < frameCount; ++i) {
-        for (int ch = 0; ch < 2; ++ch) {
-            int idx = i * 2 + ch;
-            
+        const float feedbackLinear = feedback_.getNextValue() / 100.0f;
+        const float mixLinear = mix_.getNextValue() / 100.0f;
+        const float dryMix = 1.0f - mixLinear;
+        
+        for (uint32_t ch = 0; ch < channels; ++ch) {
             // Lire depuis le buffer de delay (readPos = writePos - delaySize)
             size_t readPos;
             if (write_pos_[ch] >= delay_buffer_size_) {
                 readPos = write_pos_[ch] - delay_buffer_size_;
             } else {
-                readPos = delay_buffer_[ch].size() + write_pos_[ch] - delay_buffer_size_;
+                readPos = delay_length_ + write_pos_[ch] - delay_buffer_size_;
             }
-            readPos = readPos % delay_buffer_[ch].size();
             float delayed = delay_buffer_[ch][readPos];
             
             // Mix dry/wet
-            float sample = input[idx];
-            output[idx] = sample * dryMix + delayed * mixLinear;
+            float sample = input[ch][i];
+            output[ch][i] = sample * dryMix + delayed * mixLinear;
             
             // Écrire dans le buffer avec feedback
             delay_buffer_[ch][write_pos_[ch]] = sample + delayed * feedbackLinear;
             
             // Avancer les pointeurs (modulo sur la taille du buffer)
-            write_pos_[ch] = (write_pos_[ch] + 1) % delay_buffer_[ch].size();
+            write_pos_[ch] = (write_pos_[ch] + 1) % delay_length_;
         }
     }
 }
 
 std::vector<EffectBase::Parameter> DelayEffect::getParameters() const {
     return {
-        {"time", "Time", 0.0f, 100.0f, 50.0f, time_},
-        {"feedback", "Feedback", 0.0f, 100.0f, 50.0f, feedback_},
-        {"mix", "Mix", 0.0f, 100.0f, 50.0f, mix_}
+        {"time", "Time", 0.0f, 100.0f, 50.0f, time_.getRequestedValue()},
+        {"feedback", "Feedback", 0.0f, 100.0f, 50.0f, feedback_.getRequestedValue()},
+        {"mix", "Mix", 0.0f, 100.0f, 50.0f, mix_.getRequestedValue()}
     };
 }
 
 void DelayEffect::setParameter(const std::string& name, float value) {
     if (name == "time") {
-        time_ = std::max(0.0f, std::min(100.0f, value));
-        updateDelayBuffer();
+        setParameterByIndex(PARAM_TIME, value);
     } else if (name == "feedback") {
-        feedback_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_FEEDBACK, value);
     } else if (name == "mix") {
-        mix_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_MIX, value);
+    }
+}
+
+void DelayEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_TIME:
+            time_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_FEEDBACK:
+            feedback_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_MIX:
+            mix_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        default:
+            break;
     }
 }
 
 float DelayEffect::getParameter(const std::string& name) const {
-    if (name == "time") return time_;
-    if (name == "feedback") return feedback_;
-    if (name == "mix") return mix_;
+    if (name == "time") return time_.getRequestedValue();
+    if (name == "feedback") return feedback_.getRequestedValue();
+    if (name == "mix") return mix_.getRequestedValue();
     return 0.0f;
 }
 
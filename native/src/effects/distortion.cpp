@@ -8,10 +8,14 @@ DistortionEffect::DistortionEffect()
     : gain_(50.0f)
     , tone_(50.0f)
     , level_(50.0f)
+    , shaper_(Waveshaper::Curve::HardClip)
 {
-    lowpass_state_[0] = 0.0f;
-    lowpass_state_[1] = 0.0f;
+    for (auto& state : lowpass_state_) {
+        state[0] = 0.0f;
+        state[1] = 0.0f;
+    }
     lowpass_coeff_ = 0.5f;
+    oversampler_.prepare();
 }
 
 void DistortionEffect::setSampleRate(uint32_t sampleRate) {
@@ -22,67 +26,142 @@ void DistortionEffect::setSampleRate(uint32_t sampleRate) {
 void DistortionEffect::updateToneFilter() {
     // Filtre passe-bas simple (1-pole)
     // Tone: 0 = dark, 100 = bright
-    float cutoff = 2000.0f + (tone_ / 100.0f) * 18000.0f; // 2kHz à 20kHz
+    float cutoff = 2000.0f + (tone_.getCurrentValue() / 100.0f) * 18000.0f; // 2kHz à 20kHz
     float rc = 1.0f / (2.0f * 3.14159f * cutoff);
     float dt = 1.0f / sample_rate_;
     lowpass_coeff_ = dt / (rc + dt);
 }
 
-void DistortionEffect::process(float* input, float* output, uint32_t frameCount) {
+void DistortionEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    float gainLinear = gain_ / 50.0f * 10.0f; // 0-10x
-    float levelLinear = level_ / 100.0f;
+    const float toneMix = beginTone(frameCount);
     
+    // Gain d'entrée au taux de base
     for (uint32_t i = 0; i < frameCount; ++i) {
-        float sample = input[i] * gainLinear;
-        
-        // Hard clipping
-        sample = std::max(-1.0f, std::min(1.0f, sample));
-        
-        // Filtre tone (passe-bas)
-        float filtered = sample;
-        filtered = filtered + lowpass_coeff_ * (lowpass_state_[0] - filtered);
-        lowpass_state_[0] = filtered;
-        filtered = filtered + lowpass_coeff_ * (lowpass_state_[1] - filtered);
-        lowpass_state_[1] = filtered;
-        
-        // Mix tone
-        sample = sample * (1.0f - tone_ / 100.0f) + filtered * (tone_ / 100.0f);
+        const float gain = gainLinear(gain_.getNextValue());
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            output[ch][i] = input[ch][i] * gain;
+        }
+    }
+    
+    // Hard clipping (ADAA et suréchantillonnage si demandés)
+    oversampler_.process(output, output, channels, frameCount, [this](uint32_t ch, float* samples, uint32_t count) {
+        shaper_.process(ch, samples, count);
+    });
+    
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        const float level = levelLinear(level_.getNextValue());
         
-        // Level
-        output[i] = sample * levelLinear;
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            float sample = output[ch][i];
+            
+            // Filtre tone (passe-bas)
+            float* state = lowpass_state_[ch];
+            float filtered = sample;
+            filtered = filtered + lowpass_coeff_ * (state[0] - filtered);
+            state[0] = filtered;
+            filtered = filtered + lowpass_coeff_ * (state[1] - filtered);
+            state[1] = filtered;
+            
+            // Mix tone
+            sample = sample * (1.0f - toneMix) + filtered * toneMix;
+            
+            // Level
+            output[ch][i] = sample * level;
+        }
+    }
+}
+
+float DistortionEffect::beginTone(uint32_t frameCount) {
+    if (tone_.isSmoothing()) {
+        tone_.skip(frameCount);
+        updateToneFilter();
     }
+    return tone_.getCurrentValue() / 100.0f;
+}
+
+EffectBase::FusedKind DistortionEffect::getFusedKind() const {
+    if (!oversampler_.isPassthrough() || shaper_.getMode() != Waveshaper::Mode::Naive) {
+        return FusedKind::None;
+    }
+    return FusedKind::Distortion;
+}
+
+DistortionEffect::FusedStage DistortionEffect::beginFused(uint32_t frameCount) {
+    const float toneMix = beginTone(frameCount);
+    return FusedStage(FusedGain<&DistortionEffect::gainLinear>(gain_), FusedShape<Waveshaper::Curve::HardClip>(),
+                      FusedTone(lowpass_state_, lowpass_coeff_, toneMix), FusedGain<&DistortionEffect::levelLinear>(level_));
+}
+
+uint32_t DistortionEffect::getLatency() const {
+    const float latency = oversampler_.getLatency() + shaper_.getLatency() / static_cast<float>(oversampler_.getEffectiveFactor());
+    return static_cast<uint32_t>(std::lround(latency));
 }
 
 std::vector<EffectBase::Parameter> DistortionEffect::getParameters() const {
     return {
-        {"gain", "Gain", 0.0f, 100.0f, 50.0f, gain_},
-        {"tone", "Tone", 0.0f, 100.0f, 50.0f, tone_},
-        {"level", "Level", 0.0f, 100.0f, 50.0f, level_}
+        {"gain", "Gain", 0.0f, 100.0f, 50.0f, gain_.getRequestedValue()},
+        {"tone", "Tone", 0.0f, 100.0f, 50.0f, tone_.getRequestedValue()},
+        {"level", "Level", 0.0f, 100.0f, 50.0f, level_.getRequestedValue()},
+        {"oversampling", "Oversampling", 1.0f, 8.0f, 1.0f, static_cast<float>(oversampler_.getFactor())},
+        {"oversamplingPhase", "Oversampling Phase", 0.0f, 1.0f, 0.0f, static_cast<float>(oversampler_.getPhase())},
+        {"antialiasing", "Anti-aliasing", 0.0f, 2.0f, 0.0f, static_cast<float>(shaper_.getMode())}
     };
 }
 
 void DistortionEffect::setParameter(const std::string& name, float value) {
     if (name == "gain") {
-        gain_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_GAIN, value);
     } else if (name == "tone") {
-        tone_ = std::max(0.0f, std::min(100.0f, value));
-        updateToneFilter();
+        setParameterByIndex(PARAM_TONE, value);
     } else if (name == "level") {
-        level_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_LEVEL, value);
+    } else if (name == "oversampling") {
+        setParameterByIndex(PARAM_OVERSAMPLING, value);
+    } else if (name == "oversamplingPhase") {
+        setParameterByIndex(PARAM_OVERSAMPLING_PHASE, value);
+    } else if (name == "antialiasing") {
+        setParameterByIndex(PARAM_ANTIALIASING, value);
+    }
+}
+
+void DistortionEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_GAIN:
+            gain_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_TONE:
+            tone_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_LEVEL:
+            level_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_OVERSAMPLING:
+            oversampler_.setFactor(static_cast<uint32_t>(std::max(1.0f, value) + 0.5f));
+            break;
+        case PARAM_OVERSAMPLING_PHASE:
+            oversampler_.setPhase(value >= 0.5f ? Oversampler::Phase::Minimum : Oversampler::Phase::Linear);
+            break;
+        case PARAM_ANTIALIASING:
+            shaper_.setMode(static_cast<Waveshaper::Mode>(static_cast<uint32_t>(std::max(0.0f, std::min(2.0f, value)) + 0.5f)));
+            break;
+        default:
+            break;
     }
 }
 
 float DistortionEffect::getParameter(const std::string& name) const {
-    if (name == "gain") return gain_;
-    if (name == "tone") return tone_;
-    if (name == "level") return level_;
+    if (name == "gain") return gain_.getRequestedValue();
+    if (name == "tone") return tone_.getRequestedValue();
+    if (name == "level") return level_.getRequestedValue();
+    if (name == "oversampling") return static_cast<float>(oversampler_.getFactor());
+    if (name == "oversamplingPhase") return static_cast<float>(oversampler_.getPhase());
+    if (name == "antialiasing") return static_cast<float>(shaper_.getMode());
     return 0.0f;
 }
 
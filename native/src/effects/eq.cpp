@@ -15,47 +15,70 @@ EQEffect::EQEffect()
 void EQEffect::setSampleRate(uint32_t sampleRate) {
     EffectBase::setSampleRate(sampleRate);
     updateFilters();
+    
+    // Changement de fréquence d'échantillonnage : repartir d'un état propre
+    for (BiquadFilter* filter : {&low_filter_, &mid_filter_, &high_filter_}) {
+        for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+            filter->x1[ch] = filter->x2[ch] = 0.0f;
+            filter->y1[ch] = filter->y2[ch] = 0.0f;
+        }
+    }
 }
 
-void EQEffect::process(float* input, float* output, uint32_t frameCount) {
+void EQEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    // Copier l'input
-    std::vector<float> workBuffer(frameCount);
-    for (uint32_t i = 0; i < frameCount; ++i) {
-        workBuffer[i] = input[i];
+    // Coefficients des bandes recalculés une fois par bloc pendant la rampe
+    if (low_.isSmoothing() || mid_.isSmoothing() || high_.isSmoothing()) {
+        low_.skip(frameCount);
+        mid_.skip(frameCount);
+        high_.skip(frameCount);
+        updateFilters();
     }
     
-    // Appliquer les filtres EQ
-    processBiquad(low_filter_, workBuffer.data(), workBuffer.data(), frameCount);
-    processBiquad(mid_filter_, workBuffer.data(), workBuffer.data(), frameCount);
-    processBiquad(high_filter_, workBuffer.data(), workBuffer.data(), frameCount);
+    // Appliquer les filtres EQ canal par canal (en place dans la sortie, sans allocation)
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+        processBiquad(low_filter_, ch, input[ch], output[ch], frameCount);
+        processBiquad(mid_filter_, ch, output[ch], output[ch], frameCount);
+        processBiquad(high_filter_, ch, output[ch], output[ch], frameCount);
+    }
     
     // Appliquer le niveau
-    const float levelGain = level_ * 2.0f;
     for (uint32_t i = 0; i < frameCount; ++i) {
-        output[i] = workBuffer[i] * levelGain;
+        const float gain = level_.getNextValue() * 2.0f;
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            output[ch][i] *= gain;
+        }
     }
 }
 
-void EQEffect::processBiquad(BiquadFilter& filter, float* input, float* output, uint32_t frameCount) {
+void EQEffect::processBiquad(BiquadFilter& filter, uint32_t channel, const float* input, float* output, uint32_t frameCount) {
+    // État en registres pendant le bloc
+    float x1 = filter.x1[channel];
+    float x2 = filter.x2[channel];
+    float y1 = filter.y1[channel];
+    float y2 = filter.y2[channel];
+    
     for (uint32_t i = 0; i < frameCount; ++i) {
         float x = input[i];
-        float y = filter.b0 * x + filter.b1 * filter.x1 + filter.b2 * filter.x2
-                 - filter.a1 * filter.y1 - filter.a2 * filter.y2;
+        float y = filter.b0 * x + filter.b1 * x1 + filter.b2 * x2
+                 - filter.a1 * y1 - filter.a2 * y2;
         
-        filter.x2 = filter.x1;
-        filter.x1 = x;
-        filter.y2 = filter.y1;
-        filter.y1 = y;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
         
         output[i] = y;
     }
+    
+    filter.x1[channel] = x1;
+    filter.x2[channel] = x2;
+    filter.y1[channel] = y1;
+    filter.y2[channel] = y2;
 }
 
 void EQEffect::setBiquadPeak(BiquadFilter& filter, float freq, float gain, float q, float sampleRate) {
@@ -78,50 +101,66 @@ void EQEffect::setBiquadPeak(BiquadFilter& filter, float freq, float gain, float
     filter.a1 = a1 / a0;
     filter.a2 = a2 / a0;
     
-    filter.x1 = filter.x2 = 0.0f;
-    filter.y1 = filter.y2 = 0.0f;
+    // L'état du filtre est conservé : pas de clic quand les coefficients changent
 }
 
 void EQEffect::updateFilters() {
     // Low: 100Hz, Q=1.0
-    setBiquadPeak(low_filter_, 100.0f, low_, 1.0f, sample_rate_);
+    setBiquadPeak(low_filter_, 100.0f, low_.getCurrentValue(), 1.0f, sample_rate_);
     
     // Mid: 1000Hz, Q=1.0
-    setBiquadPeak(mid_filter_, 1000.0f, mid_, 1.0f, sample_rate_);
+    setBiquadPeak(mid_filter_, 1000.0f, mid_.getCurrentValue(), 1.0f, sample_rate_);
     
     // High: 5000Hz, Q=1.0
-    setBiquadPeak(high_filter_, 5000.0f, high_, 1.0f, sample_rate_);
+    setBiquadPeak(high_filter_, 5000.0f, high_.getCurrentValue(), 1.0f, sample_rate_);
 }
 
 std::vector<EffectBase::Parameter> EQEffect::getParameters() const {
     return {
-        {"low", "Low", -12.0f, 12.0f, 0.0f, low_},
-        {"mid", "Mid", -12.0f, 12.0f, 0.0f, mid_},
-        {"high", "High", -12.0f, 12.0f, 0.0f, high_},
-        {"level", "Level", 0.0f, 1.0f, 0.5f, level_}
+        {"low", "Low", -12.0f, 12.0f, 0.0f, low_.getRequestedValue()},
+        {"mid", "Mid", -12.0f, 12.0f, 0.0f, mid_.getRequestedValue()},
+        {"high", "High", -12.0f, 12.0f, 0.0f, high_.getRequestedValue()},
+        {"level", "Level", 0.0f, 1.0f, 0.5f, level_.getRequestedValue()}
     };
 }
 
 void EQEffect::setParameter(const std::string& name, float value) {
     if (name == "low") {
-        low_ = std::max(-12.0f, std::min(12.0f, value));
-        updateFilters();
+        setParameterByIndex(PARAM_LOW, value);
     } else if (name == "mid") {
-        mid_ = std::max(-12.0f, std::min(12.0f, value));
-        updateFilters();
+        setParameterByIndex(PARAM_MID, value);
     } else if (name == "high") {
-        high_ = std::max(-12.0f, std::min(12.0f, value));
-        updateFilters();
+        setParameterByIndex(PARAM_HIGH, value);
     } else if (name == "level") {
-        level_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_LEVEL, value);
+    }
+}
+
+void EQEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_LOW:
+            low_.setTarget(std::max(-12.0f, std::min(12.0f, value)), ramp);
+            break;
+        case PARAM_MID:
+            mid_.setTarget(std::max(-12.0f, std::min(12.0f, value)), ramp);
+            break;
+        case PARAM_HIGH:
+            high_.setTarget(std::max(-12.0f, std::min(12.0f, value)), ramp);
+            break;
+        case PARAM_LEVEL:
+            level_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        default:
+            break;
     }
 }
 
 float EQEffect::getParameter(const std::string& name) const {
-    if (name == "low") return low_;
-    if (name == "mid") return mid_;
-    if (name == "high") return high_;
-    if (name == "level") return level_;
+    if (name == "low") return low_.getRequestedValue();
+    if (name == "mid") return mid_.getRequestedValue();
+    if (name == "high") return high_.getRequestedValue();
+    if (name == "level") return level_.getRequestedValue();
     return 0.0f;
 }
 
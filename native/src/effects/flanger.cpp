@@ -8,29 +8,56 @@ FlangerEffect::FlangerEffect()
     : rate_(0.5f), depth_(0.5f), feedback_(0.3f), manual_(0.5f), resonance_(0.5f),
       delay_buffer_size_(0), write_index_(0),
       lfo_phase_(0.0f), lfo_increment_(0.0f) {
+    for (auto& buffer : delay_buffer_) {
+        buffer = nullptr;
+    }
+    allocateMemory();
 }
 
 void FlangerEffect::setSampleRate(uint32_t sampleRate) {
     EffectBase::setSampleRate(sampleRate);
-    
-    // Buffer de delay pour ~10ms max
-    delay_buffer_size_ = static_cast<size_t>(sampleRate * 0.01f);
-    delay_buffer_.resize(delay_buffer_size_, 0.0f);
-    write_index_ = 0;
-    
+    allocateMemory();
     updateLFO();
 }
 
-void FlangerEffect::process(float* input, float* output, uint32_t frameCount) {
+void FlangerEffect::layoutMemory(ArenaLayout& layout) {
+    // Retard maximal + 2 samples (interpolation entre index1 et index2)
+    const size_t size = static_cast<size_t>(std::ceil(MAX_DELAY_SECONDS * layout.getSampleRate())) + 2;
+    for (auto& buffer : delay_buffer_) {
+        layout.allocate(buffer, size);
+    }
+    if (!layout.isMeasuring()) {
+        delay_buffer_size_ = size;
+    }
+}
+
+void FlangerEffect::onMemoryBound() {
+    write_index_ = 0;
+}
+
+uint32_t FlangerEffect::getTailLength() const {
+    // Délai maximal : borne haute de la boucle de feedback
+    const float feedback = std::max(feedback_.getCurrentValue(), feedback_.getTargetValue());
+    return getFeedbackTail(std::ceil(MAX_DELAY_SECONDS * sample_rate_), feedback);
+}
+
+void FlangerEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    updateMemory();
+    
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
+    // Incrément du LFO recalculé une fois par bloc pendant la rampe
+    if (rate_.isSmoothing()) {
+        rate_.skip(frameCount);
+        updateLFO();
+    }
+    
     for (uint32_t i = 0; i < frameCount; ++i) {
-        float delayTime = getDelayTime();
+        const float depth = depth_.getNextValue();
+        float delayTime = getDelayTime(depth, manual_.getNextValue());
         float delaySamples = delayTime * sample_rate_;
         
         // Lire depuis le buffer de delay avec interpolation
@@ -41,24 +68,30 @@ void FlangerEffect::process(float* input, float* output, uint32_t frameCount) {
         size_t index2 = (index1 + 1) % delay_buffer_size_;
         float frac = readIndex - index1;
         
-        float delayed = delay_buffer_[index1] * (1.0f - frac) + delay_buffer_[index2] * frac;
+        const float feedback = feedback_.getNextValue();
         
-        // Feedback
-        float feedbackSample = delayed * feedback_;
-        
-        // Écrire dans le buffer (input + feedback)
-        delay_buffer_[write_index_] = input[i] + feedbackSample;
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            float* buffer = delay_buffer_[ch];
+            const float delayed = buffer[index1] * (1.0f - frac) + buffer[index2] * frac;
+            const float sample = input[ch][i];
+            
+            // Écrire dans le buffer (input + feedback)
+            buffer[write_index_] = sample + delayed * feedback;
+            
+            // Mix dry/wet
+            output[ch][i] = sample + delayed * depth;
+        }
         write_index_ = (write_index_ + 1) % delay_buffer_size_;
         
-        // Mix dry/wet
-        output[i] = input[i] + delayed * depth_;
-        
-        updateLFO();
+        advanceLFO();
     }
 }
 
 void FlangerEffect::updateLFO() {
-    lfo_increment_ = (2.0f * 3.14159f * rate_) / sample_rate_;
+    lfo_increment_ = (2.0f * 3.14159f * rate_.getCurrentValue()) / sample_rate_;
+}
+
+void FlangerEffect::advanceLFO() {
     lfo_phase_ += lfo_increment_;
     if (lfo_phase_ >= 2.0f * 3.14159f) {
         lfo_phase_ -= 2.0f * 3.14159f;
@@ -69,43 +102,65 @@ float FlangerEffect::getLFOValue() const {
     return sinf(lfo_phase_);
 }
 
-float FlangerEffect::getDelayTime() const {
+float FlangerEffect::getDelayTime(float depth, float manual) const {
     // Delay de base: 1-5ms selon manual, modulation: ±2ms
-    float baseDelay = 0.001f + manual_ * 0.004f; // 1-5ms
-    float modRange = 0.002f * depth_; // ±2ms
+    float baseDelay = 0.001f + manual * 0.004f; // 1-5ms
+    float modRange = 0.002f * depth; // ±2ms
     return baseDelay + modRange * getLFOValue();
 }
 
 std::vector<EffectBase::Parameter> FlangerEffect::getParameters() const {
     return {
-        {"rate", "Rate", 0.1f, 5.0f, 0.5f, rate_},
-        {"depth", "Depth", 0.0f, 1.0f, 0.5f, depth_},
-        {"feedback", "Feedback", 0.0f, 1.0f, 0.3f, feedback_},
-        {"manual", "Manual", 0.0f, 1.0f, 0.5f, manual_},
+        {"rate", "Rate", 0.1f, 5.0f, 0.5f, rate_.getRequestedValue()},
+        {"depth", "Depth", 0.0f, 1.0f, 0.5f, depth_.getRequestedValue()},
+        {"feedback", "Feedback", 0.0f, 1.0f, 0.3f, feedback_.getRequestedValue()},
+        {"manual", "Manual", 0.0f, 1.0f, 0.5f, manual_.getRequestedValue()},
         {"resonance", "Resonance", 0.0f, 1.0f, 0.5f, resonance_}
     };
 }
 
 void FlangerEffect::setParameter(const std::string& name, float value) {
     if (name == "rate") {
-        rate_ = std::max(0.1f, std::min(5.0f, value));
-        updateLFO();
+        setParameterByIndex(PARAM_RATE, value);
     } else if (name == "depth") {
-        depth_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_DEPTH, value);
     } else if (name == "feedback") {
-        feedback_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_FEEDBACK, value);
     } else if (name == "manual") {
-        manual_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_MANUAL, value);
     } else if (name == "resonance") {
-        resonance_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_RESONANCE, value);
+    }
+}
+
+void FlangerEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_RATE:
+            rate_.setTarget(std::max(0.1f, std::min(5.0f, value)), ramp);
+            break;
+        case PARAM_DEPTH:
+            depth_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_FEEDBACK:
+            feedback_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_MANUAL:
+            manual_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_RESONANCE:
+            resonance_ = std::max(0.0f, std::min(1.0f, value));
+            break;
+        default:
+            break;
     }
 }
 
 float FlangerEffect::getParameter(const std::string& name) const {
-    if (name == "rate") return rate_;
-    if (name == "depth") return depth_;
-    if (name == "feedback") return feedback_;
-    if (name == "manual") return manual_;
+    if (name == "rate") return rate_.getRequestedValue();
+    if (name == "depth") return depth_.getRequestedValue();
+    if (name == "feedback") return feedback_.getRequestedValue();
+    if (name == "manual") return manual_.getRequestedValue();
     if (name == "resonance") return resonance_;
     return 0.0f;
 }
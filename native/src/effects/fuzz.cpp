@@ -6,7 +6,9 @@ namespace webamp {
 
 FuzzEffect::FuzzEffect()
     : fuzz_(0.5f), tone_(0.5f), volume_(0.5f),
-      lowpass_state_{0.0f, 0.0f}, lowpass_coeff_(0.0f) {
+      lowpass_state_{}, lowpass_coeff_(0.0f),
+      shaper_(Waveshaper::Curve::Fuzz) {
+    oversampler_.prepare();
 }
 
 void FuzzEffect::setSampleRate(uint32_t sampleRate) {
@@ -14,75 +16,143 @@ void FuzzEffect::setSampleRate(uint32_t sampleRate) {
     updateToneFilter();
 }
 
-void FuzzEffect::process(float* input, float* output, uint32_t frameCount) {
+void FuzzEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    const float fuzzGain = fuzz_ * 10.0f + 1.0f; // 1x à 11x
-    const float volumeGain = volume_ * 2.0f;
+    const float toneMix = beginTone(frameCount);
     
+    // Gain d'entrée au taux de base
     for (uint32_t i = 0; i < frameCount; ++i) {
-        float sample = input[i] * fuzzGain;
-        
-        // Fuzz avec hard clipping extrême
-        sample = fuzzClip(sample);
-        
-        // Filtre tone (passe-bas)
-        float filtered = sample;
-        filtered = filtered + lowpass_coeff_ * (lowpass_state_[0] - filtered);
-        lowpass_state_[0] = filtered;
-        filtered = filtered + lowpass_coeff_ * (lowpass_state_[1] - filtered);
-        lowpass_state_[1] = filtered;
-        
-        // Mix tone
-        sample = sample * (1.0f - tone_) + filtered * tone_;
+        const float gain = fuzzGain(fuzz_.getNextValue());
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            output[ch][i] = input[ch][i] * gain;
+        }
+    }
+    
+    // Fuzz avec hard clipping extrême (ADAA et suréchantillonnage si demandés)
+    oversampler_.process(output, output, channels, frameCount, [this](uint32_t ch, float* samples, uint32_t count) {
+        shaper_.process(ch, samples, count);
+    });
+    
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        const float volume = volumeGain(volume_.getNextValue());
         
-        output[i] = sample * volumeGain;
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            float sample = output[ch][i];
+            
+            // Filtre tone (passe-bas)
+            float* state = lowpass_state_[ch];
+            float filtered = sample;
+            filtered = filtered + lowpass_coeff_ * (state[0] - filtered);
+            state[0] = filtered;
+            filtered = filtered + lowpass_coeff_ * (state[1] - filtered);
+            state[1] = filtered;
+            
+            // Mix tone
+            sample = sample * (1.0f - toneMix) + filtered * toneMix;
+            
+            output[ch][i] = sample * volume;
+        }
     }
 }
 
-float FuzzEffect::fuzzClip(float x) const {
-    // Hard clipping extrême avec saturation
-    x = std::max(-1.0f, std::min(1.0f, x));
-    // Compression supplémentaire pour le caractère fuzz
-    return x * (1.0f - 0.3f * fabsf(x));
-}
-
 void FuzzEffect::updateToneFilter() {
     // Filtre passe-bas pour le tone control
-    float cutoff = 20000.0f - (tone_ * 15000.0f); // 5kHz à 20kHz
+    float cutoff = 20000.0f - (tone_.getCurrentValue() * 15000.0f); // 5kHz à 20kHz
     float rc = 1.0f / (2.0f * 3.14159f * cutoff);
     float dt = 1.0f / sample_rate_;
     lowpass_coeff_ = dt / (rc + dt);
 }
 
+float FuzzEffect::beginTone(uint32_t frameCount) {
+    if (tone_.isSmoothing()) {
+        tone_.skip(frameCount);
+        updateToneFilter();
+    }
+    return tone_.getCurrentValue();
+}
+
+EffectBase::FusedKind FuzzEffect::getFusedKind() const {
+    if (!oversampler_.isPassthrough() || shaper_.getMode() != Waveshaper::Mode::Naive) {
+        return FusedKind::None;
+    }
+    return FusedKind::Fuzz;
+}
+
+FuzzEffect::FusedStage FuzzEffect::beginFused(uint32_t frameCount) {
+    const float toneMix = beginTone(frameCount);
+    return FusedStage(FusedGain<&FuzzEffect::fuzzGain>(fuzz_), FusedShape<Waveshaper::Curve::Fuzz>(),
+                      FusedTone(lowpass_state_, lowpass_coeff_, toneMix), FusedGain<&FuzzEffect::volumeGain>(volume_));
+}
+
+uint32_t FuzzEffect::getLatency() const {
+    const float latency = oversampler_.getLatency() + shaper_.getLatency() / static_cast<float>(oversampler_.getEffectiveFactor());
+    return static_cast<uint32_t>(std::lround(latency));
+}
+
 std::vector<EffectBase::Parameter> FuzzEffect::getParameters() const {
     return {
-        {"fuzz", "Fuzz", 0.0f, 1.0f, 0.5f, fuzz_},
-        {"tone", "Tone", 0.0f, 1.0f, 0.5f, tone_},
-        {"volume", "Volume", 0.0f, 1.0f, 0.5f, volume_}
+        {"fuzz", "Fuzz", 0.0f, 1.0f, 0.5f, fuzz_.getRequestedValue()},
+        {"tone", "Tone", 0.0f, 1.0f, 0.5f, tone_.getRequestedValue()},
+        {"volume", "Volume", 0.0f, 1.0f, 0.5f, volume_.getRequestedValue()},
+        {"oversampling", "Oversampling", 1.0f, 8.0f, 1.0f, static_cast<float>(oversampler_.getFactor())},
+        {"oversamplingPhase", "Oversampling Phase", 0.0f, 1.0f, 0.0f, static_cast<float>(oversampler_.getPhase())},
+        {"antialiasing", "Anti-aliasing", 0.0f, 2.0f, 0.0f, static_cast<float>(shaper_.getMode())}
     };
 }
 
 void FuzzEffect::setParameter(const std::string& name, float value) {
     if (name == "fuzz") {
-        fuzz_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_FUZZ, value);
     } else if (name == "tone") {
-        tone_ = std::max(0.0f, std::min(1.0f, value));
-        updateToneFilter();
+        setParameterByIndex(PARAM_TONE, value);
     } else if (name == "volume") {
-        volume_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_VOLUME, value);
+    } else if (name == "oversampling") {
+        setParameterByIndex(PARAM_OVERSAMPLING, value);
+    } else if (name == "oversamplingPhase") {
+        setParameterByIndex(PARAM_OVERSAMPLING_PHASE, value);
+    } else if (name == "antialiasing") {
+        setParameterByIndex(PARAM_ANTIALIASING, value);
+    }
+}
+
+void FuzzEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_FUZZ:
+            fuzz_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_TONE:
+            tone_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_VOLUME:
+            volume_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_OVERSAMPLING:
+            oversampler_.setFactor(static_cast<uint32_t>(std::max(1.0f, value) + 0.5f));
+            break;
+        case PARAM_OVERSAMPLING_PHASE:
+            oversampler_.setPhase(value >= 0.5f ? Oversampler::Phase::Minimum : Oversampler::Phase::Linear);
+            break;
+        case PARAM_ANTIALIASING:
+            shaper_.setMode(static_cast<Waveshaper::Mode>(static_cast<uint32_t>(std::max(0.0f, std::min(2.0f, value)) + 0.5f)));
+            break;
+        default:
+            break;
     }
 }
 
 float FuzzEffect::getParameter(const std::string& name) const {
-    if (name == "fuzz") return fuzz_;
-    if (name == "tone") return tone_;
-    if (name == "volume") return volume_;
+    if (name == "fuzz") return fuzz_.getRequestedValue();
+    if (name == "tone") return tone_.getRequestedValue();
+    if (name == "volume") return volume_.getRequestedValue();
+    if (name == "oversampling") return static_cast<float>(oversampler_.getFactor());
+    if (name == "oversamplingPhase") return static_cast<float>(oversampler_.getPhase());
+    if (name == "antialiasing") return static_cast<float>(shaper_.getMode());
     return 0.0f;
 }
 
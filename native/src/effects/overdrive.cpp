@@ -6,7 +6,9 @@ namespace webamp {
 
 OverdriveEffect::OverdriveEffect()
     : drive_(0.5f), tone_(0.5f), level_(0.5f),
-      lowpass_state_{0.0f, 0.0f}, lowpass_coeff_(0.0f) {
+      lowpass_state_{}, lowpass_coeff_(0.0f),
+      shaper_(Waveshaper::Curve::Tanh) {
+    oversampler_.prepare();
 }
 
 void OverdriveEffect::setSampleRate(uint32_t sampleRate) {
@@ -14,74 +16,144 @@ void OverdriveEffect::setSampleRate(uint32_t sampleRate) {
     updateToneFilter();
 }
 
-void OverdriveEffect::process(float* input, float* output, uint32_t frameCount) {
+void OverdriveEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    const float driveGain = drive_ * 3.0f + 1.0f; // 1x à 4x
-    const float levelGain = level_ * 2.0f;
+    const float toneMix = beginTone(frameCount);
     
+    // Gain d'entrée au taux de base
     for (uint32_t i = 0; i < frameCount; ++i) {
-        float sample = input[i] * driveGain;
-        
-        // Soft clipping avec tanh
-        sample = softClip(sample);
-        
-        // Filtre tone (passe-bas)
-        float filtered = sample;
-        filtered = filtered + lowpass_coeff_ * (lowpass_state_[0] - filtered);
-        lowpass_state_[0] = filtered;
-        filtered = filtered + lowpass_coeff_ * (lowpass_state_[1] - filtered);
-        lowpass_state_[1] = filtered;
-        
-        // Mix tone
-        sample = sample * (1.0f - tone_) + filtered * tone_;
+        const float gain = driveGain(drive_.getNextValue());
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            output[ch][i] = input[ch][i] * gain;
+        }
+    }
+    
+    // Soft clipping avec tanh (ADAA et suréchantillonnage si demandés)
+    oversampler_.process(output, output, channels, frameCount, [this](uint32_t ch, float* samples, uint32_t count) {
+        shaper_.process(ch, samples, count);
+    });
+    
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        const float level = levelGain(level_.getNextValue());
         
-        output[i] = sample * levelGain;
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            float sample = output[ch][i];
+            
+            // Filtre tone (passe-bas)
+            float* state = lowpass_state_[ch];
+            float filtered = sample;
+            filtered = filtered + lowpass_coeff_ * (state[0] - filtered);
+            state[0] = filtered;
+            filtered = filtered + lowpass_coeff_ * (state[1] - filtered);
+            state[1] = filtered;
+            
+            // Mix tone
+            sample = sample * (1.0f - toneMix) + filtered * toneMix;
+            
+            output[ch][i] = sample * level;
+        }
     }
 }
 
-float OverdriveEffect::softClip(float x) const {
-    // Soft clipping avec tanh (plus doux que hard clipping)
-    return tanhf(x * 2.0f) * 0.5f;
-}
-
 void OverdriveEffect::updateToneFilter() {
     // Filtre passe-bas pour le tone control
     // Tone = 0: pas de filtre, Tone = 1: filtre très bas
-    float cutoff = 20000.0f - (tone_ * 18000.0f); // 2kHz à 20kHz
+    float cutoff = 20000.0f - (tone_.getCurrentValue() * 18000.0f); // 2kHz à 20kHz
     float rc = 1.0f / (2.0f * 3.14159f * cutoff);
     float dt = 1.0f / sample_rate_;
     lowpass_coeff_ = dt / (rc + dt);
 }
 
+float OverdriveEffect::beginTone(uint32_t frameCount) {
+    if (tone_.isSmoothing()) {
+        tone_.skip(frameCount);
+        updateToneFilter();
+    }
+    return tone_.getCurrentValue();
+}
+
+EffectBase::FusedKind OverdriveEffect::getFusedKind() const {
+    if (!oversampler_.isPassthrough() || shaper_.getMode() != Waveshaper::Mode::Naive) {
+        return FusedKind::None;
+    }
+    return FusedKind::Overdrive;
+}
+
+OverdriveEffect::FusedStage OverdriveEffect::beginFused(uint32_t frameCount) {
+    const float toneMix = beginTone(frameCount);
+    return FusedStage(FusedGain<&OverdriveEffect::driveGain>(drive_), FusedShape<Waveshaper::Curve::Tanh>(),
+                      FusedTone(lowpass_state_, lowpass_coeff_, toneMix), FusedGain<&OverdriveEffect::levelGain>(level_));
+}
+
+uint32_t OverdriveEffect::getLatency() const {
+    const float latency = oversampler_.getLatency() + shaper_.getLatency() / static_cast<float>(oversampler_.getEffectiveFactor());
+    return static_cast<uint32_t>(std::lround(latency));
+}
+
 std::vector<EffectBase::Parameter> OverdriveEffect::getParameters() const {
     return {
-        {"drive", "Drive", 0.0f, 1.0f, 0.5f, drive_},
-        {"tone", "Tone", 0.0f, 1.0f, 0.5f, tone_},
-        {"level", "Level", 0.0f, 1.0f, 0.5f, level_}
+        {"drive", "Drive", 0.0f, 1.0f, 0.5f, drive_.getRequestedValue()},
+        {"tone", "Tone", 0.0f, 1.0f, 0.5f, tone_.getRequestedValue()},
+        {"level", "Level", 0.0f, 1.0f, 0.5f, level_.getRequestedValue()},
+        {"oversampling", "Oversampling", 1.0f, 8.0f, 1.0f, static_cast<float>(oversampler_.getFactor())},
+        {"oversamplingPhase", "Oversampling Phase", 0.0f, 1.0f, 0.0f, static_cast<float>(oversampler_.getPhase())},
+        {"antialiasing", "Anti-aliasing", 0.0f, 2.0f, 0.0f, static_cast<float>(shaper_.getMode())}
     };
 }
 
 void OverdriveEffect::setParameter(const std::string& name, float value) {
     if (name == "drive") {
-        drive_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_DRIVE, value);
     } else if (name == "tone") {
-        tone_ = std::max(0.0f, std::min(1.0f, value));
-        updateToneFilter();
+        setParameterByIndex(PARAM_TONE, value);
     } else if (name == "level") {
-        level_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_LEVEL, value);
+    } else if (name == "oversampling") {
+        setParameterByIndex(PARAM_OVERSAMPLING, value);
+    } else if (name == "oversamplingPhase") {
+        setParameterByIndex(PARAM_OVERSAMPLING_PHASE, value);
+    } else if (name == "antialiasing") {
+        setParameterByIndex(PARAM_ANTIALIASING, value);
+    }
+}
+
+void OverdriveEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_DRIVE:
+            drive_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_TONE:
+            tone_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_LEVEL:
+            level_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_OVERSAMPLING:
+            oversampler_.setFactor(static_cast<uint32_t>(std::max(1.0f, value) + 0.5f));
+            break;
+        case PARAM_OVERSAMPLING_PHASE:
+            oversampler_.setPhase(value >= 0.5f ? Oversampler::Phase::Minimum : Oversampler::Phase::Linear);
+            break;
+        case PARAM_ANTIALIASING:
+            shaper_.setMode(static_cast<Waveshaper::Mode>(static_cast<uint32_t>(std::max(0.0f, std::min(2.0f, value)) + 0.5f)));
+            break;
+        default:
+            break;
     }
 }
 
 float OverdriveEffect::getParameter(const std::string& name) const {
-    if (name == "drive") return drive_;
-    if (name == "tone") return tone_;
-    if (name == "level") return level_;
+    if (name == "drive") return drive_.getRequestedValue();
+    if (name == "tone") return tone_.getRequestedValue();
+    if (name == "level") return level_.getRequestedValue();
+    if (name == "oversampling") return static_cast<float>(oversampler_.getFactor());
+    if (name == "oversamplingPhase") return static_cast<float>(oversampler_.getPhase());
+    if (name == "antialiasing") return static_cast<float>(shaper_.getMode());
     return 0.0f;
 }
 
@@ -6,35 +6,42 @@
 namespace webamp {
 
 // Délais des comb filters (en samples @ 44.1kHz, ajustés par sample rate)
-static constexpr size_t COMB_DELAYS_44K[NUM_COMBS] = {
+static constexpr size_t COMB_DELAYS_44K[ReverbEffect::NUM_COMBS] = {
     1116, 1188, 1277, 1356
 };
 
 // Délais des allpass filters
-static constexpr size_t ALLPASS_DELAYS_44K[NUM_ALLPASS] = {
+static constexpr size_t ALLPASS_DELAYS_44K[ReverbEffect::NUM_ALLPASS] = {
     556, 441
 };
 
+static constexpr float ALLPASS_GAIN = 0.5f;
+
 ReverbEffect::ReverbEffect()
     : room_(50.0f)
     , decay_(50.0f)
     , mix_(50.0f)
+    , active_combs_(NUM_COMBS)
+    , active_allpass_(NUM_ALLPASS)
 {
-    for (int ch = 0; ch < 2; ++ch) {
+    for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
         for (int i = 0; i < NUM_COMBS; ++i) {
-            comb_buffers_[ch][i].resize(2000); // Taille max
-            std::fill(comb_buffers_[ch][i].begin(), comb_buffers_[ch][i].end(), 0.0f);
+            comb_buffers_[ch][i] = nullptr;
             comb_write_pos_[ch][i] = 0;
         }
         for (int i = 0; i < NUM_ALLPASS; ++i) {
-            allpass_buffers_[ch][i].resize(1000);
-            std::fill(allpass_buffers_[ch][i].begin(), allpass_buffers_[ch][i].end(), 0.0f);
+            allpass_buffers_[ch][i] = nullptr;
             allpass_write_pos_[ch][i] = 0;
         }
     }
+    // Longueurs effectives fixées à la liaison de la mémoire
+    std::fill(comb_lengths_, comb_lengths_ + NUM_COMBS, size_t(1));
+    std::fill(allpass_lengths_, allpass_lengths_ + NUM_ALLPASS, size_t(1));
     
     std::copy(COMB_DELAYS_44K, COMB_DELAYS_44K + NUM_COMBS, comb_delays_);
     std::copy(ALLPASS_DELAYS_44K, ALLPASS_DELAYS_44K + NUM_ALLPASS, allpass_delays_);
+    updateReverbParameters();
+    allocateMemory();
 }
 
 ReverbEffect::~ReverbEffect() {
@@ -42,6 +49,43 @@ ReverbEffect::~ReverbEffect() {
 
 void ReverbEffect::setSampleRate(uint32_t sampleRate) {
     EffectBase::setSampleRate(sampleRate);
+    allocateMemory();
+}
+
+void ReverbEffect::layoutMemory(ArenaLayout& layout) {
+    // Délais mis à l'échelle du sample rate courant (+1 : lecture à
+    // writePos - delay), sans plafond : la densité est la même à 192 kHz
+    const float rateScale = layout.getSampleRate() / 44100.0f;
+    size_t combLengths[NUM_COMBS];
+    size_t allpassLengths[NUM_ALLPASS];
+    for (int i = 0; i < NUM_COMBS; ++i) {
+        combLengths[i] = static_cast<size_t>(COMB_DELAYS_44K[i] * rateScale) + 1;
+    }
+    for (int i = 0; i < NUM_ALLPASS; ++i) {
+        allpassLengths[i] = static_cast<size_t>(ALLPASS_DELAYS_44K[i] * rateScale) + 1;
+    }
+    
+    // Par canal, dans l'ordre de traitement : combs puis allpass
+    for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+        for (int i = 0; i < NUM_COMBS; ++i) {
+            layout.allocate(comb_buffers_[ch][i], combLengths[i]);
+        }
+        for (int i = 0; i < NUM_ALLPASS; ++i) {
+            layout.allocate(allpass_buffers_[ch][i], allpassLengths[i]);
+        }
+    }
+    
+    if (!layout.isMeasuring()) {
+        std::copy(combLengths, combLengths + NUM_COMBS, comb_lengths_);
+        std::copy(allpassLengths, allpassLengths + NUM_ALLPASS, allpass_lengths_);
+    }
+}
+
+void ReverbEffect::onMemoryBound() {
+    for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+        std::fill(comb_write_pos_[ch], comb_write_pos_[ch] + NUM_COMBS, size_t(0));
+        std::fill(allpass_write_pos_[ch], allpass_write_pos_[ch] + NUM_ALLPASS, size_t(0));
+    }
     updateReverbParameters();
 }
 
@@ -51,92 +95,156 @@ void ReverbEffect::updateReverbParameters() {
     
     for (int i = 0; i < NUM_COMBS; ++i) {
         comb_delays_[i] = static_cast<size_t>(COMB_DELAYS_44K[i] * rateScale);
-        if (comb_delays_[i] >= comb_buffers_[0][i].size()) {
-            comb_delays_[i] = comb_buffers_[0][i].size() - 1;
+        if (comb_delays_[i] >= comb_lengths_[i]) {
+            comb_delays_[i] = comb_lengths_[i] - 1;
         }
     }
     
     for (int i = 0; i < NUM_ALLPASS; ++i) {
         allpass_delays_[i] = static_cast<size_t>(ALLPASS_DELAYS_44K[i] * rateScale);
-        if (allpass_delays_[i] >= allpass_buffers_[0][i].size()) {
-            allpass_delays_[i] = allpass_buffers_[0][i].size() - 1;
+        if (allpass_delays_[i] >= allpass_lengths_[i]) {
+            allpass_delays_[i] = allpass_lengths_[i] - 1;
         }
     }
     
     // Feedback des comb filters selon decay
-    float decayLinear = decay_ / 100.0f;
+    float decayLinear = decay_.getCurrentValue() / 100.0f;
     for (int i = 0; i < NUM_COMBS; ++i) {
         comb_feedback_[i] = decayLinear * 0.7f; // Limiter à 0.7 pour stabilité
     }
 }
 
-void ReverbEffect::process(float* input, float* output, uint32_t frameCount) {
+uint32_t ReverbEffect::getTailLength() const {
+    // Délais au sample rate courant (indépendants de la liaison de la mémoire)
+    const double rateScale = sample_rate_ / 44100.0;
+    size_t longestComb = 0;
+    float feedback = 0.0f;
+    for (int i = 0; i < active_combs_; ++i) {
+        longestComb = std::max(longestComb, COMB_DELAYS_44K[i]);
+        feedback = std::max(feedback, comb_feedback_[i]);
+    }
+    // Rampe de decay en cours : feedback le plus long des deux
+    feedback = std::max(feedback, decay_.getTargetValue() / 100.0f * 0.7f);
+    uint64_t tail = getFeedbackTail(longestComb * rateScale, feedback);
+    for (int i = 0; i < active_allpass_; ++i) {
+        tail += getFeedbackTail(ALLPASS_DELAYS_44K[i] * rateScale, ALLPASS_GAIN);
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(tail, INFINITE_TAIL - 1));
+}
+
+void ReverbEffect::applyQualityTier(uint32_t tier) {
+    static constexpr int COMBS_PER_TIER[QUALITY_TIERS] = {NUM_COMBS, 2, 1};
+    static constexpr int ALLPASS_PER_TIER[QUALITY_TIERS] = {NUM_ALLPASS, 2, 1};
+    const int combs = COMBS_PER_TIER[tier];
+    const int allpass = ALLPASS_PER_TIER[tier];
+    
+    // Filtres réactivés : leur contenu date de leur arrêt, on repart du
+    // silence (rien à effacer tant que la mémoire n'est pas liée)
+    for (uint32_t ch = 0; ch < MAX_CHANNELS && comb_buffers_[0][0]; ++ch) {
+        for (int i = active_combs_; i < combs; ++i) {
+            std::fill(comb_buffers_[ch][i], comb_buffers_[ch][i] + comb_lengths_[i], 0.0f);
+        }
+        for (int i = active_allpass_; i < allpass; ++i) {
+            std::fill(allpass_buffers_[ch][i], allpass_buffers_[ch][i] + allpass_lengths_[i], 0.0f);
+        }
+    }
+    active_combs_ = combs;
+    active_allpass_ = allpass;
+}
+
+void ReverbEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    updateMemory();
+    
     if (bypass_) {
-        std::copy(input, input + frameCount * 2, output);
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    float mixLinear = mix_ / 100.0f;
-    float dryMix = 1.0f - mixLinear;
-    float roomScale = room_ / 100.0f;
+    // Feedback des combs recalculé une fois par bloc pendant la rampe
+    if (decay_.isSmoothing()) {
+        decay_.skip(frameCount);
+        updateReverbParameters();
+    }
     
     for (uint32_t i = 0; i < frameCount; ++i) {
-        for (int ch = 0; ch < 2; ++ch) {
-            int idx = i * 2 + ch;
-            float sample = input[idx] * roomScale;
+        const float mixLinear = mix_.getNextValue() / 100.0f;
+        const float dryMix = 1.0f - mixLinear;
+        const float roomScale = room_.getNextValue() / 100.0f;
+        
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            const float dry = input[ch][i];
+            float sample = dry * roomScale;
             
             // Comb filters
             float combOut = 0.0f;
-            for (int comb = 0; comb < NUM_COMBS; ++comb) {
-                size_t readPos = (comb_write_pos_[ch][comb] + comb_buffers_[ch][comb].size() - comb_delays_[comb]) % comb_buffers_[ch][comb].size();
+            for (int comb = 0; comb < active_combs_; ++comb) {
+                size_t readPos = (comb_write_pos_[ch][comb] + comb_lengths_[comb] - comb_delays_[comb]) % comb_lengths_[comb];
                 float delayed = comb_buffers_[ch][comb][readPos];
                 combOut += delayed;
                 
                 // Écrire avec feedback
                 comb_buffers_[ch][comb][comb_write_pos_[ch][comb]] = sample + delayed * comb_feedback_[comb];
-                comb_write_pos_[ch][comb] = (comb_write_pos_[ch][comb] + 1) % comb_buffers_[ch][comb].size();
+                comb_write_pos_[ch][comb] = (comb_write_pos_[ch][comb] + 1) % comb_lengths_[comb];
             }
-            combOut /= NUM_COMBS;
+            combOut /= static_cast<float>(active_combs_);
             
-            // Allpass filters
+            // Allpass filters (Schroeder, gain ALLPASS_GAIN : la boucle
+            // décroît, la queue s'éteint)
             float allpassOut = combOut;
-            for (int ap = 0; ap < NUM_ALLPASS; ++ap) {
-                size_t readPos = (allpass_write_pos_[ch][ap] + allpass_buffers_[ch][ap].size() - allpass_delays_[ap]) % allpass_buffers_[ch][ap].size();
+            for (int ap = 0; ap < active_allpass_; ++ap) {
+                size_t readPos = (allpass_write_pos_[ch][ap] + allpass_lengths_[ap] - allpass_delays_[ap]) % allpass_lengths_[ap];
                 float delayed = allpass_buffers_[ch][ap][readPos];
-                allpassOut = delayed + allpassOut * 0.5f;
-                allpass_buffers_[ch][ap][allpass_write_pos_[ch][ap]] = allpassOut;
-                allpass_write_pos_[ch][ap] = (allpass_write_pos_[ch][ap] + 1) % allpass_buffers_[ch][ap].size();
+                const float allpassIn = allpassOut;
+                allpassOut = delayed - allpassIn * ALLPASS_GAIN;
+                allpass_buffers_[ch][ap][allpass_write_pos_[ch][ap]] = allpassIn + allpassOut * ALLPASS_GAIN;
+                allpass_write_pos_[ch][ap] = (allpass_write_pos_[ch][ap] + 1) % allpass_lengths_[ap];
             }
             
             // Mix dry/wet
-            output[idx] = input[idx] * dryMix + allpassOut * mixLinear;
+            output[ch][i] = dry * dryMix + allpassOut * mixLinear;
         }
     }
 }
 
 std::vector<EffectBase::Parameter> ReverbEffect::getParameters() const {
     return {
-        {"room", "Room", 0.0f, 100.0f, 50.0f, room_},
-        {"decay", "Decay", 0.0f, 100.0f, 50.0f, decay_},
-        {"mix", "Mix", 0.0f, 100.0f, 50.0f, mix_}
+        {"room", "Room", 0.0f, 100.0f, 50.0f, room_.getRequestedValue()},
+        {"decay", "Decay", 0.0f, 100.0f, 50.0f, decay_.getRequestedValue()},
+        {"mix", "Mix", 0.0f, 100.0f, 50.0f, mix_.getRequestedValue()}
     };
 }
 
 void ReverbEffect::setParameter(const std::string& name, float value) {
     if (name == "room") {
-        room_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_ROOM, value);
     } else if (name == "decay") {
-        decay_ = std::max(0.0f, std::min(100.0f, value));
-        updateReverbParameters();
+        setParameterByIndex(PARAM_DECAY, value);
     } else if (name == "mix") {
-        mix_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_MIX, value);
+    }
+}
+
+void ReverbEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_ROOM:
+            room_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_DECAY:
+            decay_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        case PARAM_MIX:
+            mix_.setTarget(std::max(0.0f, std::min(100.0f, value)), ramp);
+            break;
+        default:
+            break;
     }
 }
 
 float ReverbEffect::getParameter(const std::string& name) const {
-    if (name == "room") return room_;
-    if (name == "decay") return decay_;
-    if (name == "mix") return mix_;
+    if (name == "room") return room_.getRequestedValue();
+    if (name == "decay") return decay_.getRequestedValue();
+    if (name == "mix") return mix_.getRequestedValue();
     return 0.0f;
 }
 
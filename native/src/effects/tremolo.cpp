@@ -14,71 +14,87 @@ void TremoloEffect::setSampleRate(uint32_t sampleRate) {
     updateLFO();
 }
 
-void TremoloEffect::process(float* input, float* output, uint32_t frameCount) {
+void TremoloEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
     if (bypass_) {
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            output[i] = input[i];
-        }
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    const float volumeGain = volume_ * 2.0f;
+    beginRate(frameCount);
     
     for (uint32_t i = 0; i < frameCount; ++i) {
-        float lfo = getLFOValue();
-        
-        // Modulation d'amplitude
-        float mod = 1.0f - (depth_ * lfo);
-        mod = std::max(0.0f, std::min(1.0f, mod));
-        
-        output[i] = input[i] * mod * volumeGain;
+        const float gain = getModulationGain(lfo_phase_, wave_.getNextValue(), depth_.getNextValue(),
+                                             volume_.getNextValue());
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            output[ch][i] = input[ch][i] * gain;
+        }
         
-        updateLFO();
+        lfo_phase_ = advanceLFO(lfo_phase_, lfo_increment_);
     }
 }
 
-void TremoloEffect::updateLFO() {
-    lfo_increment_ = (2.0f * 3.14159f * rate_) / sample_rate_;
-    lfo_phase_ += lfo_increment_;
-    if (lfo_phase_ >= 2.0f * 3.14159f) {
-        lfo_phase_ -= 2.0f * 3.14159f;
+TremoloEffect::FusedStage TremoloEffect::beginFused(uint32_t frameCount) {
+    beginRate(frameCount);
+    return FusedStage(*this);
+}
+
+void TremoloEffect::beginRate(uint32_t frameCount) {
+    if (rate_.isSmoothing()) {
+        rate_.skip(frameCount);
+        updateLFO();
     }
 }
 
-float TremoloEffect::getLFOValue() const {
-    // Mix entre sine (0) et square (1)
-    float sine = sinf(lfo_phase_);
-    float square = (lfo_phase_ < 3.14159f) ? 1.0f : -1.0f;
-    return sine * (1.0f - wave_) + square * wave_;
+void TremoloEffect::updateLFO() {
+    lfo_increment_ = (2.0f * 3.14159f * rate_.getCurrentValue()) / sample_rate_;
 }
 
 std::vector<EffectBase::Parameter> TremoloEffect::getParameters() const {
     return {
-        {"rate", "Rate", 0.1f, 20.0f, 2.0f, rate_},
-        {"depth", "Depth", 0.0f, 1.0f, 0.5f, depth_},
-        {"volume", "Volume", 0.0f, 1.0f, 0.5f, volume_},
-        {"wave", "Wave", 0.0f, 1.0f, 0.0f, wave_}
+        {"rate", "Rate", 0.1f, 20.0f, 2.0f, rate_.getRequestedValue()},
+        {"depth", "Depth", 0.0f, 1.0f, 0.5f, depth_.getRequestedValue()},
+        {"volume", "Volume", 0.0f, 1.0f, 0.5f, volume_.getRequestedValue()},
+        {"wave", "Wave", 0.0f, 1.0f, 0.0f, wave_.getRequestedValue()}
     };
 }
 
 void TremoloEffect::setParameter(const std::string& name, float value) {
     if (name == "rate") {
-        rate_ = std::max(0.1f, std::min(20.0f, value));
-        updateLFO();
+        setParameterByIndex(PARAM_RATE, value);
     } else if (name == "depth") {
-        depth_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_DEPTH, value);
     } else if (name == "volume") {
-        volume_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_VOLUME, value);
     } else if (name == "wave") {
-        wave_ = std::max(0.0f, std::min(1.0f, value));
+        setParameterByIndex(PARAM_WAVE, value);
+    }
+}
+
+void TremoloEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_RATE:
+            rate_.setTarget(std::max(0.1f, std::min(20.0f, value)), ramp);
+            break;
+        case PARAM_DEPTH:
+            depth_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_VOLUME:
+            volume_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        case PARAM_WAVE:
+            wave_.setTarget(std::max(0.0f, std::min(1.0f, value)), ramp);
+            break;
+        default:
+            break;
     }
 }
 
 float TremoloEffect::getParameter(const std::string& name) const {
-    if (name == "rate") return rate_;
-    if (name == "depth") return depth_;
-    if (name == "volume") return volume_;
-    if (name == "wave") return wave_;
+    if (name == "rate") return rate_.getRequestedValue();
+    if (name == "depth") return depth_.getRequestedValue();
+    if (name == "volume") return volume_.getRequestedValue();
+    if (name == "wave") return wave_.getRequestedValue();
     return 0.0f;
 }
 
@@ -2,8 +2,300 @@
 #include <algorithm>
 #include <cstring>
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
 namespace webamp {
 
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Premier passage radix-4 (étages de longueur 2 et 4 fusionnés)
+// Twiddles triviaux : 1 et -i
+void radix4FirstPass(float* re, float* im, size_t n) {
+    for (size_t i = 0; i < n; i += 4) {
+        const float s0r = re[i] + re[i + 1];
+        const float s0i = im[i] + im[i + 1];
+        const float d0r = re[i] - re[i + 1];
+        const float d0i = im[i] - im[i + 1];
+        const float s1r = re[i + 2] + re[i + 3];
+        const float s1i = im[i + 2] + im[i + 3];
+        const float d1r = re[i + 2] - re[i + 3];
+        const float d1i = im[i + 2] - im[i + 3];
+        
+        re[i] = s0r + s1r;
+        im[i] = s0i + s1i;
+        re[i + 2] = s0r - s1r;
+        im[i + 2] = s0i - s1i;
+        // d0 +/- (-i) * d1
+        re[i + 1] = d0r + d1i;
+        im[i + 1] = d0i - d1r;
+        re[i + 3] = d0r - d1i;
+        im[i + 3] = d0i + d1r;
+    }
+}
+
+// Étage radix-2 de demi-longueur m (twiddles wr/wi[j] = exp(-i*pi*j/m))
+void radix2Pass(float* re, float* im, size_t n, size_t m, const float* wr, const float* wi) {
+    for (size_t i = 0; i < n; i += 2 * m) {
+        float* ar = re + i;
+        float* ai = im + i;
+        float* br = re + i + m;
+        float* bi = im + i + m;
+        size_t j = 0;
+
+#ifdef __AVX__
+        for (; j + 8 <= m; j += 8) {
+            const __m256 vwr = _mm256_loadu_ps(wr + j);
+            const __m256 vwi = _mm256_loadu_ps(wi + j);
+            const __m256 vbr = _mm256_loadu_ps(br + j);
+            const __m256 vbi = _mm256_loadu_ps(bi + j);
+            const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(vbr, vwr), _mm256_mul_ps(vbi, vwi));
+            const __m256 ti = _mm256_add_ps(_mm256_mul_ps(vbr, vwi), _mm256_mul_ps(vbi, vwr));
+            const __m256 var = _mm256_loadu_ps(ar + j);
+            const __m256 vai = _mm256_loadu_ps(ai + j);
+            _mm256_storeu_ps(ar + j, _mm256_add_ps(var, tr));
+            _mm256_storeu_ps(ai + j, _mm256_add_ps(vai, ti));
+            _mm256_storeu_ps(br + j, _mm256_sub_ps(var, tr));
+            _mm256_storeu_ps(bi + j, _mm256_sub_ps(vai, ti));
+        }
+#endif
+#ifdef __SSE__
+        for (; j + 4 <= m; j += 4) {
+            const __m128 vwr = _mm_loadu_ps(wr + j);
+            const __m128 vwi = _mm_loadu_ps(wi + j);
+            const __m128 vbr = _mm_loadu_ps(br + j);
+            const __m128 vbi = _mm_loadu_ps(bi + j);
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(vbr, vwr), _mm_mul_ps(vbi, vwi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(vbr, vwi), _mm_mul_ps(vbi, vwr));
+            const __m128 var = _mm_loadu_ps(ar + j);
+            const __m128 vai = _mm_loadu_ps(ai + j);
+            _mm_storeu_ps(ar + j, _mm_add_ps(var, tr));
+            _mm_storeu_ps(ai + j, _mm_add_ps(vai, ti));
+            _mm_storeu_ps(br + j, _mm_sub_ps(var, tr));
+            _mm_storeu_ps(bi + j, _mm_sub_ps(vai, ti));
+        }
+#elif defined(__ARM_NEON)
+        for (; j + 4 <= m; j += 4) {
+            const float32x4_t vwr = vld1q_f32(wr + j);
+            const float32x4_t vwi = vld1q_f32(wi + j);
+            const float32x4_t vbr = vld1q_f32(br + j);
+            const float32x4_t vbi = vld1q_f32(bi + j);
+            const float32x4_t tr = vmlsq_f32(vmulq_f32(vbr, vwr), vbi, vwi);
+            const float32x4_t ti = vmlaq_f32(vmulq_f32(vbr, vwi), vbi, vwr);
+            const float32x4_t var = vld1q_f32(ar + j);
+            const float32x4_t vai = vld1q_f32(ai + j);
+            vst1q_f32(ar + j, vaddq_f32(var, tr));
+            vst1q_f32(ai + j, vaddq_f32(vai, ti));
+            vst1q_f32(br + j, vsubq_f32(var, tr));
+            vst1q_f32(bi + j, vsubq_f32(vai, ti));
+        }
+#endif
+
+        for (; j < m; ++j) {
+            const float tr = br[j] * wr[j] - bi[j] * wi[j];
+            const float ti = br[j] * wi[j] + bi[j] * wr[j];
+            const float ur = ar[j];
+            const float ui = ai[j];
+            ar[j] = ur + tr;
+            ai[j] = ui + ti;
+            br[j] = ur - tr;
+            bi[j] = ui - ti;
+        }
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// FFTPlan
+// ---------------------------------------------------------------------------
+
+FFTPlan::FFTPlan(size_t size)
+    : size_(FFTHelper::nextPowerOf2(std::max<size_t>(size, 2)))
+    , complex_size_(size_ / 2)
+{
+    buildBitReverse(bitrev_, size_);
+    buildBitReverse(half_bitrev_, complex_size_);
+    
+    // Twiddles de tous les étages : [m + j] = exp(-i*pi*j/m), m = 1, 2, 4...
+    // (la FFT de taille size_/2 réutilise la même table)
+    twiddle_re_.assign(size_, 0.0f);
+    twiddle_im_.assign(size_, 0.0f);
+    for (size_t m = 1; m < size_; m <<= 1) {
+        for (size_t j = 0; j < m; ++j) {
+            const double angle = -PI * static_cast<double>(j) / static_cast<double>(m);
+            twiddle_re_[m + j] = static_cast<float>(std::cos(angle));
+            twiddle_im_[m + j] = static_cast<float>(std::sin(angle));
+        }
+    }
+    
+    // Twiddles de recombinaison du chemin réel : exp(-2i*pi*k/size_)
+    real_twiddle_re_.assign(complex_size_ / 2 + 1, 0.0f);
+    real_twiddle_im_.assign(complex_size_ / 2 + 1, 0.0f);
+    for (size_t k = 0; k <= complex_size_ / 2; ++k) {
+        const double angle = -2.0 * PI * static_cast<double>(k) / static_cast<double>(size_);
+        real_twiddle_re_[k] = static_cast<float>(std::cos(angle));
+        real_twiddle_im_[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void FFTPlan::buildBitReverse(std::vector<uint32_t>& table, size_t n) {
+    table.assign(n, 0);
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < n) {
+        ++bits;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            if (i & (static_cast<size_t>(1) << b)) {
+                reversed |= 1u << (bits - 1 - b);
+            }
+        }
+        table[i] = reversed;
+    }
+}
+
+void FFTPlan::transform(float* re, float* im, size_t n, const std::vector<uint32_t>& bitrev) const {
+    if (n < 2) {
+        return;
+    }
+    
+    for (size_t i = 0; i < n; ++i) {
+        const size_t j = bitrev[i];
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    
+    size_t m = 1;
+    if (n >= 4) {
+        radix4FirstPass(re, im, n);
+        m = 4;
+    }
+    for (; m < n; m <<= 1) {
+        radix2Pass(re, im, n, m, &twiddle_re_[m], &twiddle_im_[m]);
+    }
+}
+
+void FFTPlan::forward(float* re, float* im) const {
+    transform(re, im, size_, bitrev_);
+}
+
+void FFTPlan::inverse(float* re, float* im) const {
+    // IFFT(x) = conj(FFT(conj(x))) / N : l'échange re/im réalise les conjugaisons
+    transform(im, re, size_, bitrev_);
+    
+    const float scale = 1.0f / static_cast<float>(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+void FFTPlan::forwardReal(const float* input, float* re, float* im) const {
+    const size_t n = complex_size_;
+    
+    // Échantillons pairs/impairs empaquetés en un signal complexe de taille N/2
+    for (size_t k = 0; k < n; ++k) {
+        re[k] = input[2 * k];
+        im[k] = input[2 * k + 1];
+    }
+    transform(re, im, n, half_bitrev_);
+    
+    // Recombinaison : X[k] = E[k] + W^k O[k], X[n-k] = conj(E[k] - W^k O[k])
+    const float z0r = re[0];
+    const float z0i = im[0];
+    re[0] = z0r + z0i;
+    im[0] = 0.0f;
+    re[n] = z0r - z0i;
+    im[n] = 0.0f;
+    
+    for (size_t k = 1; k <= n / 2; ++k) {
+        const float ar = re[k];
+        const float ai = im[k];
+        const float br = re[n - k];
+        const float bi = im[n - k];
+        
+        const float er = 0.5f * (ar + br);
+        const float ei = 0.5f * (ai - bi);
+        const float orr = 0.5f * (ai + bi);
+        const float oi = 0.5f * (br - ar);
+        
+        const float wr = real_twiddle_re_[k];
+        const float wi = real_twiddle_im_[k];
+        const float tr = wr * orr - wi * oi;
+        const float ti = wr * oi + wi * orr;
+        
+        re[k] = er + tr;
+        im[k] = ei + ti;
+        if (k != n - k) {
+            re[n - k] = er - tr;
+            im[n - k] = ti - ei;
+        }
+    }
+}
+
+void FFTPlan::inverseReal(float* re, float* im, float* output) const {
+    const size_t n = complex_size_;
+    
+    // Reconstruction du spectre complexe de taille N/2 : Z[k] = E[k] + i O[k]
+    const float x0 = re[0];
+    const float xn = re[n];
+    re[0] = 0.5f * (x0 + xn);
+    im[0] = 0.5f * (x0 - xn);
+    
+    for (size_t k = 1; k <= n / 2; ++k) {
+        const float xr = re[k];
+        const float xi = im[k];
+        const float yr = re[n - k];
+        const float yi = im[n - k];
+        
+        const float er = 0.5f * (xr + yr);
+        const float ei = 0.5f * (xi - yi);
+        const float dr = 0.5f * (xr - yr);
+        const float di = 0.5f * (xi + yi);
+        
+        // O = D * conj(W^k)
+        const float wr = real_twiddle_re_[k];
+        const float wi = real_twiddle_im_[k];
+        const float orr = dr * wr + di * wi;
+        const float oi = di * wr - dr * wi;
+        
+        re[k] = er - oi;
+        im[k] = ei + orr;
+        if (k != n - k) {
+            re[n - k] = er + oi;
+            im[n - k] = orr - ei;
+        }
+    }
+    
+    // FFT inverse de taille N/2 (échange re/im), normalisation lors du désentrelacement
+    transform(im, re, n, half_bitrev_);
+    
+    const float scale = 1.0f / static_cast<float>(n);
+    for (size_t k = 0; k < n; ++k) {
+        output[2 * k] = re[k] * scale;
+        output[2 * k + 1] = im[k] * scale;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// FFTHelper
+// ---------------------------------------------------------------------------
+
 size_t FFTHelper::nextPowerOf2(size_t n) {
     if (n == 0) return 1;
     n--;
@@ -18,23 +310,6 @@ size_t FFTHelper::nextPowerOf2(size_t n) {
     return n + 1;
 }
 
-void FFTHelper::bitReverse(std::vector<std::complex<float>>& data) {
-    size_t n = data.size();
-    size_t j = 0;
-    
-    for (size_t i = 1; i < n; ++i) {
-        size_t bit = n >> 1;
-        for (; j & bit; bit >>= 1) {
-            j ^= bit;
-        }
-        j ^= bit;
-        
-        if (i < j) {
-            std::swap(data[i], data[j]);
-        }
-    }
-}
-
 void FFTHelper::fft(std::vector<std::complex<float>>& data, bool inverse) {
     size_t n = data.size();
     if (n == 0 || (n & (n - 1)) != 0) {
@@ -43,34 +318,26 @@ void FFTHelper::fft(std::vector<std::complex<float>>& data, bool inverse) {
         data.resize(newSize, std::complex<float>(0.0f, 0.0f));
         n = newSize;
     }
+    if (n < 2) {
+        return;
+    }
     
-    bitReverse(data);
-    
-    float sign = inverse ? 1.0f : -1.0f;
-    
-    for (size_t len = 2; len <= n; len <<= 1) {
-        float angle = sign * 2.0f * 3.14159265358979323846f / len;
-        std::complex<float> wlen(std::cos(angle), std::sin(angle));
-        
-        for (size_t i = 0; i < n; i += len) {
-            std::complex<float> w(1.0f, 0.0f);
-            
-            for (size_t j = 0; j < len / 2; ++j) {
-                std::complex<float> u = data[i + j];
-                std::complex<float> v = data[i + j + len / 2] * w;
-                
-                data[i + j] = u + v;
-                data[i + j + len / 2] = u - v;
-                
-                w *= wlen;
-            }
-        }
+    FFTPlan plan(n);
+    AlignedVector<float> re(n);
+    AlignedVector<float> im(n);
+    for (size_t i = 0; i < n; ++i) {
+        re[i] = data[i].real();
+        im[i] = data[i].imag();
     }
     
     if (inverse) {
-        for (size_t i = 0; i < n; ++i) {
-            data[i] /= static_cast<float>(n);
-        }
+        plan.inverse(re.data(), im.data());
+    } else {
+        plan.forward(re.data(), im.data());
+    }
+    
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = std::complex<float>(re[i], im[i]);
     }
 }
 
@@ -91,47 +358,34 @@ void FFTHelper::convolveFFT(
     size_t signalLen = signal.size();
     size_t kernelLen = kernel.size();
     size_t outputLen = signalLen + kernelLen - 1;
-    size_t fftSize = nextPowerOf2(outputLen);
-    
-    // Préparer les données pour FFT
-    std::vector<std::complex<float>> signalFFT(fftSize);
-    std::vector<std::complex<float>> kernelFFT(fftSize);
+    size_t fftSize = std::max<size_t>(nextPowerOf2(outputLen), 2);
+    size_t bins = fftSize / 2 + 1;
     
-    // Copier signal
-    for (size_t i = 0; i < signalLen; ++i) {
-        signalFFT[i] = std::complex<float>(signal[i], 0.0f);
-    }
-    for (size_t i = signalLen; i < fftSize; ++i) {
-        signalFFT[i] = std::complex<float>(0.0f, 0.0f);
-    }
+    // FFT réelles (demi-spectres)
+    FFTPlan plan(fftSize);
+    AlignedVector<float> padded(fftSize, 0.0f);
+    AlignedVector<float> signalRe(bins), signalIm(bins);
+    AlignedVector<float> kernelRe(bins), kernelIm(bins);
     
-    // Copier kernel
-    for (size_t i = 0; i < kernelLen; ++i) {
-        kernelFFT[i] = std::complex<float>(kernel[i], 0.0f);
-    }
-    for (size_t i = kernelLen; i < fftSize; ++i) {
-        kernelFFT[i] = std::complex<float>(0.0f, 0.0f);
-    }
+    std::copy(signal.begin(), signal.end(), padded.begin());
+    plan.forwardReal(padded.data(), signalRe.data(), signalIm.data());
     
-    // FFT
-    fft(signalFFT, false);
-    fft(kernelFFT, false);
+    std::fill(padded.begin(), padded.end(), 0.0f);
+    std::copy(kernel.begin(), kernel.end(), padded.begin());
+    plan.forwardReal(padded.data(), kernelRe.data(), kernelIm.data());
     
     // Multiplication dans le domaine fréquentiel
-    std::vector<std::complex<float>> resultFFT(fftSize);
-    for (size_t i = 0; i < fftSize; ++i) {
-        resultFFT[i] = signalFFT[i] * kernelFFT[i];
+    for (size_t i = 0; i < bins; ++i) {
+        const float re = signalRe[i] * kernelRe[i] - signalIm[i] * kernelIm[i];
+        const float im = signalRe[i] * kernelIm[i] + signalIm[i] * kernelRe[i];
+        signalRe[i] = re;
+        signalIm[i] = im;
     }
     
     // IFFT
-    ifft(resultFFT);
+    plan.inverseReal(signalRe.data(), signalIm.data(), padded.data());
     
-    // Extraire la partie réelle
-    output.resize(outputLen);
-    for (size_t i = 0; i < outputLen; ++i) {
-        output[i] = resultFFT[i].real();
-    }
+    output.assign(padded.begin(), padded.begin() + outputLen);
 }
 
 } // namespace webamp
-
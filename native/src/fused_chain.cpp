@@ -0,0 +1,113 @@
+#include "../include/fused_chain.h"
+#include "../include/fused_stage.h"
+#include "../include/effects/distortion.h"
+#include "../include/effects/fuzz.h"
+#include "../include/effects/overdrive.h"
+#include "../include/effects/tremolo.h"
+#include <algorithm>
+#include <utility>
+
+namespace webamp {
+
+namespace {
+
+using FusedKind = EffectBase::FusedKind;
+using Runner = void (*)(EffectBase* const*, const float* const*, float* const*, uint32_t, uint32_t);
+
+// Classe concrète de chaque type d'étage
+template<FusedKind Kind> struct FusedEffect;
+template<> struct FusedEffect<FusedKind::Distortion> { using Type = DistortionEffect; };
+template<> struct FusedEffect<FusedKind::Overdrive> { using Type = OverdriveEffect; };
+template<> struct FusedEffect<FusedKind::Fuzz> { using Type = FuzzEffect; };
+template<> struct FusedEffect<FusedKind::Tremolo> { using Type = TremoloEffect; };
+
+// Boucle fusionnée : nombre de canaux connu à la compilation (boucle
+// intérieure déroulée)
+template<uint32_t Channels, typename Stage>
+void runLoop(Stage& stage, const float* const* input, float* const* output, uint32_t frameCount) {
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        stage.frame();
+        for (uint32_t ch = 0; ch < Channels; ++ch) {
+            output[ch][i] = stage.sample(ch, input[ch][i]);
+        }
+    }
+}
+
+template<FusedKind... Kinds, size_t... Index>
+void runStages(EffectBase* const* effects, const float* const* input, float* const* output, uint32_t channels,
+               uint32_t frameCount, std::index_sequence<Index...>) {
+    // Début de bloc de chaque effet, dans l'ordre de la chaîne
+    FusedSeries<typename FusedEffect<Kinds>::Type::FusedStage...> stage(
+        static_cast<typename FusedEffect<Kinds>::Type*>(effects[Index])->beginFused(frameCount)...);
+    
+    if (channels == 1) {
+        runLoop<1>(stage, input, output, frameCount);
+    } else {
+        runLoop<EffectBase::MAX_CHANNELS>(stage, input, output, frameCount);
+    }
+    stage.finish();
+}
+
+template<FusedKind... Kinds>
+void runFused(EffectBase* const* effects, const float* const* input, float* const* output, uint32_t channels,
+              uint32_t frameCount) {
+    runStages<Kinds...>(effects, input, output, channels, frameCount, std::index_sequence_for<decltype(Kinds)...>());
+}
+
+// Instanciation correspondant à la suite kinds[0..count), Kinds étant les
+// types déjà résolus
+template<FusedKind... Kinds>
+Runner resolve(const FusedKind* kinds, uint32_t count) {
+    if constexpr (sizeof...(Kinds) > 0) {
+        if (count == 0) {
+            return &runFused<Kinds...>;
+        }
+    }
+    if constexpr (sizeof...(Kinds) < FusedChain::MAX_STAGES) {
+        if (count > 0) {
+            switch (kinds[0]) {
+                case FusedKind::Distortion:
+                    return resolve<Kinds..., FusedKind::Distortion>(kinds + 1, count - 1);
+                case FusedKind::Overdrive:
+                    return resolve<Kinds..., FusedKind::Overdrive>(kinds + 1, count - 1);
+                case FusedKind::Fuzz:
+                    return resolve<Kinds..., FusedKind::Fuzz>(kinds + 1, count - 1);
+                case FusedKind::Tremolo:
+                    return resolve<Kinds..., FusedKind::Tremolo>(kinds + 1, count - 1);
+                default:
+                    break;
+            }
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+uint32_t FusedChain::compile(EffectBase* const* effects, const EffectBase::FusedKind* kinds, uint32_t count) {
+    count = std::min(count, MAX_STAGES);
+    runner_ = resolve<>(kinds, count);
+    if (!runner_) {
+        clear();
+        return 0;
+    }
+    std::copy(effects, effects + count, stages_);
+    stage_count_ = count;
+    return count;
+}
+
+void FusedChain::clear() {
+    runner_ = nullptr;
+    stage_count_ = 0;
+}
+
+void FusedChain::process(const float* const* input, float* const* output, uint32_t channels,
+                         uint32_t frameCount) const {
+    if (!runner_) {
+        AudioBuffer::copy(input, output, channels, frameCount);
+        return;
+    }
+    runner_(stages_, input, output, std::min(channels, EffectBase::MAX_CHANNELS), frameCount);
+}
+
+} // namespace webamp
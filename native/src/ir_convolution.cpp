@@ -1,6 +1,4 @@
 #include "../include/ir_convolution.h"
-#include "../include/fft_helper.h"
-#include "../include/simd_helper.h"
 #include <algorithm>
 #include <cmath>
 
@@ -8,32 +6,41 @@ namespace webamp {
 
 IRConvolution::IRConvolution()
     : mix_(100.0f)
+    , partition_size_(0)
+    , non_uniform_(false)
+    , background_tail_(true)
+    , tail_length_(0)
 {
-    buffer_pos_[0] = 0;
-    buffer_pos_[1] = 0;
-    input_buffer_[0].resize(4096);
-    input_buffer_[1].resize(4096);
-    output_buffer_[0].resize(4096);
-    output_buffer_[1].resize(4096);
-    std::fill(input_buffer_[0].begin(), input_buffer_[0].end(), 0.0f);
-    std::fill(input_buffer_[1].begin(), input_buffer_[1].end(), 0.0f);
-    std::fill(output_buffer_[0].begin(), output_buffer_[0].end(), 0.0f);
-    std::fill(output_buffer_[1].begin(), output_buffer_[1].end(), 0.0f);
 }
 
 IRConvolution::~IRConvolution() {
 }
 
 void IRConvolution::setSampleRate(uint32_t sampleRate) {
+    if (sampleRate == sample_rate_) {
+        return;
+    }
     EffectBase::setSampleRate(sampleRate);
-    // Réinitialiser les buffers si nécessaire
+    if (ir_loader_) {
+        rebuildState();
+    }
+}
+
+void IRConvolution::setMaxBlockSize(uint32_t maxFrameCount) {
+    if (maxFrameCount == max_block_size_) {
+        return;
+    }
+    EffectBase::setMaxBlockSize(maxFrameCount);
+    if (ir_loader_) {
+        rebuildState();
+    }
 }
 
 bool IRConvolution::loadIR(const std::string& filePath) {
     auto loader = std::make_shared<IRLoader>();
     if (loader->loadIR(filePath)) {
         ir_loader_ = loader;
-        return true;
+        return rebuildState();
     }
     return false;
 }
@@ -41,148 +48,141 @@ bool IRConvolution::loadIR(const std::string& filePath) {
 bool IRConvolution::loadIR(std::shared_ptr<IRLoader> irLoader) {
     if (irLoader && irLoader->isLoaded()) {
         ir_loader_ = irLoader;
-        return true;
+        return rebuildState();
     }
     return false;
 }
 
-void IRConvolution::process(float* input, float* output, uint32_t frameCount) {
-    if (bypass_ || !ir_loader_ || !ir_loader_->isLoaded()) {
-        std::copy(input, input + frameCount * 2, output);
+size_t IRConvolution::getPartitionSize() const {
+    return partition_size_;
+}
+
+void IRConvolution::setBackgroundTail(bool enabled) {
+    if (enabled == background_tail_) {
         return;
     }
+    background_tail_ = enabled;
+    if (ir_loader_) {
+        rebuildState();
+    }
+}
+
+bool IRConvolution::rebuildState() {
+    // IR convertie une fois à la fréquence du flux ; ir_loader_ garde
+    // l'original pour un changement de fréquence ultérieur. Conversion
+    // impossible : IR utilisée telle quelle.
+    std::shared_ptr<IRLoader> loader = ir_loader_;
+    if (loader->isLoaded() && loader->getSampleRate() != sample_rate_) {
+        auto resampled = std::make_shared<IRLoader>(*ir_loader_);
+        if (resampled->resample(sample_rate_)) {
+            loader = resampled;
+        }
+    }
     
-    float mixLinear = mix_ / 100.0f;
-    float dryMix = 1.0f - mixLinear;
-    
-    const auto& irSamples = ir_loader_->getIRSamples();
+    const auto& irSamples = loader->getIRSamples();
     if (irSamples.empty()) {
-        std::copy(input, input + frameCount * 2, output);
-        return;
+        return false;
     }
     
-    // Convolution optimisée : utiliser FFT pour les IR longs, directe pour les courts
-    // Seuil réduit pour utiliser FFT plus souvent (meilleure performance)
-    const size_t fftThreshold = 128; // Utiliser FFT si IR > 128 samples
+    // Partition = taille de bloc du driver : une FFT directe et une inverse par bloc
+    const size_t blockSize = std::max(static_cast<size_t>(max_block_size_), MIN_PARTITION_SIZE);
     
-    if (irSamples.size() > fftThreshold) {
-        // Convolution FFT (overlap-add)
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            for (int ch = 0; ch < 2; ++ch) {
-                int idx = i * 2 + ch;
-                float sample = input[idx];
-                
-                // Ajouter au buffer d'entrée
-                input_buffer_[ch][buffer_pos_[ch]] = sample;
-                buffer_pos_[ch] = (buffer_pos_[ch] + 1) % input_buffer_[ch].size();
-            }
-        }
-        
-        // Traiter par blocs avec FFT
-        processConvolutionFFT(0, frameCount, dryMix, mixLinear);
-        processConvolutionFFT(1, frameCount, dryMix, mixLinear);
-        
-        // Copier les résultats
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            for (int ch = 0; ch < 2; ++ch) {
-                int idx = i * 2 + ch;
-                size_t readPos = (buffer_pos_[ch] + output_buffer_[ch].size() - frameCount + i) % output_buffer_[ch].size();
-                float convolved = output_buffer_[ch][readPos];
-                output[idx] = input[idx] * dryMix + convolved * mixLinear;
+    auto state = std::make_unique<ConvolutionState>();
+    state->irLoader = loader;
+    
+    if (irSamples.size() > LONG_IR_THRESHOLD) {
+        // IR longue : tête directe + étages FFT croissants, sans latence
+        NonUniformConvolver::Config config;
+        config.headSize = MIN_PARTITION_SIZE;
+        config.backgroundTail = background_tail_;
+        for (int ch = 0; ch < 2; ++ch) {
+            state->longConvolvers[ch] = std::make_unique<NonUniformConvolver>();
+            if (!state->longConvolvers[ch]->init(irSamples.data(), irSamples.size(), config)) {
+                return false;
             }
         }
+        state->blockSize = blockSize;
     } else {
-        // Convolution directe pour IR courts (plus rapide)
-        for (uint32_t i = 0; i < frameCount; ++i) {
-            for (int ch = 0; ch < 2; ++ch) {
-                int idx = i * 2 + ch;
-                float sample = input[idx];
-                
-                // Ajouter au buffer d'entrée
-                input_buffer_[ch][buffer_pos_[ch]] = sample;
-                
-                // Convolution directe
-                float convolved = 0.0f;
-                size_t irLen = irSamples.size();
-                for (size_t j = 0; j < irLen; ++j) {
-                    size_t readPos = (buffer_pos_[ch] + input_buffer_[ch].size() - j) % input_buffer_[ch].size();
-                    convolved += input_buffer_[ch][readPos] * irSamples[j];
-                }
-                
-                // Mix dry/wet (peut être optimisé avec SIMD si plusieurs samples)
-                output[idx] = sample * dryMix + convolved * mixLinear;
-                
-                // Avancer le buffer
-                buffer_pos_[ch] = (buffer_pos_[ch] + 1) % input_buffer_[ch].size();
+        for (int ch = 0; ch < 2; ++ch) {
+            if (!state->convolvers[ch].init(blockSize, irSamples.data(), irSamples.size())) {
+                return false;
             }
         }
+        state->blockSize = state->convolvers[0].getBlockSize();
     }
-}
-
-void IRConvolution::processConvolutionFFT(int channel, uint32_t frameCount, float dryMix, float mixLinear) {
-    const auto& irSamples = ir_loader_->getIRSamples();
-    if (irSamples.empty()) {
-        return;
+    for (int ch = 0; ch < 2; ++ch) {
+        state->wet[ch].assign(state->blockSize, 0.0f);
     }
     
-    // Extraire un bloc du buffer d'entrée
-    size_t blockSize = std::min(static_cast<size_t>(512), input_buffer_[channel].size());
-    std::vector<float> inputBlock(blockSize);
-    
-    size_t startPos = (buffer_pos_[channel] + input_buffer_[channel].size() - blockSize) % input_buffer_[channel].size();
-    for (size_t i = 0; i < blockSize; ++i) {
-        size_t pos = (startPos + i) % input_buffer_[channel].size();
-        inputBlock[i] = input_buffer_[channel][pos];
-    }
-    
-    // Convolution FFT
-    std::vector<float> convolved;
-    FFTHelper::convolveFFT(inputBlock, irSamples, convolved);
-    
-    // Ajouter au buffer de sortie avec overlap
-    size_t outputStart = (buffer_pos_[channel] + output_buffer_[channel].size() - blockSize) % output_buffer_[channel].size();
-    for (size_t i = 0; i < convolved.size() && i < output_buffer_[channel].size(); ++i) {
-        size_t pos = (outputStart + i) % output_buffer_[channel].size();
-        output_buffer_[channel][pos] += convolved[i] * mixLinear;
-    }
+    partition_size_ = state->longConvolvers[0] ? state->longConvolvers[0]->getHeadSize() : state->blockSize;
+    non_uniform_ = static_cast<bool>(state->longConvolvers[0]);
+    tail_length_.store(static_cast<uint32_t>(irSamples.size() + state->blockSize), std::memory_order_relaxed);
+    state_publisher_.publish(std::move(state));
+    return true;
 }
 
-void IRConvolution::processDirectConvolution(int channel, uint32_t frameCount, float dryMix, float mixLinear) {
-    const auto& irSamples = ir_loader_->getIRSamples();
-    if (irSamples.empty()) {
+void IRConvolution::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    SnapshotPublisher<ConvolutionState>::ReadScope state(state_publisher_);
+    
+    if (bypass_ || !state) {
+        AudioBuffer::copy(input, output, channels, frameCount);
         return;
     }
     
-    // Convolution directe simple
-    for (uint32_t i = 0; i < frameCount; ++i) {
-        float sample = input_buffer_[channel][(buffer_pos_[channel] + input_buffer_[channel].size() - frameCount + i) % input_buffer_[channel].size()];
+    // Niveau de qualité : partitions convoluées (l'état publié peut avoir
+    // changé depuis le bloc précédent, on réapplique à chaque bloc)
+    for (uint32_t ch = 0; ch < 2; ++ch) {
+        PartitionedConvolver& convolver = state->convolvers[ch];
+        const size_t partitions = convolver.getPartitionCount();
+        convolver.setActivePartitionCount((partitions + (size_t(1) << quality_tier_) - 1) >> quality_tier_);
+    }
+    
+    // Traitement par sous-blocs de la taille des buffers de travail
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        const uint32_t chunk = static_cast<uint32_t>(std::min<size_t>(frameCount - offset, state->blockSize));
+        
+        // Entrée planaire lue directement par les convolveurs
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            if (state->longConvolvers[ch]) {
+                state->longConvolvers[ch]->process(input[ch] + offset, state->wet[ch].data(), chunk);
+            } else {
+                state->convolvers[ch].process(input[ch] + offset, state->wet[ch].data(), chunk);
+            }
+        }
         
-        float convolved = 0.0f;
-        size_t irLen = irSamples.size();
-        for (size_t j = 0; j < irLen; ++j) {
-            size_t readPos = (buffer_pos_[channel] + input_buffer_[channel].size() - frameCount + i - j) % input_buffer_[channel].size();
-            convolved += input_buffer_[channel][readPos] * irSamples[j];
+        for (uint32_t i = 0; i < chunk; ++i) {
+            const float mixLinear = mix_.getNextValue() / 100.0f;
+            const float dryMix = 1.0f - mixLinear;
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                output[ch][offset + i] = input[ch][offset + i] * dryMix + state->wet[ch][i] * mixLinear;
+            }
         }
         
-        size_t outputPos = (buffer_pos_[channel] + output_buffer_[channel].size() - frameCount + i) % output_buffer_[channel].size();
-        output_buffer_[channel][outputPos] = sample * dryMix + convolved * mixLinear;
+        offset += chunk;
     }
 }
 
 std::vector<EffectBase::Parameter> IRConvolution::getParameters() const {
     return {
-        {"mix", "Mix", 0.0f, 100.0f, 100.0f, mix_}
+        {"mix", "Mix", 0.0f, 100.0f, 100.0f, mix_.getRequestedValue()}
     };
 }
 
 void IRConvolution::setParameter(const std::string& name, float value) {
     if (name == "mix") {
-        mix_ = std::max(0.0f, std::min(100.0f, value));
+        setParameterByIndex(PARAM_MIX, value);
+    }
+}
+
+void IRConvolution::setParameterByIndex(size_t index, float value) {
+    if (index == PARAM_MIX) {
+        mix_.setTarget(std::max(0.0f, std::min(100.0f, value)), getSmoothingSamples());
     }
 }
 
 float IRConvolution::getParameter(const std::string& name) const {
-    if (name == "mix") return mix_;
+    if (name == "mix") return mix_.getRequestedValue();
     return 0.0f;
 }
 
@@ -1,7 +1,9 @@
 #include "json_parser.h"
 #include <cctype>
+#include <cstdlib>
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
 
 namespace webamp {
 
@@ -166,5 +168,146 @@ bool JsonParser::getBool(const std::map<std::string, std::string>& data, const s
     return defaultValue;
 }
 
+// JsonValue
+
+static const JsonValue& nullJsonValue() {
+    static const JsonValue value;
+    return value;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    return index < array_.size() ? array_[index] : nullJsonValue();
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    for (const auto& member : members_) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    const JsonValue* value = find(key);
+    return value ? *value : nullJsonValue();
+}
+
+JsonValue JsonParser::parseDocument(const std::string& json) {
+    JsonValue root;
+    size_t pos = 0;
+    parseDocumentValue(json, pos, root, 0);
+    
+    skipWhitespace(json, pos);
+    if (pos != json.length()) {
+        throw std::runtime_error("JSON: données inattendues après le document");
+    }
+    return root;
+}
+
+void JsonParser::parseDocumentValue(const std::string& json, size_t& pos, JsonValue& value, int depth) {
+    if (depth > 64) {
+        throw std::runtime_error("JSON: imbrication trop profonde");
+    }
+    
+    skipWhitespace(json, pos);
+    if (pos >= json.length()) {
+        throw std::runtime_error("JSON: fin de document inattendue");
+    }
+    
+    const char c = json[pos];
+    if (c == '{') {
+        value.type_ = JsonValue::Type::Object;
+        ++pos;
+        skipWhitespace(json, pos);
+        if (pos < json.length() && json[pos] == '}') {
+            ++pos;
+            return;
+        }
+        while (true) {
+            skipWhitespace(json, pos);
+            if (pos >= json.length() || json[pos] != '"') {
+                throw std::runtime_error("JSON: clé attendue");
+            }
+            std::string key = parseString(json, pos);
+            skipWhitespace(json, pos);
+            if (pos >= json.length() || json[pos] != ':') {
+                throw std::runtime_error("JSON: ':' attendu");
+            }
+            ++pos;
+            value.members_.emplace_back(std::move(key), JsonValue());
+            parseDocumentValue(json, pos, value.members_.back().second, depth + 1);
+            
+            skipWhitespace(json, pos);
+            if (pos < json.length() && json[pos] == ',') {
+                ++pos;
+            } else if (pos < json.length() && json[pos] == '}') {
+                ++pos;
+                return;
+            } else {
+                throw std::runtime_error("JSON: ',' ou '}' attendu");
+            }
+        }
+    }
+    
+    if (c == '[') {
+        value.type_ = JsonValue::Type::Array;
+        ++pos;
+        skipWhitespace(json, pos);
+        if (pos < json.length() && json[pos] == ']') {
+            ++pos;
+            return;
+        }
+        while (true) {
+            value.array_.emplace_back();
+            parseDocumentValue(json, pos, value.array_.back(), depth + 1);
+            
+            skipWhitespace(json, pos);
+            if (pos < json.length() && json[pos] == ',') {
+                ++pos;
+            } else if (pos < json.length() && json[pos] == ']') {
+                ++pos;
+                return;
+            } else {
+                throw std::runtime_error("JSON: ',' ou ']' attendu");
+            }
+        }
+    }
+    
+    if (c == '"') {
+        value.type_ = JsonValue::Type::String;
+        value.string_ = parseString(json, pos);
+        return;
+    }
+    
+    if (json.compare(pos, 4, "true") == 0) {
+        value.type_ = JsonValue::Type::Bool;
+        value.number_ = 1.0;
+        pos += 4;
+        return;
+    }
+    if (json.compare(pos, 5, "false") == 0) {
+        value.type_ = JsonValue::Type::Bool;
+        value.number_ = 0.0;
+        pos += 5;
+        return;
+    }
+    if (json.compare(pos, 4, "null") == 0) {
+        pos += 4;
+        return;
+    }
+    
+    // Nombre (strtod : rapide sur les grands tableaux de poids)
+    const char* start = json.c_str() + pos;
+    char* end = nullptr;
+    const double number = std::strtod(start, &end);
+    if (end == start) {
+        throw std::runtime_error("JSON: valeur invalide");
+    }
+    value.type_ = JsonValue::Type::Number;
+    value.number_ = number;
+    pos += static_cast<size_t>(end - start);
+}
+
 } // namespace webamp
 
@@ -4,6 +4,7 @@
 #include "effect_chain.h"
 #include "effect_manager.h"
 #include "json_parser.h"
+#include "oversampler.h"
 #include <iostream>
 #include <string>
 #include <csignal>
@@ -11,6 +12,7 @@
 #include <thread>
 #include <chrono>
 #include <sstream>
+#include <algorithm>
 
 using namespace webamp;
 
@@ -22,6 +24,85 @@ void signalHandler(int signal) {
     g_running = false;
 }
 
+// Stats périodiques, avec l'état du durcissement temps réel (thread audio
+// et threads de travail)
+std::string buildStatsMessage(const DSPPipeline::Stats& stats) {
+    auto writeThread = [](std::ostringstream& out, const RealtimeThread::State& state) {
+        out << "{\"priority\":" << (state.priority ? "true" : "false")
+            << ",\"priorityValue\":" << state.priorityValue
+            << ",\"affinity\":" << (state.affinity ? "true" : "false")
+            << ",\"cpu\":" << state.cpu
+            << ",\"memoryLocked\":" << (state.memoryLocked ? "true" : "false")
+            << ",\"stackPrefaulted\":" << (state.stackPrefaulted ? "true" : "false")
+            << ",\"denormalsFlushed\":" << (state.denormalsFlushed ? "true" : "false") << "}";
+    };
+    
+    std::ostringstream response;
+    response << "{\"type\":\"stats\",\"cpu\":" << stats.cpuUsage
+             << ",\"latency\":" << stats.latency
+             << ",\"processingLatency\":" << stats.processingLatency
+             << ",\"peakInput\":" << stats.peakInput
+             << ",\"peakOutput\":" << stats.peakOutput
+             << ",\"qualityLevel\":" << stats.qualityLevel
+             << ",\"realtime\":{\"audio\":";
+    writeThread(response, stats.audioThread);
+    response << ",\"workers\":";
+    writeThread(response, stats.workerThreads);
+    response << "}}";
+    return response.str();
+}
+
+// Profil temps réel : coûts en microsecondes par étage (effets identifiés
+// par leur effectId ; fused : blocs où l'effet n'a reçu qu'une part égale du
+// coût de son groupe fusionné), dépassements d'échéance
+std::string buildProfileMessage(const DSPProfiler::Profile& profile, EffectManager& effectManager) {
+    auto writeStage = [](std::ostringstream& out, const DSPProfiler::StageProfile& stage) {
+        const double avg = stage.count ? stage.totalNs / 1000.0 / stage.count : 0.0;
+        out << "\"count\":" << stage.count
+            << ",\"fused\":" << stage.fusedCount
+            << ",\"avg\":" << avg
+            << ",\"p50\":" << DSPProfiler::getPercentile(stage, 0.5) / 1000.0
+            << ",\"p99\":" << DSPProfiler::getPercentile(stage, 0.99) / 1000.0
+            << ",\"max\":" << stage.maxNs / 1000.0;
+    };
+    
+    std::ostringstream response;
+    response << "{\"type\":\"profile\",\"blocks\":" << profile.blocks
+             << ",\"xruns\":" << profile.xruns
+             << ",\"budget\":" << profile.budgetNs / 1000.0
+             << ",\"block\":{";
+    writeStage(response, profile.block);
+    response << "},\"stages\":[";
+    for (uint32_t i = 0; i < profile.stageCount; ++i) {
+        const auto& stage = profile.stages[i];
+        std::string id = stage.label ? stage.label : effectManager.getEffectId(stage.id);
+        response << (i ? "," : "") << "{\"id\":\"" << id << "\","
+                 << "\"kind\":\"" << (stage.label ? "pipeline" : "effect") << "\",";
+        writeStage(response, stage);
+        response << "}";
+    }
+    response << "]}";
+    return response.str();
+}
+
+// Coût mesuré de chaque facteur de suréchantillonnage (mesuré une fois,
+// ~50 ms), pour que le frontend puisse proposer un compromis qualité/CPU
+std::string buildOversamplingCostsMessage() {
+    static const std::vector<Oversampler::Cost> costs = Oversampler::measureCosts();
+    
+    std::ostringstream response;
+    response << "{\"type\":\"oversamplingCosts\",\"costs\":[";
+    for (size_t i = 0; i < costs.size(); ++i) {
+        const auto& cost = costs[i];
+        response << (i ? "," : "") << "{\"factor\":" << cost.factor
+                 << ",\"phase\":\"" << (cost.phase == Oversampler::Phase::Linear ? "linear" : "minimum") << "\""
+                 << ",\"nsPerFrame\":" << cost.nsPerFrame
+                 << ",\"latency\":" << cost.latency << "}";
+    }
+    response << "]}";
+    return response.str();
+}
+
 // Parser de messages WebSocket avec gestion complète des effets
 void handleWebSocketMessage(const std::string& message, AudioEngine& engine, WebSocketServer& server, EffectManager& effectManager) {
     auto data = JsonParser::parse(message);
@@ -36,13 +117,46 @@ void handleWebSocketMessage(const std::string& message, AudioEngine& engine, Web
         server.sendMessage("{\"type\":\"status\",\"running\":false}");
     }
     else if (type == "getStats") {
-        auto stats = engine.getStats();
-        std::ostringstream response;
-        response << "{\"type\":\"stats\",\"cpu\":" << stats.cpuUsage
-                 << ",\"latency\":" << stats.latency
-                 << ",\"peakInput\":" << stats.peakInput
-                 << ",\"peakOutput\":" << stats.peakOutput << "}";
-        server.sendMessage(response.str());
+        server.sendMessage(buildStatsMessage(engine.getStats()));
+    }
+    else if (type == "getProfile") {
+        auto pipeline = engine.getPipeline();
+        if (pipeline) {
+            server.sendMessage(buildProfileMessage(pipeline->getProfile(), effectManager));
+            if (JsonParser::getBool(data, "reset", false)) {
+                pipeline->resetProfile();
+            }
+        } else {
+            server.sendMessage("{\"type\":\"error\",\"message\":\"DSP pipeline non disponible\"}");
+        }
+    }
+    else if (type == "setAdaptiveQuality") {
+        auto pipeline = engine.getPipeline();
+        if (pipeline) {
+            QualityController::Settings settings = pipeline->getAdaptiveQuality();
+            settings.enabled = JsonParser::getBool(data, "enabled", settings.enabled);
+            settings.highWater = JsonParser::getDouble(data, "highWater", settings.highWater);
+            settings.lowWater = JsonParser::getDouble(data, "lowWater", settings.lowWater);
+            settings.downBlocks = static_cast<uint32_t>(std::max(1, JsonParser::getInt(data, "downBlocks", static_cast<int>(settings.downBlocks))));
+            settings.upSeconds = JsonParser::getDouble(data, "upSeconds", settings.upSeconds);
+            settings.maxLevel = static_cast<uint32_t>(std::max(0, JsonParser::getInt(data, "maxLevel", static_cast<int>(settings.maxLevel))));
+            pipeline->setAdaptiveQuality(settings);
+            server.sendMessage("{\"type\":\"ack\"}");
+        } else {
+            server.sendMessage("{\"type\":\"error\",\"message\":\"DSP pipeline non disponible\"}");
+        }
+    }
+    else if (type == "setMonoInput") {
+        auto pipeline = engine.getPipeline();
+        if (pipeline) {
+            pipeline->setMonoInput(JsonParser::getBool(data, "enabled", true));
+            server.sendMessage("{\"type\":\"ack\"}");
+        } else {
+            server.sendMessage("{\"type\":\"error\",\"message\":\"DSP pipeline non disponible\"}");
+        }
+    }
+    else if (type == "getOversamplingCosts") {
+        server.sendMessage(buildOversamplingCostsMessage());
     }
     else if (type == "addEffect") {
         std::string effectType = JsonParser::getString(data, "effectType");
@@ -181,6 +295,21 @@ void handleWebSocketMessage(const std::string& message, AudioEngine& engine, Web
             server.sendMessage("{\"type\":\"error\",\"message\":\"DSP pipeline non disponible\"}");
         }
     }
+    else if (type == "loadLightNAMModel") {
+        // Modèle allégé, utilisé par la dégradation adaptative
+        std::string filePath = JsonParser::getString(data, "filePath");
+        auto pipeline = engine.getPipeline();
+        if (pipeline) {
+            bool success = pipeline->loadLightNAMModel(filePath);
+            if (success) {
+                server.sendMessage("{\"type\":\"ack\"}");
+            } else {
+                server.sendMessage("{\"type\":\"error\",\"message\":\"Échec du chargement du modèle NAM allégé\"}");
+            }
+        } else {
+            server.sendMessage("{\"type\":\"error\",\"message\":\"DSP pipeline non disponible\"}");
+        }
+    }
     else if (type == "setNAMModelActive") {
         bool active = JsonParser::getBool(data, "active", false);
         auto pipeline = engine.getPipeline();
@@ -217,9 +346,17 @@ int main(int argc, char* argv[]) {
     AudioEngine engine;
     std::string driverName = "auto";
     
-    if (argc > 1) {
-        driverName = argv[1];
+    // Arguments : [driver] [--realtime]
+    RealtimeThread::Settings realtimeSettings;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--realtime") {
+            realtimeSettings.enabled = true;
+        } else {
+            driverName = arg;
+        }
     }
+    engine.setRealtimeSettings(realtimeSettings);
     
     if (!engine.initialize(driverName)) {
         std::cerr << "Erreur: Impossible d'initialiser l'engine audio\n";
@@ -270,18 +407,27 @@ int main(int argc, char* argv[]) {
     while (g_running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         
+        // Changements de niveau de qualité (dégradation adaptative), tous
+        // relayés dans l'ordre
+        if (pipeline) {
+            QualityController::Event events[QualityController::EVENT_QUEUE_CAPACITY];
+            const size_t count = pipeline->readQualityEvents(events, QualityController::EVENT_QUEUE_CAPACITY);
+            for (size_t i = 0; i < count; ++i) {
+                std::ostringstream qualityMsg;
+                qualityMsg << "{\"type\":\"quality\",\"level\":" << events[i].level
+                           << ",\"previousLevel\":" << events[i].previousLevel
+                           << ",\"load\":" << events[i].load
+                           << ",\"frame\":" << events[i].frame << "}";
+                server.sendMessage(qualityMsg.str());
+            }
+        }
+        
         // Envoi périodique des stats
         static auto lastStats = std::chrono::steady_clock::now();
         auto now = std::chrono::steady_clock::now();
         if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastStats).count() > 100) {
             if (engine.isRunning()) {
-                auto stats = engine.getStats();
-                std::ostringstream statsMsg;
-                statsMsg << "{\"type\":\"stats\",\"cpu\":" << stats.cpuUsage
-                         << ",\"latency\":" << stats.latency
-                         << ",\"peakInput\":" << stats.peakInput
-                         << ",\"peakOutput\":" << stats.peakOutput << "}";
-                server.sendMessage(statsMsg.str());
+                server.sendMessage(buildStatsMessage(engine.getStats()));
             }
             lastStats = now;
         }
@@ -0,0 +1,244 @@
+#include "../include/nam_effect.h"
+#include <algorithm>
+#include <cmath>
+
+namespace webamp {
+
+namespace {
+
+float dbToLinear(float db) {
+    return std::pow(10.0f, db / 20.0f);
+}
+
+} // namespace
+
+NAMEffect::NAMEffect()
+    : input_db_(0.0f)
+    , output_db_(0.0f)
+    , input_gain_(1.0f)
+    , output_gain_(1.0f)
+    , latency_(0)
+    , resampling_(false)
+    , island_underruns_(0)
+{
+}
+
+void NAMEffect::setSampleRate(uint32_t sampleRate) {
+    if (sampleRate == sample_rate_) {
+        return;
+    }
+    EffectBase::setSampleRate(sampleRate);
+    if (model_) {
+        publishState();
+    }
+}
+
+void NAMEffect::setMaxBlockSize(uint32_t maxFrameCount) {
+    if (maxFrameCount == max_block_size_) {
+        return;
+    }
+    EffectBase::setMaxBlockSize(maxFrameCount);
+    if (model_) {
+        publishState();
+    }
+}
+
+bool NAMEffect::loadModel(const std::string& filePath) {
+    auto model = std::make_shared<NAMModel>();
+    if (!model->loadFromFile(filePath)) {
+        return false;
+    }
+    return installModel(model, false);
+}
+
+bool NAMEffect::loadModelFromMemory(const uint8_t* data, size_t size) {
+    auto model = std::make_shared<NAMModel>();
+    if (!model->loadFromMemory(data, size)) {
+        return false;
+    }
+    return installModel(model, false);
+}
+
+bool NAMEffect::setModel(std::shared_ptr<NAMModel> model) {
+    if (!model) {
+        return false;
+    }
+    return installModel(std::move(model), false);
+}
+
+bool NAMEffect::loadLightModel(const std::string& filePath) {
+    auto model = std::make_shared<NAMModel>();
+    if (!model->loadFromFile(filePath)) {
+        return false;
+    }
+    return installModel(model, true);
+}
+
+bool NAMEffect::loadLightModelFromMemory(const uint8_t* data, size_t size) {
+    auto model = std::make_shared<NAMModel>();
+    if (!model->loadFromMemory(data, size)) {
+        return false;
+    }
+    return installModel(model, true);
+}
+
+bool NAMEffect::installModel(std::shared_ptr<NAMModel> model, bool light) {
+    if (!model->isValid()) {
+        return false;
+    }
+    (light ? light_model_ : model_) = model;
+    if (model_) {
+        publishState();
+    }
+    return true;
+}
+
+void NAMEffect::publishState() {
+    // Le modèle est partagé entre l'ancien et le nouvel état : le thread
+    // audio n'en traite qu'un par bloc
+    auto state = std::make_unique<ModelState>();
+    state->model = model_;
+    state->buffer.assign(max_block_size_, 0.0f);
+    
+    // L'îlot tourne à la fréquence du modèle complet : le modèle allégé
+    // n'est retenu que s'il a été entraîné à la même fréquence
+    const int modelRate = model_->getMetadata().sampleRate;
+    if (light_model_ && light_model_->getMetadata().sampleRate == modelRate) {
+        state->lightModel = light_model_;
+    }
+    
+    state->modelRate = static_cast<int>(sample_rate_);
+    uint32_t latency = 0;
+    if (modelRate > 0 && static_cast<uint32_t>(modelRate) != sample_rate_ && max_block_size_ > 0) {
+        const uint32_t rate = static_cast<uint32_t>(modelRate);
+        const bool upsampler = state->upsampler.init(sample_rate_, rate, max_block_size_);
+        const uint32_t maxModelCount = state->upsampler.getMaxOutputCount(max_block_size_);
+        if (upsampler && state->downsampler.init(rate, sample_rate_, maxModelCount)) {
+            state->modelRate = modelRate;
+            state->island = true;
+            state->modelBuffer.assign(maxModelCount, 0.0f);
+            // Amorce : un échantillon du modèle (ceil(flux / modèle)
+            // échantillons du flux) de zéros en attente dès la publication,
+            // compté dans la latence. Avec les arrondis supérieurs des deux
+            // conversions, count sorties sont toujours prêtes au bloc de
+            // count entrées (voir processIsland).
+            const size_t priming = (sample_rate_ + rate - 1) / rate;
+            // Excédent d'au plus ceil(flux / modèle) + 1 échantillons, plus l'amorce
+            const size_t surplus = priming + 2;
+            state->pending.assign(state->downsampler.getMaxOutputCount(maxModelCount) + surplus + priming, 0.0f);
+            state->pendingCount = priming;
+            
+            const double delay = state->upsampler.getLatency()
+                               + state->downsampler.getLatency() * sample_rate_ / rate;
+            latency = static_cast<uint32_t>(std::lround(delay) + priming);
+        }
+    }
+    latency_.store(latency, std::memory_order_relaxed);
+    resampling_.store(state->island, std::memory_order_relaxed);
+    
+    publisher_.publish(std::move(state));
+}
+
+void NAMEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    SnapshotPublisher<ModelState>::ReadScope state(publisher_);
+    
+    if (bypass_ || !state || channels == 0) {
+        AudioBuffer::copy(input, output, channels, frameCount);
+        return;
+    }
+    
+    // Niveau de qualité 1 : modèle allégé. Son état interne date de sa
+    // dernière utilisation, la bascule n'est pas fondue.
+    NAMModel* model = (quality_tier_ > 0 && state->lightModel) ? state->lightModel.get() : state->model.get();
+    
+    float* buffer = state->buffer.data();
+    const float downmix = 1.0f / static_cast<float>(channels);
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        const uint32_t chunk = static_cast<uint32_t>(std::min<size_t>(frameCount - offset, state->buffer.size()));
+        
+        for (uint32_t i = 0; i < chunk; ++i) {
+            float sum = 0.0f;
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                sum += input[ch][offset + i];
+            }
+            buffer[i] = sum * downmix * input_gain_.getNextValue();
+        }
+        if (state->island) {
+            processIsland(*state.get(), model, buffer, chunk);
+        } else {
+            model->processAudio(buffer, buffer, chunk, state->modelRate);
+        }
+        for (uint32_t i = 0; i < chunk; ++i) {
+            const float sample = buffer[i] * output_gain_.getNextValue();
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                output[ch][offset + i] = sample;
+            }
+        }
+        offset += chunk;
+    }
+}
+
+void NAMEffect::processIsland(ModelState& state, NAMModel* model, float* buffer, uint32_t count) {
+    float* modelBuffer = state.modelBuffer.data();
+    const uint32_t modelCount = state.upsampler.process(buffer, count, modelBuffer);
+    model->processAudio(modelBuffer, modelBuffer, modelCount, state.modelRate);
+    
+    float* pending = state.pending.data();
+    state.pendingCount += state.downsampler.process(modelBuffer, modelCount, pending + state.pendingCount);
+    
+    // Toujours au moins count sorties en attente (amorce, voir
+    // publishState). Sinon, le reste du bloc est du silence, jamais
+    // l'entrée sèche encore présente dans buffer, et le manque est compté.
+    const size_t ready = std::min<size_t>(count, state.pendingCount);
+    std::copy(pending, pending + ready, buffer);
+    if (ready < count) {
+        std::fill(buffer + ready, buffer + count, 0.0f);
+        island_underruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::copy(pending + ready, pending + state.pendingCount, pending);
+    state.pendingCount -= ready;
+}
+
+std::vector<EffectBase::Parameter> NAMEffect::getParameters() const {
+    return {
+        {"input", "Input", -24.0f, 24.0f, 0.0f, input_db_.load(std::memory_order_relaxed)},
+        {"output", "Output", -24.0f, 24.0f, 0.0f, output_db_.load(std::memory_order_relaxed)}
+    };
+}
+
+void NAMEffect::setParameter(const std::string& name, float value) {
+    if (name == "input") {
+        setParameterByIndex(PARAM_INPUT, value);
+    } else if (name == "output") {
+        setParameterByIndex(PARAM_OUTPUT, value);
+    }
+}
+
+void NAMEffect::setParameterByIndex(size_t index, float value) {
+    const uint32_t ramp = getSmoothingSamples();
+    switch (index) {
+        case PARAM_INPUT: {
+            const float db = std::max(-24.0f, std::min(24.0f, value));
+            input_db_.store(db, std::memory_order_relaxed);
+            input_gain_.setTarget(dbToLinear(db), ramp);
+            break;
+        }
+        case PARAM_OUTPUT: {
+            const float db = std::max(-24.0f, std::min(24.0f, value));
+            output_db_.store(db, std::memory_order_relaxed);
+            output_gain_.setTarget(dbToLinear(db), ramp);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+float NAMEffect::getParameter(const std::string& name) const {
+    if (name == "input") return input_db_.load(std::memory_order_relaxed);
+    if (name == "output") return output_db_.load(std::memory_order_relaxed);
+    return 0.0f;
+}
+
+} // namespace webamp
@@ -0,0 +1,610 @@
+#include "../include/nam_inference.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace webamp {
+
+namespace {
+
+size_t nextPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+size_t requireSize(const JsonValue& object, const std::string& key) {
+    const JsonValue* value = object.find(key);
+    if (!value || !value->isNumber() || value->asNumber() < 1.0) {
+        throw std::runtime_error("NAM: paramètre de configuration invalide : " + key);
+    }
+    return static_cast<size_t>(value->asNumber());
+}
+
+std::vector<size_t> requireSizes(const JsonValue& object, const std::string& key) {
+    const JsonValue& array = object[key];
+    if (!array.isArray() || array.size() == 0) {
+        throw std::runtime_error("NAM: paramètre de configuration invalide : " + key);
+    }
+    std::vector<size_t> result;
+    for (const auto& value : array.getArray()) {
+        if (!value.isNumber() || value.asNumber() < 1.0) {
+            throw std::runtime_error("NAM: paramètre de configuration invalide : " + key);
+        }
+        result.push_back(static_cast<size_t>(value.asNumber()));
+    }
+    return result;
+}
+
+// Formes WaveNet de référence de NAM (deux étages, noyau 3, tanh, sans porte)
+struct WaveNetPreset {
+    const char* name;
+    size_t channels[2];
+    size_t headSize[2];
+    bool fullDilations;     // 1..512 sur les deux étages (sinon 1..64, puis 128..512 et 1..64)
+};
+
+const WaveNetPreset WAVENET_PRESETS[] = {
+    {"standard", {16, 8}, {8, 1}, true},
+    {"lite", {12, 6}, {6, 1}, false},
+    {"feather", {8, 4}, {4, 1}, false},
+    {"nano", {4, 2}, {2, 1}, false}
+};
+
+const size_t DILATIONS_FULL[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+const size_t DILATIONS_SHORT[] = {1, 2, 4, 8, 16, 32, 64};
+const size_t DILATIONS_WRAPPED[] = {128, 256, 512, 1, 2, 4, 8, 16, 32, 64};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// NAMWeightReader
+// ---------------------------------------------------------------------------
+
+float NAMWeightReader::next() {
+    if (pos_ >= weights_.size()) {
+        throw std::runtime_error("NAM: nombre de poids insuffisant");
+    }
+    return weights_[pos_++];
+}
+
+void NAMWeightReader::readMatrix(NAMMatrix& matrix, size_t rows, size_t cols) {
+    matrix.resize(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            matrix.at(i, j) = next();
+        }
+    }
+}
+
+void NAMWeightReader::readVector(AlignedVector<float>& vector, size_t count, size_t paddedCount) {
+    vector.assign(std::max(count, paddedCount), 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        vector[i] = next();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// NAMDSP
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<NAMDSP> NAMDSP::create(const JsonValue& document, size_t maxBlockSize) {
+    const std::string architecture = document["architecture"].asString();
+    const JsonValue& config = document["config"];
+    const JsonValue& weightArray = document["weights"];
+    if (!config.isObject() || !weightArray.isArray()) {
+        throw std::runtime_error("NAM: document sans configuration ou sans poids");
+    }
+    
+    std::vector<float> weights;
+    weights.reserve(weightArray.size());
+    for (const auto& value : weightArray.getArray()) {
+        weights.push_back(static_cast<float>(value.asNumber()));
+    }
+    
+    maxBlockSize = std::max<size_t>(maxBlockSize, 1);
+    NAMWeightReader reader(weights);
+    std::unique_ptr<NAMDSP> dsp;
+    if (architecture == "WaveNet") {
+        dsp = std::make_unique<NAMWaveNet>(config, reader, maxBlockSize);
+    } else if (architecture == "LSTM") {
+        dsp = std::make_unique<NAMLSTM>(config, reader, maxBlockSize);
+    } else if (architecture == "ConvNet") {
+        dsp = std::make_unique<NAMConvNet>(config, reader, maxBlockSize);
+    } else if (architecture == "Linear") {
+        dsp = std::make_unique<NAMLinear>(config, reader, maxBlockSize);
+    } else {
+        throw std::runtime_error("NAM: architecture non supportée : " + architecture);
+    }
+    
+    if (reader.remaining() != 0) {
+        throw std::runtime_error("NAM: nombre de poids incohérent avec la configuration");
+    }
+    
+    dsp->reset();
+    return dsp;
+}
+
+NAMActivation NAMDSP::parseActivation(const std::string& name) {
+    if (name == "Tanh") return NAMActivation::Tanh;
+    if (name == "Fasttanh") return NAMActivation::FastTanh;
+    if (name == "Hardtanh") return NAMActivation::HardTanh;
+    if (name == "ReLU") return NAMActivation::ReLU;
+    if (name == "LeakyReLU") return NAMActivation::LeakyReLU;
+    if (name == "Sigmoid") return NAMActivation::Sigmoid;
+    throw std::runtime_error("NAM: activation non supportée : " + name);
+}
+
+void NAMDSP::process(const float* input, float* output, size_t numFrames) {
+    size_t done = 0;
+    while (done < numFrames) {
+        const size_t chunk = std::min(numFrames - done, max_block_size_);
+        processBlock(input + done, output + done, chunk);
+        done += chunk;
+    }
+}
+
+void NAMDSP::prewarm() {
+    float silence[64] = {};
+    float discard[64];
+    size_t remaining = getPrewarmSamples();
+    while (remaining > 0) {
+        const size_t chunk = std::min(remaining, std::min<size_t>(64, max_block_size_));
+        processBlock(silence, discard, chunk);
+        remaining -= chunk;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// NAMLinear
+// ---------------------------------------------------------------------------
+
+NAMLinear::NAMLinear(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize)
+    : NAMDSP(maxBlockSize)
+    , receptive_field_(requireSize(config, "receptive_field"))
+    , bias_(0.0f)
+{
+    // Le poids j s'applique à x[t - j] : stockage chronologique pour le produit scalaire
+    weights_.assign(receptive_field_, 0.0f);
+    for (size_t j = 0; j < receptive_field_; ++j) {
+        weights_[receptive_field_ - 1 - j] = weights.next();
+    }
+    if (config["bias"].asBool(false)) {
+        bias_ = weights.next();
+    }
+    history_.assign(receptive_field_ - 1 + maxBlockSize, 0.0f);
+}
+
+void NAMLinear::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+}
+
+void NAMLinear::processBlock(const float* input, float* output, size_t numFrames) {
+    const size_t tail = receptive_field_ - 1;
+    std::copy(input, input + numFrames, history_.begin() + tail);
+    
+    for (size_t t = 0; t < numFrames; ++t) {
+        output[t] = bias_ + NAMKernels::dot(history_.data() + t, weights_.data(), receptive_field_);
+    }
+    
+    std::copy(history_.begin() + numFrames, history_.begin() + numFrames + tail, history_.begin());
+}
+
+// ---------------------------------------------------------------------------
+// NAMConvNet
+// ---------------------------------------------------------------------------
+
+NAMConvNet::NAMConvNet(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize)
+    : NAMDSP(maxBlockSize)
+    , channels_(requireSize(config, "channels"))
+    , stride_(namPaddedSize(channels_))
+    , activation_(parseActivation(config["activation"].asString("Tanh")))
+    , head_bias_(0.0f)
+    , time_(0)
+    , receptive_field_(1)
+{
+    const std::vector<size_t> dilations = requireSizes(config, "dilations");
+    const bool batchnorm = config["batchnorm"].asBool(false);
+    
+    blocks_.resize(dilations.size());
+    for (size_t b = 0; b < dilations.size(); ++b) {
+        Block& block = blocks_[b];
+        const size_t inputSize = (b == 0) ? 1 : channels_;
+        block.dilation = dilations[b];
+        block.inputStride = namPaddedSize(inputSize);
+        
+        // Conv1D : [sortie][entrée][tap]
+        for (auto& tap : block.conv) {
+            tap.resize(channels_, inputSize);
+        }
+        for (size_t o = 0; o < channels_; ++o) {
+            for (size_t i = 0; i < inputSize; ++i) {
+                for (size_t k = 0; k < KERNEL_SIZE; ++k) {
+                    block.conv[k].at(o, i) = weights.next();
+                }
+            }
+        }
+        
+        block.bias.assign(stride_, 0.0f);
+        if (!batchnorm) {
+            for (size_t o = 0; o < channels_; ++o) {
+                block.bias[o] = weights.next();
+            }
+        } else {
+            // BatchNorm (inférence) repliée dans la convolution : y = scale * conv(x) + loc
+            std::vector<float> mean(channels_), var(channels_), gamma(channels_), beta(channels_);
+            for (auto& v : mean) v = weights.next();
+            for (auto& v : var) v = weights.next();
+            for (auto& v : gamma) v = weights.next();
+            for (auto& v : beta) v = weights.next();
+            const float eps = weights.next();
+            
+            for (size_t o = 0; o < channels_; ++o) {
+                const float scale = gamma[o] / std::sqrt(eps + var[o]);
+                for (auto& tap : block.conv) {
+                    for (size_t i = 0; i < inputSize; ++i) {
+                        tap.at(o, i) *= scale;
+                    }
+                }
+                block.bias[o] = beta[o] - scale * mean[o];
+            }
+        }
+        
+        const size_t historySize = nextPowerOfTwo(block.dilation * (KERNEL_SIZE - 1) + maxBlockSize);
+        block.history.assign(historySize * block.inputStride, 0.0f);
+        block.historyMask = historySize - 1;
+        receptive_field_ += block.dilation * (KERNEL_SIZE - 1);
+    }
+    
+    weights.readVector(head_weights_, channels_, stride_);
+    head_bias_ = weights.next();
+    last_output_.assign(maxBlockSize * stride_, 0.0f);
+}
+
+void NAMConvNet::reset() {
+    for (auto& block : blocks_) {
+        std::fill(block.history.begin(), block.history.end(), 0.0f);
+    }
+    time_ = 0;
+}
+
+void NAMConvNet::processBlock(const float* input, float* output, size_t numFrames) {
+    // Entrée du premier bloc
+    Block& first = blocks_.front();
+    for (size_t t = 0; t < numFrames; ++t) {
+        float* slot = &first.history[((time_ + t) & first.historyMask) * first.inputStride];
+        std::fill(slot, slot + first.inputStride, 0.0f);
+        slot[0] = input[t];
+    }
+    
+    for (size_t b = 0; b < blocks_.size(); ++b) {
+        Block& block = blocks_[b];
+        Block* next = (b + 1 < blocks_.size()) ? &blocks_[b + 1] : nullptr;
+        
+        for (size_t t = 0; t < numFrames; ++t) {
+            const uint64_t now = time_ + t;
+            float* out = next ? &next->history[(now & next->historyMask) * stride_]
+                              : &last_output_[t * stride_];
+            
+            std::copy(block.bias.begin(), block.bias.end(), out);
+            NAMKernels::gemvAccumulate(block.conv[0], &block.history[((now - block.dilation) & block.historyMask) * block.inputStride], out);
+            NAMKernels::gemvAccumulate(block.conv[1], &block.history[(now & block.historyMask) * block.inputStride], out);
+            NAMKernels::activate(activation_, out, channels_);
+        }
+    }
+    
+    for (size_t t = 0; t < numFrames; ++t) {
+        output[t] = head_bias_ + NAMKernels::dot(head_weights_.data(), &last_output_[t * stride_], channels_);
+    }
+    time_ += numFrames;
+}
+
+// ---------------------------------------------------------------------------
+// NAMLSTM
+// ---------------------------------------------------------------------------
+
+NAMLSTM::NAMLSTM(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize)
+    : NAMDSP(maxBlockSize)
+    , hidden_size_(requireSize(config, "hidden_size"))
+    , head_bias_(0.0f)
+{
+    const size_t layerCount = requireSize(config, "num_layers");
+    const size_t inputSize = requireSize(config, "input_size");
+    if (inputSize != 1) {
+        throw std::runtime_error("NAM: LSTM à entrée mono uniquement");
+    }
+    
+    const size_t gateCount = 4 * hidden_size_;
+    cells_.resize(layerCount);
+    for (size_t l = 0; l < layerCount; ++l) {
+        Cell& cell = cells_[l];
+        cell.inputSize = (l == 0) ? inputSize : hidden_size_;
+        weights.readMatrix(cell.weights, gateCount, cell.inputSize + hidden_size_);
+        weights.readVector(cell.bias, gateCount, namPaddedSize(gateCount));
+        weights.readVector(cell.initialHidden, hidden_size_, hidden_size_);
+        weights.readVector(cell.initialCell, hidden_size_, hidden_size_);
+        cell.xh.assign(cell.inputSize + hidden_size_, 0.0f);
+        cell.cell.assign(hidden_size_, 0.0f);
+        cell.gates.assign(namPaddedSize(gateCount), 0.0f);
+    }
+    
+    weights.readVector(head_weights_, hidden_size_, hidden_size_);
+    head_bias_ = weights.next();
+}
+
+void NAMLSTM::reset() {
+    for (auto& cell : cells_) {
+        std::fill(cell.xh.begin(), cell.xh.begin() + cell.inputSize, 0.0f);
+        std::copy(cell.initialHidden.begin(), cell.initialHidden.end(), cell.xh.begin() + cell.inputSize);
+        std::copy(cell.initialCell.begin(), cell.initialCell.end(), cell.cell.begin());
+    }
+}
+
+void NAMLSTM::processBlock(const float* input, float* output, size_t numFrames) {
+    const size_t h = hidden_size_;
+    
+    for (size_t t = 0; t < numFrames; ++t) {
+        for (size_t l = 0; l < cells_.size(); ++l) {
+            Cell& cell = cells_[l];
+            if (l == 0) {
+                cell.xh[0] = input[t];
+            } else {
+                const Cell& previous = cells_[l - 1];
+                std::copy(previous.xh.begin() + previous.inputSize, previous.xh.end(), cell.xh.begin());
+            }
+            
+            // Portes i, f, g, o
+            float* gates = cell.gates.data();
+            std::copy(cell.bias.begin(), cell.bias.end(), gates);
+            NAMKernels::gemvAccumulate(cell.weights, cell.xh.data(), gates);
+            NAMKernels::activate(NAMActivation::Sigmoid, gates, 2 * h);
+            NAMKernels::activate(NAMActivation::Tanh, gates + 2 * h, h);
+            NAMKernels::activate(NAMActivation::Sigmoid, gates + 3 * h, h);
+            
+            // c = f * c + i * g ; h = o * tanh(c) (tanh(c) calculé dans la zone de g)
+            for (size_t k = 0; k < h; ++k) {
+                cell.cell[k] = gates[h + k] * cell.cell[k] + gates[k] * gates[2 * h + k];
+                gates[2 * h + k] = cell.cell[k];
+            }
+            NAMKernels::activate(NAMActivation::Tanh, gates + 2 * h, h);
+            float* hidden = cell.xh.data() + cell.inputSize;
+            for (size_t k = 0; k < h; ++k) {
+                hidden[k] = gates[3 * h + k] * gates[2 * h + k];
+            }
+        }
+        
+        const Cell& last = cells_.back();
+        output[t] = head_bias_ + NAMKernels::dot(head_weights_.data(), last.xh.data() + last.inputSize, h);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// NAMWaveNet
+// ---------------------------------------------------------------------------
+
+NAMWaveNet::NAMWaveNet(const JsonValue& config, NAMWeightReader& weights, size_t maxBlockSize)
+    : NAMDSP(maxBlockSize)
+    , head_scale_(1.0f)
+    , time_(0)
+    , receptive_field_(1)
+    , preset_("custom")
+{
+    const JsonValue& layers = config["layers"];
+    if (!layers.isArray() || layers.size() == 0) {
+        throw std::runtime_error("NAM: WaveNet sans couches");
+    }
+    if (!config["head"].isNull()) {
+        throw std::runtime_error("NAM: tête WaveNet non supportée");
+    }
+    
+    size_t maxConvStride = 0;
+    arrays_.resize(layers.size());
+    for (size_t a = 0; a < layers.size(); ++a) {
+        const JsonValue& desc = layers[a];
+        LayerArray& array = arrays_[a];
+        array.inputSize = requireSize(desc, "input_size");
+        array.channels = requireSize(desc, "channels");
+        array.stride = namPaddedSize(array.channels);
+        array.headSize = requireSize(desc, "head_size");
+        array.kernelSize = requireSize(desc, "kernel_size");
+        array.gated = desc["gated"].asBool(false);
+        array.activation = parseActivation(desc["activation"].asString("Tanh"));
+        const bool headBias = desc["head_bias"].asBool(false);
+        const std::vector<size_t> dilations = requireSizes(desc, "dilations");
+        
+        // Chaînage : la sortie d'un étage alimente le suivant, sa tête devient
+        // l'accumulateur de tête du suivant
+        if (requireSize(desc, "condition_size") != 1) {
+            throw std::runtime_error("NAM: condition mono uniquement");
+        }
+        const size_t expectedInput = (a == 0) ? 1 : arrays_[a - 1].channels;
+        if (array.inputSize != expectedInput || (a > 0 && arrays_[a - 1].headSize != array.channels)) {
+            throw std::runtime_error("NAM: dimensions WaveNet incohérentes");
+        }
+        
+        const size_t convOut = array.gated ? 2 * array.channels : array.channels;
+        maxConvStride = std::max(maxConvStride, namPaddedSize(convOut));
+        
+        weights.readMatrix(array.rechannel, array.channels, array.inputSize);
+        
+        array.layers.resize(dilations.size());
+        for (size_t l = 0; l < dilations.size(); ++l) {
+            Layer& layer = array.layers[l];
+            layer.dilation = dilations[l];
+            
+            // Conv1D : [sortie][entrée][tap]
+            layer.conv.resize(array.kernelSize);
+            for (auto& tap : layer.conv) {
+                tap.resize(convOut, array.channels);
+            }
+            for (size_t o = 0; o < convOut; ++o) {
+                for (size_t i = 0; i < array.channels; ++i) {
+                    for (size_t k = 0; k < array.kernelSize; ++k) {
+                        layer.conv[k].at(o, i) = weights.next();
+                    }
+                }
+            }
+            weights.readVector(layer.convBias, convOut, namPaddedSize(convOut));
+            weights.readMatrix(layer.mixin, convOut, 1);
+            weights.readMatrix(layer.oneByOne, array.channels, array.channels);
+            weights.readVector(layer.oneByOneBias, array.channels, array.stride);
+            
+            const size_t span = (array.kernelSize - 1) * layer.dilation;
+            const size_t historySize = nextPowerOfTwo(span + maxBlockSize);
+            layer.history.assign(historySize * array.stride, 0.0f);
+            layer.historyMask = historySize - 1;
+            receptive_field_ += span;
+        }
+        
+        weights.readMatrix(array.headRechannel, array.headSize, array.channels);
+        weights.readVector(array.headBias, headBias ? array.headSize : 0, namPaddedSize(array.headSize));
+        
+        const size_t outputSize = nextPowerOfTwo(maxBlockSize);
+        array.output.assign(outputSize * array.stride, 0.0f);
+        array.outputMask = outputSize - 1;
+        array.head.assign(maxBlockSize * array.stride, 0.0f);
+        array.kernel = NAMKernels::findWaveNetLayerKernel(array.channels, array.kernelSize,
+                                                          array.gated, array.activation);
+    }
+    
+    if (arrays_.back().headSize != 1) {
+        throw std::runtime_error("NAM: sortie WaveNet mono uniquement");
+    }
+    head_scale_ = weights.next();
+    
+    condition_.assign(maxBlockSize * NAM_SIMD_WIDTH, 0.0f);
+    head_output_.assign(maxBlockSize * NAM_SIMD_WIDTH, 0.0f);
+    z_.assign(maxConvStride, 0.0f);
+    preset_ = detectPreset();
+}
+
+const char* NAMWaveNet::detectPreset() const {
+    if (arrays_.size() != 2) {
+        return "custom";
+    }
+    auto matches = [](const std::vector<Layer>& layers, const size_t* dilations, size_t count) {
+        if (layers.size() != count) {
+            return false;
+        }
+        for (size_t l = 0; l < count; ++l) {
+            if (layers[l].dilation != dilations[l]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    for (const auto& preset : WAVENET_PRESETS) {
+        bool match = true;
+        for (size_t a = 0; a < 2 && match; ++a) {
+            const LayerArray& array = arrays_[a];
+            match = array.channels == preset.channels[a] && array.headSize == preset.headSize[a]
+                 && array.kernelSize == 3 && !array.gated && array.activation == NAMActivation::Tanh;
+        }
+        if (!match) {
+            continue;
+        }
+        const bool dilationsMatch = preset.fullDilations
+            ? matches(arrays_[0].layers, DILATIONS_FULL, 10) && matches(arrays_[1].layers, DILATIONS_FULL, 10)
+            : matches(arrays_[0].layers, DILATIONS_SHORT, 7) && matches(arrays_[1].layers, DILATIONS_WRAPPED, 10);
+        if (dilationsMatch) {
+            return preset.name;
+        }
+    }
+    return "custom";
+}
+
+bool NAMWaveNet::isSpecialised() const {
+    for (const auto& array : arrays_) {
+        if (!array.kernel) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NAMWaveNet::reset() {
+    for (auto& array : arrays_) {
+        for (auto& layer : array.layers) {
+            std::fill(layer.history.begin(), layer.history.end(), 0.0f);
+        }
+    }
+    time_ = 0;
+}
+
+void NAMWaveNet::processLayer(LayerArray& array, size_t layerIndex, size_t numFrames) {
+    Layer& layer = array.layers[layerIndex];
+    const bool last = layerIndex + 1 == array.layers.size();
+    Layer* next = last ? nullptr : &array.layers[layerIndex + 1];
+    
+    NAMWaveNetLayerView view;
+    view.channels = array.channels;
+    view.stride = array.stride;
+    view.kernelSize = array.kernelSize;
+    view.dilation = layer.dilation;
+    view.gated = array.gated;
+    view.activation = array.activation;
+    view.conv = layer.conv.data();
+    view.convBias = layer.convBias.data();
+    view.mixin = &layer.mixin;
+    view.oneByOne = &layer.oneByOne;
+    view.oneByOneBias = layer.oneByOneBias.data();
+    view.input = layer.history.data();
+    view.inputMask = layer.historyMask;
+    view.output = last ? array.output.data() : next->history.data();
+    view.outputMask = last ? array.outputMask : next->historyMask;
+    view.condition = condition_.data();
+    view.head = array.head.data();
+    view.scratch = z_.data();
+    
+    if (array.kernel) {
+        array.kernel(view, time_, numFrames);
+    } else {
+        NAMKernels::waveNetLayer(view, time_, numFrames);
+    }
+}
+
+void NAMWaveNet::processBlock(const float* input, float* output, size_t numFrames) {
+    for (size_t t = 0; t < numFrames; ++t) {
+        condition_[t * NAM_SIMD_WIDTH] = input[t];
+    }
+    std::fill(arrays_.front().head.begin(), arrays_.front().head.begin() + numFrames * arrays_.front().stride, 0.0f);
+    
+    for (size_t a = 0; a < arrays_.size(); ++a) {
+        LayerArray& array = arrays_[a];
+        const LayerArray* previous = (a == 0) ? nullptr : &arrays_[a - 1];
+        
+        // Rechannel vers l'historique de la première couche
+        Layer& first = array.layers.front();
+        for (size_t t = 0; t < numFrames; ++t) {
+            const uint64_t now = time_ + t;
+            const float* in = previous ? &previous->output[(now & previous->outputMask) * previous->stride]
+                                       : &condition_[t * NAM_SIMD_WIDTH];
+            float* slot = &first.history[(now & first.historyMask) * array.stride];
+            std::fill(slot, slot + array.stride, 0.0f);
+            NAMKernels::gemvAccumulate(array.rechannel, in, slot);
+        }
+        
+        for (size_t l = 0; l < array.layers.size(); ++l) {
+            processLayer(array, l, numFrames);
+        }
+        
+        // Tête : alimente l'accumulateur de l'étage suivant (ou la sortie)
+        float* headTarget = (a + 1 < arrays_.size()) ? arrays_[a + 1].head.data() : head_output_.data();
+        const size_t headStride = array.headRechannel.stride;
+        for (size_t t = 0; t < numFrames; ++t) {
+            float* dst = headTarget + t * headStride;
+            std::copy(array.headBias.begin(), array.headBias.end(), dst);
+            NAMKernels::gemvAccumulate(array.headRechannel, &array.head[t * array.stride], dst);
+        }
+    }
+    
+    for (size_t t = 0; t < numFrames; ++t) {
+        output[t] = head_scale_ * head_output_[t * NAM_SIMD_WIDTH];
+    }
+    time_ += numFrames;
+}
+
+} // namespace webamp
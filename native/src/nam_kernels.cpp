@@ -0,0 +1,373 @@
+#include "../include/nam_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define WEBAMP_NAM_AVX2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define WEBAMP_NAM_NEON 1
+#endif
+
+namespace webamp {
+
+namespace {
+
+// Opérations vectorielles minimales : chaque noyau est écrit une seule fois
+// (templates) et instancié pour la largeur native et pour le scalaire (restes)
+struct ScalarOps {
+    using V = float;
+    static constexpr size_t WIDTH = 1;
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V set1(float v) { return v; }
+    static V add(V a, V b) { return a + b; }
+    static V mul(V a, V b) { return a * b; }
+    static V fma(V a, V b, V c) { return a * b + c; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return std::min(a, b); }
+    static V max(V a, V b) { return std::max(a, b); }
+    static V abs(V a) { return std::fabs(a); }
+    static float sum(V a) { return a; }
+};
+
+#if defined(WEBAMP_NAM_AVX2)
+struct VectorOps {
+    using V = __m256;
+    static constexpr size_t WIDTH = 8;
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float v) { return _mm256_set1_ps(v); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V fma(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static float sum(V a) {
+        __m128 lo = _mm256_castps256_ps128(a);
+        __m128 hi = _mm256_extractf128_ps(a, 1);
+        lo = _mm_add_ps(lo, hi);
+        lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+        lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+        return _mm_cvtss_f32(lo);
+    }
+};
+#elif defined(WEBAMP_NAM_NEON)
+struct VectorOps {
+    using V = float32x4_t;
+    static constexpr size_t WIDTH = 4;
+    static V load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, V v) { vst1q_f32(p, v); }
+    static V set1(float v) { return vdupq_n_f32(v); }
+    static V add(V a, V b) { return vaddq_f32(a, b); }
+    static V mul(V a, V b) { return vmulq_f32(a, b); }
+    static V fma(V a, V b, V c) { return vfmaq_f32(c, a, b); }
+    static V div(V a, V b) { return vdivq_f32(a, b); }
+    static V min(V a, V b) { return vminq_f32(a, b); }
+    static V max(V a, V b) { return vmaxq_f32(a, b); }
+    static V abs(V a) { return vabsq_f32(a); }
+    static float sum(V a) { return vaddvq_f32(a); }
+};
+#else
+using VectorOps = ScalarOps;
+#endif
+
+// tanh rationnelle (13/6) bornée, erreur < 1e-6 sur tout l'intervalle
+template<typename Ops>
+typename Ops::V tanhKernel(typename Ops::V x) {
+    using V = typename Ops::V;
+    x = Ops::max(Ops::min(x, Ops::set1(7.90531110763549805f)), Ops::set1(-7.90531110763549805f));
+    const V x2 = Ops::mul(x, x);
+    
+    V p = Ops::set1(-2.76076847742355e-16f);
+    p = Ops::fma(x2, p, Ops::set1(2.00018790482477e-13f));
+    p = Ops::fma(x2, p, Ops::set1(-8.60467152213735e-11f));
+    p = Ops::fma(x2, p, Ops::set1(5.12229709037114e-08f));
+    p = Ops::fma(x2, p, Ops::set1(1.48572235717979e-05f));
+    p = Ops::fma(x2, p, Ops::set1(6.37261928875436e-04f));
+    p = Ops::fma(x2, p, Ops::set1(4.89352455891786e-03f));
+    p = Ops::mul(x, p);
+    
+    V q = Ops::set1(1.19825839466702e-06f);
+    q = Ops::fma(x2, q, Ops::set1(1.18534705686654e-04f));
+    q = Ops::fma(x2, q, Ops::set1(2.26843463243900e-03f));
+    q = Ops::fma(x2, q, Ops::set1(4.89352518554385e-03f));
+    return Ops::div(p, q);
+}
+
+// "Fasttanh" de NAM (même approximation que l'entraînement)
+template<typename Ops>
+typename Ops::V fastTanhKernel(typename Ops::V x) {
+    using V = typename Ops::V;
+    const V ax = Ops::abs(x);
+    const V x2 = Ops::mul(x, x);
+    const V a = Ops::fma(Ops::set1(2.45550750702956f), ax, Ops::set1(2.45550750702956f));
+    const V b = Ops::fma(Ops::set1(0.821226666969744f), ax, Ops::set1(0.893229853513558f));
+    const V num = Ops::mul(x, Ops::fma(b, x2, a));
+    const V inner = Ops::abs(Ops::fma(Ops::mul(Ops::set1(0.814642734961073f), x), ax, x));
+    const V den = Ops::fma(Ops::add(Ops::set1(2.44506634652299f), x2), inner, Ops::set1(2.44506634652299f));
+    return Ops::div(num, den);
+}
+
+template<typename Ops>
+typename Ops::V sigmoidKernel(typename Ops::V x) {
+    const typename Ops::V half = Ops::set1(0.5f);
+    return Ops::fma(half, tanhKernel<Ops>(Ops::mul(half, x)), half);
+}
+
+template<typename Ops>
+typename Ops::V activationKernel(NAMActivation activation, typename Ops::V x) {
+    switch (activation) {
+        case NAMActivation::Tanh:
+            return tanhKernel<Ops>(x);
+        case NAMActivation::FastTanh:
+            return fastTanhKernel<Ops>(x);
+        case NAMActivation::HardTanh:
+            return Ops::max(Ops::min(x, Ops::set1(1.0f)), Ops::set1(-1.0f));
+        case NAMActivation::ReLU:
+            return Ops::max(x, Ops::set1(0.0f));
+        case NAMActivation::LeakyReLU:
+            return Ops::max(x, Ops::mul(x, Ops::set1(0.01f)));
+        case NAMActivation::Sigmoid:
+            return sigmoidKernel<Ops>(x);
+        case NAMActivation::Identity:
+        default:
+            return x;
+    }
+}
+
+template<NAMActivation Activation>
+void activateRange(float* x, size_t count) {
+    size_t i = 0;
+    for (; i + VectorOps::WIDTH <= count; i += VectorOps::WIDTH) {
+        VectorOps::store(x + i, activationKernel<VectorOps>(Activation, VectorOps::load(x + i)));
+    }
+    for (; i < count; ++i) {
+        x[i] = activationKernel<ScalarOps>(Activation, x[i]);
+    }
+}
+
+// Couche WaveNet à forme fixe (activation tanh, sans porte) : Channels et
+// KernelSize constants, toutes les boucles internes se déroulent et la sortie
+// de convolution d'une frame reste dans REGS registres
+template<size_t Channels, size_t KernelSize>
+void waveNetLayerFixed(const NAMWaveNetLayerView& layer, uint64_t time, size_t numFrames) {
+    using Ops = VectorOps;
+    using V = typename Ops::V;
+    constexpr size_t STRIDE = (Channels + NAM_SIMD_WIDTH - 1) / NAM_SIMD_WIDTH * NAM_SIMD_WIDTH;
+    constexpr size_t REGS = (Channels + Ops::WIDTH - 1) / Ops::WIDTH;
+    
+    const float* conv[KernelSize];
+    for (size_t k = 0; k < KernelSize; ++k) {
+        conv[k] = layer.conv[k].data.data();
+    }
+    const float* mixin = layer.mixin->data.data();
+    const float* oneByOne = layer.oneByOne->data.data();
+    const size_t dilation = layer.dilation;
+    
+    for (size_t t = 0; t < numFrames; ++t) {
+        const uint64_t now = time + t;
+        
+        V z[REGS];
+        for (size_t r = 0; r < REGS; ++r) {
+            z[r] = Ops::load(layer.convBias + r * Ops::WIDTH);
+        }
+        for (size_t k = 0; k < KernelSize; ++k) {
+            const uint64_t offset = (KernelSize - 1 - k) * dilation;
+            const float* x = layer.input + ((now - offset) & layer.inputMask) * STRIDE;
+            for (size_t j = 0; j < Channels; ++j) {
+                const V xj = Ops::set1(x[j]);
+                for (size_t r = 0; r < REGS; ++r) {
+                    z[r] = Ops::fma(Ops::load(conv[k] + j * STRIDE + r * Ops::WIDTH), xj, z[r]);
+                }
+            }
+        }
+        const V condition = Ops::set1(layer.condition[t * NAM_SIMD_WIDTH]);
+        float* head = layer.head + t * STRIDE;
+        alignas(32) float activated[REGS * Ops::WIDTH];
+        for (size_t r = 0; r < REGS; ++r) {
+            z[r] = tanhKernel<Ops>(Ops::fma(Ops::load(mixin + r * Ops::WIDTH), condition, z[r]));
+            Ops::store(head + r * Ops::WIDTH, Ops::add(Ops::load(head + r * Ops::WIDTH), z[r]));
+            Ops::store(activated + r * Ops::WIDTH, z[r]);
+        }
+        
+        // Sortie résiduelle : entrée + 1x1(z). Les voies de padding restent nulles.
+        const float* in = layer.input + (now & layer.inputMask) * STRIDE;
+        V out[REGS];
+        for (size_t r = 0; r < REGS; ++r) {
+            out[r] = Ops::add(Ops::load(in + r * Ops::WIDTH), Ops::load(layer.oneByOneBias + r * Ops::WIDTH));
+        }
+        for (size_t j = 0; j < Channels; ++j) {
+            const V zj = Ops::set1(activated[j]);
+            for (size_t r = 0; r < REGS; ++r) {
+                out[r] = Ops::fma(Ops::load(oneByOne + j * STRIDE + r * Ops::WIDTH), zj, out[r]);
+            }
+        }
+        float* dst = layer.output + (now & layer.outputMask) * STRIDE;
+        for (size_t r = 0; r < REGS; ++r) {
+            Ops::store(dst + r * Ops::WIDTH, out[r]);
+        }
+    }
+}
+
+} // namespace
+
+void NAMKernels::gemvAccumulate(const NAMMatrix& m, const float* x, float* y) {
+    using Ops = VectorOps;
+    const size_t stride = m.stride;
+    const size_t cols = m.cols;
+    const float* data = m.data.data();
+    size_t r = 0;
+    
+    // Deux registres d'accumulation par passage : chaque diffusion de x[j] sert deux fois
+    for (; r + 2 * Ops::WIDTH <= stride; r += 2 * Ops::WIDTH) {
+        typename Ops::V acc0 = Ops::load(y + r);
+        typename Ops::V acc1 = Ops::load(y + r + Ops::WIDTH);
+        const float* column = data + r;
+        for (size_t j = 0; j < cols; ++j, column += stride) {
+            const typename Ops::V xj = Ops::set1(x[j]);
+            acc0 = Ops::fma(Ops::load(column), xj, acc0);
+            acc1 = Ops::fma(Ops::load(column + Ops::WIDTH), xj, acc1);
+        }
+        Ops::store(y + r, acc0);
+        Ops::store(y + r + Ops::WIDTH, acc1);
+    }
+    for (; r < stride; r += Ops::WIDTH) {
+        typename Ops::V acc = Ops::load(y + r);
+        const float* column = data + r;
+        for (size_t j = 0; j < cols; ++j, column += stride) {
+            acc = Ops::fma(Ops::load(column), Ops::set1(x[j]), acc);
+        }
+        Ops::store(y + r, acc);
+    }
+}
+
+void NAMKernels::add(const float* x, float* y, size_t count) {
+    size_t i = 0;
+    for (; i + VectorOps::WIDTH <= count; i += VectorOps::WIDTH) {
+        VectorOps::store(y + i, VectorOps::add(VectorOps::load(y + i), VectorOps::load(x + i)));
+    }
+    for (; i < count; ++i) {
+        y[i] += x[i];
+    }
+}
+
+void NAMKernels::activate(NAMActivation activation, float* x, size_t count) {
+    // Dispatch hors de la boucle : une instanciation par activation
+    switch (activation) {
+        case NAMActivation::Tanh:
+            activateRange<NAMActivation::Tanh>(x, count);
+            break;
+        case NAMActivation::FastTanh:
+            activateRange<NAMActivation::FastTanh>(x, count);
+            break;
+        case NAMActivation::HardTanh:
+            activateRange<NAMActivation::HardTanh>(x, count);
+            break;
+        case NAMActivation::ReLU:
+            activateRange<NAMActivation::ReLU>(x, count);
+            break;
+        case NAMActivation::LeakyReLU:
+            activateRange<NAMActivation::LeakyReLU>(x, count);
+            break;
+        case NAMActivation::Sigmoid:
+            activateRange<NAMActivation::Sigmoid>(x, count);
+            break;
+        case NAMActivation::Identity:
+        default:
+            break;
+    }
+}
+
+void NAMKernels::gatedActivate(NAMActivation activation, float* x, size_t channels) {
+    activate(activation, x, channels);
+    activate(NAMActivation::Sigmoid, x + channels, channels);
+    
+    const float* gate = x + channels;
+    size_t i = 0;
+    for (; i + VectorOps::WIDTH <= channels; i += VectorOps::WIDTH) {
+        VectorOps::store(x + i, VectorOps::mul(VectorOps::load(x + i), VectorOps::load(gate + i)));
+    }
+    for (; i < channels; ++i) {
+        x[i] *= gate[i];
+    }
+}
+
+float NAMKernels::dot(const float* a, const float* b, size_t count) {
+    typename VectorOps::V acc = VectorOps::set1(0.0f);
+    size_t i = 0;
+    for (; i + VectorOps::WIDTH <= count; i += VectorOps::WIDTH) {
+        acc = VectorOps::fma(VectorOps::load(a + i), VectorOps::load(b + i), acc);
+    }
+    float result = VectorOps::sum(acc);
+    for (; i < count; ++i) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+void NAMKernels::waveNetLayer(const NAMWaveNetLayerView& layer, uint64_t time, size_t numFrames) {
+    const size_t stride = layer.stride;
+    const size_t convStride = layer.mixin->stride;
+    float* z = layer.scratch;
+    
+    for (size_t t = 0; t < numFrames; ++t) {
+        const uint64_t now = time + t;
+        
+        // Convolution causale dilatée : le dernier tap s'applique à la frame courante
+        std::copy(layer.convBias, layer.convBias + convStride, z);
+        for (size_t k = 0; k < layer.kernelSize; ++k) {
+            const uint64_t offset = (layer.kernelSize - 1 - k) * layer.dilation;
+            gemvAccumulate(layer.conv[k], layer.input + ((now - offset) & layer.inputMask) * stride, z);
+        }
+        gemvAccumulate(*layer.mixin, layer.condition + t * NAM_SIMD_WIDTH, z);
+        
+        if (layer.gated) {
+            gatedActivate(layer.activation, z, layer.channels);
+        } else {
+            activate(layer.activation, z, layer.channels);
+        }
+        add(z, layer.head + t * stride, layer.channels);
+        
+        // Sortie résiduelle : entrée + 1x1(z)
+        const float* in = layer.input + (now & layer.inputMask) * stride;
+        float* out = layer.output + (now & layer.outputMask) * stride;
+        std::copy(in, in + stride, out);
+        add(layer.oneByOneBias, out, stride);
+        gemvAccumulate(*layer.oneByOne, z, out);
+    }
+}
+
+NAMWaveNetLayerKernel NAMKernels::findWaveNetLayerKernel(size_t channels, size_t kernelSize,
+                                                         bool gated, NAMActivation activation) {
+    // Toutes les architectures de référence : noyau 3, tanh, sans porte
+    if (gated || activation != NAMActivation::Tanh || kernelSize != 3) {
+        return nullptr;
+    }
+    switch (channels) {
+        case 16: return &waveNetLayerFixed<16, 3>;     // standard
+        case 12: return &waveNetLayerFixed<12, 3>;     // lite
+        case 8:  return &waveNetLayerFixed<8, 3>;      // standard (2e étage), feather
+        case 6:  return &waveNetLayerFixed<6, 3>;      // lite (2e étage)
+        case 4:  return &waveNetLayerFixed<4, 3>;      // feather (2e étage), nano
+        case 2:  return &waveNetLayerFixed<2, 3>;      // nano (2e étage)
+        default: return nullptr;
+    }
+}
+
+float NAMKernels::tanhApprox(float x) {
+    return tanhKernel<ScalarOps>(x);
+}
+
+float NAMKernels::fastTanh(float x) {
+    return fastTanhKernel<ScalarOps>(x);
+}
+
+float NAMKernels::sigmoidApprox(float x) {
+    return sigmoidKernel<ScalarOps>(x);
+}
+
+} // namespace webamp
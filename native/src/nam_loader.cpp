@@ -10,6 +10,8 @@
 #include <sstream>
 #include <iostream>
 #include <regex>
+#include <algorithm>
+#include <initializer_list>
 
 using namespace webamp;
 
@@ -51,12 +53,36 @@ bool NAMModel::loadFromMemory(const uint8_t* data, size_t size) {
         return false;
     }
 
-    // Parser les métadonnées
-    if (!parseMetadata(data, size)) {
-        std::cerr << "Failed to parse NAM metadata" << std::endl;
+    valid_ = false;
+    dsp_.reset();
+
+    // Le document JSON commence au premier '{' (BOM éventuel ignoré)
+    size_t jsonStart = 0;
+    while (jsonStart < size && data[jsonStart] != '{') {
+        ++jsonStart;
+    }
+    if (jsonStart == size) {
+        std::cerr << "NAM file is not a JSON document" << std::endl;
+        return false;
+    }
+
+    try {
+        std::string json(reinterpret_cast<const char*>(data + jsonStart), size - jsonStart);
+        JsonValue document = JsonParser::parseDocument(json);
+
+        parseMetadata(document);
+
+        // Moteur d'inférence : poids pré-transposés, état alloué une fois
+        dsp_ = NAMDSP::create(document);
+        dsp_->prewarm();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load NAM model: " << e.what() << std::endl;
+        dsp_.reset();
         return false;
     }
 
+    scratch_.assign(dsp_->getMaxBlockSize(), 0.0f);
+
     // Copier les données du modèle
     modelData_.assign(data, data + size);
     valid_ = true;
@@ -64,108 +90,83 @@ bool NAMModel::loadFromMemory(const uint8_t* data, size_t size) {
     return true;
 }
 
-bool NAMModel::parseMetadata(const uint8_t* data, size_t size) {
-    // Les fichiers NAM commencent généralement par un header JSON
-    // Chercher le début du JSON
-    size_t jsonStart = 0;
-    for (size_t i = 0; i < size && i < 1024; ++i) {
-        if (data[i] == '{') {
-            jsonStart = i;
-            break;
+void NAMModel::parseMetadata(const JsonValue& document) {
+    // Métadonnées dans l'objet "metadata" (format NAM), sinon à la racine
+    const JsonValue& metadata = document["metadata"];
+    auto findValue = [&](const char* key) -> const JsonValue& {
+        const JsonValue* value = metadata.find(key);
+        return (value && !value->isNull()) ? *value : document[key];
+    };
+    auto getString = [&](std::initializer_list<const char*> keys, const std::string& defaultValue) {
+        for (const char* key : keys) {
+            const JsonValue& value = findValue(key);
+            if (value.isString() && !value.asString().empty()) {
+                return value.asString();
+            }
         }
-    }
-
-    // Chercher la fin du JSON
-    size_t jsonEnd = jsonStart;
-    int braceCount = 0;
-    for (size_t i = jsonStart; i < size && i < jsonStart + 2048; ++i) {
-        if (data[i] == '{') braceCount++;
-        if (data[i] == '}') {
-            braceCount--;
-            if (braceCount == 0) {
-                jsonEnd = i + 1;
-                break;
+        return defaultValue;
+    };
+    auto getNumber = [&](std::initializer_list<const char*> keys, double defaultValue) {
+        for (const char* key : keys) {
+            const JsonValue& value = findValue(key);
+            if (value.isNumber() && value.asNumber() != 0.0) {
+                return value.asNumber();
             }
         }
+        return defaultValue;
+    };
+
+    metadata_.name = getString({"name"}, "Unknown Model");
+    metadata_.author = getString({"author", "modeled_by"}, "");
+    metadata_.description = getString({"description"}, "");
+    metadata_.modelType = getString({"model_type", "modelType", "gear_type"}, "amp");
+    metadata_.version = getString({"version"}, "");
+    metadata_.sampleRate = static_cast<int>(getNumber({"sample_rate", "sampleRate"}, 48000.0));
+    metadata_.inputGain = static_cast<float>(getNumber({"input_gain", "inputGain"}, 1.0));
+    metadata_.outputGain = static_cast<float>(getNumber({"output_gain", "outputGain"}, 1.0));
+    metadata_.toneStack = getString({"tone_stack", "toneStack", "tone_type"}, "");
+
+    metadata_.tags.clear();
+    const JsonValue& tags = findValue("tags");
+    for (const auto& tag : tags.getArray()) {
+        if (tag.isString()) {
+            metadata_.tags.push_back(tag.asString());
+        }
     }
+}
 
-    if (jsonEnd <= jsonStart) {
-        // Pas de JSON trouvé, utiliser des valeurs par défaut
-        metadata_.name = "Unknown Model";
-        metadata_.modelType = "amp";
-        metadata_.sampleRate = 48000;
-        return true;
-    }
+void NAMModel::processAudio(float* input, float* output, size_t numSamples, int sampleRate) {
+    // Le modèle tourne à metadata_.sampleRate : le flux y est converti en
+    // amont (NAMEffect), sampleRate n'est donc pas utilisé ici
+    (void)sampleRate;
 
-    // Parser le JSON avec JsonParser
-    try {
-        std::string jsonStr(reinterpret_cast<const char*>(data + jsonStart), jsonEnd - jsonStart);
-        
-        // Utiliser JsonParser pour parser le JSON
-        auto jsonData = JsonParser::parse(jsonStr);
-        
-        // Extraire les métadonnées avec JsonParser
-        metadata_.name = JsonParser::getString(jsonData, "name", "Unknown Model");
-        metadata_.author = JsonParser::getString(jsonData, "author", "");
-        metadata_.description = JsonParser::getString(jsonData, "description", "");
-        
-        // Essayer model_type puis modelType
-        std::string modelType = JsonParser::getString(jsonData, "model_type", "");
-        if (modelType.empty()) {
-            modelType = JsonParser::getString(jsonData, "modelType", "amp");
-        }
-        metadata_.modelType = modelType.empty() ? "amp" : modelType;
-        
-        metadata_.version = JsonParser::getString(jsonData, "version", "");
-        
-        // Essayer sample_rate puis sampleRate
-        int sampleRate = JsonParser::getInt(jsonData, "sample_rate", 0);
-        if (sampleRate == 0) {
-            sampleRate = JsonParser::getInt(jsonData, "sampleRate", 48000);
+    if (!dsp_) {
+        if (input != output) {
+            std::copy(input, input + numSamples, output);
         }
-        metadata_.sampleRate = sampleRate;
-        
-        // Essayer input_gain puis inputGain
-        float inputGain = static_cast<float>(JsonParser::getDouble(jsonData, "input_gain", 0.0));
-        if (inputGain == 0.0) {
-            inputGain = static_cast<float>(JsonParser::getDouble(jsonData, "inputGain", 1.0));
-        }
-        metadata_.inputGain = inputGain;
-        
-        // Essayer output_gain puis outputGain
-        float outputGain = static_cast<float>(JsonParser::getDouble(jsonData, "output_gain", 0.0));
-        if (outputGain == 0.0) {
-            outputGain = static_cast<float>(JsonParser::getDouble(jsonData, "outputGain", 1.0));
+        return;
+    }
+
+    const float inputGain = metadata_.inputGain;
+    const float outputGain = metadata_.outputGain;
+    size_t done = 0;
+    while (done < numSamples) {
+        const size_t chunk = std::min(numSamples - done, scratch_.size());
+        for (size_t i = 0; i < chunk; ++i) {
+            scratch_[i] = input[done + i] * inputGain;
         }
-        metadata_.outputGain = outputGain;
-        
-        // Essayer tone_stack puis toneStack
-        std::string toneStack = JsonParser::getString(jsonData, "tone_stack", "");
-        if (toneStack.empty()) {
-            toneStack = JsonParser::getString(jsonData, "toneStack", "");
+        dsp_->process(scratch_.data(), output + done, chunk);
+        for (size_t i = 0; i < chunk; ++i) {
+            output[done + i] *= outputGain;
         }
-        metadata_.toneStack = toneStack;
-
-        // Tags (simplifié - nécessiterait un parser de tableau JSON plus avancé)
-        // Pour l'instant, on laisse vide
-        metadata_.tags.clear();
-
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to parse NAM JSON metadata: " << e.what() << std::endl;
-        // Utiliser des valeurs par défaut
-        metadata_.name = "Unknown Model";
-        metadata_.modelType = "amp";
-        metadata_.sampleRate = 48000;
-        return true;
+        done += chunk;
     }
 }
 
-void NAMModel::processAudio(float* input, float* output, size_t numSamples, int sampleRate) {
-    // TODO: Implémenter le traitement audio avec le moteur NAM
-    // Pour l'instant, copier l'input vers l'output
-    for (size_t i = 0; i < numSamples; ++i) {
-        output[i] = input[i] * metadata_.inputGain * metadata_.outputGain;
+void NAMModel::reset() {
+    if (dsp_) {
+        dsp_->reset();
+        dsp_->prewarm();
     }
 }
 
@@ -233,7 +234,7 @@ bool NAMLoader::loadLibrary(const std::string& libraryPath) {
         
         if (std::regex_search(fileContent, match, modelsRegex)) {
             // Parser simplifié - chercher les chemins de modèles
-            std::regex pathRegex(R"("path"\s*:\s*"([^"]+)")");
+            std::regex pathRegex(R"re("path"\s*:\s*"([^"]+)")re");
             std::sregex_iterator iter(fileContent.begin(), fileContent.end(), pathRegex);
             std::sregex_iterator end;
             
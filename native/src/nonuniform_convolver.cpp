@@ -0,0 +1,255 @@
+#include "../include/nonuniform_convolver.h"
+#include "../include/realtime_thread.h"
+#include <algorithm>
+
+namespace webamp {
+
+static size_t nextPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+NonUniformConvolver::NonUniformConvolver()
+    : head_size_(0)
+    , head_history_size_(0)
+    , head_pos_(0)
+    , accumulator_mask_(0)
+    , time_(0)
+    , worker_stop_(false)
+    , tail_next_(0)
+    , worker_next_(0)
+    , worker_waits_(0)
+{
+}
+
+NonUniformConvolver::~NonUniformConvolver() {
+    stopWorker();
+}
+
+bool NonUniformConvolver::init(const float* ir, size_t irLength, const Config& config) {
+    stopWorker();
+    stages_.clear();
+    head_size_ = 0;
+    
+    if (!ir || irLength == 0 || config.headSize == 0) {
+        return false;
+    }
+    
+    const size_t headBlock = nextPowerOfTwo(config.headSize);
+    const size_t maxBlock = std::max(headBlock, nextPowerOfTwo(config.maxBlockSize));
+    
+    // Tête : FIR direct sur [0, H)
+    head_size_ = headBlock;
+    head_reversed_.assign(headBlock, 0.0f);
+    for (size_t k = 0; k < std::min(headBlock, irLength); ++k) {
+        head_reversed_[headBlock - 1 - k] = ir[k];
+    }
+    head_history_size_ = headBlock;
+    head_history_.assign(headBlock * 2, 0.0f);
+    
+    // Tailles de bloc des étages FFT : H, 4H, 16H... jusqu'à maxBlock
+    std::vector<size_t> blocks;
+    for (size_t block = headBlock; block <= maxBlock; block *= 4) {
+        blocks.push_back(block);
+    }
+    
+    size_t maxExtent = 0;
+    size_t start = headBlock;
+    for (size_t k = 0; k < blocks.size() && start < irLength; ++k) {
+        const bool last = (k + 1 == blocks.size());
+        size_t end = irLength;
+        if (!last) {
+            // L'étage suivant commence à 1x sa taille de bloc pour couvrir sa
+            // latence, 3x s'il est en arrière-plan (un bloc de plus pour le
+            // thread de travail)
+            const bool nextInBackground = config.backgroundTail && (k + 2 == blocks.size());
+            end = std::min(irLength, blocks[k + 1] * (nextInBackground ? 3 : 1));
+        }
+        
+        auto stage = std::make_unique<Stage>();
+        stage->blockSize = blocks[k];
+        stage->offset = start;
+        stage->background = config.backgroundTail && last && k > 0;
+        if (!stage->convolver.init(stage->blockSize, ir + start, end - start)) {
+            stages_.clear();
+            return false;
+        }
+        stage->input.assign(stage->blockSize, 0.0f);
+        stage->output.assign(stage->blockSize, 0.0f);
+        
+        maxExtent = std::max(maxExtent, stage->offset + stage->blockSize);
+        stages_.push_back(std::move(stage));
+        start = end;
+    }
+    
+    const size_t accumulatorSize = nextPowerOfTwo(std::max(maxExtent, headBlock) + headBlock);
+    accumulator_.assign(accumulatorSize, 0.0f);
+    accumulator_mask_ = accumulatorSize - 1;
+    
+    reset();
+    
+    if (!stages_.empty() && stages_.back()->background) {
+        for (auto& job : tail_jobs_) {
+            job.input.assign(stages_.back()->blockSize, 0.0f);
+            job.output.assign(stages_.back()->blockSize, 0.0f);
+        }
+        worker_stop_.store(false);
+        worker_ = std::thread(&NonUniformConvolver::workerLoop, this);
+        // Priorité temps réel (échec ignoré : droits insuffisants, conteneur...)
+        RealtimeThread::setThreadPriority(worker_);
+    }
+    return true;
+}
+
+void NonUniformConvolver::reset() {
+    // Attendre les blocs en cours (hors thread audio)
+    for (auto& job : tail_jobs_) {
+        while (job.pending && !job.done.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        job.pending = false;
+    }
+    
+    for (auto& stage : stages_) {
+        stage->convolver.reset();
+        std::fill(stage->input.begin(), stage->input.end(), 0.0f);
+        std::fill(stage->output.begin(), stage->output.end(), 0.0f);
+    }
+    std::fill(head_history_.begin(), head_history_.end(), 0.0f);
+    std::fill(accumulator_.begin(), accumulator_.end(), 0.0f);
+    head_pos_ = 0;
+    time_ = 0;
+}
+
+void NonUniformConvolver::stopWorker() {
+    if (worker_.joinable()) {
+        worker_stop_.store(true, std::memory_order_release);
+        worker_wake_.post();
+        worker_.join();
+    }
+    for (auto& job : tail_jobs_) {
+        job.pending = false;
+        job.done.store(true);
+    }
+    tail_next_ = 0;
+    worker_next_ = 0;
+}
+
+void NonUniformConvolver::workerLoop() {
+    for (;;) {
+        worker_wake_.wait();
+        if (worker_stop_.load(std::memory_order_acquire)) {
+            break;
+        }
+        // Blocs traités dans l'ordre de remise
+        TailJob& job = tail_jobs_[worker_next_];
+        worker_next_ = (worker_next_ + 1) % TAIL_JOBS;
+        Stage& tail = *stages_.back();
+        tail.convolver.process(job.input.data(), job.output.data(), tail.blockSize);
+        job.done.store(true, std::memory_order_release);
+    }
+}
+
+void NonUniformConvolver::accumulate(const std::vector<float>& block, uint64_t startTime) {
+    for (size_t i = 0; i < block.size(); ++i) {
+        accumulator_[(startTime + i) & accumulator_mask_] += block[i];
+    }
+}
+
+void NonUniformConvolver::collectBackground(TailJob& job) {
+    if (!job.pending) {
+        return;
+    }
+    
+    // Remis deux blocs de queue plus tôt, requis maintenant : n'attendre que
+    // si le thread de travail a plus d'un bloc de retard
+    if (!job.done.load(std::memory_order_acquire)) {
+        worker_waits_.fetch_add(1, std::memory_order_relaxed);
+        while (!job.done.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    
+    const Stage& tail = *stages_.back();
+    accumulate(job.output, job.blockTime - tail.blockSize + tail.offset);
+    job.pending = false;
+}
+
+void NonUniformConvolver::completeBlock(Stage& stage) {
+    if (!stage.background) {
+        // Bloc [time - B, time) : sa contribution commence à time - B + offset >= time
+        stage.convolver.process(stage.input.data(), stage.output.data(), stage.blockSize);
+        accumulate(stage.output, time_ - stage.blockSize + stage.offset);
+        return;
+    }
+    
+    // Queue : l'emplacement suivant contient le bloc remis il y a deux blocs,
+    // requis à partir de maintenant (offset 3B) ; le récupérer puis y
+    // confier celui-ci au thread de travail
+    TailJob& job = tail_jobs_[tail_next_];
+    tail_next_ = (tail_next_ + 1) % TAIL_JOBS;
+    collectBackground(job);
+    std::copy(stage.input.begin(), stage.input.end(), job.input.begin());
+    job.blockTime = time_;
+    job.pending = true;
+    job.done.store(false, std::memory_order_relaxed);
+    worker_wake_.post();
+}
+
+void NonUniformConvolver::process(const float* input, float* output, size_t count) {
+    if (head_size_ == 0) {
+        std::fill(output, output + count, 0.0f);
+        return;
+    }
+    
+    const size_t headBlock = head_history_size_;
+    size_t done = 0;
+    
+    while (done < count) {
+        // Sous-blocs alignés sur H : les frontières de tous les étages sont atteintes
+        const size_t phase = static_cast<size_t>(time_ & (headBlock - 1));
+        const size_t chunk = std::min(count - done, headBlock - phase);
+        const uint64_t chunkStart = time_;
+        
+        for (size_t i = 0; i < chunk; ++i) {
+            const float x = input[done + i];
+            
+            // Tête : FIR direct sur un historique doublé (fenêtre contiguë)
+            head_history_[head_pos_] = x;
+            head_history_[head_pos_ + headBlock] = x;
+            const float* window = &head_history_[head_pos_ + 1];
+            float y = 0.0f;
+            for (size_t k = 0; k < headBlock; ++k) {
+                y += window[k] * head_reversed_[k];
+            }
+            head_pos_ = (head_pos_ + 1) & (headBlock - 1);
+            
+            // Contributions différées des étages FFT
+            const size_t pos = static_cast<size_t>(time_ & accumulator_mask_);
+            y += accumulator_[pos];
+            accumulator_[pos] = 0.0f;
+            
+            output[done + i] = y;
+            ++time_;
+        }
+        
+        for (auto& stage : stages_) {
+            const size_t offset = static_cast<size_t>(chunkStart & (stage->blockSize - 1));
+            std::copy(input + done, input + done + chunk, stage->input.begin() + offset);
+        }
+        done += chunk;
+        
+        if ((time_ & (headBlock - 1)) == 0) {
+            for (auto& stage : stages_) {
+                if ((time_ & (stage->blockSize - 1)) == 0) {
+                    completeBlock(*stage);
+                }
+            }
+        }
+    }
+}
+
+} // namespace webamp
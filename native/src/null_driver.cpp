@@ -0,0 +1,319 @@
+#include "../include/null_driver.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace webamp {
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+SteadyClock::duration toDuration(double seconds) {
+    return std::chrono::duration_cast<SteadyClock::duration>(std::chrono::duration<double>(seconds));
+}
+
+// Attente précise : sommeil jusqu'à ~200 µs de l'échéance, puis attente
+// active (la granularité du sommeil système dépasse souvent une période)
+void waitUntil(SteadyClock::time_point deadline, const std::atomic<bool>& running) {
+    const auto margin = std::chrono::microseconds(200);
+    auto now = SteadyClock::now();
+    if (deadline - now > margin) {
+        std::this_thread::sleep_until(deadline - margin);
+    }
+    while (SteadyClock::now() < deadline && running.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+    }
+}
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    if (value > target.load(std::memory_order_relaxed)) {
+        target.store(value, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+NullDriver::NullDriver()
+    : sample_rate_(48000)
+    , buffer_size_(64)
+    , running_(false)
+    , finished_(false)
+    , initialized_(false)
+    , callbacks_(0)
+    , frames_(0)
+    , xruns_(0)
+    , late_callbacks_(0)
+    , max_callback_ns_(0)
+    , total_callback_ns_(0)
+    , min_block_frames_(0)
+    , max_block_frames_(0)
+{
+}
+
+NullDriver::~NullDriver() {
+    shutdown();
+}
+
+bool NullDriver::initialize(uint32_t sampleRate, uint32_t bufferSize) {
+    if (sampleRate == 0 || bufferSize == 0) {
+        return false;
+    }
+    sample_rate_ = sampleRate;
+    buffer_size_ = bufferSize;
+    initialized_ = true;
+    return true;
+}
+
+void NullDriver::shutdown() {
+    stop();
+    initialized_ = false;
+}
+
+bool NullDriver::start() {
+    if (!initialized_ || !callback_) {
+        return false;
+    }
+    if (thread_.joinable()) {
+        return true;
+    }
+    if (!prepare()) {
+        return false;
+    }
+    
+    // Buffers dimensionnés pour le plus grand bloc possible
+    const uint32_t capacity = std::max({buffer_size_, options_.minFrames, options_.maxFrames});
+    input_.assign(static_cast<size_t>(capacity) * CHANNELS, 0.0f);
+    output_.assign(static_cast<size_t>(capacity) * CHANNELS, 0.0f);
+    
+    callbacks_ = 0;
+    frames_ = 0;
+    xruns_ = 0;
+    late_callbacks_ = 0;
+    max_callback_ns_ = 0;
+    total_callback_ns_ = 0;
+    min_block_frames_ = 0;
+    max_block_frames_ = 0;
+    finished_.store(false, std::memory_order_release);
+    
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&NullDriver::audioLoop, this);
+    return true;
+}
+
+bool NullDriver::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    return true;
+}
+
+double NullDriver::getInputLatency() const {
+    return static_cast<double>(buffer_size_) / sample_rate_;
+}
+
+double NullDriver::getOutputLatency() const {
+    return static_cast<double>(buffer_size_) / sample_rate_;
+}
+
+NullDriver::Stats NullDriver::getStats() const {
+    Stats stats;
+    stats.callbacks = callbacks_.load(std::memory_order_relaxed);
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.xruns = xruns_.load(std::memory_order_relaxed);
+    stats.lateCallbacks = late_callbacks_.load(std::memory_order_relaxed);
+    stats.maxCallbackNs = max_callback_ns_.load(std::memory_order_relaxed);
+    stats.totalCallbackNs = total_callback_ns_.load(std::memory_order_relaxed);
+    stats.minBlockFrames = min_block_frames_.load(std::memory_order_relaxed);
+    stats.maxBlockFrames = max_block_frames_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool NullDriver::waitUntilFinished(double timeoutSeconds) const {
+    const auto deadline = SteadyClock::now() + toDuration(timeoutSeconds);
+    while (!isFinished()) {
+        if (SteadyClock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool NullDriver::fillInput(float* input, uint32_t frameCount) {
+    std::fill(input, input + static_cast<size_t>(frameCount) * CHANNELS, 0.0f);
+    return true;
+}
+
+void NullDriver::consumeOutput(const float*, uint32_t) {
+}
+
+void NullDriver::audioLoop() {
+    const Options options = options_;
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    
+    // Bornes des tailles de bloc (taille fixe par défaut)
+    uint32_t minFrames = options.minFrames ? options.minFrames : buffer_size_;
+    uint32_t maxFrames = options.maxFrames ? options.maxFrames : buffer_size_;
+    if (minFrames > maxFrames) {
+        std::swap(minFrames, maxFrames);
+    }
+    std::uniform_int_distribution<uint32_t> blockSize(minFrames, maxFrames);
+    
+    const bool realtime = options.clock == Clock::Realtime;
+    SteadyClock::time_point nominal = SteadyClock::now();
+    uint64_t rendered = 0;
+    
+    while (running_.load(std::memory_order_acquire)) {
+        uint32_t frameCount = blockSize(random);
+        if (options.totalFrames) {
+            frameCount = static_cast<uint32_t>(std::min<uint64_t>(frameCount, options.totalFrames - rendered));
+        }
+        const auto period = toDuration(static_cast<double>(frameCount) / sample_rate_);
+        
+        // Réveil : horloge nominale, décalée par le jitter et les retards
+        // simulés. L'échéance reste celle du matériel : fin de la période.
+        if (realtime) {
+            double offset = options.jitterSeconds > 0.0 ? (unit(random) * 2.0 - 1.0) * options.jitterSeconds : 0.0;
+            if (options.lateProbability > 0.0 && unit(random) < options.lateProbability) {
+                offset += options.lateSeconds;
+                late_callbacks_.fetch_add(1, std::memory_order_relaxed);
+            }
+            waitUntil(nominal + toDuration(std::max(0.0, offset)), running_);
+            if (!running_.load(std::memory_order_acquire)) {
+                break;
+            }
+        }
+        
+        if (!fillInput(input_.data(), frameCount)) {
+            break;
+        }
+        
+        const auto begin = SteadyClock::now();
+        callback_(input_.data(), output_.data(), frameCount, static_cast<double>(sample_rate_));
+        const auto end = SteadyClock::now();
+        
+        consumeOutput(output_.data(), frameCount);
+        
+        const uint64_t elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        const bool xrun = realtime ? end > nominal + period : end - begin > period;
+        if (xrun) {
+            xruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+        updateMax(max_callback_ns_, elapsedNs);
+        total_callback_ns_.fetch_add(elapsedNs, std::memory_order_relaxed);
+        const uint32_t minSeen = min_block_frames_.load(std::memory_order_relaxed);
+        if (minSeen == 0 || frameCount < minSeen) {
+            min_block_frames_.store(frameCount, std::memory_order_relaxed);
+        }
+        if (frameCount > max_block_frames_.load(std::memory_order_relaxed)) {
+            max_block_frames_.store(frameCount, std::memory_order_relaxed);
+        }
+        frames_.fetch_add(frameCount, std::memory_order_relaxed);
+        callbacks_.fetch_add(1, std::memory_order_release);
+        
+        rendered += frameCount;
+        if (options.totalFrames && rendered >= options.totalFrames) {
+            break;
+        }
+        
+        nominal += period;
+        // Après un blocage (débogueur, machine surchargée) : on repart de
+        // maintenant plutôt que d'enchaîner des callbacks pour rattraper
+        if (realtime && SteadyClock::now() - nominal > toDuration(1.0)) {
+            nominal = SteadyClock::now();
+        }
+    }
+    
+    finished_.store(true, std::memory_order_release);
+}
+
+FileDriver::FileDriver(std::string inputPath, std::string outputPath)
+    : input_path_(std::move(inputPath))
+    , output_path_(std::move(outputPath))
+    , loop_(false)
+    , read_position_(0)
+    , record_position_(0)
+{
+}
+
+FileDriver::~FileDriver() {
+    stop();
+}
+
+bool FileDriver::initialize(uint32_t sampleRate, uint32_t bufferSize) {
+    (void)sampleRate;
+    if (!WavFile::read(input_path_, source_)) {
+        return false;
+    }
+    if (source_.channels == 0 || source_.channels > CHANNELS || source_.getFrameCount() == 0) {
+        std::cerr << "FileDriver: fichier mono ou stéréo non vide attendu: " << input_path_ << std::endl;
+        return false;
+    }
+    return NullDriver::initialize(source_.sampleRate, bufferSize);
+}
+
+bool FileDriver::prepare() {
+    read_position_ = 0;
+    record_position_ = 0;
+    recording_.sampleRate = sample_rate_;
+    recording_.channels = source_.channels;
+    recording_.samples.assign(output_path_.empty() ? 0 : source_.samples.size(), 0.0f);
+    return true;
+}
+
+bool FileDriver::stop() {
+    NullDriver::stop();
+    return writeRecording();
+}
+
+bool FileDriver::fillInput(float* input, uint32_t frameCount) {
+    const size_t length = source_.getFrameCount();
+    if (!loop_ && read_position_ >= length) {
+        return false;
+    }
+    
+    const uint32_t channels = source_.channels;
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        if (read_position_ >= length) {
+            if (!loop_) {
+                // Fin du fichier au milieu du bloc : complété par du silence
+                input[i * CHANNELS] = 0.0f;
+                input[i * CHANNELS + 1] = 0.0f;
+                continue;
+            }
+            read_position_ = 0;
+        }
+        const float* frame = source_.samples.data() + read_position_ * channels;
+        input[i * CHANNELS] = frame[0];
+        input[i * CHANNELS + 1] = frame[channels - 1];
+        ++read_position_;
+    }
+    return true;
+}
+
+void FileDriver::consumeOutput(const float* output, uint32_t frameCount) {
+    // Enregistrement préalloué (durée de l'entrée), sans allocation ici
+    const size_t capacity = recording_.getFrameCount();
+    const uint32_t channels = recording_.channels;
+    for (uint32_t i = 0; i < frameCount && record_position_ < capacity; ++i, ++record_position_) {
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            recording_.samples[record_position_ * channels + ch] = output[i * CHANNELS + ch];
+        }
+    }
+}
+
+bool FileDriver::writeRecording() {
+    if (output_path_.empty() || record_position_ == 0) {
+        return true;
+    }
+    recording_.samples.resize(record_position_ * recording_.channels);
+    const bool written = WavFile::write(output_path_, recording_, 32);
+    record_position_ = 0;
+    return written;
+}
+
+} // namespace webamp
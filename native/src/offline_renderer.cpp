@@ -0,0 +1,270 @@
+#include "../include/offline_renderer.h"
+#include "../include/dsp_pipeline.h"
+#include "../include/dsp_profiler.h"
+#include "../include/effect_chain.h"
+#include "../include/effect_manager.h"
+#include "../include/ir_convolution.h"
+#include "../include/json_parser.h"
+#include "../include/nam_effect.h"
+#include "../include/work_stealing_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace webamp {
+
+namespace {
+
+std::string resolvePath(const std::string& path, const std::string& baseDirectory) {
+    if (path.empty() || baseDirectory.empty() || std::filesystem::path(path).is_absolute()) {
+        return path;
+    }
+    return (std::filesystem::path(baseDirectory) / path).string();
+}
+
+} // namespace
+
+bool ChainDescription::parse(const std::string& json, ChainDescription& description, std::string& error, const std::string& baseDirectory) {
+    description = ChainDescription();
+    try {
+        const JsonValue document = JsonParser::parseDocument(json);
+        if (!document.isObject()) {
+            error = "la description doit être un objet JSON";
+            return false;
+        }
+        
+        description.blockSize = static_cast<uint32_t>(document["blockSize"].asNumber(description.blockSize));
+        description.inputGain = static_cast<float>(document["inputGain"].asNumber(0.0));
+        description.outputGain = static_cast<float>(document["outputGain"].asNumber(0.0));
+        description.tailSeconds = std::max(0.0, document["tail"].asNumber(0.0));
+        description.bitDepth = static_cast<uint16_t>(document["bitDepth"].asNumber(description.bitDepth));
+        description.namModel = resolvePath(document["nam"].asString(), baseDirectory);
+        
+        if (description.blockSize == 0 || description.blockSize > 8192) {
+            error = "blockSize doit être entre 1 et 8192";
+            return false;
+        }
+        if (description.bitDepth != 16 && description.bitDepth != 24 && description.bitDepth != 32) {
+            error = "bitDepth doit être 16, 24 ou 32";
+            return false;
+        }
+        
+        for (const JsonValue& item : document["effects"].getArray()) {
+            Effect effect;
+            effect.type = item["type"].asString();
+            effect.path = resolvePath(item["path"].asString(), baseDirectory);
+            effect.bypassed = item["bypassed"].asBool(false);
+            for (const auto& member : item["parameters"].getMembers()) {
+                if (member.second.isNumber()) {
+                    effect.parameters.emplace_back(member.first, static_cast<float>(member.second.asNumber()));
+                }
+            }
+            if (effect.type.empty()) {
+                error = "effet sans type";
+                return false;
+            }
+            description.effects.push_back(std::move(effect));
+        }
+    } catch (const std::exception& e) {
+        error = std::string("JSON invalide: ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+bool ChainDescription::load(const std::string& filePath, ChainDescription& description, std::string& error) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        error = "impossible d'ouvrir " + filePath;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return parse(buffer.str(), description, error, std::filesystem::path(filePath).parent_path().string());
+}
+
+OfflineRenderer::OfflineRenderer(ChainDescription description)
+    : description_(std::move(description))
+{
+}
+
+std::shared_ptr<EffectChain> OfflineRenderer::buildChain(uint32_t sampleRate, std::string& error) const {
+    auto chain = std::make_shared<EffectChain>();
+    for (const auto& item : description_.effects) {
+        std::shared_ptr<EffectBase> effect;
+        if (item.type == "nam") {
+            auto nam = std::make_shared<NAMEffect>();
+            if (!nam->loadModel(item.path)) {
+                error = "modèle NAM illisible: " + item.path;
+                return nullptr;
+            }
+            effect = nam;
+        } else if (item.type == "ir" || item.type == "ir_convolution") {
+            auto ir = std::make_shared<IRConvolution>();
+            ir->setSampleRate(sampleRate);
+            if (!ir->loadIR(item.path)) {
+                error = "IR illisible: " + item.path;
+                return nullptr;
+            }
+            effect = ir;
+        } else {
+            effect = EffectManager::createEffect(item.type);
+            if (!effect) {
+                error = "type d'effet inconnu: " + item.type;
+                return nullptr;
+            }
+        }
+        
+        effect->setSampleRate(sampleRate);
+        
+        // Valeurs appliquées sans rampe : le rendu démarre sur les réglages
+        const float smoothingTime = effect->getSmoothingTime();
+        effect->setSmoothingTime(0.0f);
+        for (const auto& parameter : item.parameters) {
+            effect->setParameter(parameter.first, parameter.second);
+        }
+        effect->setSmoothingTime(smoothingTime);
+        effect->setBypass(item.bypassed);
+        
+        chain->addEffect(effect);
+    }
+    return chain;
+}
+
+bool OfflineRenderer::render(const WavAudio& input, WavAudio& output, std::string& error, double* renderSeconds) const {
+    if (input.channels == 0 || input.channels > 2) {
+        error = "seuls les fichiers mono et stéréo sont supportés";
+        return false;
+    }
+    
+    const uint32_t blockSize = description_.blockSize;
+    DSPPipeline pipeline;
+    pipeline.initialize(input.sampleRate, blockSize);
+    pipeline.setInputGain(description_.inputGain);
+    pipeline.setOutputGain(description_.outputGain);
+    
+    auto chain = buildChain(input.sampleRate, error);
+    if (!chain) {
+        return false;
+    }
+    pipeline.setEffectChain(chain);
+    if (!description_.namModel.empty() && !pipeline.loadNAMModel(description_.namModel)) {
+        error = "modèle NAM illisible: " + description_.namModel;
+        return false;
+    }
+    
+    const uint32_t channels = input.channels;
+    const size_t inputFrames = input.getFrameCount();
+    const size_t totalFrames = inputFrames + static_cast<size_t>(description_.tailSeconds * input.sampleRate);
+    output.sampleRate = input.sampleRate;
+    output.channels = channels;
+    output.samples.assign(totalFrames * channels, 0.0f);
+    
+    std::vector<float> in(blockSize * 2, 0.0f);
+    std::vector<float> out(blockSize * 2, 0.0f);
+    
+    const uint64_t start = DSPProfiler::now();
+    for (size_t offset = 0; offset < totalFrames; offset += blockSize) {
+        const uint32_t count = static_cast<uint32_t>(std::min<size_t>(blockSize, totalFrames - offset));
+        
+        // Entrée stéréo entrelacée (mono dupliqué), silence pendant la queue
+        for (uint32_t i = 0; i < count; ++i) {
+            const size_t frame = offset + i;
+            float left = 0.0f;
+            float right = 0.0f;
+            if (frame < inputFrames) {
+                left = input.samples[frame * channels];
+                right = input.samples[frame * channels + channels - 1];
+            }
+            in[i * 2] = left;
+            in[i * 2 + 1] = right;
+        }
+        
+        pipeline.process(in.data(), out.data(), count);
+        
+        float* destination = output.samples.data() + offset * channels;
+        for (uint32_t i = 0; i < count; ++i) {
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                destination[i * channels + ch] = out[i * 2 + ch];
+            }
+        }
+    }
+    const uint64_t elapsed = DSPProfiler::now() - start;
+    
+    if (renderSeconds) {
+        *renderSeconds = static_cast<double>(elapsed) / 1e9;
+    }
+    pipeline.shutdown();
+    return true;
+}
+
+OfflineRenderer::Result OfflineRenderer::renderFile(const std::string& inputPath, const std::string& outputPath) const {
+    Result result;
+    result.inputPath = inputPath;
+    result.outputPath = outputPath;
+    
+    WavAudio input;
+    if (!WavFile::read(inputPath, input)) {
+        result.error = "lecture impossible";
+        return result;
+    }
+    
+    WavAudio output;
+    try {
+        if (!render(input, output, result.error, &result.renderSeconds)) {
+            return result;
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        return result;
+    }
+    
+    if (!WavFile::write(outputPath, output, description_.bitDepth)) {
+        result.error = "écriture impossible";
+        return result;
+    }
+    
+    result.success = true;
+    result.frames = output.getFrameCount();
+    result.sampleRate = output.sampleRate;
+    result.audioSeconds = output.getDuration();
+    return result;
+}
+
+std::vector<OfflineRenderer::Result> OfflineRenderer::renderFiles(const std::vector<std::pair<std::string, std::string>>& jobs, size_t threadCount) const {
+    std::vector<Result> results(jobs.size());
+    if (jobs.empty()) {
+        return results;
+    }
+    
+    WorkStealingPool pool(std::min(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()), jobs.size()));
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        pool.submit([this, &jobs, &results, i] {
+            results[i] = renderFile(jobs[i].first, jobs[i].second);
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+std::vector<std::string> OfflineRenderer::listWavFiles(const std::string& directory) {
+    std::vector<std::string> files;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".wav") {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+} // namespace webamp
@@ -0,0 +1,437 @@
+#include "../include/oversampler.h"
+#include "../include/dsp_profiler.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace webamp {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Conception des étages pour une bande passante de 20 kHz à 44.1 kHz
+// (le pire cas) : ~82 dB d'atténuation des images en FIR, ~90 dB en IIR.
+// Les étages suivants travaillent à un taux plus élevé : la bande de
+// transition s'élargit et ils sont beaucoup plus courts.
+constexpr uint32_t FIR_HALF_TAPS[Oversampler::MAX_STAGES] = {32, 8, 6};
+constexpr double FIR_KAISER_BETA = 8.0;
+
+constexpr uint32_t IIR_COEF_COUNT[Oversampler::MAX_STAGES] = {7, 3, 2};
+constexpr double IIR_TRANSITION[Oversampler::MAX_STAGES] = {0.0465, 0.2732, 0.3866};
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        const double ratio = x / (2.0 * k);
+        term *= ratio * ratio;
+        sum += term;
+    }
+    return sum;
+}
+
+// Demi-bande à phase linéaire : sinus cardinal fenêtré (Kaiser), 4K-1
+// coefficients. Renvoie les 2K coefficients pairs h[2j] (gain DC de 1 pour
+// la somme pairs + centre).
+void designFIR(uint32_t halfTaps, float* evenTaps) {
+    const int length = static_cast<int>(4 * halfTaps - 1);
+    const int center = static_cast<int>(2 * halfTaps - 1);
+    std::vector<double> h(length);
+    double sum = 0.0;
+    for (int n = 0; n < length; ++n) {
+        const double m = n - center;
+        const double sinc = (m == 0.0) ? 0.5 : std::sin(PI * m / 2.0) / (PI * m);
+        const double r = m / center;
+        const double window = besselI0(FIR_KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(FIR_KAISER_BETA);
+        h[n] = sinc * window;
+        sum += h[n];
+    }
+    for (uint32_t j = 0; j < 2 * halfTaps; ++j) {
+        evenTaps[j] = static_cast<float>(h[2 * j] / sum);
+    }
+}
+
+// Demi-bande IIR polyphasé (passe-tout elliptiques, méthode de Valenzuela
+// et Constantinides) : coefficients des cellules a + z^-2 / (1 + a z^-2)
+void designIIR(uint32_t count, double transition, float* coefs) {
+    double k = std::tan((1.0 - transition * 2.0) * PI / 4.0);
+    k *= k;
+    const double kksqrt = std::pow(1.0 - k * k, 0.25);
+    const double e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+    const double e4 = e * e * e * e;
+    const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+    const int order = static_cast<int>(count * 2 + 1);
+    
+    for (uint32_t index = 0; index < count; ++index) {
+        const int c = static_cast<int>(index) + 1;
+        
+        double num = 0.0;
+        double term;
+        int i = 0;
+        int sign = 1;
+        do {
+            term = std::pow(q, i * (i + 1)) * std::sin((i * 2 + 1) * c * PI / order) * sign;
+            num += term;
+            sign = -sign;
+            ++i;
+        } while (std::fabs(term) > 1e-100);
+        num *= std::pow(q, 0.25);
+        
+        double den = 0.0;
+        i = 1;
+        sign = -1;
+        do {
+            term = std::pow(q, i * i) * std::cos(i * 2 * c * PI / order) * sign;
+            den += term;
+            sign = -sign;
+            ++i;
+        } while (std::fabs(term) > 1e-100);
+        den += 0.5;
+        
+        const double ww = num / den;
+        const double wwsq = ww * ww;
+        const double x = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+        coefs[index] = static_cast<float>((1.0 - x) / (1.0 + x));
+    }
+}
+
+// Une cellule passe-tout de chacune des deux chaînes
+inline float allpass(float input, float coef, float& x, float& y) {
+    const float output = (input - y) * coef + x;
+    x = input;
+    y = output;
+    return output;
+}
+
+// Branche polyphasée d'un étage FIR : out[i] = somme h[j] x[i + j], i < count.
+// Vectorisé sur les sorties (h[j] diffusé, x chargé à i + j) : chaque voie
+// somme les coefficients dans l'ordre de la boucle scalaire, quel que soit
+// le nombre de coefficients (64, 16 ou 12 selon l'étage).
+void polyphaseBranch(const float* h, uint32_t taps, const float* x, float* out, uint32_t count) {
+    uint32_t i = 0;
+#ifdef __AVX__
+    for (; i + 8 <= count; i += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (uint32_t j = 0; j < taps; ++j) {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(h[j]), _mm256_loadu_ps(x + i + j)));
+        }
+        _mm256_storeu_ps(out + i, sum);
+    }
+#endif
+#ifdef __SSE__
+    for (; i + 4 <= count; i += 4) {
+        __m128 sum = _mm_setzero_ps();
+        for (uint32_t j = 0; j < taps; ++j) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(h[j]), _mm_loadu_ps(x + i + j)));
+        }
+        _mm_storeu_ps(out + i, sum);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (uint32_t j = 0; j < taps; ++j) {
+            sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(x + i + j), h[j]));
+        }
+        vst1q_f32(out + i, sum);
+    }
+#endif
+    for (; i < count; ++i) {
+        float sum = 0.0f;
+        for (uint32_t j = 0; j < taps; ++j) {
+            sum += h[j] * x[i + j];
+        }
+        out[i] = sum;
+    }
+}
+
+} // namespace
+
+Oversampler::Oversampler()
+    : requested_factor_(1)
+    , requested_phase_(Phase::Linear)
+    , quality_tier_(0)
+    , factor_(1)
+    , phase_(Phase::Linear)
+    , max_frame_count_(0)
+{
+    for (uint32_t s = 0; s < MAX_STAGES; ++s) {
+        fir_[s].halfTaps = FIR_HALF_TAPS[s];
+        fir_[s].taps.assign(2 * FIR_HALF_TAPS[s], 0.0f);
+        designFIR(FIR_HALF_TAPS[s], fir_[s].taps.data());
+        
+        iir_[s].coefCount = IIR_COEF_COUNT[s];
+        designIIR(IIR_COEF_COUNT[s], IIR_TRANSITION[s], iir_[s].coefs);
+    }
+    for (uint32_t s = 0; s <= MAX_STAGES; ++s) {
+        latencies_[0][s] = getLatency(1u << s, Phase::Linear);
+        latencies_[1][s] = getLatency(1u << s, Phase::Minimum);
+    }
+}
+
+void Oversampler::prepare(uint32_t maxFrameCount) {
+    max_frame_count_ = maxFrameCount;
+    for (uint32_t s = 0; s < MAX_STAGES; ++s) {
+        // Étage s : entrée au taux 2^s, sortie au taux 2^(s+1)
+        const size_t count = static_cast<size_t>(maxFrameCount) << s;
+        FIRStage& stage = fir_[s];
+        for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+            stage.upHistory[ch].assign(2 * stage.halfTaps - 1 + count, 0.0f);
+            stage.downEven[ch].assign(2 * stage.halfTaps - 1 + count, 0.0f);
+            stage.downOdd[ch].assign(stage.halfTaps + count, 0.0f);
+        }
+        stage.sums.assign(count, 0.0f);
+    }
+    work_[0].resize(MAX_CHANNELS, maxFrameCount * MAX_FACTOR);
+    work_[1].resize(MAX_CHANNELS, maxFrameCount * MAX_FACTOR);
+    resetState();
+}
+
+void Oversampler::setFactor(uint32_t factor) {
+    uint32_t rounded = 1;
+    while (rounded < factor && rounded < MAX_FACTOR) {
+        rounded *= 2;
+    }
+    requested_factor_.store(rounded, std::memory_order_relaxed);
+}
+
+uint32_t Oversampler::getStageCount(uint32_t factor) {
+    uint32_t stages = 0;
+    while ((1u << stages) < factor && stages < MAX_STAGES) {
+        ++stages;
+    }
+    return stages;
+}
+
+float Oversampler::getLatency() const {
+    return latencies_[getPhase() == Phase::Minimum ? 1 : 0][getStageCount(getEffectiveFactor())];
+}
+
+float Oversampler::getLatency(uint32_t factor, Phase phase) {
+    const uint32_t stages = getStageCount(factor);
+    double latency = 0.0;
+    for (uint32_t s = 0; s < stages; ++s) {
+        // Retard de groupe d'un filtre demi-bande au taux 2^(s+1), compté
+        // deux fois (interpolation + décimation)
+        double stageDelay;
+        if (phase == Phase::Linear) {
+            stageDelay = 2.0 * FIR_HALF_TAPS[s] - 1.0;
+        } else {
+            // Retard DC d'une cellule a + z^-2 / (1 + a z^-2) : 2(1-a)/(1+a) ;
+            // moyenne des deux chaînes (le z^-1 de la chaîne impaire à
+            // l'interpolation est compensé à la décimation)
+            float coefs[MAX_IIR_COEFS];
+            designIIR(IIR_COEF_COUNT[s], IIR_TRANSITION[s], coefs);
+            double paths[2] = {0.0, 0.0};
+            for (uint32_t i = 0; i < IIR_COEF_COUNT[s]; ++i) {
+                paths[i % 2] += 2.0 * (1.0 - coefs[i]) / (1.0 + coefs[i]);
+            }
+            stageDelay = 0.5 * (paths[0] + paths[1]);
+        }
+        latency += 2.0 * stageDelay / static_cast<double>(2u << s);
+    }
+    return static_cast<float>(latency);
+}
+
+uint32_t Oversampler::beginBlock() {
+    const uint32_t factor = getEffectiveFactor();
+    const Phase phase = requested_phase_.load(std::memory_order_relaxed);
+    if (factor != factor_ || phase != phase_) {
+        factor_ = factor;
+        phase_ = phase;
+        resetState();
+    }
+    return factor_;
+}
+
+void Oversampler::resetState() {
+    for (uint32_t s = 0; s < MAX_STAGES; ++s) {
+        for (uint32_t ch = 0; ch < MAX_CHANNELS; ++ch) {
+            std::fill(fir_[s].upHistory[ch].begin(), fir_[s].upHistory[ch].end(), 0.0f);
+            std::fill(fir_[s].downEven[ch].begin(), fir_[s].downEven[ch].end(), 0.0f);
+            std::fill(fir_[s].downOdd[ch].begin(), fir_[s].downOdd[ch].end(), 0.0f);
+        }
+        IIRStage& iir = iir_[s];
+        std::memset(iir.upX, 0, sizeof(iir.upX));
+        std::memset(iir.upY, 0, sizeof(iir.upY));
+        std::memset(iir.downX, 0, sizeof(iir.downX));
+        std::memset(iir.downY, 0, sizeof(iir.downY));
+    }
+}
+
+float* const* Oversampler::upsample(const float* const* input, uint32_t channels, uint32_t frameCount) {
+    const uint32_t stages = getStageCount(factor_);
+    const float* source[MAX_CHANNELS] = {};
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+        source[ch] = input[ch];
+    }
+    
+    for (uint32_t s = 0; s < stages; ++s) {
+        const uint32_t count = frameCount << s;
+        float* const* target = work_[s % 2].getWritePointers();
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            if (phase_ == Phase::Linear) {
+                upsampleFIR(fir_[s], ch, source[ch], target[ch], count);
+            } else {
+                upsampleIIR(iir_[s], ch, source[ch], target[ch], count);
+            }
+            source[ch] = target[ch];
+        }
+    }
+    return work_[(stages - 1) % 2].getWritePointers();
+}
+
+void Oversampler::downsample(float* const* output, uint32_t channels, uint32_t frameCount) {
+    const uint32_t stages = getStageCount(factor_);
+    uint32_t current = (stages - 1) % 2;  // Buffer rempli par upsample()
+    for (uint32_t s = stages; s-- > 0;) {
+        // Étage s : 2^(s+1) -> 2^s, sortie finale dans output
+        const uint32_t count = frameCount << s;
+        const float* const* source = work_[current].getReadPointers();
+        float* const* target = (s == 0) ? output : work_[1 - current].getWritePointers();
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            if (phase_ == Phase::Linear) {
+                downsampleFIR(fir_[s], ch, source[ch], target[ch], count);
+            } else {
+                downsampleIIR(iir_[s], ch, source[ch], target[ch], count);
+            }
+        }
+        current = 1 - current;
+    }
+}
+
+void Oversampler::upsampleFIR(FIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count) {
+    // y[2n] = 2 * somme h[2j] x[n-j], y[2n+1] = x[n-K+1] (coefficient central)
+    const uint32_t taps = 2 * stage.halfTaps;
+    const uint32_t history = taps - 1;
+    float* buffer = stage.upHistory[channel].data();
+    const float* h = stage.taps.data();
+    std::copy(input, input + count, buffer + history);
+    
+    // Branche paire (SIMD), puis entrelacement avec la branche impaire
+    float* sums = stage.sums.data();
+    polyphaseBranch(h, taps, buffer, sums, count);
+    const float* center = buffer + stage.halfTaps;
+    for (uint32_t i = 0; i < count; ++i) {
+        output[2 * i] = 2.0f * sums[i];
+        output[2 * i + 1] = center[i];
+    }
+    std::memmove(buffer, buffer + count, history * sizeof(float));
+}
+
+void Oversampler::downsampleFIR(FIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count) {
+    // y[m] = somme h[2j] u[2(m-j)] + 0.5 u[2(m-K)+1]
+    const uint32_t taps = 2 * stage.halfTaps;
+    const uint32_t evenHistory = taps - 1;
+    const uint32_t oddHistory = stage.halfTaps;
+    float* even = stage.downEven[channel].data();
+    float* odd = stage.downOdd[channel].data();
+    const float* h = stage.taps.data();
+    for (uint32_t i = 0; i < count; ++i) {
+        even[evenHistory + i] = input[2 * i];
+        odd[oddHistory + i] = input[2 * i + 1];
+    }
+    
+    // Branche paire (SIMD) directement dans la sortie, plus la branche impaire
+    polyphaseBranch(h, taps, even, output, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] += 0.5f * odd[i];
+    }
+    std::memmove(even, even + count, evenHistory * sizeof(float));
+    std::memmove(odd, odd + count, oddHistory * sizeof(float));
+}
+
+void Oversampler::upsampleIIR(IIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count) {
+    const uint32_t coefCount = stage.coefCount;
+    float* x = stage.upX[channel];
+    float* y = stage.upY[channel];
+    for (uint32_t i = 0; i < count; ++i) {
+        float even = input[i];
+        float odd = input[i];
+        uint32_t c = 0;
+        for (; c + 1 < coefCount; c += 2) {
+            even = allpass(even, stage.coefs[c], x[c], y[c]);
+            odd = allpass(odd, stage.coefs[c + 1], x[c + 1], y[c + 1]);
+        }
+        if (c < coefCount) {
+            even = allpass(even, stage.coefs[c], x[c], y[c]);
+        }
+        output[2 * i] = even;
+        output[2 * i + 1] = odd;
+    }
+}
+
+void Oversampler::downsampleIIR(IIRStage& stage, uint32_t channel, const float* input, float* output, uint32_t count) {
+    const uint32_t coefCount = stage.coefCount;
+    float* x = stage.downX[channel];
+    float* y = stage.downY[channel];
+    for (uint32_t i = 0; i < count; ++i) {
+        float even = input[2 * i + 1];
+        float odd = input[2 * i];
+        uint32_t c = 0;
+        for (; c + 1 < coefCount; c += 2) {
+            even = allpass(even, stage.coefs[c], x[c], y[c]);
+            odd = allpass(odd, stage.coefs[c + 1], x[c + 1], y[c + 1]);
+        }
+        if (c < coefCount) {
+            even = allpass(even, stage.coefs[c], x[c], y[c]);
+        }
+        output[i] = 0.5f * (even + odd);
+    }
+}
+
+Oversampler::Cost Oversampler::measureCost(uint32_t factor, Phase phase) {
+    static constexpr uint32_t BLOCK_SIZE = 256;
+    static constexpr int BLOCKS = 400;
+    
+    Oversampler oversampler;
+    oversampler.prepare(BLOCK_SIZE);
+    oversampler.setFactor(factor);
+    oversampler.setPhase(phase);
+    
+    AudioBuffer buffer(2, BLOCK_SIZE);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (uint32_t ch = 0; ch < 2; ++ch) {
+        for (uint32_t i = 0; i < BLOCK_SIZE; ++i) {
+            buffer.getChannel(ch)[i] = noise(random);
+        }
+    }
+    
+    auto identity = [](uint32_t, float*, uint32_t) {};
+    // Premier bloc hors mesure (application du facteur, caches)
+    oversampler.process(buffer.getReadPointers(), buffer.getWritePointers(), 2, BLOCK_SIZE, identity);
+    const uint64_t start = DSPProfiler::now();
+    for (int b = 0; b < BLOCKS; ++b) {
+        oversampler.process(buffer.getReadPointers(), buffer.getWritePointers(), 2, BLOCK_SIZE, identity);
+    }
+    const uint64_t elapsed = DSPProfiler::now() - start;
+    
+    Cost cost;
+    cost.factor = oversampler.getFactor();
+    cost.phase = phase;
+    cost.nsPerFrame = static_cast<double>(elapsed) / (static_cast<double>(BLOCKS) * BLOCK_SIZE);
+    cost.latency = getLatency(cost.factor, phase);
+    return cost;
+}
+
+std::vector<Oversampler::Cost> Oversampler::measureCosts() {
+    std::vector<Cost> costs;
+    for (uint32_t factor = 2; factor <= MAX_FACTOR; factor *= 2) {
+        costs.push_back(measureCost(factor, Phase::Linear));
+        costs.push_back(measureCost(factor, Phase::Minimum));
+    }
+    return costs;
+}
+
+} // namespace webamp
@@ -0,0 +1,383 @@
+#include "../include/parallel_effect.h"
+#include <algorithm>
+#include <string>
+
+namespace webamp {
+
+ParallelEffect::ParallelEffect(size_t branchCount, RTWorkerPool* pool)
+    : branch_count_(std::max<size_t>(1, std::min(branchCount, MAX_BRANCHES)))
+    , pool_(pool ? pool : &RTWorkerPool::getShared())
+    , parallel_(true)
+    , latency_(0)
+    , tail_length_(0)
+    , compensation_pool_(CompensationDelay::MAX_DELAY, branch_count_ * CompensationDelay::MAX_CHANNELS)
+{
+    for (auto& level : levels_) {
+        level.setImmediate(1.0f);
+    }
+    branches_.resize(branch_count_);
+    for (size_t b = 0; b < branch_count_; ++b) {
+        compensation_[b] = std::make_unique<CompensationDelay>(&compensation_pool_);
+        compensation_[b]->reserve();
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    publishLocked();
+}
+
+ParallelEffect::~ParallelEffect() {
+    for (auto& effects : branches_) {
+        for (auto& effect : effects) {
+            effect->setStructureListener(nullptr);
+        }
+    }
+}
+
+void ParallelEffect::publishLocked() {
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->maxFrameCount = max_block_size_;
+    snapshot->branches = std::vector<Branch>(branch_count_);
+    for (size_t b = 0; b < branch_count_; ++b) {
+        Branch& branch = snapshot->branches[b];
+        branch.effects = branches_[b];
+        branch.compensation = compensation_[b].get();
+        branch.work[0].resize(MAX_CHANNELS, max_block_size_);
+        branch.work[1].resize(MAX_CHANNELS, max_block_size_);
+    }
+    latency_.store(updateCompensation(*snapshot), std::memory_order_relaxed);
+    publisher_.publish(std::move(snapshot));
+}
+
+uint32_t ParallelEffect::getBranchLatency(const std::vector<std::shared_ptr<EffectBase>>& effects) {
+    uint32_t latency = 0;
+    for (const auto& effect : effects) {
+        if (!effect->isBypassed()) {
+            latency += effect->getLatency();
+        }
+    }
+    return latency;
+}
+
+uint32_t ParallelEffect::updateCompensation(Snapshot& snapshot) {
+    uint32_t latencies[MAX_BRANCHES] = {};
+    uint32_t maxLatency = 0;
+    uint32_t maxTail = 0;
+    for (size_t b = 0; b < snapshot.branches.size(); ++b) {
+        latencies[b] = getBranchLatency(snapshot.branches[b].effects);
+        maxLatency = std::max(maxLatency, latencies[b]);
+        
+        // Queues en série (saturée à INFINITE_TAIL)
+        uint64_t tail = 0;
+        for (const auto& effect : snapshot.branches[b].effects) {
+            if (!effect->isBypassed()) {
+                tail += effect->getTailLength();
+            }
+        }
+        maxTail = static_cast<uint32_t>(std::max<uint64_t>(maxTail, std::min<uint64_t>(tail, INFINITE_TAIL)));
+    }
+    for (size_t b = 0; b < snapshot.branches.size(); ++b) {
+        snapshot.branches[b].delay = maxLatency - latencies[b];
+    }
+    tail_length_.store(maxTail, std::memory_order_relaxed);
+    return maxLatency;
+}
+
+bool ParallelEffect::isCompensationReserved() const {
+    for (size_t b = 0; b < branch_count_; ++b) {
+        if (!compensation_[b]->isReserved()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t ParallelEffect::getCompensationFailureCount() const {
+    uint64_t failures = 0;
+    for (size_t b = 0; b < branch_count_; ++b) {
+        failures += compensation_[b]->getFailureCount();
+    }
+    return failures;
+}
+
+void ParallelEffect::setSampleRate(uint32_t sampleRate) {
+    EffectBase::setSampleRate(sampleRate);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& branch : branches_) {
+        for (auto& effect : branch) {
+            effect->setSampleRate(sampleRate);
+        }
+    }
+}
+
+void ParallelEffect::setMaxBlockSize(uint32_t maxFrameCount) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (maxFrameCount == 0 || maxFrameCount == max_block_size_) {
+        return;
+    }
+    
+    EffectBase::setMaxBlockSize(maxFrameCount);
+    for (auto& branch : branches_) {
+        for (auto& effect : branch) {
+            effect->setMaxBlockSize(maxFrameCount);
+        }
+    }
+    publishLocked();
+}
+
+void ParallelEffect::addEffect(size_t branch, std::shared_ptr<EffectBase> effect, size_t position) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (!effect || branch >= branch_count_) {
+            return;
+        }
+        
+        effect->setMaxBlockSize(max_block_size_);
+        // Effet composite dans une branche : ses modifications remontent
+        effect->setStructureListener([this] { notifyStructureChanged(); });
+        
+        auto& effects = branches_[branch];
+        if (position == static_cast<size_t>(-1) || position >= effects.size()) {
+            effects.push_back(effect);
+        } else {
+            effects.insert(effects.begin() + position, effect);
+        }
+        
+        publishLocked();
+    }
+    notifyStructureChanged();
+}
+
+void ParallelEffect::removeEffect(size_t branch, size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (branch >= branch_count_ || index >= branches_[branch].size()) {
+            return;
+        }
+        branches_[branch][index]->setStructureListener(nullptr);
+        branches_[branch].erase(branches_[branch].begin() + index);
+        publishLocked();
+    }
+    notifyStructureChanged();
+}
+
+void ParallelEffect::clearBranch(size_t branch) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (branch >= branch_count_) {
+            return;
+        }
+        for (auto& effect : branches_[branch]) {
+            effect->setStructureListener(nullptr);
+        }
+        branches_[branch].clear();
+        publishLocked();
+    }
+    notifyStructureChanged();
+}
+
+std::shared_ptr<EffectBase> ParallelEffect::getEffect(size_t branch, size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (branch < branch_count_ && index < branches_[branch].size()) {
+        return branches_[branch][index];
+    }
+    return nullptr;
+}
+
+size_t ParallelEffect::getEffectCount(size_t branch) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return branch < branch_count_ ? branches_[branch].size() : 0;
+}
+
+bool ParallelEffect::containsEffect(const EffectBase* effect) const {
+    if (effect == this) {
+        return true;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& branch : branches_) {
+        for (const auto& e : branch) {
+            if (e->containsEffect(effect)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+EffectBase::ChannelLayout ParallelEffect::getChannelLayout() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& branch : branches_) {
+        for (const auto& effect : branch) {
+            if (effect->getChannelLayout() == ChannelLayout::MonoToStereo) {
+                return ChannelLayout::MonoToStereo;
+            }
+        }
+    }
+    return ChannelLayout::MonoToMono;
+}
+
+void ParallelEffect::collectMemoryEffects(std::vector<EffectBase*>& effects) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& branch : branches_) {
+        for (const auto& effect : branch) {
+            effect->collectMemoryEffects(effects);
+        }
+    }
+}
+
+bool ParallelEffect::applyParameterChange(const ParameterChange& change) {
+    if (EffectBase::applyParameterChange(change)) {
+        return true;
+    }
+    
+    // Thread audio, en début de bloc : aucune branche n'est en cours de traitement
+    SnapshotPublisher<Snapshot>::ReadScope snapshot(publisher_);
+    if (!snapshot) {
+        return false;
+    }
+    for (auto& branch : snapshot->branches) {
+        for (auto& effect : branch.effects) {
+            if (effect->applyParameterChange(change)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ParallelEffect::applyQualityTier(uint32_t tier) {
+    SnapshotPublisher<Snapshot>::ReadScope snapshot(publisher_);
+    if (!snapshot) {
+        return;
+    }
+    for (const auto& branch : snapshot->branches) {
+        for (const auto& effect : branch.effects) {
+            effect->setQualityTier(tier);
+        }
+    }
+    latency_.store(updateCompensation(*snapshot.get()), std::memory_order_relaxed);
+}
+
+void ParallelEffect::process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) {
+    SnapshotPublisher<Snapshot>::ReadScope snapshot(publisher_);
+    
+    if (bypass_ || !snapshot) {
+        AudioBuffer::copy(input, output, channels, frameCount);
+        return;
+    }
+    
+    const auto& branches = snapshot->branches;
+    for (const auto& branch : branches) {
+        for (const auto& effect : branch.effects) {
+            effect->setQualityTier(quality_tier_);
+        }
+    }
+    // Après le niveau de qualité, qui peut changer le suréchantillonnage
+    latency_.store(updateCompensation(*snapshot.get()), std::memory_order_relaxed);
+    
+    snapshot->channels = std::min(channels, MAX_CHANNELS);
+    uint32_t offset = 0;
+    while (offset < frameCount) {
+        const uint32_t chunk = std::min(frameCount - offset, snapshot->maxFrameCount);
+        for (uint32_t ch = 0; ch < snapshot->channels; ++ch) {
+            snapshot->input[ch] = input[ch] + offset;
+        }
+        snapshot->frameCount = chunk;
+        
+        if (parallel_.load(std::memory_order_relaxed)) {
+            pool_->run(&ParallelEffect::processBranch, snapshot.get(), branch_count_);
+        } else {
+            for (size_t b = 0; b < branch_count_; ++b) {
+                processBranch(snapshot.get(), b);
+            }
+        }
+        
+        // Somme pondérée des branches (toutes terminées : output peut être input)
+        float gains[MAX_BRANCHES];
+        for (uint32_t i = 0; i < chunk; ++i) {
+            for (size_t b = 0; b < branch_count_; ++b) {
+                gains[b] = levels_[b].getNextValue();
+            }
+            for (uint32_t ch = 0; ch < snapshot->channels; ++ch) {
+                float sum = 0.0f;
+                for (size_t b = 0; b < branch_count_; ++b) {
+                    sum += gains[b] * branches[b].result[ch][i];
+                }
+                output[ch][offset + i] = sum;
+            }
+        }
+        offset += chunk;
+    }
+}
+
+void ParallelEffect::processBranch(void* context, size_t index) {
+    Snapshot* snapshot = static_cast<Snapshot*>(context);
+    Branch& branch = snapshot->branches[index];
+    const uint32_t channels = snapshot->channels;
+    
+    // Copie privée de l'entrée : un effet de la branche ne peut pas modifier
+    // l'entrée lue par les autres branches
+    AudioBuffer::copy(snapshot->input, branch.work[0].getWritePointers(), channels, snapshot->frameCount);
+    
+    // Puis en place, comme EffectChain : effets contournés sautés, second
+    // buffer réservé aux effets qui ne peuvent pas être traités en place
+    AudioBuffer* current = &branch.work[0];
+    AudioBuffer* other = &branch.work[1];
+    for (const auto& effect : branch.effects) {
+        if (effect->isBypassed()) {
+            continue;
+        }
+        if (effect->canProcessInPlace()) {
+            effect->process(current->getReadPointers(), current->getWritePointers(), channels, snapshot->frameCount);
+        } else {
+            effect->process(current->getReadPointers(), other->getWritePointers(), channels, snapshot->frameCount);
+            std::swap(current, other);
+        }
+    }
+    // En place, sur la ligne propre à la branche (retard nul : historique
+    // seulement)
+    branch.compensation->process(current->getReadPointers(), current->getWritePointers(), channels,
+                                snapshot->frameCount, branch.delay);
+    branch.result = current->getReadPointers();
+}
+
+std::vector<EffectBase::Parameter> ParallelEffect::getParameters() const {
+    std::vector<Parameter> parameters;
+    for (size_t b = 0; b < branch_count_; ++b) {
+        const std::string number = std::to_string(b + 1);
+        parameters.push_back({"level" + number, "Level " + number, 0.0f, 2.0f, 1.0f, levels_[b].getRequestedValue()});
+    }
+    return parameters;
+}
+
+void ParallelEffect::setParameter(const std::string& name, float value) {
+    for (size_t b = 0; b < branch_count_; ++b) {
+        if (name == "level" + std::to_string(b + 1)) {
+            setParameterByIndex(b, value);
+            return;
+        }
+    }
+}
+
+void ParallelEffect::setParameterByIndex(size_t index, float value) {
+    if (index < branch_count_) {
+        levels_[index].setTarget(std::max(0.0f, std::min(2.0f, value)), getSmoothingSamples());
+    }
+}
+
+float ParallelEffect::getParameter(const std::string& name) const {
+    for (size_t b = 0; b < branch_count_; ++b) {
+        if (name == "level" + std::to_string(b + 1)) {
+            return levels_[b].getRequestedValue();
+        }
+    }
+    return 0.0f;
+}
+
+} // namespace webamp
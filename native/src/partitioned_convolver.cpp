@@ -0,0 +1,196 @@
+#include "../include/partitioned_convolver.h"
+#include "../include/fft_helper.h"
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace webamp {
+
+PartitionedConvolver::PartitionedConvolver()
+    : block_size_(0)
+    , fft_size_(0)
+    , bins_(0)
+    , current_(0)
+    , active_partitions_(0)
+    , input_fill_(0)
+{
+}
+
+bool PartitionedConvolver::init(size_t blockSize, const float* ir, size_t irLength) {
+    ir_partitions_.clear();
+    input_partitions_.clear();
+    
+    if (blockSize == 0 || !ir || irLength == 0) {
+        block_size_ = 0;
+        fft_size_ = 0;
+        bins_ = 0;
+        plan_.reset();
+        return false;
+    }
+    
+    block_size_ = 1;
+    while (block_size_ < blockSize) {
+        block_size_ <<= 1;
+    }
+    fft_size_ = block_size_ * 2;
+    bins_ = block_size_ + 1;
+    plan_ = std::make_unique<FFTPlan>(fft_size_);
+    input_block_.assign(fft_size_, 0.0f);
+    output_block_.assign(fft_size_, 0.0f);
+    
+    // Spectres des partitions de l'IR (calculés une seule fois)
+    const size_t partitionCount = (irLength + block_size_ - 1) / block_size_;
+    ir_partitions_.resize(partitionCount);
+    active_partitions_ = partitionCount;
+    for (size_t p = 0; p < partitionCount; ++p) {
+        Spectrum& spectrum = ir_partitions_[p];
+        spectrum.assign(bins_);
+        
+        const size_t start = p * block_size_;
+        const size_t length = std::min(block_size_, irLength - start);
+        std::fill(input_block_.begin(), input_block_.end(), 0.0f);
+        std::copy(ir + start, ir + start + length, input_block_.begin());
+        plan_->forwardReal(input_block_.data(), spectrum.re.data(), spectrum.im.data());
+    }
+    
+    input_partitions_.resize(partitionCount);
+    for (auto& spectrum : input_partitions_) {
+        spectrum.assign(bins_);
+    }
+    accumulated_.assign(bins_);
+    fft_buffer_.assign(bins_);
+    overlap_.resize(block_size_);
+    
+    reset();
+    return true;
+}
+
+void PartitionedConvolver::reset() {
+    for (auto& spectrum : input_partitions_) {
+        spectrum.clear();
+    }
+    accumulated_.clear();
+    std::fill(input_block_.begin(), input_block_.end(), 0.0f);
+    std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+    current_ = 0;
+    input_fill_ = 0;
+}
+
+void PartitionedConvolver::multiplyAccumulate(Spectrum& acc, const Spectrum& a, const Spectrum& b, size_t bins) {
+    float* accRe = acc.re.data();
+    float* accIm = acc.im.data();
+    const float* aRe = a.re.data();
+    const float* aIm = a.im.data();
+    const float* bRe = b.re.data();
+    const float* bIm = b.im.data();
+    size_t i = 0;
+
+#ifdef __AVX__
+    for (; i + 8 <= bins; i += 8) {
+        const __m256 ar = _mm256_load_ps(aRe + i);
+        const __m256 ai = _mm256_load_ps(aIm + i);
+        const __m256 br = _mm256_load_ps(bRe + i);
+        const __m256 bi = _mm256_load_ps(bIm + i);
+        const __m256 re = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+        const __m256 im = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+        _mm256_store_ps(accRe + i, _mm256_add_ps(_mm256_load_ps(accRe + i), re));
+        _mm256_store_ps(accIm + i, _mm256_add_ps(_mm256_load_ps(accIm + i), im));
+    }
+#elif defined(__SSE__)
+    for (; i + 4 <= bins; i += 4) {
+        const __m128 ar = _mm_load_ps(aRe + i);
+        const __m128 ai = _mm_load_ps(aIm + i);
+        const __m128 br = _mm_load_ps(bRe + i);
+        const __m128 bi = _mm_load_ps(bIm + i);
+        const __m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+        const __m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+        _mm_store_ps(accRe + i, _mm_add_ps(_mm_load_ps(accRe + i), re));
+        _mm_store_ps(accIm + i, _mm_add_ps(_mm_load_ps(accIm + i), im));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= bins; i += 4) {
+        const float32x4_t ar = vld1q_f32(aRe + i);
+        const float32x4_t ai = vld1q_f32(aIm + i);
+        const float32x4_t br = vld1q_f32(bRe + i);
+        const float32x4_t bi = vld1q_f32(bIm + i);
+        float32x4_t re = vmlaq_f32(vld1q_f32(accRe + i), ar, br);
+        float32x4_t im = vmlaq_f32(vld1q_f32(accIm + i), ar, bi);
+        re = vmlsq_f32(re, ai, bi);
+        im = vmlaq_f32(im, ai, br);
+        vst1q_f32(accRe + i, re);
+        vst1q_f32(accIm + i, im);
+    }
+#endif
+
+    // Bins restants (dont le bin de Nyquist)
+    for (; i < bins; ++i) {
+        accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+        accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+    }
+}
+
+void PartitionedConvolver::setActivePartitionCount(size_t count) {
+    active_partitions_ = std::max<size_t>(1, std::min(count, ir_partitions_.size()));
+}
+
+void PartitionedConvolver::process(const float* input, float* output, size_t count) {
+    if (ir_partitions_.empty()) {
+        std::fill(output, output + count, 0.0f);
+        return;
+    }
+    
+    const size_t partitionCount = ir_partitions_.size();
+    size_t processed = 0;
+    
+    while (processed < count) {
+        const bool blockStart = (input_fill_ == 0);
+        const size_t offset = input_fill_;
+        const size_t chunk = std::min(count - processed, block_size_ - input_fill_);
+        
+        std::copy(input + processed, input + processed + chunk, input_block_.begin() + offset);
+        
+        // Spectre du bloc courant (complété par des zéros s'il est partiel)
+        Spectrum& current = input_partitions_[current_];
+        plan_->forwardReal(input_block_.data(), current.re.data(), current.im.data());
+        
+        // Blocs précédents : leur contribution ne change pas au sein d'un bloc
+        if (blockStart) {
+            accumulated_.clear();
+            for (size_t p = 1; p < active_partitions_; ++p) {
+                multiplyAccumulate(accumulated_, input_partitions_[(current_ + p) % partitionCount], ir_partitions_[p], bins_);
+            }
+        }
+        
+        std::copy(accumulated_.re.begin(), accumulated_.re.end(), fft_buffer_.re.begin());
+        std::copy(accumulated_.im.begin(), accumulated_.im.end(), fft_buffer_.im.begin());
+        multiplyAccumulate(fft_buffer_, current, ir_partitions_[0], bins_);
+        plan_->inverseReal(fft_buffer_.re.data(), fft_buffer_.im.data(), output_block_.data());
+        
+        for (size_t i = 0; i < chunk; ++i) {
+            output[processed + i] = output_block_[offset + i] + overlap_[offset + i];
+        }
+        
+        input_fill_ += chunk;
+        processed += chunk;
+        
+        // Bloc complet : sauvegarder la queue (overlap-add) et avancer la ligne à retard
+        if (input_fill_ == block_size_) {
+            std::copy(output_block_.begin() + block_size_, output_block_.end(), overlap_.begin());
+            std::fill(input_block_.begin(), input_block_.begin() + block_size_, 0.0f);
+            input_fill_ = 0;
+            current_ = (current_ > 0) ? current_ - 1 : partitionCount - 1;
+        }
+    }
+}
+
+} // namespace webamp
@@ -0,0 +1,92 @@
+#include "../include/quality_controller.h"
+#include <algorithm>
+
+namespace webamp {
+
+QualityController::QualityController()
+    : level_(0)
+    , events_(EVENT_QUEUE_CAPACITY)
+    , blocks_over_(0)
+    , frames_under_(0)
+    , frames_(0)
+{
+    setSettings(Settings{});
+}
+
+void QualityController::setSettings(const Settings& settings) {
+    high_water_.store(settings.highWater, std::memory_order_relaxed);
+    low_water_.store(std::min(settings.lowWater, settings.highWater), std::memory_order_relaxed);
+    down_blocks_.store(std::max(1u, settings.downBlocks), std::memory_order_relaxed);
+    up_seconds_.store(std::max(0.0, settings.upSeconds), std::memory_order_relaxed);
+    max_level_.store(settings.maxLevel, std::memory_order_relaxed);
+    enabled_.store(settings.enabled, std::memory_order_release);
+}
+
+QualityController::Settings QualityController::getSettings() const {
+    Settings settings;
+    settings.enabled = enabled_.load(std::memory_order_acquire);
+    settings.highWater = high_water_.load(std::memory_order_relaxed);
+    settings.lowWater = low_water_.load(std::memory_order_relaxed);
+    settings.downBlocks = down_blocks_.load(std::memory_order_relaxed);
+    settings.upSeconds = up_seconds_.load(std::memory_order_relaxed);
+    settings.maxLevel = max_level_.load(std::memory_order_relaxed);
+    return settings;
+}
+
+uint32_t QualityController::update(double load, uint32_t frameCount, uint32_t sampleRate) {
+    frames_ += frameCount;
+    const uint32_t level = level_.load(std::memory_order_relaxed);
+    
+    if (!enabled_.load(std::memory_order_acquire)) {
+        blocks_over_ = 0;
+        frames_under_ = 0;
+        if (level != 0) {
+            changeLevel(0, load);
+        }
+        return 0;
+    }
+    
+    const uint32_t maxLevel = max_level_.load(std::memory_order_relaxed);
+    if (level > maxLevel) {
+        changeLevel(maxLevel, load);
+        return maxLevel;
+    }
+    
+    // Dégradation : échéance dépassée, ou charge haute sur plusieurs blocs
+    if (load >= high_water_.load(std::memory_order_relaxed)) {
+        frames_under_ = 0;
+        ++blocks_over_;
+        if ((load >= 1.0 || blocks_over_ >= down_blocks_.load(std::memory_order_relaxed)) && level < maxLevel) {
+            blocks_over_ = 0;
+            changeLevel(level + 1, load);
+            return level + 1;
+        }
+        return level;
+    }
+    blocks_over_ = 0;
+    
+    // Remontée : charge basse pendant upSeconds (la zone entre lowWater et
+    // highWater remet le compteur à zéro)
+    if (load < low_water_.load(std::memory_order_relaxed)) {
+        frames_under_ += frameCount;
+        const double upFrames = up_seconds_.load(std::memory_order_relaxed) * sampleRate;
+        if (level > 0 && static_cast<double>(frames_under_) >= upFrames) {
+            frames_under_ = 0;
+            changeLevel(level - 1, load);
+            return level - 1;
+        }
+    } else {
+        frames_under_ = 0;
+    }
+    return level;
+}
+
+void QualityController::changeLevel(uint32_t level, double load) {
+    const Event event{level, level_.load(std::memory_order_relaxed), load, frames_};
+    level_.store(level, std::memory_order_relaxed);
+    // File pleine (thread de contrôle absent) : l'événement est perdu, le
+    // niveau courant reste lisible par getLevel()
+    events_.write(&event, 1);
+}
+
+} // namespace webamp
@@ -0,0 +1,263 @@
+#include "../include/realtime_thread.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#if defined(__linux__) || defined(__APPLE__)
+#include <alloca.h>
+#else
+#include <stdlib.h>
+#endif
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#define WEBAMP_X86_MXCSR 1
+#endif
+
+namespace webamp {
+
+namespace {
+
+#ifndef _WIN32
+// Priorité demandée (-1 : max - 1, comme le RTWorkerPool), bornée à la plage SCHED_FIFO
+int resolvePriority(int priority) {
+    const int maximum = sched_get_priority_max(SCHED_FIFO);
+    const int minimum = sched_get_priority_min(SCHED_FIFO);
+    if (priority < 0) {
+        priority = maximum - 1;
+    }
+    return std::clamp(priority, minimum, maximum);
+}
+
+int applyPriority(pthread_t thread, int priority) {
+    sched_param param{};
+    param.sched_priority = resolvePriority(priority);
+    int result = pthread_setschedparam(thread, SCHED_FIFO, &param);
+    
+    #ifdef __linux__
+    // Sans CAP_SYS_NICE, le noyau accepte SCHED_FIFO jusqu'à RLIMIT_RTPRIO
+    // (limits.conf, groupe audio) : on retente à cette priorité
+    if (result == EPERM) {
+        rlimit limit{};
+        if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0) {
+            const int allowed = limit.rlim_cur == RLIM_INFINITY
+                ? param.sched_priority
+                : static_cast<int>(std::min<rlim_t>(limit.rlim_cur, static_cast<rlim_t>(param.sched_priority)));
+            param.sched_priority = allowed;
+            result = pthread_setschedparam(thread, SCHED_FIFO, &param);
+        }
+    }
+    #endif
+    
+    return result == 0 ? param.sched_priority : 0;
+}
+#endif
+
+} // namespace
+
+RealtimeThread::State RealtimeThread::setupCurrentThread(const Settings& settings, size_t threadIndex) {
+    State state;
+    
+    state.priorityValue = setCurrentThreadPriority(settings.priority);
+    state.priority = state.priorityValue > 0;
+    
+    if (settings.setAffinity) {
+        const std::vector<int> cpus = settings.cpus.empty() ? getIsolatedCpus() : settings.cpus;
+        if (!cpus.empty()) {
+            const int cpu = cpus[threadIndex % cpus.size()];
+            if (setCurrentThreadAffinity(cpu)) {
+                state.affinity = true;
+                state.cpu = cpu;
+            }
+        }
+    }
+    
+    if (settings.prefaultStackBytes > 0) {
+        state.stackPrefaulted = prefaultStack(settings.prefaultStackBytes);
+    }
+    
+    if (settings.flushDenormals) {
+        state.denormalsFlushed = disableDenormals();
+    }
+    
+    return state;
+}
+
+int RealtimeThread::setCurrentThreadPriority(int priority) {
+    #ifdef _WIN32
+    (void)priority;
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) ? THREAD_PRIORITY_TIME_CRITICAL : 0;
+    #else
+    return applyPriority(pthread_self(), priority);
+    #endif
+}
+
+int RealtimeThread::setThreadPriority(std::thread& thread, int priority) {
+    #ifdef _WIN32
+    (void)priority;
+    return SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL) ? THREAD_PRIORITY_TIME_CRITICAL : 0;
+    #else
+    return applyPriority(thread.native_handle(), priority);
+    #endif
+}
+
+bool RealtimeThread::setCurrentThreadAffinity(int cpu) {
+    if (cpu < 0) {
+        return false;
+    }
+    #if defined(_WIN32)
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+    #elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    #else
+    // macOS : pas d'affinité stricte (seulement des indications au noyau)
+    return false;
+    #endif
+}
+
+std::vector<int> RealtimeThread::getIsolatedCpus() {
+    #ifdef __linux__
+    std::ifstream file("/sys/devices/system/cpu/isolated");
+    std::string list;
+    if (file && std::getline(file, list)) {
+        return parseCpuList(list);
+    }
+    #endif
+    return {};
+}
+
+std::vector<int> RealtimeThread::parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), [](char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }), range.end());
+        if (range.empty()) {
+            continue;
+        }
+        
+        try {
+            const size_t dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last && cpu >= 0; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "RealtimeThread: liste de cœurs invalide: " << list << std::endl;
+            return {};
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+bool RealtimeThread::lockMemory() {
+    #ifdef _WIN32
+    // Pas d'équivalent processus entier (VirtualLock est par région)
+    return false;
+    #else
+    // MCL_FUTURE seulement si la limite est infinie : avec une limite
+    // finie, les allocations qui la dépassent échoueraient ensuite
+    int flags = MCL_CURRENT;
+    rlimit limit{};
+    if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur == RLIM_INFINITY) {
+        flags |= MCL_FUTURE;
+    }
+    if (mlockall(flags) != 0) {
+        std::cerr << "RealtimeThread: mlockall impossible (errno " << errno
+                  << "), vérifier RLIMIT_MEMLOCK" << std::endl;
+        return false;
+    }
+    return true;
+    #endif
+}
+
+void RealtimeThread::unlockMemory() {
+    #ifndef _WIN32
+    munlockall();
+    #endif
+}
+
+bool RealtimeThread::prefaultStack(size_t bytes) {
+    if (bytes == 0) {
+        return false;
+    }
+    // Une écriture par page : le noyau mappe toute la zone maintenant
+    // plutôt qu'au premier appel profond dans un effet
+    #ifdef _WIN32
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(_alloca(bytes));
+    #else
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(alloca(bytes));
+    #endif
+    constexpr size_t PAGE = 4096;
+    for (size_t offset = 0; offset < bytes; offset += PAGE) {
+        stack[offset] = 0;
+    }
+    stack[bytes - 1] = 0;
+    return true;
+}
+
+bool RealtimeThread::disableDenormals() {
+    #if defined(WEBAMP_X86_MXCSR)
+    // Bits 15 (FTZ) et 6 (DAZ) du MXCSR
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+    return true;
+    #elif defined(__aarch64__)
+    // Bit 24 (FZ) du FPCR
+    uint64_t fpcr;
+    asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+    asm volatile("msr fpcr, %0" : : "r"(fpcr | (uint64_t(1) << 24)));
+    return true;
+    #elif defined(__arm__) && defined(__ARM_FP)
+    // Bit 24 (FZ) du FPSCR
+    uint32_t fpscr;
+    asm volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    asm volatile("vmsr fpscr, %0" : : "r"(fpscr | (uint32_t(1) << 24)));
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+bool RealtimeThread::areDenormalsDisabled() {
+    #if defined(WEBAMP_X86_MXCSR)
+    return (_mm_getcsr() & 0x8040) == 0x8040;
+    #elif defined(__aarch64__)
+    uint64_t fpcr;
+    asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return (fpcr & (uint64_t(1) << 24)) != 0;
+    #elif defined(__arm__) && defined(__ARM_FP)
+    uint32_t fpscr;
+    asm volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    return (fpscr & (uint32_t(1) << 24)) != 0;
+    #else
+    return false;
+    #endif
+}
+
+} // namespace webamp
@@ -0,0 +1,149 @@
+#include "dsp_profiler.h"
+#include "offline_renderer.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace webamp;
+
+// webamp-render : rendu hors ligne de fichiers WAV à travers une chaîne
+// d'effets décrite en JSON (voir offline_renderer.h), sans driver audio.
+// Sert au traitement par lots, aux tests de non-régression sur des rendus
+// de référence et aux mesures de performance (xRT).
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --chain chain.json [options] <entrée.wav|répertoire> <sortie.wav|répertoire>\n"
+              << "\n"
+              << "Options:\n"
+              << "  --chain <fichier>   Description JSON de la chaîne (obligatoire)\n"
+              << "  --block <N>         Taille de bloc en échantillons (défaut : celle de la chaîne, 256)\n"
+              << "  --threads <N>       Fichiers rendus en parallèle (défaut : un par cœur)\n"
+              << "  --tail <secondes>   Durée rendue après la fin de l'entrée\n"
+              << "  --bits <16|24|32>   Format de sortie (32 = float)\n";
+}
+
+bool parseNumber(const char* text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string chainPath;
+    std::vector<std::string> positional;
+    double block = 0.0;
+    double threads = 0.0;
+    double tail = -1.0;
+    double bits = 0.0;
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--chain" && hasValue) {
+            chainPath = argv[++i];
+        } else if (arg == "--block" && hasValue) {
+            valid = parseNumber(argv[++i], block);
+        } else if (arg == "--threads" && hasValue) {
+            valid = parseNumber(argv[++i], threads);
+        } else if (arg == "--tail" && hasValue) {
+            valid = parseNumber(argv[++i], tail);
+        } else if (arg == "--bits" && hasValue) {
+            valid = parseNumber(argv[++i], bits);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            valid = false;
+        } else {
+            positional.push_back(arg);
+        }
+        if (!valid) {
+            std::cerr << "Argument invalide: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (chainPath.empty() || positional.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    ChainDescription description;
+    std::string error;
+    if (!ChainDescription::load(chainPath, description, error)) {
+        std::cerr << "Erreur: " << chainPath << ": " << error << "\n";
+        return 1;
+    }
+    
+    // La ligne de commande prime sur la description
+    if (block > 0.0) {
+        description.blockSize = static_cast<uint32_t>(block);
+    }
+    if (tail >= 0.0) {
+        description.tailSeconds = tail;
+    }
+    if (bits > 0.0) {
+        description.bitDepth = static_cast<uint16_t>(bits);
+    }
+    if (description.blockSize == 0 || description.blockSize > 8192 ||
+        (description.bitDepth != 16 && description.bitDepth != 24 && description.bitDepth != 32)) {
+        std::cerr << "Erreur: taille de bloc ou format de sortie invalide\n";
+        return 1;
+    }
+    
+    // Fichier unique ou répertoire complet (même nom en sortie)
+    std::vector<std::pair<std::string, std::string>> jobs;
+    const std::filesystem::path input = positional[0];
+    const std::filesystem::path output = positional[1];
+    if (std::filesystem::is_directory(input)) {
+        std::error_code ec;
+        std::filesystem::create_directories(output, ec);
+        for (const auto& file : OfflineRenderer::listWavFiles(input.string())) {
+            jobs.emplace_back(file, (output / std::filesystem::path(file).filename()).string());
+        }
+        if (jobs.empty()) {
+            std::cerr << "Erreur: aucun fichier WAV dans " << input.string() << "\n";
+            return 1;
+        }
+    } else {
+        jobs.emplace_back(input.string(), output.string());
+    }
+    
+    OfflineRenderer renderer(std::move(description));
+    const uint64_t start = DSPProfiler::now();
+    const auto results = renderer.renderFiles(jobs, static_cast<size_t>(threads));
+    const double wallSeconds = static_cast<double>(DSPProfiler::now() - start) / 1e9;
+    
+    double audioSeconds = 0.0;
+    size_t failures = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& result : results) {
+        if (!result.success) {
+            ++failures;
+            std::cerr << "ÉCHEC " << result.inputPath << ": " << result.error << "\n";
+            continue;
+        }
+        audioSeconds += result.audioSeconds;
+        std::cout << result.inputPath << " -> " << result.outputPath
+                  << " (" << result.audioSeconds << " s, " << result.getRealtimeFactor() << "x temps réel)\n";
+    }
+    
+    std::cout << results.size() - failures << "/" << results.size() << " fichiers, "
+              << audioSeconds << " s audio en " << std::setprecision(2) << wallSeconds << " s";
+    if (wallSeconds > 0.0) {
+        std::cout << std::setprecision(1) << " (" << audioSeconds / wallSeconds << "x temps réel)";
+    }
+    std::cout << "\n";
+    
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#include "../include/resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define WEBAMP_RESAMPLER_AVX2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define WEBAMP_RESAMPLER_NEON 1
+#endif
+
+namespace webamp {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double KAISER_BETA = 7.0;     // ~70 dB d'atténuation hors bande
+constexpr double ROLLOFF = 0.9;         // Coupure relative à la plus petite fréquence de Nyquist
+constexpr uint32_t TAP_ALIGNMENT = 8;   // Un registre AVX
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        const double ratio = x / (2.0 * k);
+        term *= ratio * ratio;
+        sum += term;
+    }
+    return sum;
+}
+
+// coefs aligné, count multiple de TAP_ALIGNMENT, x quelconque
+inline float dot(const float* coefs, const float* x, uint32_t count) {
+#if defined(WEBAMP_RESAMPLER_AVX2)
+    __m256 acc = _mm256_setzero_ps();
+    for (uint32_t i = 0; i < count; i += 8) {
+        acc = _mm256_fmadd_ps(_mm256_load_ps(coefs + i), _mm256_loadu_ps(x + i), acc);
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#elif defined(WEBAMP_RESAMPLER_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (uint32_t i = 0; i < count; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(coefs + i), vld1q_f32(x + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(coefs + i + 4), vld1q_f32(x + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (uint32_t i = 0; i < count; i += 4) {
+        acc[0] += coefs[i] * x[i];
+        acc[1] += coefs[i + 1] * x[i + 1];
+        acc[2] += coefs[i + 2] * x[i + 2];
+        acc[3] += coefs[i + 3] * x[i + 3];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+}
+
+} // namespace
+
+Resampler::Resampler()
+    : input_rate_(0)
+    , output_rate_(0)
+    , interpolation_(1)
+    , decimation_(1)
+    , taps_(0)
+    , phases_(0)
+    , max_input_count_(0)
+    , index_(0)
+    , phase_(0)
+{
+}
+
+bool Resampler::init(uint32_t inputRate, uint32_t outputRate, uint32_t maxInputCount, uint32_t taps) {
+    phases_ = 0;
+    if (inputRate == 0 || outputRate == 0 || maxInputCount == 0) {
+        return false;
+    }
+    
+    const uint32_t divisor = std::gcd(inputRate, outputRate);
+    const uint32_t interpolation = outputRate / divisor;
+    const uint32_t decimation = inputRate / divisor;
+    if (interpolation > MAX_PHASES) {
+        return false;
+    }
+    
+    input_rate_ = inputRate;
+    output_rate_ = outputRate;
+    interpolation_ = interpolation;
+    decimation_ = decimation;
+    taps_ = std::max(TAP_ALIGNMENT, (taps + TAP_ALIGNMENT - 1) / TAP_ALIGNMENT * TAP_ALIGNMENT);
+    max_input_count_ = maxInputCount;
+    
+    // Prototype au taux suréchantillonné L x inputRate, longueur taps_ x L
+    const uint32_t length = taps_ * interpolation_;
+    const double cutoff = ROLLOFF * 0.5 / std::max(interpolation_, decimation_);
+    // Centre sur un coefficient (fenêtre de length + 1 points dont le
+    // dernier, quasi nul, est omis) : retard de taps_ / 2 entrées exactement
+    const double center = 0.5 * length;
+    std::vector<double> h(length);
+    double sum = 0.0;
+    for (uint32_t n = 0; n < length; ++n) {
+        const double m = n - center;
+        const double sinc = (m == 0.0) ? 2.0 * cutoff : std::sin(2.0 * PI * cutoff * m) / (PI * m);
+        const double r = m / center;
+        const double window = besselI0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(KAISER_BETA);
+        h[n] = sinc * window;
+        sum += h[n];
+    }
+    
+    // Gain DC de 1 par branche (en moyenne) : somme totale = L
+    const double scale = interpolation_ / sum;
+    coefs_.assign(static_cast<size_t>(taps_) * interpolation_, 0.0f);
+    for (uint32_t p = 0; p < interpolation_; ++p) {
+        float* branch = coefs_.data() + static_cast<size_t>(p) * taps_;
+        for (uint32_t j = 0; j < taps_; ++j) {
+            branch[taps_ - 1 - j] = static_cast<float>(h[j * interpolation_ + p] * scale);
+        }
+    }
+    
+    buffer_.assign(taps_ - 1 + maxInputCount, 0.0f);
+    phases_ = interpolation_;
+    reset();
+    return true;
+}
+
+double Resampler::getLatency() const {
+    return 0.5 * taps_;
+}
+
+uint32_t Resampler::getMaxOutputCount(uint32_t inputCount) const {
+    const uint64_t count = static_cast<uint64_t>(inputCount) * interpolation_;
+    return static_cast<uint32_t>((count + decimation_ - 1) / decimation_) + 1;
+}
+
+void Resampler::reset() {
+    std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+    index_ = 0;
+    phase_ = 0;
+}
+
+uint32_t Resampler::process(const float* input, uint32_t inputCount, float* output) {
+    if (phases_ == 0) {
+        return 0;
+    }
+    inputCount = std::min(inputCount, max_input_count_);
+    
+    // Sortie k : entrée floor(kM / L), branche kM mod L ; la fenêtre de
+    // taps_ échantillons se termine sur l'entrée courante
+    const uint32_t history = taps_ - 1;
+    float* buffer = buffer_.data();
+    std::copy(input, input + inputCount, buffer + history);
+    
+    uint32_t produced = 0;
+    while (index_ < inputCount) {
+        output[produced++] = dot(coefs_.data() + static_cast<size_t>(phase_) * taps_, buffer + index_, taps_);
+        phase_ += decimation_;
+        index_ += phase_ / interpolation_;
+        phase_ %= interpolation_;
+    }
+    index_ -= inputCount;
+    
+    std::memmove(buffer, buffer + inputCount, history * sizeof(float));
+    return produced;
+}
+
+std::vector<float> Resampler::resample(const float* input, size_t count, uint32_t inputRate, uint32_t outputRate,
+                                       uint32_t taps) {
+    if (inputRate == outputRate) {
+        return std::vector<float>(input, input + count);
+    }
+    
+    static constexpr uint32_t BLOCK_SIZE = 4096;
+    Resampler resampler;
+    if (!resampler.init(inputRate, outputRate, BLOCK_SIZE, taps)) {
+        return {};
+    }
+    
+    // Première sortie décalée du retard de groupe (taps_ / 2 entrées) : le
+    // signal n'est pas retardé
+    resampler.index_ = resampler.taps_ / 2;
+    
+    const size_t target = static_cast<size_t>((static_cast<uint64_t>(count) * outputRate + inputRate / 2) / inputRate);
+    std::vector<float> output;
+    output.reserve(target + resampler.getMaxOutputCount(BLOCK_SIZE));
+    std::vector<float> chunk(resampler.getMaxOutputCount(BLOCK_SIZE));
+    const std::vector<float> zeros(BLOCK_SIZE, 0.0f);
+    
+    // Le signal puis des zéros, jusqu'à la dernière sortie attendue
+    size_t offset = 0;
+    while (output.size() < target) {
+        const bool tail = offset >= count;
+        const uint32_t n = tail ? BLOCK_SIZE : static_cast<uint32_t>(std::min<size_t>(BLOCK_SIZE, count - offset));
+        const uint32_t produced = resampler.process(tail ? zeros.data() : input + offset, n, chunk.data());
+        output.insert(output.end(), chunk.begin(), chunk.begin() + produced);
+        offset += n;
+    }
+    output.resize(target);
+    return output;
+}
+
+} // namespace webamp
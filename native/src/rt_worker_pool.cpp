@@ -0,0 +1,154 @@
+#include "../include/rt_worker_pool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace webamp {
+
+RTWorkerPool::RTWorkerPool(size_t workerCount)
+    : stop_(false)
+    , task_(nullptr)
+    , context_(nullptr)
+    , count_(0)
+    , busy_(false)
+    , open_(false)
+    , next_(0)
+    , remaining_(0)
+    , active_(0)
+    , settings_generation_(0)
+    , configured_(0)
+    , thread_states_(workerCount)
+{
+    workers_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back(&RTWorkerPool::workerLoop, this, i);
+        // Priorité temps réel (échec ignoré : droits insuffisants, conteneur...)
+        RealtimeThread::setThreadPriority(workers_.back());
+    }
+}
+
+RTWorkerPool::~RTWorkerPool() {
+    stop_.store(true);
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        wake_.post();
+    }
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+RTWorkerPool& RTWorkerPool::getShared() {
+    static RTWorkerPool pool([] {
+        const size_t cores = std::thread::hardware_concurrency();
+        return std::min(cores > 1 ? cores - 1 : size_t(1), MAX_SHARED_WORKERS);
+    }());
+    return pool;
+}
+
+void RTWorkerPool::run(Task task, void* context, size_t count) {
+    bool expected = false;
+    if (count <= 1 || workers_.empty() || !busy_.compare_exchange_strong(expected, true)) {
+        for (size_t i = 0; i < count; ++i) {
+            task(context, i);
+        }
+        return;
+    }
+    
+    task_ = task;
+    context_ = context;
+    count_ = count;
+    next_.store(0);
+    remaining_.store(count);
+    open_.store(true);
+    
+    const size_t wakeups = std::min(count - 1, workers_.size());
+    for (size_t i = 0; i < wakeups; ++i) {
+        wake_.post();
+    }
+    
+    // Le thread appelant prend sa part, puis attend les tâches en cours
+    executeTasks();
+    while (remaining_.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    
+    // Fermeture : un thread réveillé en retard voit open_ == false, ou bien
+    // il est compté dans active_ et on attend qu'il ressorte avant de
+    // réutiliser task_/context_/count_ (ordre séquentiel requis)
+    open_.store(false);
+    while (active_.load() != 0) {
+        std::this_thread::yield();
+    }
+    busy_.store(false, std::memory_order_release);
+}
+
+void RTWorkerPool::executeTasks() {
+    size_t index;
+    while ((index = next_.fetch_add(1)) < count_) {
+        task_(context_, index);
+        remaining_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+RealtimeThread::State RTWorkerPool::configureThreads(const RealtimeThread::Settings& settings, double timeoutSeconds) {
+    settings_ = settings;
+    configured_.store(0);
+    settings_generation_.fetch_add(1, std::memory_order_release);
+    
+    // Le sémaphore ne cible pas un thread : on réveille tout le pool jusqu'à
+    // ce que chacun ait vu la nouvelle génération (les réveils en trop
+    // ressortent sans rien faire)
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSeconds);
+    while (configured_.load(std::memory_order_acquire) < workers_.size()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            wake_.post();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return getThreadState();
+}
+
+RealtimeThread::State RTWorkerPool::getThreadState() const {
+    if (workers_.empty() || configured_.load(std::memory_order_acquire) < workers_.size()) {
+        return RealtimeThread::State{};
+    }
+    
+    RealtimeThread::State state = thread_states_.front();
+    for (const auto& thread : thread_states_) {
+        state.priority = state.priority && thread.priority;
+        state.affinity = state.affinity && thread.affinity;
+        state.stackPrefaulted = state.stackPrefaulted && thread.stackPrefaulted;
+        state.denormalsFlushed = state.denormalsFlushed && thread.denormalsFlushed;
+        state.priorityValue = std::min(state.priorityValue, thread.priorityValue);
+    }
+    return state;
+}
+
+void RTWorkerPool::workerLoop(size_t index) {
+    uint32_t generation = 0;
+    for (;;) {
+        wake_.wait();
+        if (stop_.load()) {
+            return;
+        }
+        
+        const uint32_t requested = settings_generation_.load(std::memory_order_acquire);
+        if (requested != generation) {
+            generation = requested;
+            thread_states_[index] = RealtimeThread::setupCurrentThread(settings_, index + 1);
+            configured_.fetch_add(1, std::memory_order_release);
+        }
+        
+        active_.fetch_add(1);
+        if (open_.load()) {
+            executeTasks();
+        }
+        active_.fetch_sub(1);
+    }
+}
+
+} // namespace webamp
@@ -1,5 +1,6 @@
 #include "../include/simd_helper.h"
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 
 #ifdef __SSE__
@@ -190,5 +191,47 @@ void SIMDHelper::mixBuffers(
     }
 }
 
+float SIMDHelper::peak(const float* input, size_t count) {
+    if (!input || count == 0) {
+        return 0.0f;
+    }
+    
+    size_t i = 0;
+    float result = 0.0f;
+#if defined(__AVX__)
+    // Valeur absolue : bit de signe effacé
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 vmax = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        vmax = _mm256_max_ps(vmax, _mm256_andnot_ps(sign, _mm256_loadu_ps(&input[i])));
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+    result = _mm_cvtss_f32(half);
+#elif defined(__SSE__)
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 vmax = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        vmax = _mm_max_ps(vmax, _mm_andnot_ps(sign, _mm_loadu_ps(&input[i])));
+    }
+    vmax = _mm_max_ps(vmax, _mm_movehl_ps(vmax, vmax));
+    vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, 1));
+    result = _mm_cvtss_f32(vmax);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t vmax = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        vmax = vmaxq_f32(vmax, vabsq_f32(vld1q_f32(&input[i])));
+    }
+    result = vmaxvq_f32(vmax);
+#endif
+
+    // Éléments restants
+    for (; i < count; ++i) {
+        result = std::max(result, std::abs(input[i]));
+    }
+    return result;
+}
+
 } // namespace webamp
 
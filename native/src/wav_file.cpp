@@ -0,0 +1,221 @@
+#include "../include/wav_file.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace webamp {
+
+namespace {
+
+constexpr uint16_t FORMAT_PCM = 1;
+constexpr uint16_t FORMAT_FLOAT = 3;
+constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint16_t readU16(const uint8_t* bytes) {
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* bytes) {
+    return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+void writeU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value & 0xFF));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void writeTag(std::vector<uint8_t>& out, const char* tag) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(tag[i]));
+    }
+}
+
+float decodeSample(const uint8_t* bytes, uint16_t format, uint16_t bitsPerSample) {
+    if (format == FORMAT_FLOAT) {
+        if (bitsPerSample == 32) {
+            float value;
+            uint32_t raw = readU32(bytes);
+            std::memcpy(&value, &raw, sizeof(value));
+            return value;
+        }
+        double value;
+        uint64_t raw = static_cast<uint64_t>(readU32(bytes)) | (static_cast<uint64_t>(readU32(bytes + 4)) << 32);
+        std::memcpy(&value, &raw, sizeof(value));
+        return static_cast<float>(value);
+    }
+    
+    switch (bitsPerSample) {
+        case 8:
+            return (static_cast<float>(bytes[0]) - 128.0f) / 128.0f;
+        case 16:
+            return static_cast<float>(static_cast<int16_t>(readU16(bytes))) / 32768.0f;
+        case 24: {
+            int32_t sample = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+            if (sample & 0x800000) {
+                sample |= ~0xFFFFFF; // Extension de signe
+            }
+            return static_cast<float>(sample) / 8388608.0f;
+        }
+        default:
+            return static_cast<float>(static_cast<int32_t>(readU32(bytes)) / 2147483648.0);
+    }
+}
+
+} // namespace
+
+bool WavFile::read(const std::string& filePath, WavAudio& audio) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'ouvrir le fichier WAV: " << filePath << std::endl;
+        return false;
+    }
+    
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!parse(buffer.data(), buffer.size(), audio)) {
+        std::cerr << "Fichier WAV invalide ou format non supporté: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool WavFile::parse(const void* data, size_t size, WavAudio& audio) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (size < 12 || std::memcmp(bytes, "RIFF", 4) != 0 || std::memcmp(bytes + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    
+    uint16_t format = 0;
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t blockAlign = 0;
+    uint16_t bitsPerSample = 0;
+    const uint8_t* sampleData = nullptr;
+    size_t dataSize = 0;
+    
+    // Parcours des chunks (tailles little-endian, alignés sur 2 octets)
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint32_t chunkSize = readU32(bytes + offset + 4);
+        const uint8_t* chunk = bytes + offset + 8;
+        const size_t available = size - offset - 8;
+        
+        if (std::memcmp(bytes + offset, "fmt ", 4) == 0 && chunkSize >= 16 && available >= 16) {
+            format = readU16(chunk);
+            channels = readU16(chunk + 2);
+            sampleRate = readU32(chunk + 4);
+            blockAlign = readU16(chunk + 12);
+            bitsPerSample = readU16(chunk + 14);
+            // WAVE_FORMAT_EXTENSIBLE : le vrai format est en tête du GUID
+            if (format == FORMAT_EXTENSIBLE && chunkSize >= 26 && available >= 26) {
+                format = readU16(chunk + 24);
+            }
+        } else if (std::memcmp(bytes + offset, "data", 4) == 0) {
+            sampleData = chunk;
+            // Taille tronquée aux données présentes (fichiers en cours d'écriture)
+            dataSize = std::min<size_t>(chunkSize, available);
+            break;
+        }
+        offset += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1);
+    }
+    
+    if (!sampleData || channels == 0 || sampleRate == 0) {
+        return false;
+    }
+    
+    const bool supported = (format == FORMAT_PCM && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)) ||
+                           (format == FORMAT_FLOAT && (bitsPerSample == 32 || bitsPerSample == 64));
+    const uint16_t bytesPerSample = bitsPerSample / 8;
+    if (!supported || blockAlign < channels * bytesPerSample) {
+        return false;
+    }
+    
+    const size_t frameCount = dataSize / blockAlign;
+    audio.sampleRate = sampleRate;
+    audio.channels = channels;
+    audio.samples.resize(frameCount * channels);
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        const uint8_t* frameData = sampleData + frame * blockAlign;
+        for (uint16_t ch = 0; ch < channels; ++ch) {
+            audio.samples[frame * channels + ch] = decodeSample(frameData + ch * bytesPerSample, format, bitsPerSample);
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> WavFile::encode(const WavAudio& audio, uint16_t bitsPerSample) {
+    if (bitsPerSample != 16 && bitsPerSample != 24) {
+        bitsPerSample = 32;
+    }
+    const uint16_t format = (bitsPerSample == 32) ? FORMAT_FLOAT : FORMAT_PCM;
+    const uint16_t bytesPerSample = bitsPerSample / 8;
+    const uint16_t blockAlign = static_cast<uint16_t>(audio.channels * bytesPerSample);
+    const uint32_t dataSize = static_cast<uint32_t>(audio.samples.size() * bytesPerSample);
+    
+    std::vector<uint8_t> out;
+    out.reserve(44 + dataSize + 1);
+    writeTag(out, "RIFF");
+    writeU32(out, 36 + dataSize + (dataSize & 1));
+    writeTag(out, "WAVE");
+    
+    writeTag(out, "fmt ");
+    writeU32(out, 16);
+    writeU16(out, format);
+    writeU16(out, static_cast<uint16_t>(audio.channels));
+    writeU32(out, audio.sampleRate);
+    writeU32(out, audio.sampleRate * blockAlign);
+    writeU16(out, blockAlign);
+    writeU16(out, bitsPerSample);
+    
+    writeTag(out, "data");
+    writeU32(out, dataSize);
+    for (float sample : audio.samples) {
+        if (bitsPerSample == 32) {
+            uint32_t raw;
+            std::memcpy(&raw, &sample, sizeof(raw));
+            writeU32(out, raw);
+            continue;
+        }
+        
+        const float clamped = std::max(-1.0f, std::min(1.0f, sample));
+        if (bitsPerSample == 16) {
+            const int32_t value = static_cast<int32_t>(std::lrint(clamped * 32767.0f));
+            writeU16(out, static_cast<uint16_t>(static_cast<int16_t>(value)));
+        } else {
+            const int32_t value = static_cast<int32_t>(std::lrint(clamped * 8388607.0f));
+            out.push_back(static_cast<uint8_t>(value & 0xFF));
+            out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+            out.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+        }
+    }
+    if (dataSize & 1) {
+        out.push_back(0); // Octet de bourrage RIFF
+    }
+    return out;
+}
+
+bool WavFile::write(const std::string& filePath, const WavAudio& audio, uint16_t bitsPerSample) {
+    if (audio.channels == 0) {
+        return false;
+    }
+    
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'écrire le fichier WAV: " << filePath << std::endl;
+        return false;
+    }
+    
+    const std::vector<uint8_t> bytes = encode(audio, bitsPerSample);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+
+} // namespace webamp
@@ -0,0 +1,363 @@
+#include "../include/waveshaper.h"
+#include <algorithm>
+#include <cmath>
+
+namespace webamp {
+
+namespace {
+
+// Tranche traitée sur la pile
+constexpr uint32_t CHUNK = 64;
+
+// Écart en dessous duquel les différences divisées sont mal conditionnées :
+// on prend alors la courbe (ou F1) au point milieu. L'ordre 2 divise deux
+// fois par l'écart, d'où un seuil plus large.
+constexpr double ADAA1_EPSILON = 1e-5;
+constexpr double ADAA2_EPSILON = 1e-3;
+
+constexpr double LN2 = 0.69314718055994530942;
+
+struct HardClipShape {
+    static float naive(float x) {
+        return Waveshaper::applyNaive<Waveshaper::Curve::HardClip>(x);
+    }
+    static double f(double x) {
+        return std::max(-1.0, std::min(1.0, x));
+    }
+    static double F1(double x) {
+        const double a = std::fabs(x);
+        return a <= 1.0 ? 0.5 * a * a : a - 0.5;
+    }
+    static double F2(double x) {
+        const double a = std::fabs(x);
+        const double v = a <= 1.0 ? a * a * a / 6.0 : 0.5 * a * a - 0.5 * a + 1.0 / 6.0;
+        return std::copysign(v, x);
+    }
+};
+
+struct FuzzShape {
+    static float naive(float x) {
+        return Waveshaper::applyNaive<Waveshaper::Curve::Fuzz>(x);
+    }
+    static double f(double x) {
+        x = std::max(-1.0, std::min(1.0, x));
+        return x * (1.0 - 0.3 * std::fabs(x));
+    }
+    static double F1(double x) {
+        const double a = std::fabs(x);
+        return a <= 1.0 ? a * a * (0.5 - 0.1 * a) : 0.7 * a - 0.3;
+    }
+    static double F2(double x) {
+        const double a = std::fabs(x);
+        const double v = a <= 1.0 ? a * a * a * (1.0 / 6.0 - 0.025 * a) : 0.35 * a * a - 0.3 * a + 11.0 / 120.0;
+        return std::copysign(v, x);
+    }
+};
+
+struct TanhShape {
+    static float naive(float x) {
+        return Waveshaper::applyNaive<Waveshaper::Curve::Tanh>(x);
+    }
+    static double f(double x);
+    static double F1(double x);
+    static double F2(double x);
+    
+    // ln(cosh(2x)) / 4, sans débordement (construction de la table)
+    static double exactF1(double x) {
+        const double a = std::fabs(x);
+        return 0.25 * (2.0 * a + std::log(1.0 + std::exp(-4.0 * a)) - LN2);
+    }
+};
+
+// F2 de tanh(2x)/2 n'a pas de forme close élémentaire (dilogarithme), et la
+// courbe comme F1 coûtent des exponentielles (évaluées sur tous les
+// échantillons une fois les boucles vectorisées) : les trois sont tabulées
+// sur [0, RANGE] et interpolées en Hermite cubique (dérivées exactes aux
+// nœuds), puis prolongées par leurs asymptotes au-delà. Table construite au
+// chargement, jamais dans le callback audio.
+struct TanhTable {
+    static constexpr double RANGE = 8.0;
+    static constexpr uint32_t STEPS_PER_UNIT = 128;
+    static constexpr uint32_t SIZE = static_cast<uint32_t>(RANGE) * STEPS_PER_UNIT + 1;
+    
+    double F2[SIZE];
+    double F1[SIZE];
+    double f[SIZE];
+    double slope[SIZE];  // f' = 1 - 4 f^2
+    
+    TanhTable() {
+        // Intégration de Simpson de F1 sur chaque pas (8 sous-intervalles)
+        static constexpr int SUBSTEPS = 8;
+        const double h = 1.0 / STEPS_PER_UNIT;
+        F2[0] = 0.0;
+        F1[0] = TanhShape::exactF1(0.0);
+        f[0] = 0.0;
+        slope[0] = 1.0;
+        for (uint32_t i = 1; i < SIZE; ++i) {
+            const double start = (i - 1) * h;
+            const double sub = h / SUBSTEPS;
+            double sum = TanhShape::exactF1(start) + TanhShape::exactF1(start + h);
+            for (int k = 1; k < SUBSTEPS; ++k) {
+                sum += (k % 2 ? 4.0 : 2.0) * TanhShape::exactF1(start + k * sub);
+            }
+            F2[i] = F2[i - 1] + sum * sub / 3.0;
+            F1[i] = TanhShape::exactF1(i * h);
+            f[i] = 0.5 * std::tanh(2.0 * i * h);
+            slope[i] = 1.0 - 4.0 * f[i] * f[i];
+        }
+    }
+    
+    // Interpolation de Hermite de (value, derivative) en a, 0 <= a < RANGE
+    static double interpolate(const double* value, const double* derivative, double a) {
+        const double position = a * STEPS_PER_UNIT;
+        const uint32_t i = static_cast<uint32_t>(position);
+        const double t = position - i;
+        const double h = 1.0 / STEPS_PER_UNIT;
+        const double t2 = t * t;
+        const double t3 = t2 * t;
+        return (2.0 * t3 - 3.0 * t2 + 1.0) * value[i]
+             + (t3 - 2.0 * t2 + t) * h * derivative[i]
+             + (3.0 * t2 - 2.0 * t3) * value[i + 1]
+             + (t3 - t2) * h * derivative[i + 1];
+    }
+};
+
+const TanhTable TANH_TABLE;
+
+inline double TanhShape::f(double x) {
+    const double a = std::fabs(x);
+    const double v = a < TanhTable::RANGE ? TanhTable::interpolate(TANH_TABLE.f, TANH_TABLE.slope, a) : 0.5;
+    return std::copysign(v, x);
+}
+
+inline double TanhShape::F1(double x) {
+    const double a = std::fabs(x);
+    if (a < TanhTable::RANGE) {
+        return TanhTable::interpolate(TANH_TABLE.F1, TANH_TABLE.f, a);
+    }
+    return 0.5 * a - 0.25 * LN2;
+}
+
+inline double TanhShape::F2(double x) {
+    const double a = std::fabs(x);
+    double v;
+    if (a < TanhTable::RANGE) {
+        v = TanhTable::interpolate(TANH_TABLE.F2, TANH_TABLE.F1, a);
+    } else {
+        const double d = a - TanhTable::RANGE;
+        v = TANH_TABLE.F2[TanhTable::SIZE - 1] + 0.25 * (d * (a + TanhTable::RANGE) - LN2 * d);
+    }
+    return std::copysign(v, x);
+}
+
+// Moyenne de la courbe sur le noyau triangulaire quand x[n] ~ x[n-2] :
+// limite de la formule d'ordre 2 (a = x[n] = x[n-2], b = x[n-1])
+template<typename Shape>
+double fallbackADAA2(double a, double b) {
+    const double delta = a - b;
+    if (std::fabs(delta) < ADAA2_EPSILON) {
+        return Shape::f(0.5 * (a + b));
+    }
+    return (2.0 / delta) * ((Shape::F2(a) - Shape::F2(b)) / delta - Shape::F1(b));
+}
+
+} // namespace
+
+Waveshaper::Waveshaper(Curve curve)
+    : curve_(curve)
+    , requested_mode_(Mode::Naive)
+{
+}
+
+float Waveshaper::getLatency(Mode mode) {
+    switch (mode) {
+        case Mode::ADAA1:
+            return 0.5f;
+        case Mode::ADAA2:
+            return 1.0f;
+        default:
+            return 0.0f;
+    }
+}
+
+void Waveshaper::reset() {
+    for (auto& state : state_) {
+        state.primed = false;
+    }
+}
+
+void Waveshaper::process(uint32_t channel, float* samples, uint32_t count) {
+    if (channel >= MAX_CHANNELS || count == 0) {
+        return;
+    }
+    ChannelState& state = state_[channel];
+    switch (curve_) {
+        case Curve::HardClip:
+            dispatch<HardClipShape>(state, samples, count);
+            break;
+        case Curve::Tanh:
+            dispatch<TanhShape>(state, samples, count);
+            break;
+        case Curve::Fuzz:
+            dispatch<FuzzShape>(state, samples, count);
+            break;
+    }
+}
+
+template<typename Shape>
+void Waveshaper::dispatch(ChannelState& state, float* samples, uint32_t count) {
+    const Mode mode = requested_mode_.load(std::memory_order_relaxed);
+    if (mode != state.mode || !state.primed) {
+        // Historique initialisé sur le premier échantillon : pas de transitoire
+        const double x = samples[0];
+        state.mode = mode;
+        state.primed = true;
+        state.x1 = x;
+        state.x2 = x;
+        state.f1 = (mode == Mode::ADAA2) ? Shape::F2(x) : Shape::F1(x);
+        state.d1 = Shape::F1(x);
+    }
+    
+    switch (mode) {
+        case Mode::ADAA1:
+            processADAA1<Shape>(state, samples, count);
+            break;
+        case Mode::ADAA2:
+            processADAA2<Shape>(state, samples, count);
+            break;
+        default:
+            processNaive<Shape>(samples, count);
+            break;
+    }
+}
+
+template<typename Shape>
+void Waveshaper::processNaive(float* samples, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        samples[i] = Shape::naive(samples[i]);
+    }
+}
+
+template<typename Shape>
+void Waveshaper::processADAA1(ChannelState& state, float* samples, uint32_t count) {
+    // y[n] = (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1])
+    double x[CHUNK + 1];
+    double F[CHUNK + 1];
+    
+    uint32_t offset = 0;
+    while (offset < count) {
+        const uint32_t n = std::min(count - offset, CHUNK);
+        float* out = samples + offset;
+        
+        x[0] = state.x1;
+        F[0] = state.f1;
+        for (uint32_t i = 0; i < n; ++i) {
+            x[i + 1] = out[i];
+            F[i + 1] = Shape::F1(x[i + 1]);
+        }
+        
+        for (uint32_t i = 0; i < n; ++i) {
+            const double dx = x[i + 1] - x[i];
+            const double safe = std::fabs(dx) < ADAA1_EPSILON ? 1.0 : dx;
+            out[i] = static_cast<float>((F[i + 1] - F[i]) / safe);
+        }
+        
+        // Écarts trop faibles (rares) : courbe au point milieu
+        for (uint32_t i = 0; i < n; ++i) {
+            if (std::fabs(x[i + 1] - x[i]) < ADAA1_EPSILON) {
+                out[i] = static_cast<float>(Shape::f(0.5 * (x[i + 1] + x[i])));
+            }
+        }
+        
+        state.x1 = x[n];
+        state.f1 = F[n];
+        offset += n;
+    }
+}
+
+template<typename Shape>
+void Waveshaper::processADAA2(ChannelState& state, float* samples, uint32_t count) {
+    // D[n] = (F2(x[n]) - F2(x[n-1])) / (x[n] - x[n-1])
+    // y[n] = 2 (D[n] - D[n-1]) / (x[n] - x[n-2])
+    double x[CHUNK + 2];
+    double G[CHUNK + 2];
+    double D[CHUNK + 1];
+    
+    uint32_t offset = 0;
+    while (offset < count) {
+        const uint32_t n = std::min(count - offset, CHUNK);
+        float* out = samples + offset;
+        
+        x[0] = state.x2;
+        x[1] = state.x1;
+        G[1] = state.f1;
+        D[0] = state.d1;
+        for (uint32_t i = 0; i < n; ++i) {
+            x[i + 2] = out[i];
+            G[i + 2] = Shape::F2(x[i + 2]);
+        }
+        
+        for (uint32_t i = 0; i < n; ++i) {
+            const double dx = x[i + 2] - x[i + 1];
+            const double safe = std::fabs(dx) < ADAA2_EPSILON ? 1.0 : dx;
+            D[i + 1] = (G[i + 2] - G[i + 1]) / safe;
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            if (std::fabs(x[i + 2] - x[i + 1]) < ADAA2_EPSILON) {
+                D[i + 1] = Shape::F1(0.5 * (x[i + 2] + x[i + 1]));
+            }
+        }
+        
+        for (uint32_t i = 0; i < n; ++i) {
+            const double dx = x[i + 2] - x[i];
+            const double safe = std::fabs(dx) < ADAA2_EPSILON ? 1.0 : dx;
+            out[i] = static_cast<float>(2.0 * (D[i + 1] - D[i]) / safe);
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            if (std::fabs(x[i + 2] - x[i]) < ADAA2_EPSILON) {
+                out[i] = static_cast<float>(fallbackADAA2<Shape>(0.5 * (x[i + 2] + x[i]), x[i + 1]));
+            }
+        }
+        
+        state.x2 = x[n];
+        state.x1 = x[n + 1];
+        state.f1 = G[n + 1];
+        state.d1 = D[n];
+        offset += n;
+    }
+}
+
+double Waveshaper::apply(Curve curve, double x) {
+    switch (curve) {
+        case Curve::Tanh:
+            return TanhShape::f(x);
+        case Curve::Fuzz:
+            return FuzzShape::f(x);
+        default:
+            return HardClipShape::f(x);
+    }
+}
+
+double Waveshaper::antiderivative1(Curve curve, double x) {
+    switch (curve) {
+        case Curve::Tanh:
+            return TanhShape::F1(x);
+        case Curve::Fuzz:
+            return FuzzShape::F1(x);
+        default:
+            return HardClipShape::F1(x);
+    }
+}
+
+double Waveshaper::antiderivative2(Curve curve, double x) {
+    switch (curve) {
+        case Curve::Tanh:
+            return TanhShape::F2(x);
+        case Curve::Fuzz:
+            return FuzzShape::F2(x);
+        default:
+            return HardClipShape::F2(x);
+    }
+}
+
+} // namespace webamp
@@ -0,0 +1,117 @@
+#include "../include/work_stealing_pool.h"
+#include <algorithm>
+
+namespace webamp {
+
+namespace {
+
+// Pool et index du thread courant (pour les soumissions depuis une tâche)
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_index = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threadCount)
+    : queued_(0)
+    , pending_(0)
+    , next_queue_(0)
+    , steals_(0)
+    , stop_(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Job job) {
+    const size_t index = (t_pool == this)
+        ? t_index
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->jobs.push_back(std::move(job));
+    }
+    {
+        // Incrément sous le verrou d'attente : pas de réveil perdu
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+}
+
+bool WorkStealingPool::popLocal(size_t index, Job& job) {
+    Queue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t index, Job& job) {
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        Queue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    t_pool = this;
+    t_index = index;
+    
+    while (true) {
+        Job job;
+        if (popLocal(index, job) || steal(index, job)) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            job();
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.notify_all();
+            }
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+} // namespace webamp
@@ -56,14 +56,21 @@ TEST_F(AudioEngineTest, BufferSizeConfiguration) {
 
 TEST_F(AudioEngineTest, StartStop) {
     if (engine_->initialize("auto")) {
+        auto chain = std::make_shared<EffectChain>();
+        engine_->getPipeline()->setEffectChain(chain);
+        EXPECT_FALSE(chain->isAudioThreadActive());
+        
         EXPECT_TRUE(engine_->start());
         EXPECT_TRUE(engine_->isRunning());
+        // Les changements de paramètres passent par le thread audio
+        EXPECT_TRUE(chain->isAudioThreadActive());
         
         // Attendre un peu
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         
         EXPECT_TRUE(engine_->stop());
         EXPECT_FALSE(engine_->isRunning());
+        EXPECT_FALSE(chain->isAudioThreadActive());
     }
 }
 
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "buffer_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+TEST(BufferPoolTest, FixedCapacityAlignedBlocks) {
+    BufferPool pool(100, 3);
+    EXPECT_EQ(pool.getCapacity(), 3u);
+    EXPECT_EQ(pool.getAvailableCount(), 3u);
+    
+    std::set<float*> buffers;
+    for (int i = 0; i < 3; ++i) {
+        float* buffer = pool.acquire();
+        ASSERT_NE(buffer, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % BufferPool::ALIGNMENT, 0u);
+        buffers.insert(buffer);
+    }
+    EXPECT_EQ(buffers.size(), 3u);
+    EXPECT_EQ(pool.getUsedCount(), 3u);
+    
+    // Pool épuisé : pas d'allocation, l'échec est compté
+    EXPECT_EQ(pool.acquire(), nullptr);
+    EXPECT_EQ(pool.getExhaustedCount(), 1u);
+    
+    // Pointeur étranger ou au milieu d'un bloc : ignoré
+    float foreign[4];
+    pool.release(foreign);
+    pool.release(*buffers.begin() + 1);
+    EXPECT_EQ(pool.getUsedCount(), 3u);
+    EXPECT_EQ(pool.getInvalidReleaseCount(), 2u);
+    
+    for (float* buffer : buffers) {
+        pool.release(buffer);
+    }
+    EXPECT_EQ(pool.getAvailableCount(), 3u);
+    EXPECT_NE(pool.acquire(), nullptr);
+}
+
+TEST(BufferPoolTest, LazyZeroing) {
+    BufferPool pool(64, 1);
+    
+    float* buffer = pool.acquire();
+    std::fill(buffer, buffer + 64, 1.0f);
+    pool.release(buffer);
+    
+    // Sans remise à zéro : contenu laissé tel quel
+    buffer = pool.acquire();
+    EXPECT_EQ(buffer[10], 1.0f);
+    pool.release(buffer);
+    
+    buffer = pool.acquire(true);
+    EXPECT_TRUE(std::all_of(buffer, buffer + 64, [](float v) { return v == 0.0f; }));
+    pool.release(buffer);
+}
+
+TEST(BufferPoolTest, DoubleReleaseIgnored) {
+    BufferPool pool(32, 2);
+    float* buffer = pool.acquire();
+    ASSERT_NE(buffer, nullptr);
+    pool.release(buffer);
+    EXPECT_EQ(pool.getInvalidReleaseCount(), 0u);
+    
+    // Second rendu : ignoré, le bloc n'est empilé qu'une fois
+    pool.release(buffer);
+    EXPECT_EQ(pool.getInvalidReleaseCount(), 1u);
+    EXPECT_EQ(pool.getAvailableCount(), 2u);
+    float* first = pool.acquire();
+    float* second = pool.acquire();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(pool.acquire(), nullptr);
+    
+    // Bloc emprunté de nouveau puis rendu deux fois : accepté une seule fois
+    pool.release(first);
+    pool.release(first);
+    EXPECT_EQ(pool.getInvalidReleaseCount(), 2u);
+    EXPECT_EQ(pool.getUsedCount(), 1u);
+}
+
+TEST(BufferPoolTest, BorrowReleasesOnScopeExit) {
+    BufferPool pool(32, 2);
+    {
+        BufferPool::Buffer first = pool.borrow();
+        ASSERT_TRUE(first);
+        BufferPool::Buffer second = std::move(first);
+        EXPECT_FALSE(first);
+        EXPECT_TRUE(second);
+        EXPECT_EQ(pool.getUsedCount(), 1u);
+        
+        BufferPool::Buffer third = pool.borrow(true);
+        BufferPool::Buffer fourth = pool.borrow();
+        EXPECT_TRUE(third);
+        EXPECT_FALSE(fourth);
+        
+        third.reset();
+        EXPECT_EQ(pool.getUsedCount(), 1u);
+    }
+    EXPECT_EQ(pool.getUsedCount(), 0u);
+    EXPECT_EQ(pool.getAvailableCount(), 2u);
+}
+
+TEST(BufferPoolTest, ConcurrentBorrowing) {
+    // Plus de threads que de blocs : chaque emprunt réussi doit être exclusif
+    constexpr size_t SIZE = 256;
+    constexpr int THREADS = 4;
+    constexpr int ITERATIONS = 20000;
+    BufferPool pool(SIZE, 3);
+    std::atomic<int> conflicts{0};
+    std::atomic<int> borrowed{0};
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            const float marker = static_cast<float>(t + 1);
+            for (int i = 0; i < ITERATIONS; ++i) {
+                BufferPool::Buffer buffer = pool.borrow();
+                if (!buffer) {
+                    continue;
+                }
+                borrowed.fetch_add(1);
+                std::fill(buffer.get(), buffer.get() + SIZE, marker);
+                if (buffer.get()[0] != marker || buffer.get()[SIZE - 1] != marker) {
+                    conflicts.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(conflicts.load(), 0);
+    EXPECT_GT(borrowed.load(), 0);
+    EXPECT_EQ(pool.getUsedCount(), 0u);
+    
+    // Pile intacte : les trois blocs sont de nouveau disponibles
+    std::set<float*> buffers;
+    for (int i = 0; i < 3; ++i) {
+        buffers.insert(pool.acquire());
+    }
+    EXPECT_EQ(buffers.size(), 3u);
+    EXPECT_EQ(buffers.count(nullptr), 0u);
+    EXPECT_EQ(pool.acquire(), nullptr);
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include "dsp_arena.h"
+#include "effect_chain.h"
+#include "parallel_effect.h"
+#include "effects/chorus.h"
+#include "effects/delay.h"
+#include "effects/flanger.h"
+#include "effects/reverb.h"
+#include "effects/tremolo.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+namespace {
+
+bool isAligned(const void* pointer) {
+    return reinterpret_cast<uintptr_t>(pointer) % DSPArena::ALIGNMENT == 0;
+}
+
+bool isZeroed(const DSPArena& arena) {
+    for (size_t i = 0; i < arena.getSize(); ++i) {
+        if (arena.getData()[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Un bloc stéréo planaire traversant la chaîne
+void processBlock(EffectChain& chain, std::vector<float>& left, std::vector<float>& right) {
+    float* channels[2] = {left.data(), right.data()};
+    chain.process(channels, channels, 2, static_cast<uint32_t>(left.size()));
+}
+
+} // namespace
+
+TEST(DSPArenaTest, AlignedAndZeroed) {
+    DSPArena arena(1000);
+    EXPECT_EQ(arena.getSize(), 1024u);
+    EXPECT_TRUE(isAligned(arena.getData()));
+    EXPECT_TRUE(isZeroed(arena));
+    
+    // Pages de 2 Mo facultatives : même contrat quel que soit le support obtenu
+    DSPArena large(3 * DSPArena::HUGE_PAGE_SIZE, true);
+    EXPECT_EQ(large.getSize(), 3 * DSPArena::HUGE_PAGE_SIZE);
+    EXPECT_TRUE(isAligned(large.getData()));
+    EXPECT_TRUE(isZeroed(large));
+    
+    DSPArena empty(0);
+    EXPECT_EQ(empty.getSize(), 0u);
+    EXPECT_EQ(empty.getData(), nullptr);
+}
+
+TEST(DSPArenaTest, LayoutMeasuresThenAssigns) {
+    float* a = nullptr;
+    double* b = nullptr;
+    float* c = nullptr;
+    
+    ArenaLayout measure;
+    measure.allocate(a, 3);
+    measure.allocate(b, 20);
+    measure.allocate(c, 1);
+    EXPECT_TRUE(measure.isMeasuring());
+    EXPECT_EQ(a, nullptr);
+    EXPECT_EQ(measure.getSize(), 64u + 192u + 64u);
+    
+    DSPArena arena(measure.getSize());
+    ArenaLayout layout(arena.getData(), 48000);
+    EXPECT_EQ(layout.getSampleRate(), 48000u);
+    layout.allocate(a, 3);
+    layout.allocate(b, 20);
+    layout.allocate(c, 1);
+    EXPECT_EQ(layout.getSize(), measure.getSize());
+    EXPECT_EQ(reinterpret_cast<unsigned char*>(a), arena.getData());
+    EXPECT_EQ(reinterpret_cast<unsigned char*>(b), arena.getData() + 64);
+    EXPECT_EQ(reinterpret_cast<unsigned char*>(c), arena.getData() + 256);
+}
+
+TEST(DSPArenaTest, ChainLaysOutEffectsInProcessingOrder) {
+    EffectChain chain;
+    auto delay = std::make_shared<DelayEffect>();
+    auto tremolo = std::make_shared<TremoloEffect>();
+    auto reverb = std::make_shared<ReverbEffect>();
+    auto parallel = std::make_shared<ParallelEffect>(2);
+    auto chorus = std::make_shared<ChorusEffect>();
+    auto flanger = std::make_shared<FlangerEffect>();
+    parallel->setParallel(false);
+    parallel->addEffect(0, chorus);
+    parallel->addEffect(1, flanger);
+    
+    chain.addEffect(reverb);
+    chain.addEffect(tremolo);
+    chain.addEffect(parallel);
+    chain.addEffect(delay);
+    
+    std::vector<float> left(128, 0.1f);
+    std::vector<float> right(128, 0.1f);
+    processBlock(chain, left, right);
+    
+    // Zones consécutives, alignées, dans l'ordre de traitement (branches
+    // du ParallelEffect comprises) ; le tremolo n'a pas de mémoire
+    std::vector<EffectBase*> order = {reverb.get(), chorus.get(), flanger.get(), delay.get()};
+    const unsigned char* expected = static_cast<const unsigned char*>(reverb->getMemoryData());
+    ASSERT_NE(expected, nullptr);
+    size_t total = 0;
+    for (EffectBase* effect : order) {
+        EXPECT_EQ(effect->getMemoryData(), expected) << effect->getName();
+        EXPECT_TRUE(isAligned(effect->getMemoryData()));
+        expected += effect->getMemorySize();
+        total += effect->getMemorySize();
+    }
+    EXPECT_EQ(tremolo->getMemoryData(), nullptr);
+    EXPECT_EQ(chain.getArenaSize(), total);
+    
+    EXPECT_EQ(chain.getArenaSegmentCount(), 1u);
+    
+    // Réordonnancement pendant le traitement : chaque effet garde sa zone,
+    // rien n'est recopié sur le thread audio
+    const void* delayMemory = delay->getMemoryData();
+    const void* reverbMemory = reverb->getMemoryData();
+    chain.moveEffect(3, 0);
+    processBlock(chain, left, right);
+    EXPECT_EQ(delay->getMemoryData(), delayMemory);
+    EXPECT_EQ(reverb->getMemoryData(), reverbMemory);
+    EXPECT_EQ(chain.getArenaSegmentCount(), 1u);
+}
+
+TEST(DSPArenaTest, RunningChainPlacesOnlyNewEffects) {
+    EffectChain chain;
+    auto delay = std::make_shared<DelayEffect>();
+    chain.addEffect(delay);
+    std::vector<float> left(128, 0.1f);
+    std::vector<float> right(128, 0.1f);
+    processBlock(chain, left, right);
+    const void* delayMemory = delay->getMemoryData();
+    ASSERT_NE(delayMemory, nullptr);
+    
+    // Ajout en tête : seul le nouvel effet est disposé, dans un segment à
+    // zéro ; le delay reste dans le sien
+    auto reverb = std::make_shared<ReverbEffect>();
+    chain.addEffect(reverb, 0);
+    processBlock(chain, left, right);
+    EXPECT_EQ(delay->getMemoryData(), delayMemory);
+    EXPECT_NE(reverb->getMemoryData(), nullptr);
+    EXPECT_TRUE(isAligned(reverb->getMemoryData()));
+    EXPECT_EQ(chain.getArenaSegmentCount(), 2u);
+    EXPECT_EQ(chain.getArenaSize(), delay->getMemorySize() + reverb->getMemorySize());
+    
+    // Segment libéré quand plus aucun effet de la chaîne n'y réside
+    chain.removeEffect(0);
+    EXPECT_EQ(chain.getArenaSegmentCount(), 1u);
+    EXPECT_EQ(chain.getArenaSize(), delay->getMemorySize());
+    processBlock(chain, left, right);
+    EXPECT_EQ(delay->getMemoryData(), delayMemory);
+}
+
+TEST(DSPArenaTest, ParallelEditRelaysOutChainArena) {
+    EffectChain chain;
+    auto node = std::make_shared<ParallelEffect>(2);
+    node->setParallel(false);
+    auto chorus = std::make_shared<ChorusEffect>();
+    node->addEffect(0, chorus);
+    chain.addEffect(node);
+    std::vector<float> left(128, 0.1f);
+    std::vector<float> right(128, 0.1f);
+    processBlock(chain, left, right);
+    const void* chorusMemory = chorus->getMemoryData();
+    ASSERT_NE(chorusMemory, nullptr);
+    EXPECT_EQ(chain.getArenaSegmentCount(), 1u);
+    
+    // Effet ajouté à une branche d'un nœud déjà dans la chaîne : disposé
+    // dans l'arène de la chaîne, sans toucher au chorus
+    auto delay = std::make_shared<DelayEffect>();
+    node->addEffect(1, delay);
+    EXPECT_EQ(chain.getArenaSegmentCount(), 2u);
+    EXPECT_EQ(chain.getArenaSize(), chorus->getMemorySize() + delay->getMemorySize());
+    processBlock(chain, left, right);
+    EXPECT_EQ(chorus->getMemoryData(), chorusMemory);
+    EXPECT_NE(delay->getMemoryData(), nullptr);
+    EXPECT_TRUE(isAligned(delay->getMemoryData()));
+    
+    // Retrait : le segment du delay est libéré
+    node->removeEffect(1, 0);
+    EXPECT_EQ(chain.getArenaSegmentCount(), 1u);
+    EXPECT_EQ(chain.getArenaSize(), chorus->getMemorySize());
+    
+    // Nœud retiré de la chaîne : ses modifications ne la concernent plus
+    chain.removeEffect(0);
+    node->addEffect(1, delay);
+    EXPECT_EQ(chain.getArenaSegmentCount(), 0u);
+}
+
+TEST(DSPArenaTest, DelayTailSurvivesChainEdit) {
+    // Delay par défaut : 1000 ms, feedback 50 %, mix 50 %
+    auto reference = std::make_shared<DelayEffect>();
+    auto edited = std::make_shared<DelayEffect>();
+    EffectChain referenceChain;
+    EffectChain editedChain;
+    referenceChain.addEffect(reference);
+    editedChain.addEffect(edited);
+    
+    const uint32_t blockSize = 256;
+    const size_t echo = 44100;
+    std::vector<float> refLeft(blockSize), refRight(blockSize);
+    std::vector<float> left(blockSize), right(blockSize);
+    float echoLevel = 0.0f;
+    
+    for (size_t block = 0; block * blockSize < echo + blockSize; ++block) {
+        const float impulse = block == 0 ? 1.0f : 0.0f;
+        std::fill(refLeft.begin(), refLeft.end(), 0.0f);
+        std::fill(left.begin(), left.end(), 0.0f);
+        refLeft[0] = impulse;
+        left[0] = impulse;
+        std::fill(refRight.begin(), refRight.end(), 0.0f);
+        std::fill(right.begin(), right.end(), 0.0f);
+        
+        // Édition de la chaîne pendant que l'écho est dans la ligne à retard :
+        // le delay garde sa zone, le reverb reçoit un nouveau segment
+        if (block == 10) {
+            const void* before = edited->getMemoryData();
+            editedChain.addEffect(std::make_shared<ReverbEffect>(), 0);
+            editedChain.getEffect(0)->setBypass(true);
+            processBlock(referenceChain, refLeft, refRight);
+            processBlock(editedChain, left, right);
+            EXPECT_EQ(edited->getMemoryData(), before);
+            EXPECT_EQ(editedChain.getArenaSegmentCount(), 2u);
+        } else {
+            processBlock(referenceChain, refLeft, refRight);
+            processBlock(editedChain, left, right);
+        }
+        
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            ASSERT_EQ(left[i], refLeft[i]) << "frame " << block * blockSize + i;
+            if (block * blockSize + i == echo) {
+                echoLevel = left[i];
+            }
+        }
+    }
+    EXPECT_NEAR(echoLevel, 0.5f, 1e-6f);
+}
+
+TEST(DSPArenaTest, ReverbKeepsDelaysAtHighSampleRate) {
+    // Les lignes sont dimensionnées au sample rate : plus de plafond à
+    // 2000 samples, le premier retour arrive au délai du plus court comb
+    ReverbEffect reverb;
+    reverb.setSampleRate(192000);
+    reverb.setSmoothingTime(0.0f);
+    reverb.setParameter("mix", 100.0f);
+    
+    const size_t firstComb = static_cast<size_t>(1116 * (192000 / 44100.0f));
+    std::vector<float> buffer((firstComb + 64) * 2, 0.0f);
+    buffer[0] = 1.0f;
+    buffer[1] = 1.0f;
+    reverb.process(buffer.data(), buffer.data(), static_cast<uint32_t>(buffer.size() / 2));
+    
+    size_t firstNonZero = 0;
+    while (firstNonZero < buffer.size() / 2 && buffer[firstNonZero * 2] == 0.0f) {
+        ++firstNonZero;
+    }
+    EXPECT_EQ(firstNonZero, firstComb);
+}
+
+} // namespace tests
+} // namespace webamp
@@ -2,9 +2,15 @@
 #include "dsp_pipeline.h"
 #include "effect_chain.h"
 #include "effects/distortion.h"
+#include "effects/delay.h"
+#include "effects/tremolo.h"
+#include "test_signal.h"
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <cmath>
 #include <chrono>
+#include <string>
 
 namespace webamp {
 namespace tests {
@@ -41,7 +47,7 @@ TEST_F(DSPPipelineTest, ProcessWithoutEffects) {
     pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
     // Sans effets, le signal devrait passer tel quel (avec gains)
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(DSPPipelineTest, ProcessWithEffects) {
@@ -54,7 +60,7 @@ TEST_F(DSPPipelineTest, ProcessWithEffects) {
     pipeline_->setEffectChain(chain);
     pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], test_buffer_[0]);
+    EXPECT_GT(maxDifference(output_buffer_, test_buffer_), 0.001f);
 }
 
 TEST_F(DSPPipelineTest, LatencyMeasurement) {
@@ -110,7 +116,7 @@ TEST_F(DSPPipelineTest, HighSampleRate) {
     
     pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(DSPPipelineTest, VeryHighSampleRate) {
@@ -120,7 +126,199 @@ TEST_F(DSPPipelineTest, VeryHighSampleRate) {
     
     pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
+}
+
+TEST_F(DSPPipelineTest, ReinitializeDuringProcess) {
+    auto chain = std::make_shared<EffectChain>();
+    auto distortion = std::make_shared<DistortionEffect>();
+    distortion->setSampleRate(sample_rate_);
+    chain->addEffect(distortion);
+    pipeline_->setEffectChain(chain);
+    
+    // Thread de contrôle : change la taille de bloc et arrête le pipeline
+    // pendant le traitement (buffers de travail remplacés et libérés)
+    std::atomic<bool> running{true};
+    std::thread control([&]() {
+        for (int i = 0; i < 200; ++i) {
+            pipeline_->initialize(sample_rate_, (i % 2) ? 32 : 256);
+            if (i % 50 == 49) {
+                pipeline_->shutdown();
+                pipeline_->initialize(sample_rate_, buffer_size_);
+                pipeline_->setEffectChain(chain);
+            }
+        }
+        running = false;
+    });
+    
+    // Thread audio : blocs plus grands que la plus petite taille initialisée
+    std::vector<float> input(256 * 2, 0.25f);
+    std::vector<float> output(256 * 2);
+    size_t blocks = 0;
+    while (running || blocks < 10) {
+        pipeline_->process(input.data(), output.data(), 128);
+        ++blocks;
+    }
+    control.join();
+    
+    pipeline_->process(input.data(), output.data(), 128);
+    EXPECT_TRUE(std::isfinite(output[0]));
+    EXPECT_GT(blocks, 0u);
+}
+
+TEST_F(DSPPipelineTest, NAMDownmixesStereoChain) {
+    // Modèle Linear identité au taux du pipeline (pas de rééchantillonnage)
+    const std::string model = "{\"version\":\"0.5.2\",\"architecture\":\"Linear\","
+        "\"config\":{\"receptive_field\":1,\"bias\":false},\"metadata\":{\"name\":\"Identity\"},"
+        "\"sample_rate\":" + std::to_string(sample_rate_) + ",\"weights\":[1.0]}";
+    ASSERT_TRUE(pipeline_->loadNAMModelFromMemory(reinterpret_cast<const uint8_t*>(model.data()), model.size()));
+    ASSERT_TRUE(pipeline_->isNAMModelActive());
+    
+    // Entrée stéréo : les deux canaux atteignent le modèle, moyennés
+    std::vector<float> input(buffer_size_ * 2);
+    for (uint32_t i = 0; i < buffer_size_; ++i) {
+        input[i * 2] = 0.4f;
+        input[i * 2 + 1] = -0.2f;
+    }
+    for (int block = 0; block < 4; ++block) {
+        pipeline_->process(input.data(), output_buffer_.data(), buffer_size_);
+    }
+    for (uint32_t i = 0; i < buffer_size_; ++i) {
+        EXPECT_NEAR(output_buffer_[i * 2], 0.1f, 1e-5f);
+        EXPECT_NEAR(output_buffer_[i * 2 + 1], 0.1f, 1e-5f);
+    }
+}
+
+TEST_F(DSPPipelineTest, ProfileReportsEveryEffect) {
+    auto chain = std::make_shared<EffectChain>();
+    auto distortion = std::make_shared<DistortionEffect>();
+    auto delay = std::make_shared<DelayEffect>();
+    distortion->setSampleRate(sample_rate_);
+    delay->setSampleRate(sample_rate_);
+    chain->addEffect(distortion);
+    chain->addEffect(delay);
+    pipeline_->setEffectChain(chain);
+    
+    for (int block = 0; block < 100; ++block) {
+        pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    }
+    
+    // Étages dans l'ordre de traitement : entrée, effets, sortie
+    auto profile = pipeline_->getProfile();
+    ASSERT_GT(profile.blocks, 0u);
+    ASSERT_EQ(profile.stageCount, 4u);
+    EXPECT_EQ(profile.stages[0].label, DSPPipeline::STAGE_INPUT);
+    EXPECT_EQ(profile.stages[1].id, distortion->getInstanceId());
+    EXPECT_EQ(profile.stages[2].id, delay->getInstanceId());
+    EXPECT_EQ(profile.stages[3].label, DSPPipeline::STAGE_OUTPUT);
+    EXPECT_EQ(profile.stages[1].label, nullptr);
+    EXPECT_EQ(profile.budgetNs, static_cast<uint32_t>(buffer_size_ * 1000000000ull / sample_rate_));
+    for (uint32_t i = 0; i < profile.stageCount; ++i) {
+        const auto& stage = profile.stages[i];
+        EXPECT_EQ(stage.count, profile.blocks);
+        EXPECT_LE(DSPProfiler::getPercentile(stage, 0.5), DSPProfiler::getPercentile(stage, 0.99));
+        EXPECT_LE(DSPProfiler::getPercentile(stage, 0.99), stage.maxNs);
+    }
+    EXPECT_EQ(profile.block.count, profile.blocks);
+    
+    // Un effet déplacé conserve son historique
+    const uint64_t distortionCount = profile.stages[1].count;
+    chain->swapEffects(0, 1);
+    for (int block = 0; block < 20; ++block) {
+        pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    }
+    profile = pipeline_->getProfile();
+    EXPECT_EQ(profile.stages[1].id, delay->getInstanceId());
+    EXPECT_EQ(profile.stages[2].id, distortion->getInstanceId());
+    EXPECT_GT(profile.stages[2].count, distortionCount);
+    
+    // Un effet remplacé ne transmet pas son historique au nouveau, même si
+    // celui-ci réutilise son adresse
+    chain->removeEffect(1);
+    auto replacement = std::make_shared<DistortionEffect>();
+    replacement->setSampleRate(sample_rate_);
+    chain->addEffect(replacement);
+    for (int block = 0; block < 20; ++block) {
+        pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    }
+    profile = pipeline_->getProfile();
+    EXPECT_EQ(profile.stages[2].id, replacement->getInstanceId());
+    EXPECT_LT(profile.stages[2].count, distortionCount);
+}
+
+TEST_F(DSPPipelineTest, ProfileCountsSleepingAndFusedEffects) {
+    // Distortion + tremolo : fusionnés sur le signal, en veille sur le silence
+    auto chain = std::make_shared<EffectChain>();
+    auto distortion = std::make_shared<DistortionEffect>();
+    auto tremolo = std::make_shared<TremoloEffect>();
+    distortion->setSampleRate(sample_rate_);
+    tremolo->setSampleRate(sample_rate_);
+    chain->addEffect(distortion);
+    chain->addEffect(tremolo);
+    pipeline_->setEffectChain(chain);
+    
+    std::vector<float> silence(buffer_size_ * 2, 0.0f);
+    for (int block = 0; block < 50; ++block) {
+        pipeline_->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    }
+    for (int block = 0; block < 50; ++block) {
+        pipeline_->process(silence.data(), output_buffer_.data(), buffer_size_);
+    }
+    EXPECT_TRUE(distortion->isSilent());
+    EXPECT_TRUE(tremolo->isSilent());
+    
+    // Un échantillon par bloc et par effet, traité, fusionné ou en veille
+    auto profile = pipeline_->getProfile();
+    ASSERT_EQ(profile.stageCount, 4u);
+    EXPECT_EQ(profile.stages[1].id, distortion->getInstanceId());
+    EXPECT_EQ(profile.stages[2].id, tremolo->getInstanceId());
+    for (uint32_t i = 0; i < profile.stageCount; ++i) {
+        EXPECT_EQ(profile.stages[i].count, profile.blocks) << "stage " << i;
+    }
+    EXPECT_EQ(profile.stages[2].lastNs, 0u);
+    
+    // Blocs fusionnés : chaque effet reçoit sa part du coût du groupe, et
+    // non un échantillon nul, et le profil l'indique
+    EXPECT_GT(profile.stages[1].fusedCount, 0u);
+    EXPECT_EQ(profile.stages[2].fusedCount, profile.stages[1].fusedCount);
+    EXPECT_LT(profile.stages[1].fusedCount, profile.blocks);
+    EXPECT_GT(profile.stages[2].maxNs, 0u);
+    EXPECT_EQ(profile.stages[0].fusedCount, 0u);
+}
+
+TEST_F(DSPPipelineTest, ProfilerCountsDeadlineMisses) {
+    DSPProfiler profiler;
+    
+    // 64 frames à 48 kHz : 1,33 ms de budget
+    profiler.recordStage(0, "stage", 300000);
+    profiler.endBlock(400000, 64, 48000);
+    profiler.recordStage(0, "stage", 1900000);
+    profiler.endBlock(2000000, 64, 48000);
+    
+    // Seul le premier bloc est publié immédiatement ; la suite l'est par intervalle
+    for (int block = 0; block < 20; ++block) {
+        profiler.recordStage(0, "stage", 300000);
+        profiler.endBlock(400000, 64, 48000);
+    }
+    
+    auto profile = profiler.getProfile();
+    EXPECT_EQ(profile.xruns, 1u);
+    EXPECT_GE(profile.blocks, 15u);
+    EXPECT_EQ(profile.stages[0].maxNs, 1900000u);
+    EXPECT_EQ(profile.block.maxNs, 2000000u);
+    
+    // p50 dans la classe de 300 µs (4 classes par octave : erreur < 25 %)
+    const uint64_t p50 = DSPProfiler::getPercentile(profile.stages[0], 0.5);
+    EXPECT_GE(p50, 300000u);
+    EXPECT_LT(p50, 375000u);
+    EXPECT_EQ(DSPProfiler::getPercentile(profile.stages[0], 1.0), 1900000u);
+    
+    // Remise à zéro appliquée au bloc suivant
+    profiler.reset();
+    profiler.endBlock(400000, 64, 48000);
+    profile = profiler.getProfile();
+    EXPECT_EQ(profile.blocks, 1u);
+    EXPECT_EQ(profile.xruns, 0u);
 }
 
 } // namespace tests
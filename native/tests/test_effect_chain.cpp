@@ -3,12 +3,49 @@
 #include "effects/distortion.h"
 #include "effects/chorus.h"
 #include "effects/delay.h"
+#include "effects/eq.h"
+#include "effects/reverb.h"
+#include "test_signal.h"
 #include <vector>
 #include <cmath>
+#include <atomic>
+#include <thread>
 
 namespace webamp {
 namespace tests {
 
+// Ajoute 1 à chaque échantillon et note les buffers reçus
+class OffsetTestEffect : public EffectBase {
+public:
+    explicit OffsetTestEffect(bool inPlace) : in_place_(inPlace) {}
+    
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override {
+        last_input = input[0];
+        last_output = output[0];
+        ++calls;
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            for (uint32_t i = 0; i < frameCount; ++i) {
+                output[ch][i] = input[ch][i] + 1.0f;
+            }
+        }
+    }
+    bool canProcessInPlace() const override { return in_place_; }
+    
+    std::vector<Parameter> getParameters() const override { return {}; }
+    void setParameter(const std::string&, float) override {}
+    float getParameter(const std::string&) const override { return 0.0f; }
+    std::string getName() const override { return "Offset"; }
+    std::string getType() const override { return "offset"; }
+    
+    const float* last_input = nullptr;
+    const float* last_output = nullptr;
+    int calls = 0;
+
+private:
+    bool in_place_;
+};
+
 class EffectChainTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -52,7 +89,7 @@ TEST_F(EffectChainTest, SingleEffect) {
     chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
     // La sortie devrait être modifiée
-    EXPECT_NE(output_buffer_[0], test_buffer_[0]);
+    EXPECT_GT(maxDifference(output_buffer_, test_buffer_), 0.001f);
 }
 
 TEST_F(EffectChainTest, MultipleEffects) {
@@ -76,7 +113,7 @@ TEST_F(EffectChainTest, MultipleEffects) {
     
     chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], test_buffer_[0]);
+    EXPECT_GT(maxDifference(output_buffer_, test_buffer_), 0.001f);
     EXPECT_EQ(chain.getEffectCount(), 3);
 }
 
@@ -95,7 +132,7 @@ TEST_F(EffectChainTest, MaximumEffects) {
     chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
     // Devrait traiter sans erreur
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(EffectChainTest, AddRemoveEffects) {
@@ -163,31 +200,270 @@ TEST_F(EffectChainTest, BypassedEffects) {
     EXPECT_FLOAT_EQ(output_buffer_[0], test_buffer_[0]);
 }
 
-TEST_F(EffectChainTest, PresetSaveLoad) {
+TEST_F(EffectChainTest, ParameterRoundTrip) {
     EffectChain chain;
     
     auto effect = std::make_shared<DistortionEffect>();
     effect->setSampleRate(sample_rate_);
-    effect->setParameter("distortion", 75.0f);
+    effect->setParameter("gain", 75.0f);
     effect->setParameter("tone", 60.0f);
     chain.addEffect(effect);
     
-    // Sauvegarder le preset
-    auto preset = chain.savePreset("test_preset");
-    EXPECT_EQ(preset.name, "test_preset");
-    EXPECT_EQ(preset.effectTypes.size(), 1);
-    EXPECT_EQ(preset.effectTypes[0], "distortion");
+    // Relever type et paramètres des effets de la chaîne
+    std::vector<std::string> types;
+    std::vector<std::vector<EffectBase::Parameter>> parameters;
+    for (size_t i = 0; i < chain.getEffectCount(); ++i) {
+        types.push_back(chain.getEffect(i)->getType());
+        parameters.push_back(chain.getEffect(i)->getParameters());
+    }
+    ASSERT_EQ(types.size(), 1u);
+    EXPECT_EQ(types[0], "distortion");
     
-    // Charger le preset
+    // Reconstruire la chaîne à partir du relevé
     chain.clear();
-    chain.loadPreset(preset);
-    EXPECT_EQ(chain.getEffectCount(), 1);
+    auto restored = std::make_shared<DistortionEffect>();
+    restored->setSampleRate(sample_rate_);
+    for (const auto& parameter : parameters[0]) {
+        restored->setParameter(parameter.name, parameter.currentValue);
+    }
+    chain.addEffect(restored);
+    EXPECT_EQ(chain.getEffectCount(), 1u);
     
     auto loadedEffect = chain.getEffect(0);
-    EXPECT_FLOAT_EQ(loadedEffect->getParameter("distortion"), 75.0f);
+    EXPECT_FLOAT_EQ(loadedEffect->getParameter("gain"), 75.0f);
     EXPECT_FLOAT_EQ(loadedEffect->getParameter("tone"), 60.0f);
 }
 
+TEST_F(EffectChainTest, ConcurrentModificationDuringProcess) {
+    EffectChain chain;
+    chain.prepare(buffer_size_);
+    
+    std::atomic<bool> running{true};
+    
+    // Thread de contrôle : modifie la chaîne pendant le traitement
+    std::thread control([&]() {
+        for (int i = 0; i < 200; ++i) {
+            auto effect = std::make_shared<DistortionEffect>();
+            effect->setSampleRate(sample_rate_);
+            chain.addEffect(effect, 0);
+            if (chain.getEffectCount() > 1) {
+                chain.moveEffect(0, chain.getEffectCount() - 1);
+            }
+            if (chain.getEffectCount() > 5) {
+                chain.removeEffect(0);
+            }
+        }
+        running = false;
+    });
+    
+    // Thread audio : traite en continu, sans verrou
+    size_t blocks = 0;
+    while (running || blocks < 10) {
+        chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+        ++blocks;
+    }
+    control.join();
+    
+    EXPECT_EQ(chain.getEffectCount(), 5);
+    EXPECT_GT(blocks, 0u);
+}
+
+TEST_F(EffectChainTest, ProcessLargerThanPreparedBlock) {
+    EffectChain chain;
+    chain.prepare(32);
+    
+    auto effect = std::make_shared<DistortionEffect>();
+    effect->setSampleRate(sample_rate_);
+    effect->setBypass(true);
+    chain.addEffect(effect);
+    
+    // 128 frames avec des buffers de travail de 32 frames : traitement par sous-blocs
+    chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    
+    for (size_t i = 0; i < buffer_size_ * 2; ++i) {
+        EXPECT_FLOAT_EQ(output_buffer_[i], test_buffer_[i]);
+    }
+}
+
+TEST_F(EffectChainTest, QueuedParameterAppliedByProcess) {
+    EffectChain chain;
+    auto distortion = std::make_shared<DistortionEffect>();
+    distortion->setSampleRate(sample_rate_);
+    chain.addEffect(distortion);
+    chain.setAudioThreadActive(true);
+    
+    // La valeur n'est appliquée qu'au début du prochain bloc audio
+    EXPECT_TRUE(chain.queueParameterChange(distortion.get(), DistortionEffect::PARAM_GAIN, 80.0f));
+    EXPECT_FLOAT_EQ(distortion->getParameter("gain"), 50.0f);
+    
+    chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    EXPECT_FLOAT_EQ(distortion->getParameter("gain"), 80.0f);
+    
+    // Effet absent de la chaîne : refusé
+    DistortionEffect other;
+    EXPECT_FALSE(chain.queueParameterChange(&other, DistortionEffect::PARAM_GAIN, 10.0f));
+}
+
+TEST_F(EffectChainTest, StaleParameterChangeIgnored) {
+    // Un effet libéré dont l'adresse est réutilisée par un nouvel effet :
+    // l'identifiant d'instance ne correspond plus, le changement est ignoré
+    DistortionEffect effect;
+    DistortionEffect other;
+    EXPECT_NE(effect.getInstanceId(), other.getInstanceId());
+    
+    ParameterChange stale{&effect, other.getInstanceId(), DistortionEffect::PARAM_GAIN, 80.0f};
+    EXPECT_FALSE(effect.applyParameterChange(stale));
+    EXPECT_FLOAT_EQ(effect.getParameter("gain"), 50.0f);
+    
+    ParameterChange current{&effect, effect.getInstanceId(), DistortionEffect::PARAM_GAIN, 80.0f};
+    EXPECT_TRUE(effect.applyParameterChange(current));
+    EXPECT_FLOAT_EQ(effect.getParameter("gain"), 80.0f);
+}
+
+TEST_F(EffectChainTest, ParameterQueueFull) {
+    EffectChain chain;
+    auto distortion = std::make_shared<DistortionEffect>();
+    chain.addEffect(distortion);
+    chain.setAudioThreadActive(true);
+    
+    size_t accepted = 0;
+    for (size_t i = 0; i < EffectChain::PARAMETER_QUEUE_CAPACITY * 2; ++i) {
+        if (chain.queueParameterChange(distortion.get(), DistortionEffect::PARAM_LEVEL, static_cast<float>(i % 100))) {
+            ++accepted;
+        }
+    }
+    EXPECT_LT(accepted, EffectChain::PARAMETER_QUEUE_CAPACITY * 2);
+    
+    // Le thread audio vide la file : de nouveaux changements sont acceptés
+    chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+    EXPECT_TRUE(chain.queueParameterChange(distortion.get(), DistortionEffect::PARAM_LEVEL, 42.0f));
+}
+
+TEST_F(EffectChainTest, ParameterAppliedWithoutAudioThread) {
+    EffectChain chain;
+    auto distortion = std::make_shared<DistortionEffect>();
+    chain.addEffect(distortion);
+    EXPECT_FALSE(chain.isAudioThreadActive());
+    
+    // Aucun thread audio ne vide la file : chaque changement est appliqué
+    // aussitôt, bien au-delà de la capacité de la file
+    for (size_t i = 0; i < EffectChain::PARAMETER_QUEUE_CAPACITY * 2; ++i) {
+        ASSERT_TRUE(chain.queueParameterChange(distortion.get(), DistortionEffect::PARAM_LEVEL,
+                                               static_cast<float>(i % 100))) << i;
+        EXPECT_FLOAT_EQ(distortion->getParameter("level"), static_cast<float>(i % 100));
+    }
+    
+    // Thread audio arrêté : les changements restés en file sont appliqués
+    chain.setAudioThreadActive(true);
+    EXPECT_TRUE(chain.queueParameterChange(distortion.get(), DistortionEffect::PARAM_GAIN, 80.0f));
+    EXPECT_FLOAT_EQ(distortion->getParameter("gain"), 50.0f);
+    chain.setAudioThreadActive(false);
+    EXPECT_FLOAT_EQ(distortion->getParameter("gain"), 80.0f);
+}
+
+TEST_F(EffectChainTest, MonoInputWidensAtFirstStereoEffect) {
+    // Deux chaînes identiques : l'une alimentée en mono, l'autre avec le
+    // même signal sur les deux canaux
+    auto build = [](EffectChain& chain) {
+        chain.addEffect(std::make_shared<DistortionEffect>());
+        chain.addEffect(std::make_shared<EQEffect>());
+        chain.addEffect(std::make_shared<ChorusEffect>());
+        chain.addEffect(std::make_shared<DelayEffect>());
+        chain.addEffect(std::make_shared<ReverbEffect>());
+    };
+    EffectChain monoChain;
+    EffectChain stereoChain;
+    build(monoChain);
+    build(stereoChain);
+    EXPECT_EQ(monoChain.getMonoEffectCount(), 2u);
+    
+    std::vector<float> mono(buffer_size_);
+    std::vector<float> left(buffer_size_), right(buffer_size_);
+    std::vector<float> monoLeft(buffer_size_), monoRight(buffer_size_);
+    for (int block = 0; block < 8; ++block) {
+        for (uint32_t i = 0; i < buffer_size_; ++i) {
+            mono[i] = test_buffer_[i * 2];
+            left[i] = mono[i];
+            right[i] = mono[i];
+        }
+        float* stereo[2] = {left.data(), right.data()};
+        stereoChain.process(stereo, stereo, 2, buffer_size_);
+        float* out[2] = {monoLeft.data(), monoRight.data()};
+        ASSERT_EQ(monoChain.processMono(mono.data(), out, buffer_size_), 2u);
+        
+        for (uint32_t i = 0; i < buffer_size_; ++i) {
+            ASSERT_FLOAT_EQ(monoLeft[i], left[i]);
+            ASSERT_FLOAT_EQ(monoRight[i], right[i]);
+        }
+    }
+}
+
+TEST_F(EffectChainTest, MonoInputStaysMonoWithoutStereoEffects) {
+    EffectChain chain;
+    chain.addEffect(std::make_shared<DistortionEffect>());
+    chain.addEffect(std::make_shared<EQEffect>());
+    EXPECT_EQ(chain.getMonoEffectCount(), 2u);
+    
+    std::vector<float> mono(buffer_size_);
+    for (uint32_t i = 0; i < buffer_size_; ++i) {
+        mono[i] = test_buffer_[i * 2];
+    }
+    std::vector<float> left(buffer_size_), right(buffer_size_, 7.0f);
+    float* out[2] = {left.data(), right.data()};
+    
+    // Un seul canal produit, le second n'est pas touché
+    EXPECT_EQ(chain.processMono(mono.data(), out, buffer_size_), 1u);
+    EXPECT_EQ(right[0], 7.0f);
+    EXPECT_NE(left[0], 7.0f);
+    
+    // Un effet stéréo ajouté en fin de chaîne élargit la sortie
+    chain.addEffect(std::make_shared<ChorusEffect>());
+    EXPECT_EQ(chain.getMonoEffectCount(), 2u);
+    EXPECT_EQ(chain.processMono(mono.data(), out, buffer_size_), 2u);
+}
+
+TEST_F(EffectChainTest, InPlaceExecutionSkipsBypassedEffects) {
+    EffectChain chain;
+    chain.prepare(buffer_size_);
+    auto first = std::make_shared<OffsetTestEffect>(true);
+    auto bypassed = std::make_shared<OffsetTestEffect>(true);
+    auto outOfPlace = std::make_shared<OffsetTestEffect>(false);
+    auto last = std::make_shared<OffsetTestEffect>(true);
+    bypassed->setBypass(true);
+    chain.addEffect(first);
+    chain.addEffect(bypassed);
+    chain.addEffect(outOfPlace);
+    chain.addEffect(last);
+    
+    std::vector<float> inLeft(buffer_size_, 0.25f), inRight(buffer_size_, 0.25f);
+    std::vector<float> outLeft(buffer_size_), outRight(buffer_size_);
+    const float* in[2] = {inLeft.data(), inRight.data()};
+    float* out[2] = {outLeft.data(), outRight.data()};
+    chain.process(in, out, 2, buffer_size_);
+    
+    // Entrée lue directement, puis travail dans la sortie ; seul l'effet
+    // qui ne peut pas être traité en place écrit dans le buffer de travail
+    EXPECT_EQ(first->last_input, inLeft.data());
+    EXPECT_EQ(first->last_output, outLeft.data());
+    EXPECT_EQ(bypassed->calls, 0);
+    EXPECT_EQ(outOfPlace->last_input, outLeft.data());
+    EXPECT_NE(outOfPlace->last_output, outLeft.data());
+    EXPECT_EQ(last->last_input, outOfPlace->last_output);
+    EXPECT_EQ(last->last_output, outLeft.data());
+    
+    for (uint32_t i = 0; i < buffer_size_; ++i) {
+        ASSERT_FLOAT_EQ(outLeft[i], 3.25f);
+        ASSERT_FLOAT_EQ(outRight[i], 3.25f);
+        ASSERT_FLOAT_EQ(inLeft[i], 0.25f);
+    }
+    
+    // Bypass levé : l'effet retrouve sa place au bloc suivant
+    bypassed->setBypass(false);
+    chain.process(in, out, 2, buffer_size_);
+    EXPECT_EQ(bypassed->calls, 1);
+    EXPECT_FLOAT_EQ(outLeft[0], 4.25f);
+}
+
 } // namespace tests
 } // namespace webamp
 
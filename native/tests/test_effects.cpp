@@ -8,6 +8,12 @@
 #include "effects/eq.h"
 #include "effects/delay.h"
 #include "effects/reverb.h"
+#include "smoothed_value.h"
+#include "audio_buffer.h"
+#include "test_signal.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <cmath>
 
@@ -64,7 +70,7 @@ TEST_F(EffectTest, OverdriveEffect) {
     output_buffer_.resize(buffer_size_ * 2);
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(EffectTest, FuzzEffect) {
@@ -77,7 +83,7 @@ TEST_F(EffectTest, FuzzEffect) {
     output_buffer_.resize(buffer_size_ * 2);
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(EffectTest, ChorusEffect) {
@@ -90,13 +96,13 @@ TEST_F(EffectTest, ChorusEffect) {
     output_buffer_.resize(buffer_size_ * 2);
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(EffectTest, DelayEffect) {
     auto effect = std::make_shared<DelayEffect>();
     effect->setSampleRate(sample_rate_);
-    effect->setParameter("time", 250.0f); // 250ms
+    effect->setParameter("time", 12.5f); // 12,5 % de 2000 ms = 250 ms
     effect->setParameter("feedback", 50.0f);
     effect->setParameter("mix", 50.0f);
     
@@ -105,11 +111,18 @@ TEST_F(EffectTest, DelayEffect) {
     // Traiter plusieurs buffers pour voir l'écho
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    // Deuxième buffer (devrait avoir l'écho)
-    std::vector<float> secondBuffer(buffer_size_ * 2, 0.0f);
-    effect->process(secondBuffer.data(), secondBuffer.data(), buffer_size_);
+    // Buffers silencieux suivants : l'écho arrive après le temps de delay
+    // (la rampe de "time" part de 50 %, soit 1 s au plus)
+    std::vector<float> silentBuffer(buffer_size_ * 2, 0.0f);
+    float echoRms = 0.0f;
+    const uint32_t maxBlocks = static_cast<uint32_t>(1.5f * sample_rate_ / buffer_size_);
+    for (uint32_t block = 0; block < maxBlocks && echoRms == 0.0f; ++block) {
+        std::fill(silentBuffer.begin(), silentBuffer.end(), 0.0f);
+        effect->process(silentBuffer.data(), silentBuffer.data(), buffer_size_);
+        echoRms = rms(silentBuffer);
+    }
     
-    EXPECT_NE(secondBuffer[0], 0.0f);
+    EXPECT_GT(echoRms, 0.0f);
 }
 
 TEST_F(EffectTest, ReverbEffect) {
@@ -122,7 +135,7 @@ TEST_F(EffectTest, ReverbEffect) {
     output_buffer_.resize(buffer_size_ * 2);
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(EffectTest, EQEffect) {
@@ -136,7 +149,7 @@ TEST_F(EffectTest, EQEffect) {
     output_buffer_.resize(buffer_size_ * 2);
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(EffectTest, BypassFunctionality) {
@@ -149,7 +162,7 @@ TEST_F(EffectTest, BypassFunctionality) {
     // Traiter avec bypass OFF
     effect->setBypass(false);
     effect->process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
-    float outputWithEffect = output_buffer_[0];
+    const std::vector<float> outputWithEffect = output_buffer_;
     
     // Traiter avec bypass ON
     effect->setBypass(true);
@@ -159,7 +172,7 @@ TEST_F(EffectTest, BypassFunctionality) {
     // Avec bypass, le signal devrait être identique à l'entrée
     EXPECT_FLOAT_EQ(outputBypassed, test_buffer_[0]);
     // Sans bypass, le signal devrait être modifié
-    EXPECT_NE(outputWithEffect, test_buffer_[0]);
+    EXPECT_GT(maxDifference(outputWithEffect, test_buffer_), 0.001f);
 }
 
 TEST_F(EffectTest, ParameterRanges) {
@@ -173,6 +186,116 @@ TEST_F(EffectTest, ParameterRanges) {
     EXPECT_NO_THROW(effect->setParameter("distortion", 150.0f)); // Valeur invalide mais gérée
 }
 
+TEST_F(EffectTest, SmoothedValueRamp) {
+    SmoothedValue value(0.0f);
+    value.setTarget(1.0f, 4);
+    
+    EXPECT_TRUE(value.isSmoothing());
+    EXPECT_FLOAT_EQ(value.getNextValue(), 0.25f);
+    EXPECT_FLOAT_EQ(value.getNextValue(), 0.5f);
+    value.skip(8);
+    EXPECT_FALSE(value.isSmoothing());
+    EXPECT_FLOAT_EQ(value.getCurrentValue(), 1.0f);
+}
+
+TEST_F(EffectTest, ParameterChangeIsSmoothed) {
+    auto effect = std::make_shared<DistortionEffect>();
+    effect->setSampleRate(sample_rate_);
+    effect->setSmoothingTime(0.01f); // 441 échantillons
+    
+    std::vector<float> constant(buffer_size_ * 2, 0.05f);
+    output_buffer_.resize(buffer_size_ * 2);
+    effect->process(constant.data(), output_buffer_.data(), buffer_size_);
+    
+    // Level 50 -> 100 : le niveau monte progressivement, sans saut
+    effect->setParameterByIndex(DistortionEffect::PARAM_LEVEL, 100.0f);
+    EXPECT_FLOAT_EQ(effect->getParameter("level"), 100.0f);
+    
+    const float before = output_buffer_[buffer_size_ * 2 - 1];
+    float previous = before;
+    float maxStep = 0.0f;
+    for (int block = 0; block < 8; ++block) {
+        effect->process(constant.data(), output_buffer_.data(), buffer_size_);
+        for (uint32_t i = 0; i < buffer_size_ * 2; ++i) {
+            maxStep = std::max(maxStep, std::abs(output_buffer_[i] - previous));
+            previous = output_buffer_[i];
+        }
+    }
+    
+    EXPECT_LT(maxStep, 0.01f);
+    EXPECT_NEAR(previous, 2.0f * before, 1e-4f);
+}
+
+TEST_F(EffectTest, ParameterIndexMatchesName) {
+    auto effect = std::make_shared<EQEffect>();
+    effect->setSampleRate(sample_rate_);
+    
+    EXPECT_EQ(effect->getParameterIndex("mid"), static_cast<size_t>(EQEffect::PARAM_MID));
+    EXPECT_EQ(effect->getParameterIndex("unknown"), EffectBase::INVALID_PARAMETER);
+    
+    effect->setParameterByIndex(effect->getParameterIndex("high"), -6.0f);
+    EXPECT_FLOAT_EQ(effect->getParameter("high"), -6.0f);
+}
+
+TEST_F(EffectTest, PlanarChannelsStayIndependent) {
+    // Signal à gauche, silence à droite : aucun état ne fuit d'un canal à l'autre
+    const std::vector<std::function<std::shared_ptr<EffectBase>()>> factories = {
+        [] { return std::make_shared<DistortionEffect>(); },
+        [] { return std::make_shared<OverdriveEffect>(); },
+        [] { return std::make_shared<FuzzEffect>(); },
+        [] { return std::make_shared<ChorusEffect>(); },
+        [] { return std::make_shared<FlangerEffect>(); },
+        [] { return std::make_shared<TremoloEffect>(); },
+        [] { return std::make_shared<EQEffect>(); },
+        [] { return std::make_shared<DelayEffect>(); },
+        [] { return std::make_shared<ReverbEffect>(); }
+    };
+    
+    AudioBuffer input(2, buffer_size_);
+    AudioBuffer output(2, buffer_size_);
+    for (uint32_t i = 0; i < buffer_size_; ++i) {
+        input.getChannel(0)[i] = test_buffer_[i];
+    }
+    std::vector<float> interleaved(buffer_size_ * 2);
+    AudioBuffer::interleave(input.getReadPointers(), interleaved.data(), 2, buffer_size_);
+    
+    for (const auto& factory : factories) {
+        auto planar = factory();
+        auto reference = factory();
+        planar->setSampleRate(sample_rate_);
+        reference->setSampleRate(sample_rate_);
+        
+        output_buffer_.resize(buffer_size_ * 2);
+        for (int block = 0; block < 4; ++block) {
+            planar->process(input.getReadPointers(), output.getWritePointers(), 2, buffer_size_);
+            reference->process(interleaved.data(), output_buffer_.data(), buffer_size_);
+            
+            for (uint32_t i = 0; i < buffer_size_; ++i) {
+                ASSERT_EQ(output.getChannel(1)[i], 0.0f) << planar->getName() << " frame " << i;
+                // La variante entrelacée passe par le même traitement planaire
+                ASSERT_FLOAT_EQ(output_buffer_[i * 2], output.getChannel(0)[i]) << planar->getName();
+                ASSERT_FLOAT_EQ(output_buffer_[i * 2 + 1], 0.0f) << planar->getName();
+            }
+        }
+    }
+}
+
+TEST_F(EffectTest, AudioBufferRoundTrip) {
+    AudioBuffer buffer(2, buffer_size_);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.getChannel(0)) % 32, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.getChannel(1)) % 32, 0u);
+    
+    AudioBuffer::deinterleave(test_buffer_.data(), buffer.getWritePointers(), 2, buffer_size_);
+    for (uint32_t i = 0; i < buffer_size_; ++i) {
+        EXPECT_EQ(buffer.getChannel(0)[i], test_buffer_[i * 2]);
+        EXPECT_EQ(buffer.getChannel(1)[i], test_buffer_[i * 2 + 1]);
+    }
+    
+    std::vector<float> restored(buffer_size_ * 2);
+    AudioBuffer::interleave(buffer.getReadPointers(), restored.data(), 2, buffer_size_);
+    EXPECT_EQ(restored, test_buffer_);
+}
+
 } // namespace tests
 } // namespace webamp
 
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "fft_helper.h"
+#include <vector>
+#include <random>
+#include <cmath>
+
+namespace webamp {
+namespace tests {
+
+class FFTTest : public ::testing::Test {
+protected:
+    std::vector<float> randomSignal(size_t size, unsigned seed) const {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::vector<float> signal(size);
+        for (auto& s : signal) {
+            s = dist(gen);
+        }
+        return signal;
+    }
+    
+    // DFT directe de référence (double précision)
+    void naiveDFT(const std::vector<float>& re, const std::vector<float>& im,
+                  std::vector<double>& outRe, std::vector<double>& outIm) const {
+        const size_t n = re.size();
+        outRe.assign(n, 0.0);
+        outIm.assign(n, 0.0);
+        for (size_t k = 0; k < n; ++k) {
+            for (size_t t = 0; t < n; ++t) {
+                const double angle = -2.0 * 3.14159265358979323846 * static_cast<double>(k * t % n) / n;
+                outRe[k] += re[t] * std::cos(angle) - im[t] * std::sin(angle);
+                outIm[k] += re[t] * std::sin(angle) + im[t] * std::cos(angle);
+            }
+        }
+    }
+};
+
+TEST_F(FFTTest, ComplexForwardMatchesDFT) {
+    for (size_t n : {2u, 4u, 8u, 16u, 64u, 512u}) {
+        std::vector<float> re = randomSignal(n, 1);
+        std::vector<float> im = randomSignal(n, 2);
+        std::vector<double> expectedRe, expectedIm;
+        naiveDFT(re, im, expectedRe, expectedIm);
+        
+        FFTPlan plan(n);
+        ASSERT_EQ(plan.getSize(), n);
+        plan.forward(re.data(), im.data());
+        
+        for (size_t k = 0; k < n; ++k) {
+            EXPECT_NEAR(re[k], expectedRe[k], 1e-3) << "n=" << n << " k=" << k;
+            EXPECT_NEAR(im[k], expectedIm[k], 1e-3) << "n=" << n << " k=" << k;
+        }
+    }
+}
+
+TEST_F(FFTTest, ComplexRoundTrip) {
+    const size_t n = 1024;
+    std::vector<float> re = randomSignal(n, 3);
+    std::vector<float> im = randomSignal(n, 4);
+    const std::vector<float> originalRe = re;
+    const std::vector<float> originalIm = im;
+    
+    FFTPlan plan(n);
+    plan.forward(re.data(), im.data());
+    plan.inverse(re.data(), im.data());
+    
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(re[i], originalRe[i], 1e-5);
+        EXPECT_NEAR(im[i], originalIm[i], 1e-5);
+    }
+}
+
+TEST_F(FFTTest, RealForwardMatchesDFT) {
+    for (size_t n : {2u, 4u, 8u, 32u, 256u}) {
+        const std::vector<float> input = randomSignal(n, 5);
+        std::vector<double> expectedRe, expectedIm;
+        naiveDFT(input, std::vector<float>(n, 0.0f), expectedRe, expectedIm);
+        
+        FFTPlan plan(n);
+        AlignedVector<float> re(n / 2 + 1), im(n / 2 + 1);
+        plan.forwardReal(input.data(), re.data(), im.data());
+        
+        for (size_t k = 0; k <= n / 2; ++k) {
+            EXPECT_NEAR(re[k], expectedRe[k], 1e-3) << "n=" << n << " k=" << k;
+            EXPECT_NEAR(im[k], expectedIm[k], 1e-3) << "n=" << n << " k=" << k;
+        }
+    }
+}
+
+TEST_F(FFTTest, RealRoundTrip) {
+    const size_t n = 2048;
+    const std::vector<float> input = randomSignal(n, 6);
+    
+    FFTPlan plan(n);
+    AlignedVector<float> re(n / 2 + 1), im(n / 2 + 1);
+    AlignedVector<float> output(n);
+    plan.forwardReal(input.data(), re.data(), im.data());
+    plan.inverseReal(re.data(), im.data(), output.data());
+    
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(output[i], input[i], 1e-5);
+    }
+}
+
+TEST_F(FFTTest, LegacyConvolveMatchesDirect) {
+    const std::vector<float> signal = randomSignal(300, 7);
+    const std::vector<float> kernel = randomSignal(37, 8);
+    
+    std::vector<float> output;
+    FFTHelper::convolveFFT(signal, kernel, output);
+    ASSERT_EQ(output.size(), signal.size() + kernel.size() - 1);
+    
+    for (size_t n = 0; n < output.size(); ++n) {
+        double expected = 0.0;
+        for (size_t k = 0; k < kernel.size(); ++k) {
+            if (n >= k && n - k < signal.size()) {
+                expected += static_cast<double>(signal[n - k]) * kernel[k];
+            }
+        }
+        EXPECT_NEAR(output[n], expected, 1e-4);
+    }
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "effect_chain.h"
+#include "fused_chain.h"
+#include "effects/chorus.h"
+#include "effects/distortion.h"
+#include "effects/fuzz.h"
+#include "effects/overdrive.h"
+#include "effects/tremolo.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class FusionTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t BLOCK = 256;
+    
+    struct Rig {
+        EffectChain chain;
+        std::shared_ptr<DistortionEffect> distortion = std::make_shared<DistortionEffect>();
+        std::shared_ptr<OverdriveEffect> overdrive = std::make_shared<OverdriveEffect>();
+        std::shared_ptr<TremoloEffect> tremolo = std::make_shared<TremoloEffect>();
+        std::shared_ptr<FuzzEffect> fuzz = std::make_shared<FuzzEffect>();
+        std::shared_ptr<ChorusEffect> chorus = std::make_shared<ChorusEffect>();
+    };
+    
+    // Drive, overdrive, tremolo et fuzz consécutifs (groupes de 3 + 1), puis
+    // un chorus non fusionnable. Paramètres en rampe sur plusieurs blocs.
+    static void build(Rig& rig, bool fusion) {
+        rig.chain.setFusionEnabled(fusion);
+        rig.chain.prepare(BLOCK);
+        std::shared_ptr<EffectBase> effects[] = {rig.distortion, rig.overdrive, rig.tremolo, rig.fuzz, rig.chorus};
+        for (auto& effect : effects) {
+            effect->setSampleRate(48000);
+            effect->setSmoothingTime(0.01f);
+            rig.chain.addEffect(effect);
+        }
+        rig.distortion->setParameter("gain", 20.0f);
+        rig.distortion->setParameter("tone", 80.0f);
+        rig.overdrive->setParameter("drive", 0.3f);
+        rig.tremolo->setParameter("rate", 7.0f);
+        rig.tremolo->setParameter("depth", 0.8f);
+        rig.fuzz->setParameter("fuzz", 0.1f);
+    }
+    
+    static void fill(std::vector<float>& left, std::vector<float>& right, uint32_t block) {
+        for (uint32_t i = 0; i < BLOCK; ++i) {
+            const float t = static_cast<float>(block * BLOCK + i) / 48000.0f;
+            left[i] = 0.3f * std::sin(2.0f * 3.14159265f * 220.0f * t);
+            right[i] = 0.2f * std::sin(2.0f * 3.14159265f * 330.0f * t);
+        }
+    }
+    
+    // Traite le même signal dans les deux chaînes et compare les sorties
+    static void expectSameOutput(Rig& fused, Rig& reference, uint32_t blocks, uint32_t& block) {
+        std::vector<float> left[2] = {std::vector<float>(BLOCK), std::vector<float>(BLOCK)};
+        std::vector<float> right[2] = {std::vector<float>(BLOCK), std::vector<float>(BLOCK)};
+        for (uint32_t end = block + blocks; block < end; ++block) {
+            Rig* rigs[2] = {&fused, &reference};
+            for (int r = 0; r < 2; ++r) {
+                fill(left[r], right[r], block);
+                float* channels[2] = {left[r].data(), right[r].data()};
+                rigs[r]->chain.process(channels, channels, 2, BLOCK);
+            }
+            for (uint32_t i = 0; i < BLOCK; ++i) {
+                ASSERT_NEAR(left[0][i], left[1][i], 1e-5f) << "block " << block << " frame " << i;
+                ASSERT_NEAR(right[0][i], right[1][i], 1e-5f) << "block " << block << " frame " << i;
+            }
+        }
+    }
+};
+
+TEST_F(FusionTest, CompileSplitsLongRuns) {
+    DistortionEffect distortion;
+    OverdriveEffect overdrive;
+    TremoloEffect tremolo;
+    EffectBase* effects[] = {&distortion, &overdrive, &tremolo, &distortion};
+    EffectBase::FusedKind kinds[4];
+    for (int i = 0; i < 4; ++i) {
+        kinds[i] = effects[i]->getFusedKind();
+    }
+    EXPECT_EQ(kinds[0], EffectBase::FusedKind::Distortion);
+    EXPECT_EQ(kinds[2], EffectBase::FusedKind::Tremolo);
+    
+    FusedChain fused;
+    EXPECT_FALSE(fused.isCompiled());
+    EXPECT_EQ(fused.compile(effects, kinds, 4), FusedChain::MAX_STAGES);
+    EXPECT_TRUE(fused.isCompiled());
+    EXPECT_EQ(fused.getStageCount(), FusedChain::MAX_STAGES);
+    EXPECT_EQ(fused.getStage(0), &distortion);
+    EXPECT_EQ(fused.getStage(FusedChain::MAX_STAGES - 1), &tremolo);
+    
+    // Suréchantillonnage ou ADAA : traitement par process()
+    distortion.setParameter("oversampling", 2.0f);
+    EXPECT_EQ(distortion.getFusedKind(), EffectBase::FusedKind::None);
+    overdrive.setParameter("antialiasing", 1.0f);
+    EXPECT_EQ(overdrive.getFusedKind(), EffectBase::FusedKind::None);
+    
+    // Non fusionnable : rien n'est compilé
+    EffectBase::FusedKind none = EffectBase::FusedKind::None;
+    EXPECT_EQ(fused.compile(effects, &none, 1), 0u);
+    EXPECT_FALSE(fused.isCompiled());
+}
+
+TEST_F(FusionTest, FusedChainMatchesSeparateEffects) {
+    Rig fused;
+    Rig reference;
+    build(fused, true);
+    build(reference, false);
+    ASSERT_TRUE(fused.chain.isFusionEnabled());
+    
+    uint32_t block = 0;
+    expectSameOutput(fused, reference, 8, block);
+    
+    // Bypass au milieu du groupe, puis suréchantillonnage : groupes
+    // recompilés au bloc suivant
+    fused.overdrive->setBypass(true);
+    reference.overdrive->setBypass(true);
+    expectSameOutput(fused, reference, 4, block);
+    fused.distortion->setParameter("oversampling", 2.0f);
+    reference.distortion->setParameter("oversampling", 2.0f);
+    expectSameOutput(fused, reference, 4, block);
+    fused.overdrive->setBypass(false);
+    reference.overdrive->setBypass(false);
+    fused.distortion->setParameter("oversampling", 1.0f);
+    reference.distortion->setParameter("oversampling", 1.0f);
+    expectSameOutput(fused, reference, 4, block);
+}
+
+TEST_F(FusionTest, MonoInputFusedBeforeWidening) {
+    Rig fused;
+    Rig reference;
+    build(fused, true);
+    build(reference, false);
+    
+    std::vector<float> input(BLOCK);
+    std::vector<float> left[2] = {std::vector<float>(BLOCK), std::vector<float>(BLOCK)};
+    std::vector<float> right[2] = {std::vector<float>(BLOCK), std::vector<float>(BLOCK)};
+    for (uint32_t block = 0; block < 8; ++block) {
+        fill(input, left[0], block);
+        float* out[2][2] = {{left[0].data(), right[0].data()}, {left[1].data(), right[1].data()}};
+        EXPECT_EQ(fused.chain.processMono(input.data(), out[0], BLOCK), 2u);
+        EXPECT_EQ(reference.chain.processMono(input.data(), out[1], BLOCK), 2u);
+        for (uint32_t i = 0; i < BLOCK; ++i) {
+            ASSERT_NEAR(left[0][i], left[1][i], 1e-5f) << i;
+            ASSERT_NEAR(right[0][i], right[1][i], 1e-5f) << i;
+        }
+    }
+}
+
+} // namespace tests
+} // namespace webamp
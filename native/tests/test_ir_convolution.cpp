@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include "partitioned_convolver.h"
+#include "nonuniform_convolver.h"
+#include "ir_convolution.h"
+#include "ir_loader.h"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <thread>
+
+namespace webamp {
+namespace tests {
+
+class IRConvolutionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        
+        // IR de cabinet typique : bruit à décroissance exponentielle
+        ir_.resize(3000);
+        for (size_t i = 0; i < ir_.size(); ++i) {
+            ir_[i] = dist(gen) * std::exp(-static_cast<float>(i) / 600.0f) * 0.1f;
+        }
+        
+        signal_.resize(6000);
+        for (auto& s : signal_) {
+            s = dist(gen) * 0.5f;
+        }
+    }
+    
+    // Convolution directe de référence
+    std::vector<float> directConvolution(const std::vector<float>& x, const std::vector<float>& h) const {
+        std::vector<float> y(x.size(), 0.0f);
+        for (size_t n = 0; n < x.size(); ++n) {
+            double acc = 0.0;
+            for (size_t k = 0; k < h.size() && k <= n; ++k) {
+                acc += static_cast<double>(x[n - k]) * h[k];
+            }
+            y[n] = static_cast<float>(acc);
+        }
+        return y;
+    }
+    
+    std::vector<float> ir_;
+    std::vector<float> signal_;
+};
+
+TEST_F(IRConvolutionTest, PartitionedMatchesDirectConvolution) {
+    PartitionedConvolver convolver;
+    ASSERT_TRUE(convolver.init(256, ir_.data(), ir_.size()));
+    EXPECT_EQ(convolver.getBlockSize(), 256u);
+    EXPECT_EQ(convolver.getPartitionCount(), 12u);
+    
+    // Blocs de tailles irrégulières : pas de latence, résultat identique
+    std::vector<float> output(signal_.size());
+    const size_t chunks[] = {1, 37, 256, 511, 128, 3, 1000};
+    size_t pos = 0;
+    size_t c = 0;
+    while (pos < signal_.size()) {
+        size_t n = std::min(chunks[c++ % 7], signal_.size() - pos);
+        convolver.process(signal_.data() + pos, output.data() + pos, n);
+        pos += n;
+    }
+    
+    auto reference = directConvolution(signal_, ir_);
+    for (size_t i = 0; i < signal_.size(); ++i) {
+        ASSERT_NEAR(output[i], reference[i], 1e-4f) << "sample " << i;
+    }
+}
+
+TEST_F(IRConvolutionTest, BlockSizeRoundedToPowerOfTwo) {
+    PartitionedConvolver convolver;
+    ASSERT_TRUE(convolver.init(100, ir_.data(), ir_.size()));
+    EXPECT_EQ(convolver.getBlockSize(), 128u);
+    EXPECT_FALSE(convolver.init(128, nullptr, 0));
+    EXPECT_FALSE(convolver.isInitialized());
+}
+
+TEST_F(IRConvolutionTest, EffectConvolvesBothChannels) {
+    auto loader = std::make_shared<IRLoader>();
+    loader->loadIRFromSamples(ir_.data(), ir_.size(), 44100);
+    
+    IRConvolution effect;
+    effect.setMaxBlockSize(128);
+    ASSERT_TRUE(effect.loadIR(loader));
+    EXPECT_EQ(effect.getPartitionSize(), 128u);
+    
+    const uint32_t frames = 2048;
+    std::vector<float> input(frames * 2);
+    for (uint32_t i = 0; i < frames; ++i) {
+        input[i * 2] = signal_[i];
+        input[i * 2 + 1] = -signal_[i];
+    }
+    std::vector<float> output(frames * 2);
+    
+    // Plus grand que la taille de partition : traité par sous-blocs
+    effect.process(input.data(), output.data(), 1000);
+    effect.process(input.data() + 2000, output.data() + 2000, frames - 1000);
+    
+    std::vector<float> left(signal_.begin(), signal_.begin() + frames);
+    auto reference = directConvolution(left, loader->getIRSamples());
+    for (uint32_t i = 0; i < frames; ++i) {
+        ASSERT_NEAR(output[i * 2], reference[i], 1e-4f);
+        ASSERT_NEAR(output[i * 2 + 1], -reference[i], 1e-4f);
+    }
+}
+
+TEST_F(IRConvolutionTest, NonUniformLayout) {
+    std::vector<float> longIR(12000, 0.001f);
+    NonUniformConvolver convolver;
+    NonUniformConvolver::Config config;
+    config.headSize = 64;
+    config.maxBlockSize = 1024;
+    ASSERT_TRUE(convolver.init(longIR.data(), longIR.size(), config));
+    
+    // Tête [0, 64), étages 64 @ 64, 256 @ 256, queue 1024 @ 3072 (3x son bloc)
+    EXPECT_EQ(convolver.getHeadSize(), 64u);
+    ASSERT_EQ(convolver.getStageCount(), 3u);
+    EXPECT_EQ(convolver.getStageOffset(0), 64u);
+    EXPECT_EQ(convolver.getStageOffset(1), 256u);
+    EXPECT_EQ(convolver.getStageOffset(2), 3072u);
+    EXPECT_EQ(convolver.getStageBlockSize(2), 1024u);
+    EXPECT_TRUE(convolver.hasBackgroundStage());
+}
+
+TEST_F(IRConvolutionTest, NonUniformMatchesDirectConvolution) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> longIR(12000);
+    for (size_t i = 0; i < longIR.size(); ++i) {
+        longIR[i] = dist(gen) * std::exp(-static_cast<float>(i) / 4000.0f) * 0.02f;
+    }
+    std::vector<float> signal(16000);
+    for (auto& x : signal) {
+        x = dist(gen) * 0.5f;
+    }
+    auto reference = directConvolution(signal, longIR);
+    
+    // Queue en arrière-plan puis dans le callback : résultats identiques, sans latence
+    for (bool background : {true, false}) {
+        NonUniformConvolver convolver;
+        NonUniformConvolver::Config config;
+        config.headSize = 64;
+        config.maxBlockSize = 1024;
+        config.backgroundTail = background;
+        ASSERT_TRUE(convolver.init(longIR.data(), longIR.size(), config));
+        EXPECT_EQ(convolver.hasBackgroundStage(), background);
+        
+        std::vector<float> output(signal.size());
+        const size_t chunks[] = {64, 17, 128, 300, 1, 64};
+        size_t pos = 0;
+        size_t c = 0;
+        while (pos < signal.size()) {
+            size_t n = std::min(chunks[c++ % 6], signal.size() - pos);
+            convolver.process(signal.data() + pos, output.data() + pos, n);
+            pos += n;
+        }
+        
+        for (size_t i = 0; i < signal.size(); ++i) {
+            ASSERT_NEAR(output[i], reference[i], 1e-4f) << "sample " << i << " background " << background;
+        }
+    }
+}
+
+TEST_F(IRConvolutionTest, NonUniformTailReadyInRealtime) {
+    std::vector<float> longIR(12000, 0.001f);
+    NonUniformConvolver convolver;
+    NonUniformConvolver::Config config;
+    config.headSize = 64;
+    config.maxBlockSize = 1024;
+    ASSERT_TRUE(convolver.init(longIR.data(), longIR.size(), config));
+    ASSERT_TRUE(convolver.hasBackgroundStage());
+    
+    // Cadence temps réel : la queue, remise deux blocs avant d'être requise,
+    // est toujours prête et le thread audio n'attend jamais
+    const size_t block = 256;
+    std::vector<float> input(block, 0.25f);
+    std::vector<float> output(block);
+    for (int i = 0; i < 48; ++i) {
+        convolver.process(input.data(), output.data(), block);
+        std::this_thread::sleep_for(std::chrono::microseconds(block * 1000000 / 44100));
+    }
+    EXPECT_EQ(convolver.getWorkerWaitCount(), 0u);
+}
+
+TEST_F(IRConvolutionTest, LongIRUsesNonUniformPartition) {
+    std::vector<float> longIR(IRConvolution::LONG_IR_THRESHOLD * 2, 0.0f);
+    longIR[0] = 1.0f;
+    auto loader = std::make_shared<IRLoader>();
+    loader->loadIRFromSamples(longIR.data(), longIR.size(), 44100);
+    
+    IRConvolution effect;
+    ASSERT_TRUE(effect.loadIR(loader));
+    EXPECT_TRUE(effect.isUsingNonUniformPartition());
+    EXPECT_EQ(effect.getPartitionSize(), IRConvolution::MIN_PARTITION_SIZE);
+}
+
+TEST_F(IRConvolutionTest, WithoutIRPassesThrough) {
+    IRConvolution effect;
+    std::vector<float> input(256, 0.25f);
+    std::vector<float> output(256, 0.0f);
+    effect.process(input.data(), output.data(), 128);
+    for (float s : output) {
+        EXPECT_FLOAT_EQ(s, 0.25f);
+    }
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+#include "compensation_delay.h"
+#include "effect_chain.h"
+#include "parallel_effect.h"
+#include "effects/distortion.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+// Retard pur de N échantillons qui rapporte sa latence
+class DelayTestEffect : public EffectBase {
+public:
+    explicit DelayTestEffect(uint32_t delay) : delay_(delay) {
+        for (auto& history : history_) {
+            history.assign(delay, 0.0f);
+        }
+    }
+    
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override {
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            auto& history = history_[ch];
+            for (uint32_t i = 0; i < frameCount; ++i) {
+                const float sample = input[ch][i];
+                history.push_back(sample);
+                output[ch][i] = history.front();
+                history.erase(history.begin());
+            }
+        }
+    }
+    
+    uint32_t getLatency() const override { return delay_; }
+    
+    std::vector<Parameter> getParameters() const override { return {}; }
+    void setParameter(const std::string&, float) override {}
+    float getParameter(const std::string&) const override { return 0.0f; }
+    std::string getName() const override { return "Delay"; }
+    std::string getType() const override { return "delay-test"; }
+
+private:
+    uint32_t delay_;
+    std::vector<float> history_[MAX_CHANNELS];
+};
+
+TEST(LatencyTest, CompensationDelayReservesLinesOnControlThread) {
+    BufferPool pool(CompensationDelay::MAX_DELAY, 2);
+    CompensationDelay delay(&pool);
+    
+    std::vector<float> left(64, 0.0f);
+    std::vector<float> right(64, 0.0f);
+    left[0] = 1.0f;
+    right[1] = -1.0f;
+    float* channels[2] = {left.data(), right.data()};
+    
+    // Non réservé : aucun emprunt sur le thread audio, échec signalé
+    EXPECT_FALSE(delay.process(channels, channels, 2, 64, 5));
+    EXPECT_EQ(delay.getFailureCount(), 1u);
+    EXPECT_EQ(pool.getAvailableCount(), 2u);
+    EXPECT_EQ(left[0], 1.0f);
+    
+    // Réservé : une ligne par canal, retard de 5 en place
+    ASSERT_TRUE(delay.reserve());
+    EXPECT_EQ(pool.getAvailableCount(), 0u);
+    EXPECT_TRUE(delay.process(channels, channels, 2, 64, 5));
+    EXPECT_EQ(delay.getDelay(), 5u);
+    for (uint32_t i = 0; i < 64; ++i) {
+        EXPECT_EQ(left[i], i == 5 ? 1.0f : 0.0f) << i;
+        EXPECT_EQ(right[i], i == 6 ? -1.0f : 0.0f) << i;
+    }
+    EXPECT_EQ(delay.getFailureCount(), 1u);
+    
+    // Retard nul : l'historique continue d'être enregistré, un retard
+    // rétabli relit les échantillons réels
+    std::fill(left.begin(), left.end(), 0.0f);
+    std::fill(right.begin(), right.end(), 0.0f);
+    left[63] = 1.0f;
+    EXPECT_TRUE(delay.process(channels, channels, 2, 64, 0));
+    EXPECT_EQ(left[63], 1.0f);
+    std::fill(left.begin(), left.end(), 0.0f);
+    EXPECT_TRUE(delay.process(channels, channels, 2, 64, 2));
+    EXPECT_EQ(left[1], 1.0f);
+    
+    // Pool épuisé : réservation refusée, rien n'est gardé
+    delay.release();
+    EXPECT_EQ(pool.getAvailableCount(), 2u);
+    auto held = pool.borrow();
+    EXPECT_FALSE(delay.reserve());
+    EXPECT_EQ(pool.getAvailableCount(), 1u);
+}
+
+TEST(LatencyTest, ChainSumsActiveEffects) {
+    auto distortion = std::make_shared<DistortionEffect>();
+    distortion->setSampleRate(48000);
+    EXPECT_EQ(distortion->getLatency(), 0u);
+    distortion->setParameter("oversampling", 4.0f);
+    EXPECT_EQ(distortion->getLatency(), static_cast<uint32_t>(std::lround(
+        Oversampler::getLatency(4, Oversampler::Phase::Linear) +
+        distortion->getWaveshaper().getLatency() / 4.0f)));
+    EXPECT_GT(distortion->getLatency(), 0u);
+    
+    auto delay = std::make_shared<DelayTestEffect>(10);
+    EffectChain chain;
+    chain.prepare(128);
+    chain.addEffect(distortion);
+    chain.addEffect(delay);
+    EXPECT_EQ(chain.getLatency(), distortion->getLatency() + 10u);
+    
+    // Un effet contourné n'ajoute pas de latence (pris en compte au bloc suivant)
+    delay->setBypass(true);
+    std::vector<float> buffer(128 * 2, 0.0f);
+    chain.process(buffer.data(), buffer.data(), 128);
+    EXPECT_EQ(chain.getLatency(), distortion->getLatency());
+}
+
+TEST(LatencyTest, LatencyFollowsQualityTier) {
+    auto expected = [](uint32_t factor, const Waveshaper& shaper) {
+        return static_cast<uint32_t>(std::lround(
+            Oversampler::getLatency(factor, Oversampler::Phase::Linear) + shaper.getLatency() / factor));
+    };
+
+    // Le niveau de qualité divise le facteur appliqué : la latence rapportée
+    // est celle du facteur qui tourne, pas du facteur demandé
+    DistortionEffect distortion;
+    distortion.setSampleRate(48000);
+    distortion.setParameter("oversampling", 8.0f);
+    const Waveshaper& shaper = distortion.getWaveshaper();
+    EXPECT_EQ(distortion.getLatency(), expected(8, shaper));
+    distortion.setQualityTier(1);
+    EXPECT_EQ(distortion.getOversampler().getEffectiveFactor(), 4u);
+    EXPECT_EQ(distortion.getLatency(), expected(4, shaper));
+    distortion.setQualityTier(3);
+    EXPECT_EQ(distortion.getOversampler().getEffectiveFactor(), 1u);
+    EXPECT_EQ(distortion.getLatency(), expected(1, shaper));
+    distortion.setQualityTier(0);
+    EXPECT_EQ(distortion.getLatency(), expected(8, shaper));
+    EXPECT_NE(expected(8, shaper), expected(4, shaper));
+}
+
+TEST(LatencyTest, QualityLevelUpdatesChainAndCompensation) {
+    // Branche 1 : distorsion suréchantillonnée 8x, branche 2 : chemin sec
+    auto distortion = std::make_shared<DistortionEffect>();
+    distortion->setSampleRate(48000);
+    distortion->setParameter("oversampling", 8.0f);
+    const uint32_t full = distortion->getLatency();
+    auto node = std::make_shared<ParallelEffect>(2);
+    node->setParallel(false);
+    node->addEffect(0, distortion);
+
+    EffectChain chain;
+    chain.prepare(64);
+    chain.addEffect(node);
+    EXPECT_EQ(chain.getLatency(), full);
+
+    // Dès le bloc où le niveau change : le nœud et la chaîne rapportent la
+    // latence du facteur dégradé
+    std::vector<float> buffer(64 * 2, 0.0f);
+    chain.setQualityLevel(2);
+    chain.process(buffer.data(), buffer.data(), 64);
+    const uint32_t degraded = distortion->getLatency();
+    EXPECT_EQ(distortion->getOversampler().getActiveFactor(), 2u);
+    EXPECT_LT(degraded, full);
+    EXPECT_EQ(node->getLatency(), degraded);
+    EXPECT_EQ(chain.getLatency(), degraded);
+
+    chain.setQualityLevel(0);
+    chain.process(buffer.data(), buffer.data(), 64);
+    EXPECT_EQ(node->getLatency(), full);
+    EXPECT_EQ(chain.getLatency(), full);
+}
+
+TEST(LatencyTest, ParallelBranchesAligned) {
+    // Branche 1 vide (chemin sec), branche 2 retardée de 10 échantillons
+    ParallelEffect parallel(2);
+    parallel.setParallel(false);
+    parallel.setMaxBlockSize(64);
+    parallel.addEffect(1, std::make_shared<DelayTestEffect>(10));
+    EXPECT_EQ(parallel.getLatency(), 10u);
+    
+    std::vector<float> left(64, 0.0f);
+    std::vector<float> right(64, 0.0f);
+    left[3] = 1.0f;
+    right[3] = 1.0f;
+    float* channels[2] = {left.data(), right.data()};
+    parallel.process(channels, channels, 2, 64);
+    
+    // Les deux impulsions se somment au même instant
+    for (uint32_t i = 0; i < 64; ++i) {
+        EXPECT_FLOAT_EQ(left[i], i == 13 ? 2.0f : 0.0f) << i;
+        EXPECT_FLOAT_EQ(right[i], i == 13 ? 2.0f : 0.0f) << i;
+    }
+    
+    // Le nœud rapporte la latence de la branche la plus lente à la chaîne
+    auto node = std::make_shared<ParallelEffect>(2);
+    node->addEffect(0, std::make_shared<DelayTestEffect>(4));
+    node->addEffect(1, std::make_shared<DelayTestEffect>(7));
+    EffectChain chain;
+    chain.addEffect(node);
+    EXPECT_EQ(chain.getLatency(), 7u);
+}
+
+TEST(LatencyTest, ParallelCompensationSurvivesEdits) {
+    // Impulsions régulières, branche 2 retardée de 10 : une modification de
+    // la topologie en cours de route ne remet pas la ligne à zéro
+    auto render = [](bool edit) {
+        ParallelEffect parallel(2);
+        parallel.setParallel(false);
+        parallel.setMaxBlockSize(16);
+        parallel.addEffect(1, std::make_shared<DelayTestEffect>(10));
+        
+        std::vector<float> output;
+        for (int block = 0; block < 8; ++block) {
+            if (edit && block == 4) {
+                auto bypassed = std::make_shared<DelayTestEffect>(0);
+                bypassed->setBypass(true);
+                parallel.addEffect(0, bypassed);
+            }
+            std::vector<float> left(16, 0.0f);
+            std::vector<float> right(16, 0.0f);
+            left[block % 16] = 1.0f;
+            left[15] = 0.5f;
+            float* channels[2] = {left.data(), right.data()};
+            parallel.process(channels, channels, 2, 16);
+            output.insert(output.end(), left.begin(), left.end());
+        }
+        EXPECT_EQ(parallel.getCompensationFailureCount(), 0u);
+        return output;
+    };
+    
+    const auto reference = render(false);
+    const auto edited = render(true);
+    for (size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_FLOAT_EQ(edited[i], reference[i]) << i;
+    }
+}
+
+TEST(LatencyTest, ParallelCompensationLinesPerNode) {
+    // Lignes propres à chaque nœud : aucun épuisement d'un pool commun
+    std::vector<std::unique_ptr<ParallelEffect>> nodes;
+    for (int n = 0; n < 40; ++n) {
+        nodes.push_back(std::make_unique<ParallelEffect>(ParallelEffect::MAX_BRANCHES));
+        EXPECT_TRUE(nodes.back()->isCompensationReserved()) << n;
+    }
+    
+    auto& node = *nodes.back();
+    node.setParallel(false);
+    node.setMaxBlockSize(64);
+    node.addEffect(0, std::make_shared<DelayTestEffect>(7));
+    std::vector<float> left(64, 0.0f);
+    std::vector<float> right(64, 0.0f);
+    float* channels[2] = {left.data(), right.data()};
+    node.process(channels, channels, 2, 64);
+    EXPECT_EQ(node.getCompensationFailureCount(), 0u);
+}
+
+} // namespace tests
+} // namespace webamp
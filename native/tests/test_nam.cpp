@@ -0,0 +1,504 @@
+#include <gtest/gtest.h>
+#include "nam_loader.h"
+#include "nam_inference.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+// Configuration d'un étage WaveNet pour les tests
+struct WaveNetArraySpec {
+    size_t inputSize;
+    size_t channels;
+    size_t headSize;
+    size_t kernelSize;
+    std::vector<size_t> dilations;
+    bool gated;
+    bool headBias;
+};
+
+class NAMTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        signal_.resize(1500);
+        for (auto& s : signal_) {
+            s = dist(gen) * 0.5f;
+        }
+    }
+    
+    static std::vector<float> randomWeights(size_t count, float scale, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dist(-scale, scale);
+        std::vector<float> weights(count);
+        for (auto& w : weights) {
+            w = dist(gen);
+        }
+        return weights;
+    }
+    
+    static std::string formatWeights(const std::vector<float>& weights) {
+        std::ostringstream out;
+        out << std::setprecision(9) << "[";
+        for (size_t i = 0; i < weights.size(); ++i) {
+            out << (i ? "," : "") << weights[i];
+        }
+        out << "]";
+        return out.str();
+    }
+    
+    static std::string formatSizes(const std::vector<size_t>& values) {
+        std::ostringstream out;
+        out << "[";
+        for (size_t i = 0; i < values.size(); ++i) {
+            out << (i ? "," : "") << values[i];
+        }
+        out << "]";
+        return out.str();
+    }
+    
+    static std::string makeDocument(const std::string& architecture, const std::string& config, const std::vector<float>& weights) {
+        return "{\"version\":\"0.5.2\",\"architecture\":\"" + architecture + "\",\"config\":" + config +
+               ",\"metadata\":{\"name\":\"Test " + architecture + "\",\"modeled_by\":\"WebAmp\",\"gear_type\":\"amp\"}" +
+               ",\"sample_rate\":48000,\"weights\":" + formatWeights(weights) + "}";
+    }
+    
+    static std::string waveNetConfig(const std::vector<WaveNetArraySpec>& arrays) {
+        std::ostringstream out;
+        out << "{\"layers\":[";
+        for (size_t a = 0; a < arrays.size(); ++a) {
+            const auto& spec = arrays[a];
+            out << (a ? "," : "") << "{\"input_size\":" << spec.inputSize << ",\"condition_size\":1"
+                << ",\"head_size\":" << spec.headSize << ",\"channels\":" << spec.channels
+                << ",\"kernel_size\":" << spec.kernelSize << ",\"dilations\":" << formatSizes(spec.dilations)
+                << ",\"activation\":\"Tanh\",\"gated\":" << (spec.gated ? "true" : "false")
+                << ",\"head_bias\":" << (spec.headBias ? "true" : "false") << "}";
+        }
+        out << "],\"head\":null,\"head_scale\":0.02}";
+        return out.str();
+    }
+    
+    static std::unique_ptr<NAMDSP> createDSP(const std::string& json, size_t maxBlockSize = 64) {
+        return NAMDSP::create(JsonParser::parseDocument(json), maxBlockSize);
+    }
+    
+    // Traitement par blocs de tailles variables
+    static std::vector<float> processInBlocks(NAMDSP& dsp, const std::vector<float>& input) {
+        std::vector<float> output(input.size());
+        const size_t sizes[] = {64, 17, 1, 100, 33};
+        size_t pos = 0;
+        size_t i = 0;
+        while (pos < input.size()) {
+            const size_t count = std::min(sizes[i++ % 5], input.size() - pos);
+            dsp.process(input.data() + pos, output.data() + pos, count);
+            pos += count;
+        }
+        return output;
+    }
+    
+    static double sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+    
+    // WaveNet de référence (double précision, hors ligne) : renvoie le nombre de poids lus
+    static size_t referenceWaveNet(const std::vector<WaveNetArraySpec>& arrays, const std::vector<float>& w,
+                                   const std::vector<float>& x, std::vector<float>& y) {
+        const size_t n = x.size();
+        size_t pos = 0;
+        std::vector<std::vector<double>> previous(n, std::vector<double>(1));
+        for (size_t t = 0; t < n; ++t) previous[t][0] = x[t];
+        std::vector<std::vector<double>> headIn(n, std::vector<double>(arrays[0].channels, 0.0));
+        
+        for (const auto& spec : arrays) {
+            const size_t c = spec.channels;
+            const size_t convOut = spec.gated ? 2 * c : c;
+            std::vector<std::vector<double>> current(n, std::vector<double>(c, 0.0));
+            for (size_t o = 0; o < c; ++o) {
+                for (size_t i = 0; i < spec.inputSize; ++i) {
+                    const double weight = w[pos++];
+                    for (size_t t = 0; t < n; ++t) current[t][o] += weight * previous[t][i];
+                }
+            }
+            
+            for (size_t d : spec.dilations) {
+                const size_t k = spec.kernelSize;
+                std::vector<double> conv(convOut * c * k), bias(convOut), mix(convOut), proj(c * c), projBias(c);
+                for (auto& v : conv) v = w[pos++];
+                for (auto& v : bias) v = w[pos++];
+                for (auto& v : mix) v = w[pos++];
+                for (auto& v : proj) v = w[pos++];
+                for (auto& v : projBias) v = w[pos++];
+                
+                std::vector<std::vector<double>> next(n, std::vector<double>(c, 0.0));
+                for (size_t t = 0; t < n; ++t) {
+                    std::vector<double> z(convOut);
+                    for (size_t o = 0; o < convOut; ++o) {
+                        double acc = bias[o] + mix[o] * x[t];
+                        for (size_t i = 0; i < c; ++i) {
+                            for (size_t tap = 0; tap < k; ++tap) {
+                                const size_t lag = (k - 1 - tap) * d;
+                                if (t >= lag) acc += conv[(o * c + i) * k + tap] * current[t - lag][i];
+                            }
+                        }
+                        z[o] = acc;
+                    }
+                    std::vector<double> a(c);
+                    for (size_t i = 0; i < c; ++i) {
+                        a[i] = std::tanh(z[i]) * (spec.gated ? sigmoid(z[c + i]) : 1.0);
+                        headIn[t][i] += a[i];
+                    }
+                    for (size_t o = 0; o < c; ++o) {
+                        double acc = current[t][o] + projBias[o];
+                        for (size_t i = 0; i < c; ++i) acc += proj[o * c + i] * a[i];
+                        next[t][o] = acc;
+                    }
+                }
+                current = next;
+            }
+            
+            std::vector<std::vector<double>> headOut(n, std::vector<double>(spec.headSize, 0.0));
+            for (size_t h = 0; h < spec.headSize; ++h) {
+                for (size_t i = 0; i < c; ++i) {
+                    const double weight = w[pos++];
+                    for (size_t t = 0; t < n; ++t) headOut[t][h] += weight * headIn[t][i];
+                }
+            }
+            if (spec.headBias) {
+                for (size_t h = 0; h < spec.headSize; ++h) {
+                    const double bias = w[pos++];
+                    for (size_t t = 0; t < n; ++t) headOut[t][h] += bias;
+                }
+            }
+            previous = current;
+            headIn = headOut;
+        }
+        
+        const double scale = w[pos++];
+        y.resize(n);
+        for (size_t t = 0; t < n; ++t) y[t] = static_cast<float>(scale * headIn[t][0]);
+        return pos;
+    }
+    
+    std::vector<float> signal_;
+};
+
+TEST_F(NAMTest, JsonDocumentParsing) {
+    JsonValue doc = JsonParser::parseDocument("{\"a\":[1,2.5,-3e2],\"b\":{\"c\":\"x\",\"d\":true},\"e\":null}");
+    ASSERT_TRUE(doc.isObject());
+    ASSERT_EQ(doc["a"].size(), 3u);
+    EXPECT_DOUBLE_EQ(doc["a"][1].asNumber(), 2.5);
+    EXPECT_DOUBLE_EQ(doc["a"][2].asNumber(), -300.0);
+    EXPECT_EQ(doc["b"]["c"].asString(), "x");
+    EXPECT_TRUE(doc["b"]["d"].asBool());
+    EXPECT_TRUE(doc["e"].isNull());
+    EXPECT_TRUE(doc["missing"].isNull());
+    
+    EXPECT_THROW(JsonParser::parseDocument("{\"a\":[1,2}"), std::runtime_error);
+}
+
+TEST_F(NAMTest, ActivationApproximations) {
+    for (float x = -10.0f; x <= 10.0f; x += 0.01f) {
+        EXPECT_NEAR(NAMKernels::tanhApprox(x), std::tanh(x), 1e-5f);
+        EXPECT_NEAR(NAMKernels::sigmoidApprox(x), 1.0f / (1.0f + std::exp(-x)), 1e-5f);
+    }
+    
+    // Version vectorisée identique à la version scalaire
+    std::vector<float> values(37);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = -4.0f + 0.2f * static_cast<float>(i);
+    }
+    std::vector<float> activated = values;
+    NAMKernels::activate(NAMActivation::Tanh, activated.data(), activated.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_NEAR(activated[i], NAMKernels::tanhApprox(values[i]), 1e-6f);
+    }
+}
+
+TEST_F(NAMTest, WaveNetMatchesReference) {
+    for (bool gated : {false, true}) {
+        const std::vector<WaveNetArraySpec> arrays = {
+            {1, 6, 3, 3, {1, 2, 4, 8, 16}, gated, false},
+            {6, 3, 1, 3, {1, 2, 4}, gated, true},
+        };
+        std::vector<float> weights = randomWeights(4000, 0.3f, gated ? 2 : 1);
+        std::vector<float> expected;
+        weights.resize(referenceWaveNet(arrays, weights, signal_, expected));
+        
+        auto dsp = createDSP(makeDocument("WaveNet", waveNetConfig(arrays), weights));
+        ASSERT_NE(dsp, nullptr);
+        EXPECT_STREQ(dsp->getArchitecture(), "WaveNet");
+        
+        const std::vector<float> output = processInBlocks(*dsp, signal_);
+        for (size_t t = 0; t < signal_.size(); ++t) {
+            ASSERT_NEAR(output[t], expected[t], 1e-4f) << "gated=" << gated << " t=" << t;
+        }
+    }
+}
+
+TEST_F(NAMTest, PresetShapesUseSpecialisedKernels) {
+    const std::vector<size_t> full = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+    const std::vector<size_t> shortDilations = {1, 2, 4, 8, 16, 32, 64};
+    const std::vector<size_t> wrapped = {128, 256, 512, 1, 2, 4, 8, 16, 32, 64};
+    const struct {
+        const char* name;
+        std::vector<WaveNetArraySpec> arrays;
+    } presets[] = {
+        {"standard", {{1, 16, 8, 3, full, false, false}, {16, 8, 1, 3, full, false, true}}},
+        {"lite", {{1, 12, 6, 3, shortDilations, false, false}, {12, 6, 1, 3, wrapped, false, true}}},
+        {"feather", {{1, 8, 4, 3, shortDilations, false, false}, {8, 4, 1, 3, wrapped, false, true}}},
+        {"nano", {{1, 4, 2, 3, shortDilations, false, false}, {4, 2, 1, 3, wrapped, false, true}}},
+    };
+    
+    for (const auto& preset : presets) {
+        std::vector<float> weights = randomWeights(20000, 0.1f, 11);
+        std::vector<float> expected;
+        weights.resize(referenceWaveNet(preset.arrays, weights, signal_, expected));
+        
+        auto dsp = createDSP(makeDocument("WaveNet", waveNetConfig(preset.arrays), weights));
+        auto* waveNet = dynamic_cast<NAMWaveNet*>(dsp.get());
+        ASSERT_NE(waveNet, nullptr);
+        EXPECT_STREQ(waveNet->getPreset(), preset.name);
+        EXPECT_TRUE(waveNet->isSpecialised()) << preset.name;
+        
+        const std::vector<float> output = processInBlocks(*dsp, signal_);
+        for (size_t t = 0; t < signal_.size(); ++t) {
+            ASSERT_NEAR(output[t], expected[t], 1e-4f) << preset.name << " t=" << t;
+        }
+    }
+    
+    // Formes non couvertes : noyau générique
+    const std::vector<WaveNetArraySpec> custom = {
+        {1, 5, 3, 3, {1, 2}, false, false},
+        {5, 3, 1, 2, {1, 2}, false, true},
+    };
+    std::vector<float> weights = randomWeights(2000, 0.3f, 12);
+    std::vector<float> unused;
+    weights.resize(referenceWaveNet(custom, weights, std::vector<float>(1, 0.0f), unused));
+    auto dsp = createDSP(makeDocument("WaveNet", waveNetConfig(custom), weights));
+    auto* waveNet = dynamic_cast<NAMWaveNet*>(dsp.get());
+    ASSERT_NE(waveNet, nullptr);
+    EXPECT_STREQ(waveNet->getPreset(), "custom");
+    EXPECT_FALSE(waveNet->isSpecialised());
+    EXPECT_EQ(NAMKernels::findWaveNetLayerKernel(16, 3, true, NAMActivation::Tanh), nullptr);
+    EXPECT_EQ(NAMKernels::findWaveNetLayerKernel(16, 3, false, NAMActivation::ReLU), nullptr);
+}
+
+TEST_F(NAMTest, LSTMMatchesReference) {
+    const size_t layers = 2;
+    const size_t hidden = 5;
+    
+    // Poids : par couche W (4H x (in + H)), b (4H), h0 (H), c0 (H) ; puis tête (H + 1)
+    size_t count = 0;
+    for (size_t l = 0; l < layers; ++l) {
+        const size_t in = (l == 0) ? 1 : hidden;
+        count += 4 * hidden * (in + hidden) + 4 * hidden + 2 * hidden;
+    }
+    count += hidden + 1;
+    const std::vector<float> weights = randomWeights(count, 0.5f, 3);
+    
+    auto dsp = createDSP(makeDocument("LSTM", "{\"num_layers\":2,\"input_size\":1,\"hidden_size\":5}", weights));
+    const std::vector<float> output = processInBlocks(*dsp, signal_);
+    
+    // Référence
+    struct RefCell { size_t in; std::vector<double> w, b, h, c; };
+    std::vector<RefCell> cells(layers);
+    size_t pos = 0;
+    for (size_t l = 0; l < layers; ++l) {
+        RefCell& cell = cells[l];
+        cell.in = (l == 0) ? 1 : hidden;
+        cell.w.resize(4 * hidden * (cell.in + hidden));
+        cell.b.resize(4 * hidden);
+        cell.h.resize(hidden);
+        cell.c.resize(hidden);
+        for (auto& v : cell.w) v = weights[pos++];
+        for (auto& v : cell.b) v = weights[pos++];
+        for (auto& v : cell.h) v = weights[pos++];
+        for (auto& v : cell.c) v = weights[pos++];
+    }
+    std::vector<double> head(hidden);
+    for (auto& v : head) v = weights[pos++];
+    const double headBias = weights[pos++];
+    
+    for (size_t t = 0; t < signal_.size(); ++t) {
+        std::vector<double> x(1, signal_[t]);
+        for (auto& cell : cells) {
+            std::vector<double> xh = x;
+            xh.insert(xh.end(), cell.h.begin(), cell.h.end());
+            std::vector<double> g(4 * hidden);
+            for (size_t r = 0; r < 4 * hidden; ++r) {
+                double acc = cell.b[r];
+                for (size_t j = 0; j < xh.size(); ++j) acc += cell.w[r * xh.size() + j] * xh[j];
+                g[r] = acc;
+            }
+            for (size_t k = 0; k < hidden; ++k) {
+                cell.c[k] = sigmoid(g[hidden + k]) * cell.c[k] + sigmoid(g[k]) * std::tanh(g[2 * hidden + k]);
+                cell.h[k] = sigmoid(g[3 * hidden + k]) * std::tanh(cell.c[k]);
+            }
+            x = cell.h;
+        }
+        double expected = headBias;
+        for (size_t k = 0; k < hidden; ++k) expected += head[k] * x[k];
+        ASSERT_NEAR(output[t], expected, 1e-4) << "t=" << t;
+    }
+}
+
+TEST_F(NAMTest, ConvNetMatchesReference) {
+    const size_t channels = 5;
+    const std::vector<size_t> dilations = {1, 2, 4, 8};
+    
+    // Par bloc : conv (C x in x 2), batchnorm (4C + 1) ; puis tête (C + 1)
+    size_t count = 0;
+    for (size_t b = 0; b < dilations.size(); ++b) {
+        count += channels * (b == 0 ? 1 : channels) * 2 + 4 * channels + 1;
+    }
+    count += channels + 1;
+    std::vector<float> weights = randomWeights(count, 0.5f, 4);
+    
+    // Variances et epsilon positifs
+    size_t pos = 0;
+    for (size_t b = 0; b < dilations.size(); ++b) {
+        pos += channels * (b == 0 ? 1 : channels) * 2;
+        pos += channels;
+        for (size_t k = 0; k < channels; ++k) weights[pos + k] = std::fabs(weights[pos + k]) + 0.5f;
+        pos += 3 * channels;
+        weights[pos++] = 1e-5f;
+    }
+    
+    const std::string config = "{\"channels\":5,\"dilations\":[1,2,4,8],\"batchnorm\":true,\"activation\":\"Tanh\"}";
+    auto dsp = createDSP(makeDocument("ConvNet", config, weights));
+    const std::vector<float> output = processInBlocks(*dsp, signal_);
+    
+    // Référence
+    const size_t n = signal_.size();
+    std::vector<std::vector<double>> current(n, std::vector<double>(1));
+    for (size_t t = 0; t < n; ++t) current[t][0] = signal_[t];
+    pos = 0;
+    for (size_t d : dilations) {
+        const size_t in = current[0].size();
+        std::vector<double> conv(channels * in * 2);
+        for (auto& v : conv) v = weights[pos++];
+        std::vector<double> mean(channels), var(channels), gamma(channels), beta(channels);
+        for (auto& v : mean) v = weights[pos++];
+        for (auto& v : var) v = weights[pos++];
+        for (auto& v : gamma) v = weights[pos++];
+        for (auto& v : beta) v = weights[pos++];
+        const double eps = weights[pos++];
+        
+        std::vector<std::vector<double>> next(n, std::vector<double>(channels));
+        for (size_t t = 0; t < n; ++t) {
+            for (size_t o = 0; o < channels; ++o) {
+                double acc = 0.0;
+                for (size_t i = 0; i < in; ++i) {
+                    if (t >= d) acc += conv[(o * in + i) * 2] * current[t - d][i];
+                    acc += conv[(o * in + i) * 2 + 1] * current[t][i];
+                }
+                acc = (acc - mean[o]) / std::sqrt(var[o] + eps) * gamma[o] + beta[o];
+                next[t][o] = std::tanh(acc);
+            }
+        }
+        current = next;
+    }
+    std::vector<double> head(channels);
+    for (auto& v : head) v = weights[pos++];
+    const double headBias = weights[pos++];
+    
+    for (size_t t = 0; t < n; ++t) {
+        double expected = headBias;
+        for (size_t o = 0; o < channels; ++o) expected += head[o] * current[t][o];
+        ASSERT_NEAR(output[t], expected, 1e-4) << "t=" << t;
+    }
+}
+
+TEST_F(NAMTest, LinearMatchesFIR) {
+    const std::vector<float> weights = randomWeights(33, 0.5f, 5);
+    auto dsp = createDSP(makeDocument("Linear", "{\"receptive_field\":32,\"bias\":true}", weights));
+    const std::vector<float> output = processInBlocks(*dsp, signal_);
+    
+    for (size_t t = 0; t < signal_.size(); ++t) {
+        double expected = weights[32];
+        for (size_t j = 0; j < 32 && j <= t; ++j) {
+            expected += static_cast<double>(weights[j]) * signal_[t - j];
+        }
+        ASSERT_NEAR(output[t], expected, 1e-4) << "t=" << t;
+    }
+}
+
+TEST_F(NAMTest, ModelLoadsMetadataAndProcesses) {
+    const std::vector<float> weights = randomWeights(9, 0.5f, 6);
+    const std::string json = makeDocument("Linear", "{\"receptive_field\":8,\"bias\":true}", weights);
+    
+    NAMModel model;
+    ASSERT_TRUE(model.loadFromMemory(reinterpret_cast<const uint8_t*>(json.data()), json.size()));
+    EXPECT_TRUE(model.isValid());
+    EXPECT_STREQ(model.getArchitecture(), "Linear");
+    EXPECT_EQ(model.getMetadata().name, "Test Linear");
+    EXPECT_EQ(model.getMetadata().author, "WebAmp");
+    EXPECT_EQ(model.getMetadata().sampleRate, 48000);
+    
+    // Impulsion : la réponse est le FIR (plus le biais)
+    std::vector<float> buffer(16, 0.0f);
+    buffer[0] = 1.0f;
+    model.processAudio(buffer.data(), buffer.data(), buffer.size(), 48000);
+    for (size_t t = 0; t < 8; ++t) {
+        EXPECT_NEAR(buffer[t], weights[t] + weights[8], 1e-5f);
+    }
+    EXPECT_NEAR(buffer[12], weights[8], 1e-5f);
+}
+
+TEST_F(NAMTest, InvalidModelsRejected) {
+    NAMModel model;
+    
+    const std::string unknown = makeDocument("Transformer", "{}", {1.0f});
+    EXPECT_FALSE(model.loadFromMemory(reinterpret_cast<const uint8_t*>(unknown.data()), unknown.size()));
+    
+    // Poids manquants
+    const std::string truncated = makeDocument("Linear", "{\"receptive_field\":8,\"bias\":true}", randomWeights(5, 0.5f, 7));
+    EXPECT_FALSE(model.loadFromMemory(reinterpret_cast<const uint8_t*>(truncated.data()), truncated.size()));
+    
+    const std::string notJson = "not a model";
+    EXPECT_FALSE(model.loadFromMemory(reinterpret_cast<const uint8_t*>(notJson.data()), notJson.size()));
+    EXPECT_FALSE(model.isValid());
+}
+
+TEST_F(NAMTest, StandardWaveNetProcessesBlocks) {
+    // Architecture "standard" : 16 puis 8 canaux, dilatations 1..512. Le
+    // coût temps réel est mesuré par BM_NAMWaveNetStandard (benchmarks).
+    const std::vector<size_t> dilations = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+    const std::vector<WaveNetArraySpec> arrays = {
+        {1, 16, 8, 3, dilations, false, false},
+        {16, 8, 1, 3, dilations, false, true},
+    };
+    std::vector<float> weights = randomWeights(20000, 0.1f, 8);
+    std::vector<float> unused;
+    weights.resize(referenceWaveNet(arrays, weights, std::vector<float>(1, 0.0f), unused));
+    
+    auto dsp = createDSP(makeDocument("WaveNet", waveNetConfig(arrays), weights), 64);
+    ASSERT_NE(dsp, nullptr);
+    EXPECT_STREQ(dsp->getArchitecture(), "WaveNet");
+    
+    // Au-delà du champ réceptif (2 x 1023 échantillons), blocs de 64 frames
+    const size_t blockSize = 64;
+    std::vector<float> block(blockSize);
+    bool finite = true;
+    float peak = 0.0f;
+    for (size_t pos = 0; pos < 4096; pos += blockSize) {
+        for (size_t i = 0; i < blockSize; ++i) {
+            block[i] = signal_[(pos + i) % signal_.size()];
+        }
+        dsp->process(block.data(), block.data(), blockSize);
+        for (float sample : block) {
+            finite = finite && std::isfinite(sample);
+            peak = std::max(peak, std::abs(sample));
+        }
+    }
+    EXPECT_TRUE(finite);
+    EXPECT_GT(peak, 0.0f);
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "null_driver.h"
+#include "audio_engine.h"
+#include "wav_file.h"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class NullDriverTest : public ::testing::Test {
+protected:
+    // Callback identité qui relève les tailles de bloc reçues
+    static void passThrough(NullDriver& driver, std::vector<uint32_t>& sizes) {
+        sizes.reserve(100000);
+        driver.setCallback([&sizes](float* input, float* output, uint32_t frameCount, double) {
+            if (sizes.size() < sizes.capacity()) {
+                sizes.push_back(frameCount);
+            }
+            for (uint32_t i = 0; i < frameCount * NullDriver::CHANNELS; ++i) {
+                output[i] = input[i];
+            }
+        });
+    }
+};
+
+TEST_F(NullDriverTest, FreewheelVariableBlockSizes) {
+    NullDriver driver;
+    ASSERT_TRUE(driver.initialize(48000, 128));
+    
+    NullDriver::Options options;
+    options.clock = NullDriver::Clock::Freewheel;
+    options.minFrames = 17;
+    options.maxFrames = 300;
+    options.totalFrames = 48000;
+    options.seed = 42;
+    driver.setOptions(options);
+    
+    std::vector<uint32_t> sizes;
+    passThrough(driver, sizes);
+    ASSERT_TRUE(driver.start());
+    ASSERT_TRUE(driver.waitUntilFinished(5.0));
+    driver.stop();
+    
+    const auto stats = driver.getStats();
+    EXPECT_EQ(stats.frames, 48000u);
+    EXPECT_EQ(stats.callbacks, sizes.size());
+    EXPECT_GE(stats.minBlockFrames, 1u);
+    EXPECT_LE(stats.maxBlockFrames, 300u);
+    EXPECT_GT(stats.maxBlockFrames, stats.minBlockFrames);
+    
+    // Même graine : même suite de tailles
+    std::vector<uint32_t> replay;
+    passThrough(driver, replay);
+    ASSERT_TRUE(driver.start());
+    ASSERT_TRUE(driver.waitUntilFinished(5.0));
+    driver.stop();
+    EXPECT_EQ(replay, sizes);
+}
+
+TEST_F(NullDriverTest, RealtimeClockPacesCallbacks) {
+    NullDriver driver;
+    ASSERT_TRUE(driver.initialize(48000, 480));
+    
+    NullDriver::Options options;
+    options.totalFrames = 4800;     // 100 ms
+    options.jitterSeconds = 0.0005;
+    driver.setOptions(options);
+    
+    std::vector<uint32_t> sizes;
+    passThrough(driver, sizes);
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(driver.start());
+    ASSERT_TRUE(driver.waitUntilFinished(5.0));
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    driver.stop();
+    
+    // 10 périodes de 10 ms : le dernier bloc part à ~90 ms
+    EXPECT_EQ(driver.getStats().callbacks, 10u);
+    EXPECT_GE(elapsed, 0.085);
+    EXPECT_LT(elapsed, 1.0);
+}
+
+TEST_F(NullDriverTest, LateCallbacksCountAsXruns) {
+    NullDriver driver;
+    ASSERT_TRUE(driver.initialize(48000, 48));   // Période de 1 ms
+    
+    NullDriver::Options options;
+    options.totalFrames = 48 * 50;
+    options.lateProbability = 0.2;
+    options.lateSeconds = 0.002;                 // Deux périodes de retard
+    options.seed = 3;
+    driver.setOptions(options);
+    
+    std::vector<uint32_t> sizes;
+    passThrough(driver, sizes);
+    ASSERT_TRUE(driver.start());
+    ASSERT_TRUE(driver.waitUntilFinished(5.0));
+    driver.stop();
+    
+    const auto stats = driver.getStats();
+    EXPECT_GT(stats.lateCallbacks, 0u);
+    EXPECT_GE(stats.xruns, stats.lateCallbacks);
+}
+
+TEST_F(NullDriverTest, FileDriverFeedsAndRecords) {
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string inputPath = (directory / "webamp_null_driver_in.wav").string();
+    const std::string outputPath = (directory / "webamp_null_driver_out.wav").string();
+    
+    WavAudio source;
+    source.sampleRate = 44100;
+    source.channels = 2;
+    source.samples.resize(1000 * 2);
+    for (size_t i = 0; i < source.samples.size(); ++i) {
+        source.samples[i] = 0.5f * static_cast<float>(std::sin(0.01 * static_cast<double>(i)));
+    }
+    ASSERT_TRUE(WavFile::write(inputPath, source, 32));
+    
+    {
+        FileDriver driver(inputPath, outputPath);
+        ASSERT_TRUE(driver.initialize(48000, 64));
+        EXPECT_EQ(driver.getSampleRate(), 44100u);
+        
+        NullDriver::Options options;
+        options.clock = NullDriver::Clock::Freewheel;
+        options.minFrames = 10;
+        options.maxFrames = 100;
+        driver.setOptions(options);
+        
+        std::vector<uint32_t> sizes;
+        passThrough(driver, sizes);
+        ASSERT_TRUE(driver.start());
+        ASSERT_TRUE(driver.waitUntilFinished(5.0));
+        ASSERT_TRUE(driver.stop());
+        EXPECT_GE(driver.getStats().frames, 1000u);
+    }
+    
+    WavAudio recorded;
+    ASSERT_TRUE(WavFile::read(outputPath, recorded));
+    EXPECT_EQ(recorded.sampleRate, 44100u);
+    ASSERT_EQ(recorded.samples.size(), source.samples.size());
+    for (size_t i = 0; i < source.samples.size(); ++i) {
+        ASSERT_FLOAT_EQ(recorded.samples[i], source.samples[i]) << i;
+    }
+    
+    std::filesystem::remove(inputPath);
+    std::filesystem::remove(outputPath);
+}
+
+TEST_F(NullDriverTest, AudioEngineRunsOnNullDriver) {
+    AudioEngine engine;
+    ASSERT_TRUE(engine.initialize("null"));
+    EXPECT_EQ(engine.getDriverName(), "null");
+    EXPECT_GT(engine.getTotalLatency(), 0.0);
+    
+    auto* driver = dynamic_cast<NullDriver*>(engine.getDriver());
+    ASSERT_NE(driver, nullptr);
+    NullDriver::Options options;
+    options.clock = NullDriver::Clock::Freewheel;
+    options.totalFrames = engine.getSampleRate();
+    driver->setOptions(options);
+    
+    ASSERT_TRUE(engine.start());
+    ASSERT_TRUE(driver->waitUntilFinished(5.0));
+    EXPECT_TRUE(engine.stop());
+    EXPECT_EQ(engine.getStats().samplesProcessed, engine.getSampleRate());
+    
+    EXPECT_FALSE(engine.initialize("file:/nonexistent/input.wav"));
+}
+
+} // namespace tests
+} // namespace webamp
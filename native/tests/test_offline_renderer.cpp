@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+#include "offline_renderer.h"
+#include "wav_file.h"
+#include "work_stealing_pool.h"
+#include "ir_loader.h"
+#include "dsp_pipeline.h"
+#include "effect_chain.h"
+#include "effects/overdrive.h"
+#include "effects/delay.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class OfflineRendererTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory_;
+    
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+            ("webamp_render_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::create_directories(directory_);
+    }
+    
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(directory_, ec);
+    }
+    
+    std::string path(const std::string& name) const {
+        return (directory_ / name).string();
+    }
+    
+    static WavAudio sine(uint32_t channels, size_t frames, float amplitude, uint32_t sampleRate = 48000) {
+        WavAudio audio;
+        audio.sampleRate = sampleRate;
+        audio.channels = channels;
+        audio.samples.resize(frames * channels);
+        for (size_t i = 0; i < frames; ++i) {
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                audio.samples[i * channels + ch] = amplitude * static_cast<float>(
+                    std::sin(2.0 * 3.14159265358979 * (220.0 + 110.0 * ch) * i / sampleRate));
+            }
+        }
+        return audio;
+    }
+    
+    static const char* chainJson() {
+        return R"({
+            "blockSize": 128,
+            "outputGain": -3,
+            "effects": [
+                {"type": "overdrive", "parameters": {"drive": 0.8, "tone": 0.3, "level": 0.6}},
+                {"type": "delay", "parameters": {"time": 50, "feedback": 20, "mix": 30}},
+                {"type": "chorus", "bypassed": true}
+            ]
+        })";
+    }
+};
+
+TEST_F(OfflineRendererTest, WavRoundTrip) {
+    const WavAudio audio = sine(2, 1000, 0.5f, 44100);
+    
+    const struct { uint16_t bits; float tolerance; } formats[] = {{16, 1.0f / 32767.0f}, {24, 1.0f / 8388607.0f}, {32, 0.0f}};
+    for (const auto& format : formats) {
+        const std::string file = path("roundtrip_" + std::to_string(format.bits) + ".wav");
+        ASSERT_TRUE(WavFile::write(file, audio, format.bits));
+        
+        WavAudio decoded;
+        ASSERT_TRUE(WavFile::read(file, decoded));
+        EXPECT_EQ(decoded.sampleRate, 44100u);
+        EXPECT_EQ(decoded.channels, 2u);
+        ASSERT_EQ(decoded.samples.size(), audio.samples.size());
+        for (size_t i = 0; i < audio.samples.size(); ++i) {
+            ASSERT_NEAR(decoded.samples[i], audio.samples[i], format.tolerance) << format.bits << " bits, échantillon " << i;
+        }
+    }
+}
+
+TEST_F(OfflineRendererTest, WavParsesExtraChunksAndStereoIR) {
+    // Chunk LIST de taille impaire avant "data", IR stéréo 16 bits
+    WavAudio audio;
+    audio.sampleRate = 48000;
+    audio.channels = 2;
+    audio.samples = {0.5f, -0.25f, 0.25f, 0.125f, -0.5f, 0.0f};
+    std::vector<uint8_t> bytes = WavFile::encode(audio, 16);
+    
+    const uint8_t list[] = {'L', 'I', 'S', 'T', 3, 0, 0, 0, 'a', 'b', 'c', 0};
+    bytes.insert(bytes.begin() + 36, list, list + sizeof(list));
+    const uint32_t riffSize = static_cast<uint32_t>(bytes.size() - 8);
+    std::memcpy(bytes.data() + 4, &riffSize, sizeof(riffSize));
+    
+    WavAudio decoded;
+    ASSERT_TRUE(WavFile::parse(bytes.data(), bytes.size(), decoded));
+    ASSERT_EQ(decoded.getFrameCount(), 3u);
+    EXPECT_NEAR(decoded.samples[4], -0.5f, 1e-4f);
+    
+    // L'IR garde toutes les trames (premier canal) et est normalisée
+    IRLoader loader;
+    ASSERT_TRUE(loader.loadIRFromMemory(bytes.data(), bytes.size()));
+    ASSERT_EQ(loader.getLength(), 3u);
+    EXPECT_EQ(loader.getSampleRate(), 48000u);
+    EXPECT_NEAR(std::fabs(loader.getIRSamples()[0]), std::fabs(loader.getIRSamples()[2]), 1e-4f);
+    
+    const uint8_t garbage[] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'};
+    EXPECT_FALSE(WavFile::parse(garbage, sizeof(garbage), decoded));
+}
+
+TEST_F(OfflineRendererTest, ChainDescriptionParsing) {
+    ChainDescription description;
+    std::string error;
+    ASSERT_TRUE(ChainDescription::parse(chainJson(), description, error, "/presets")) << error;
+    EXPECT_EQ(description.blockSize, 128u);
+    EXPECT_FLOAT_EQ(description.outputGain, -3.0f);
+    ASSERT_EQ(description.effects.size(), 3u);
+    EXPECT_EQ(description.effects[0].type, "overdrive");
+    ASSERT_EQ(description.effects[0].parameters.size(), 3u);
+    EXPECT_EQ(description.effects[0].parameters[0].first, "drive");
+    EXPECT_FLOAT_EQ(description.effects[0].parameters[0].second, 0.8f);
+    EXPECT_TRUE(description.effects[2].bypassed);
+    
+    ASSERT_TRUE(ChainDescription::parse(R"({"effects": [{"type": "ir", "path": "cab.wav"}]})", description, error, "/presets"));
+    EXPECT_EQ(std::filesystem::path(description.effects[0].path), std::filesystem::path("/presets") / "cab.wav");
+    
+    EXPECT_FALSE(ChainDescription::parse("{\"effects\": [", description, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(ChainDescription::parse(R"({"effects": [{"parameters": {}}]})", description, error));
+    EXPECT_FALSE(ChainDescription::parse(R"({"bitDepth": 12})", description, error));
+    
+    // Type inconnu : refusé au rendu
+    ASSERT_TRUE(ChainDescription::parse(R"({"effects": [{"type": "wah"}]})", description, error));
+    WavAudio output;
+    EXPECT_FALSE(OfflineRenderer(description).render(sine(1, 256, 0.5f), output, error));
+    EXPECT_NE(error.find("wah"), std::string::npos);
+}
+
+TEST_F(OfflineRendererTest, RenderMatchesPipeline) {
+    ChainDescription description;
+    std::string error;
+    ASSERT_TRUE(ChainDescription::parse(chainJson(), description, error)) << error;
+    description.tailSeconds = 0.1;
+    
+    const WavAudio input = sine(2, 4800, 0.4f);
+    WavAudio output;
+    double renderSeconds = 0.0;
+    ASSERT_TRUE(OfflineRenderer(description).render(input, output, error, &renderSeconds)) << error;
+    ASSERT_EQ(output.channels, 2u);
+    ASSERT_EQ(output.getFrameCount(), 4800u + 4800u);
+    EXPECT_GT(renderSeconds, 0.0);
+    
+    // Référence : même chaîne construite à la main, traitée par blocs de 128
+    auto overdrive = std::make_shared<OverdriveEffect>();
+    auto delay = std::make_shared<DelayEffect>();
+    for (EffectBase* effect : {static_cast<EffectBase*>(overdrive.get()), static_cast<EffectBase*>(delay.get())}) {
+        effect->setSampleRate(48000);
+        effect->setSmoothingTime(0.0f);
+    }
+    overdrive->setParameter("drive", 0.8f);
+    overdrive->setParameter("tone", 0.3f);
+    overdrive->setParameter("level", 0.6f);
+    delay->setParameter("time", 50.0f);
+    delay->setParameter("feedback", 20.0f);
+    delay->setParameter("mix", 30.0f);
+    auto chain = std::make_shared<EffectChain>();
+    chain->addEffect(overdrive);
+    chain->addEffect(delay);
+    
+    DSPPipeline pipeline;
+    pipeline.initialize(48000, 128);
+    pipeline.setOutputGain(-3.0f);
+    pipeline.setEffectChain(chain);
+    
+    std::vector<float> in(input.samples);
+    in.resize(output.samples.size(), 0.0f);
+    std::vector<float> expected(in.size());
+    for (size_t offset = 0; offset < output.getFrameCount(); offset += 128) {
+        pipeline.process(in.data() + offset * 2, expected.data() + offset * 2, 128);
+    }
+    
+    float energy = 0.0f;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_NEAR(output.samples[i], expected[i], 1e-6f) << "échantillon " << i;
+        energy += std::fabs(output.samples[i]);
+    }
+    EXPECT_GT(energy, 0.0f);
+    
+    // Entrée mono : sortie mono (canal gauche du rendu stéréo dupliqué)
+    WavAudio mono;
+    ASSERT_TRUE(OfflineRenderer(description).render(sine(1, 4800, 0.4f), mono, error)) << error;
+    EXPECT_EQ(mono.channels, 1u);
+    EXPECT_EQ(mono.getFrameCount(), 9600u);
+}
+
+TEST_F(OfflineRendererTest, BatchRenderMatchesSequential) {
+    ChainDescription description;
+    std::string error;
+    ASSERT_TRUE(ChainDescription::parse(chainJson(), description, error)) << error;
+    const OfflineRenderer renderer(description);
+    
+    std::vector<std::pair<std::string, std::string>> jobs;
+    std::filesystem::create_directories(directory_ / "in");
+    for (int i = 0; i < 6; ++i) {
+        const std::string name = "take" + std::to_string(i) + ".wav";
+        ASSERT_TRUE(WavFile::write(path("in/" + name), sine(1 + i % 2, 2000 + 500 * i, 0.1f * (i + 1)), 32));
+        jobs.emplace_back(path("in/" + name), path("out_" + name));
+    }
+    ASSERT_EQ(OfflineRenderer::listWavFiles(path("in")).size(), 6u);
+    
+    const auto results = renderer.renderFiles(jobs, 3);
+    ASSERT_EQ(results.size(), jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        ASSERT_TRUE(results[i].success) << results[i].error;
+        EXPECT_EQ(results[i].inputPath, jobs[i].first);
+        EXPECT_GT(results[i].getRealtimeFactor(), 0.0);
+        
+        WavAudio input;
+        WavAudio sequential;
+        WavAudio parallel;
+        ASSERT_TRUE(WavFile::read(jobs[i].first, input));
+        ASSERT_TRUE(renderer.render(input, sequential, error)) << error;
+        ASSERT_TRUE(WavFile::read(jobs[i].second, parallel));
+        ASSERT_EQ(parallel.samples.size(), sequential.samples.size());
+        for (size_t s = 0; s < sequential.samples.size(); ++s) {
+            ASSERT_NEAR(parallel.samples[s], sequential.samples[s], 1.0f / 8388607.0f);
+        }
+    }
+    
+    const auto missing = renderer.renderFiles({{path("absent.wav"), path("absent_out.wav")}});
+    ASSERT_EQ(missing.size(), 1u);
+    EXPECT_FALSE(missing[0].success);
+}
+
+TEST_F(OfflineRendererTest, WorkStealingPoolRunsNestedJobs) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.getThreadCount(), 4u);
+    
+    std::atomic<int> count{0};
+    for (int i = 0; i < 16; ++i) {
+        pool.submit([&pool, &count] {
+            for (int j = 0; j < 8; ++j) {
+                pool.submit([&count] { count.fetch_add(1); });
+            }
+            count.fetch_add(1);
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(count.load(), 16 * 9);
+    
+    pool.submit([&count] { count.fetch_add(1); });
+    pool.wait();
+    EXPECT_EQ(count.load(), 16 * 9 + 1);
+}
+
+} // namespace tests
+} // namespace webamp
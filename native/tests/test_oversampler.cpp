@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "oversampler.h"
+#include "fft_helper.h"
+#include "effects/distortion.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class OversamplerTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t SAMPLE_RATE = 48000;
+    static constexpr uint32_t FFT_SIZE = 8192;
+    static constexpr uint32_t BLOCK_SIZE = 128;
+    
+    // Traite un signal mono complet (dupliqué en stéréo) par blocs
+    static std::vector<float> run(Oversampler& oversampler, const std::vector<float>& signal, float drive) {
+        std::vector<float> left = signal;
+        std::vector<float> right = signal;
+        auto clip = [drive](uint32_t, float* x, uint32_t n) {
+            for (uint32_t i = 0; i < n; ++i) {
+                x[i] = std::max(-1.0f, std::min(1.0f, x[i] * drive));
+            }
+        };
+        for (size_t offset = 0; offset < signal.size(); offset += BLOCK_SIZE) {
+            const uint32_t count = static_cast<uint32_t>(std::min<size_t>(BLOCK_SIZE, signal.size() - offset));
+            float* channels[2] = {left.data() + offset, right.data() + offset};
+            if (drive > 0.0f) {
+                oversampler.process(channels, channels, 2, count, clip);
+            } else {
+                oversampler.process(channels, channels, 2, count, [](uint32_t, float*, uint32_t) {});
+            }
+        }
+        EXPECT_EQ(left, right);
+        return left;
+    }
+    
+    // Énergie (dB, relative au fondamental) hors des harmoniques de la
+    // fondamentale "bin" : repliement spectral
+    static float aliasingDb(const std::vector<float>& signal, size_t start, uint32_t bin) {
+        FFTPlan plan(FFT_SIZE);
+        std::vector<float> windowed(FFT_SIZE);
+        for (uint32_t i = 0; i < FFT_SIZE; ++i) {
+            const float hann = 0.5f - 0.5f * std::cos(2.0f * 3.14159265f * i / FFT_SIZE);
+            windowed[i] = signal[start + i] * hann;
+        }
+        std::vector<float> re(FFT_SIZE / 2 + 1), im(FFT_SIZE / 2 + 1);
+        plan.forwardReal(windowed.data(), re.data(), im.data());
+        
+        double fundamental = 0.0;
+        double aliases = 0.0;
+        for (uint32_t k = 4; k < FFT_SIZE / 2; ++k) {
+            const double power = static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+            const uint32_t nearest = (k + bin / 2) / bin * bin;
+            const bool harmonic = (k > nearest ? k - nearest : nearest - k) <= 3;
+            if (k >= bin - 3 && k <= bin + 3) {
+                fundamental += power;
+            } else if (!harmonic) {
+                aliases += power;
+            }
+        }
+        return static_cast<float>(10.0 * std::log10(aliases / fundamental + 1e-30));
+    }
+    
+    static std::vector<float> sine(uint32_t bin, size_t length, float amplitude) {
+        std::vector<float> signal(length);
+        for (size_t i = 0; i < length; ++i) {
+            signal[i] = amplitude * std::sin(2.0 * 3.14159265358979 * bin * i / FFT_SIZE);
+        }
+        return signal;
+    }
+};
+
+TEST_F(OversamplerTest, PassbandIsTransparentWithReportedLatency) {
+    for (auto phase : {Oversampler::Phase::Linear, Oversampler::Phase::Minimum}) {
+        for (uint32_t factor : {2u, 4u, 8u}) {
+            Oversampler oversampler;
+            oversampler.prepare(BLOCK_SIZE);
+            oversampler.setFactor(factor);
+            oversampler.setPhase(phase);
+            EXPECT_EQ(oversampler.getFactor(), factor);
+            
+            // Réponse impulsionnelle : gain DC unitaire, retard de groupe = latence annoncée
+            std::vector<float> impulse(4096, 0.0f);
+            impulse[0] = 1.0f;
+            const auto response = run(oversampler, impulse, 0.0f);
+            double sum = 0.0;
+            double moment = 0.0;
+            for (size_t i = 0; i < response.size(); ++i) {
+                sum += response[i];
+                moment += response[i] * static_cast<double>(i);
+            }
+            EXPECT_NEAR(sum, 1.0, 1e-3) << factor << "x";
+            EXPECT_NEAR(moment / sum, oversampler.getLatency(), 0.05) << factor << "x";
+            
+            // Sinusoïde à 1 kHz : amplitude conservée
+            Oversampler fresh;
+            fresh.prepare(BLOCK_SIZE);
+            fresh.setFactor(factor);
+            fresh.setPhase(phase);
+            const auto input = sine(171, 8192, 0.5f);
+            const auto output = run(fresh, input, 0.0f);
+            float peak = 0.0f;
+            for (size_t i = 4096; i < output.size(); ++i) {
+                peak = std::max(peak, std::fabs(output[i]));
+            }
+            EXPECT_NEAR(peak, 0.5f, 0.005f) << factor << "x";
+        }
+    }
+    EXPECT_FLOAT_EQ(Oversampler::getLatency(1, Oversampler::Phase::Linear), 0.0f);
+    EXPECT_LT(Oversampler::getLatency(8, Oversampler::Phase::Minimum), Oversampler::getLatency(2, Oversampler::Phase::Linear));
+}
+
+TEST_F(OversamplerTest, ReducesClippingAliases) {
+    // Écrêtage dur d'une sinusoïde de ~4.1 kHz à 48 kHz : les harmoniques
+    // au-delà de Nyquist se replient entre les harmoniques
+    const uint32_t bin = 700;
+    const auto input = sine(bin, 4 * FFT_SIZE, 0.8f);
+    
+    float aliasing[4];
+    const uint32_t factors[4] = {1, 2, 4, 8};
+    for (int f = 0; f < 4; ++f) {
+        Oversampler oversampler;
+        oversampler.prepare(BLOCK_SIZE);
+        oversampler.setFactor(factors[f]);
+        const auto output = run(oversampler, input, 8.0f);
+        aliasing[f] = aliasingDb(output, 2 * FFT_SIZE, bin);
+    }
+    
+    EXPECT_LT(aliasing[1], aliasing[0] - 6.0f);
+    EXPECT_LT(aliasing[2], aliasing[1]);
+    EXPECT_LT(aliasing[3], aliasing[0] - 20.0f);
+}
+
+TEST_F(OversamplerTest, FactorChangeIsLockFreeAndEffectsExposeIt) {
+    DistortionEffect distortion;
+    distortion.setSampleRate(SAMPLE_RATE);
+    EXPECT_FLOAT_EQ(distortion.getParameter("oversampling"), 1.0f);
+    
+    // Paramètre appliqué par index (thread audio) : arrondi à une puissance de 2
+    distortion.setParameterByIndex(DistortionEffect::PARAM_OVERSAMPLING, 3.0f);
+    EXPECT_FLOAT_EQ(distortion.getParameter("oversampling"), 4.0f);
+    distortion.setParameter("oversamplingPhase", 1.0f);
+    EXPECT_EQ(distortion.getOversampler().getPhase(), Oversampler::Phase::Minimum);
+    
+    std::vector<float> buffer(BLOCK_SIZE * 2, 0.25f);
+    distortion.process(buffer.data(), buffer.data(), BLOCK_SIZE);
+    for (float sample : buffer) {
+        EXPECT_TRUE(std::isfinite(sample));
+    }
+    
+    const auto costs = Oversampler::measureCosts();
+    ASSERT_EQ(costs.size(), 6u);
+    for (const auto& cost : costs) {
+        EXPECT_GT(cost.nsPerFrame, 0.0);
+        EXPECT_FLOAT_EQ(cost.latency, Oversampler::getLatency(cost.factor, cost.phase));
+    }
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "parallel_effect.h"
+#include "nam_effect.h"
+#include "effect_chain.h"
+#include "effects/distortion.h"
+#include "effects/delay.h"
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+// Gain stéréo simple (sortie déterministe, paramètre unique)
+class GainTestEffect : public EffectBase {
+public:
+    explicit GainTestEffect(float gain) : gain_(gain) {}
+    
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override {
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            for (uint32_t i = 0; i < frameCount; ++i) {
+                output[ch][i] = input[ch][i] * gain_;
+            }
+        }
+    }
+    
+    std::vector<Parameter> getParameters() const override {
+        return {{"gain", "Gain", 0.0f, 4.0f, 1.0f, gain_}};
+    }
+    void setParameter(const std::string& name, float value) override {
+        if (name == "gain") gain_ = value;
+    }
+    float getParameter(const std::string& name) const override {
+        return name == "gain" ? gain_ : 0.0f;
+    }
+    std::string getName() const override { return "Gain"; }
+    std::string getType() const override { return "gain"; }
+    
+private:
+    float gain_;
+};
+
+class ParallelEffectTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        block_size_ = 128;
+        input_.resize(block_size_ * 2);
+        for (uint32_t i = 0; i < block_size_; ++i) {
+            const float sample = 0.4f * std::sin(2.0f * 3.14159f * 220.0f * i / 48000.0f);
+            input_[i * 2] = sample;
+            input_[i * 2 + 1] = sample;
+        }
+    }
+    
+    static std::string linearModel(size_t receptiveField, float scale) {
+        std::ostringstream out;
+        out << std::setprecision(9) << "{\"version\":\"0.5.2\",\"architecture\":\"Linear\","
+            << "\"config\":{\"receptive_field\":" << receptiveField << ",\"bias\":true},"
+            << "\"sample_rate\":48000,\"weights\":[";
+        for (size_t i = 0; i <= receptiveField; ++i) {
+            out << (i ? "," : "") << scale * std::cos(static_cast<float>(i));
+        }
+        out << "]}";
+        return out.str();
+    }
+    
+    static std::shared_ptr<NAMEffect> makeNAMEffect(const std::string& json) {
+        auto effect = std::make_shared<NAMEffect>();
+        // Flux à la fréquence des modèles : pas de rééchantillonnage
+        effect->setSampleRate(48000);
+        EXPECT_TRUE(effect->loadModelFromMemory(reinterpret_cast<const uint8_t*>(json.data()), json.size()));
+        return effect;
+    }
+    
+    uint32_t block_size_;
+    std::vector<float> input_;
+};
+
+TEST_F(ParallelEffectTest, WorkerPoolRunsEveryTaskOnce) {
+    RTWorkerPool pool(3);
+    EXPECT_EQ(pool.getWorkerCount(), 3u);
+    
+    std::vector<std::atomic<int>> counters(16);
+    for (auto& counter : counters) {
+        counter.store(0);
+    }
+    auto task = [](void* context, size_t index) {
+        static_cast<std::vector<std::atomic<int>>*>(context)->at(index).fetch_add(1);
+    };
+    
+    const int runs = 2000;
+    for (int r = 0; r < runs; ++r) {
+        pool.run(task, &counters, 1 + r % counters.size());
+    }
+    // L'index i est présent dans toutes les exécutions de taille > i
+    for (size_t i = 0; i < counters.size(); ++i) {
+        int expected = 0;
+        for (int r = 0; r < runs; ++r) {
+            expected += (1 + r % counters.size()) > i ? 1 : 0;
+        }
+        EXPECT_EQ(counters[i].load(), expected) << "index " << i;
+    }
+}
+
+TEST_F(ParallelEffectTest, MergeSumsBranchLevels) {
+    ParallelEffect parallel(2);
+    parallel.setSmoothingTime(0.0f);
+    parallel.addEffect(0, std::make_shared<GainTestEffect>(2.0f));
+    parallel.setBranchLevel(0, 0.25f);
+    parallel.setBranchLevel(1, 0.5f);
+    
+    // Branche 1 vide : signal sec
+    std::vector<float> output(input_.size());
+    parallel.process(input_.data(), output.data(), block_size_);
+    for (size_t i = 0; i < input_.size(); ++i) {
+        EXPECT_NEAR(output[i], input_[i] * (0.25f * 2.0f + 0.5f), 1e-6f);
+    }
+    
+    // Traitement en place
+    std::vector<float> inPlace = input_;
+    parallel.process(inPlace.data(), inPlace.data(), block_size_);
+    for (size_t i = 0; i < input_.size(); ++i) {
+        EXPECT_FLOAT_EQ(inPlace[i], output[i]);
+    }
+}
+
+TEST_F(ParallelEffectTest, ParallelMatchesSerial) {
+    // Deux graphes identiques, l'un traité en série
+    ParallelEffect parallel(3);
+    ParallelEffect serial(3);
+    serial.setParallel(false);
+    for (ParallelEffect* graph : {&parallel, &serial}) {
+        auto distortion = std::make_shared<DistortionEffect>();
+        distortion->setParameter("distortion", 70.0f);
+        graph->addEffect(0, distortion);
+        graph->addEffect(1, std::make_shared<DelayEffect>());
+        graph->addEffect(1, std::make_shared<GainTestEffect>(0.5f));
+        graph->addEffect(2, std::make_shared<GainTestEffect>(1.5f));
+        graph->setSampleRate(48000);
+    }
+    
+    std::vector<float> a(input_.size()), b(input_.size());
+    for (int block = 0; block < 50; ++block) {
+        parallel.process(input_.data(), a.data(), block_size_);
+        serial.process(input_.data(), b.data(), block_size_);
+        for (size_t i = 0; i < a.size(); ++i) {
+            ASSERT_FLOAT_EQ(a[i], b[i]) << "block " << block << " sample " << i;
+        }
+    }
+}
+
+TEST_F(ParallelEffectTest, DualAmpBranches) {
+    const std::string modelA = linearModel(16, 0.2f);
+    const std::string modelB = linearModel(8, -0.3f);
+    
+    ParallelEffect rig(2);
+    rig.setSmoothingTime(0.0f);
+    rig.addEffect(0, makeNAMEffect(modelA));
+    rig.addEffect(1, makeNAMEffect(modelB));
+    rig.setBranchLevel(0, 0.5f);
+    rig.setBranchLevel(1, 0.5f);
+    
+    // Référence : les deux modèles appliqués directement au signal mono
+    NAMModel referenceA, referenceB;
+    ASSERT_TRUE(referenceA.loadFromMemory(reinterpret_cast<const uint8_t*>(modelA.data()), modelA.size()));
+    ASSERT_TRUE(referenceB.loadFromMemory(reinterpret_cast<const uint8_t*>(modelB.data()), modelB.size()));
+    
+    std::vector<float> output(input_.size());
+    std::vector<float> mono(block_size_), outA(block_size_), outB(block_size_);
+    for (int block = 0; block < 4; ++block) {
+        rig.process(input_.data(), output.data(), block_size_);
+        for (uint32_t i = 0; i < block_size_; ++i) {
+            mono[i] = input_[i * 2];
+        }
+        referenceA.processAudio(mono.data(), outA.data(), block_size_, 48000);
+        referenceB.processAudio(mono.data(), outB.data(), block_size_, 48000);
+        for (uint32_t i = 0; i < block_size_; ++i) {
+            const float expected = 0.5f * (outA[i] + outB[i]);
+            ASSERT_NEAR(output[i * 2], expected, 1e-5f);
+            ASSERT_NEAR(output[i * 2 + 1], expected, 1e-5f);
+        }
+    }
+}
+
+TEST_F(ParallelEffectTest, ParameterChangesReachBranches) {
+    EffectChain chain;
+    auto parallel = std::make_shared<ParallelEffect>(2);
+    auto gain = std::make_shared<GainTestEffect>(1.0f);
+    parallel->addEffect(1, gain);
+    chain.addEffect(parallel);
+    
+    EXPECT_TRUE(chain.queueParameterChange(gain.get(), 0, 3.0f));
+    EXPECT_TRUE(chain.queueParameterChange(parallel.get(), 1, 0.0f));
+    GainTestEffect outsider(1.0f);
+    EXPECT_FALSE(chain.queueParameterChange(&outsider, 0, 3.0f));
+    
+    std::vector<float> output(input_.size());
+    chain.process(input_.data(), output.data(), block_size_);
+    EXPECT_FLOAT_EQ(gain->getParameter("gain"), 3.0f);
+    EXPECT_FLOAT_EQ(parallel->getParameter("level2"), 0.0f);
+    
+    // Retrait de la branche : l'effet n'est plus adressable
+    parallel->clearBranch(1);
+    EXPECT_FALSE(chain.queueParameterChange(gain.get(), 0, 2.0f));
+}
+
+} // namespace tests
+} // namespace webamp
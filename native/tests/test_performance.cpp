@@ -4,6 +4,7 @@
 #include "effects/distortion.h"
 #include "effects/chorus.h"
 #include "effects/delay.h"
+#include "test_signal.h"
 #include <vector>
 #include <chrono>
 #include <memory>
@@ -99,7 +100,7 @@ TEST_F(PerformanceTest, Support20Effects) {
     chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
     
     // Ne devrait pas planter
-    EXPECT_NE(output_buffer_[0], 0.0f);
+    EXPECT_GT(rms(output_buffer_), 0.0f);
 }
 
 TEST_F(PerformanceTest, HighSampleRatePerformance) {
@@ -117,6 +118,33 @@ TEST_F(PerformanceTest, HighSampleRatePerformance) {
     EXPECT_LE(latencyMs, 5.0);
 }
 
+TEST_F(PerformanceTest, AntialiasedDistortionChainCost) {
+    // 10 distortions en ADAA d'ordre 1 : bien moins cher qu'un suréchantillonnage
+    auto measure = [this](float antialiasing) {
+        EffectChain chain;
+        for (int i = 0; i < 10; ++i) {
+            auto effect = std::make_shared<DistortionEffect>();
+            effect->setSampleRate(sample_rate_);
+            effect->setParameter("antialiasing", antialiasing);
+            chain.addEffect(effect);
+        }
+        chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 2000; ++i) {
+            chain.process(test_buffer_.data(), output_buffer_.data(), buffer_size_);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+    
+    const double naive = measure(0.0f);
+    const double antialiased = measure(1.0f);
+    
+    // ~1.5x attendu, marge pour les machines chargées
+    EXPECT_LE(antialiased, naive * 3.0);
+}
+
 } // namespace tests
 } // namespace webamp
 
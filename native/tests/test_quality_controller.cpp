@@ -0,0 +1,304 @@
+#include <gtest/gtest.h>
+#include "quality_controller.h"
+#include "dsp_pipeline.h"
+#include "effect_chain.h"
+#include "ir_convolution.h"
+#include "nam_effect.h"
+#include "parallel_effect.h"
+#include "effects/distortion.h"
+#include "effects/reverb.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+// Effet dont le coût par bloc est réglable (attente active) : pilote la
+// charge du pipeline et relève le niveau de qualité reçu
+class LoadTestEffect : public EffectBase {
+public:
+    std::atomic<double> seconds_per_block{0.0};
+    
+    using EffectBase::process;
+    void process(const float* const* input, float* const* output, uint32_t channels, uint32_t frameCount) override {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds_per_block.load());
+        while (std::chrono::steady_clock::now() < end) {
+        }
+        AudioBuffer::copy(input, output, channels, frameCount);
+    }
+    
+    uint32_t getQualityTierCount() const override { return 3; }
+    std::vector<Parameter> getParameters() const override { return {}; }
+    void setParameter(const std::string&, float) override {}
+    float getParameter(const std::string&) const override { return 0.0f; }
+    std::string getName() const override { return "Load"; }
+    std::string getType() const override { return "load"; }
+};
+
+class QualityControllerTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t SAMPLE_RATE = 48000;
+    static constexpr uint32_t BLOCK = 64;
+    
+    static QualityController::Settings enabledSettings() {
+        QualityController::Settings settings;
+        settings.enabled = true;
+        settings.highWater = 0.8;
+        settings.lowWater = 0.5;
+        settings.downBlocks = 3;
+        settings.upSeconds = 0.01;      // 480 frames
+        settings.maxLevel = 2;
+        return settings;
+    }
+    
+    static std::string linearModel(size_t receptiveField, float scale) {
+        std::ostringstream out;
+        out << std::setprecision(9) << "{\"version\":\"0.5.2\",\"architecture\":\"Linear\","
+            << "\"config\":{\"receptive_field\":" << receptiveField << ",\"bias\":true},"
+            << "\"sample_rate\":48000,\"weights\":[";
+        for (size_t i = 0; i <= receptiveField; ++i) {
+            out << (i ? "," : "") << scale * std::cos(static_cast<float>(i));
+        }
+        out << "]}";
+        return out.str();
+    }
+};
+
+TEST_F(QualityControllerTest, StepsDownOnHighLoadAndUpWithHysteresis) {
+    QualityController controller;
+    controller.setSettings(enabledSettings());
+    
+    // Deux blocs chargés ne suffisent pas, le troisième dégrade
+    EXPECT_EQ(controller.update(0.9, BLOCK, SAMPLE_RATE), 0u);
+    EXPECT_EQ(controller.update(0.9, BLOCK, SAMPLE_RATE), 0u);
+    EXPECT_EQ(controller.update(0.9, BLOCK, SAMPLE_RATE), 1u);
+    
+    // Échéance dépassée : dégradation immédiate, bornée à maxLevel
+    EXPECT_EQ(controller.update(1.2, BLOCK, SAMPLE_RATE), 2u);
+    EXPECT_EQ(controller.update(1.2, BLOCK, SAMPLE_RATE), 2u);
+    
+    // Entre lowWater et highWater : le niveau tient
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(controller.update(0.6, BLOCK, SAMPLE_RATE), 2u);
+    }
+    
+    // Sous lowWater : un cran toutes les 480 frames (7,5 blocs de 64)
+    uint32_t level = 2;
+    int blocks = 0;
+    while (level == 2) {
+        level = controller.update(0.1, BLOCK, SAMPLE_RATE);
+        ++blocks;
+    }
+    EXPECT_EQ(level, 1u);
+    EXPECT_EQ(blocks, 8);
+    
+    // Une remontée de charge interrompt le compte à rebours
+    for (int i = 0; i < 5; ++i) {
+        controller.update(0.1, BLOCK, SAMPLE_RATE);
+    }
+    controller.update(0.7, BLOCK, SAMPLE_RATE);
+    for (int i = 0; i < 7; ++i) {
+        EXPECT_EQ(controller.update(0.1, BLOCK, SAMPLE_RATE), 1u);
+    }
+    EXPECT_EQ(controller.update(0.1, BLOCK, SAMPLE_RATE), 0u);
+    
+    // Chaque changement est relayé, dans l'ordre
+    QualityController::Event events[QualityController::EVENT_QUEUE_CAPACITY];
+    ASSERT_EQ(controller.readEvents(events, QualityController::EVENT_QUEUE_CAPACITY), 4u);
+    EXPECT_EQ(events[0].previousLevel, 0u);
+    EXPECT_EQ(events[0].level, 1u);
+    EXPECT_EQ(events[1].level, 2u);
+    EXPECT_DOUBLE_EQ(events[1].load, 1.2);
+    EXPECT_EQ(events[2].level, 1u);
+    EXPECT_EQ(events[3].level, 0u);
+    EXPECT_GT(events[3].frame, events[2].frame);
+    EXPECT_EQ(controller.readEvents(events, QualityController::EVENT_QUEUE_CAPACITY), 0u);
+}
+
+TEST_F(QualityControllerTest, DisablingRestoresNominalQuality) {
+    QualityController controller;
+    EXPECT_EQ(controller.update(5.0, BLOCK, SAMPLE_RATE), 0u);
+    
+    controller.setSettings(enabledSettings());
+    controller.update(5.0, BLOCK, SAMPLE_RATE);
+    EXPECT_EQ(controller.getLevel(), 1u);
+    
+    auto settings = controller.getSettings();
+    settings.enabled = false;
+    controller.setSettings(settings);
+    EXPECT_EQ(controller.update(5.0, BLOCK, SAMPLE_RATE), 0u);
+}
+
+TEST_F(QualityControllerTest, EffectsExposeQualityTiers) {
+    AudioBuffer buffer(2, BLOCK);
+    
+    ReverbEffect reverb;
+    EXPECT_EQ(reverb.getQualityTierCount(), 3u);
+    reverb.setQualityTier(7);
+    EXPECT_EQ(reverb.getQualityTier(), 2u);
+    EXPECT_EQ(reverb.getActiveCombCount(), 1);
+    reverb.setQualityTier(0);
+    EXPECT_EQ(reverb.getActiveCombCount(), ReverbEffect::NUM_COMBS);
+    
+    // Suréchantillonnage divisé par deux par niveau, facteur demandé conservé
+    DistortionEffect distortion;
+    distortion.setParameter("oversampling", 8.0f);
+    distortion.setQualityTier(2);
+    distortion.process(buffer.getReadPointers(), buffer.getWritePointers(), 2, BLOCK);
+    EXPECT_EQ(distortion.getOversampler().getActiveFactor(), 2u);
+    EXPECT_EQ(distortion.getParameter("oversampling"), 8.0f);
+    distortion.setQualityTier(0);
+    distortion.process(buffer.getReadPointers(), buffer.getWritePointers(), 2, BLOCK);
+    EXPECT_EQ(distortion.getOversampler().getActiveFactor(), 8u);
+    
+    // IR tronquée au quart de ses partitions
+    auto irLoader = std::make_shared<IRLoader>();
+    std::vector<float> ir(BLOCK * 16, 0.0f);
+    ir[0] = 1.0f;
+    ir.back() = 0.5f;
+    irLoader->loadIRFromSamples(ir.data(), ir.size(), SAMPLE_RATE);
+    IRConvolution convolution;
+    convolution.setSampleRate(SAMPLE_RATE);
+    convolution.setMaxBlockSize(BLOCK);
+    ASSERT_TRUE(convolution.loadIR(irLoader));
+    convolution.setMix(100.0f);
+    convolution.setQualityTier(2);
+    
+    // Impulsion : la réflexion en fin d'IR disparaît
+    std::vector<float> impulse(BLOCK * 2, 0.0f);
+    std::vector<float> out(BLOCK * 2, 0.0f);
+    float tail = 0.0f;
+    for (size_t b = 0; b < 17; ++b) {
+        impulse[0] = impulse[1] = (b == 0) ? 1.0f : 0.0f;
+        convolution.process(impulse.data(), out.data(), BLOCK);
+        for (float sample : out) {
+            if (b > 0) {
+                tail = std::max(tail, std::abs(sample));
+            }
+        }
+    }
+    EXPECT_LT(tail, 1e-3f);
+}
+
+TEST_F(QualityControllerTest, NAMUsesLightModelAtLowerQuality) {
+    const std::string full = linearModel(16, 0.5f);
+    const std::string light = linearModel(4, 0.25f);
+    
+    NAMEffect effect;
+    ASSERT_TRUE(effect.loadModelFromMemory(reinterpret_cast<const uint8_t*>(full.data()), full.size()));
+    ASSERT_TRUE(effect.loadLightModelFromMemory(reinterpret_cast<const uint8_t*>(light.data()), light.size()));
+    EXPECT_TRUE(effect.hasLightModel());
+    effect.setQualityTier(1);
+    
+    NAMEffect reference;
+    ASSERT_TRUE(reference.loadModelFromMemory(reinterpret_cast<const uint8_t*>(light.data()), light.size()));
+    
+    std::vector<float> input(BLOCK * 2);
+    for (uint32_t i = 0; i < BLOCK; ++i) {
+        input[i * 2] = input[i * 2 + 1] = 0.3f * std::sin(0.1f * static_cast<float>(i));
+    }
+    std::vector<float> degraded(BLOCK * 2);
+    std::vector<float> expected(BLOCK * 2);
+    effect.process(input.data(), degraded.data(), BLOCK);
+    reference.process(input.data(), expected.data(), BLOCK);
+    for (size_t i = 0; i < degraded.size(); ++i) {
+        ASSERT_FLOAT_EQ(degraded[i], expected[i]) << i;
+    }
+}
+
+TEST_F(QualityControllerTest, PipelineAmpUsesLightModelUnderLoad) {
+    const std::string full = linearModel(16, 0.5f);
+    const std::string light = linearModel(4, 0.25f);
+    
+    // Entrée constante : après le champ récepteur, la sortie d'un modèle
+    // Linear ne dépend plus de son historique
+    std::vector<float> input(BLOCK * 2, 0.1f);
+    std::vector<float> output(BLOCK * 2, 0.0f);
+    const auto steadyOutput = [&](const std::string& model) {
+        DSPPipeline reference;
+        reference.initialize(SAMPLE_RATE, BLOCK);
+        reference.loadNAMModelFromMemory(reinterpret_cast<const uint8_t*>(model.data()), model.size());
+        std::vector<float> out(BLOCK * 2, 0.0f);
+        reference.process(input.data(), out.data(), BLOCK);
+        return out.back();
+    };
+    const float fullOutput = steadyOutput(full);
+    const float lightOutput = steadyOutput(light);
+    ASSERT_GT(std::abs(fullOutput - lightOutput), 1e-3f);
+    
+    DSPPipeline pipeline;
+    ASSERT_TRUE(pipeline.initialize(SAMPLE_RATE, BLOCK));
+    ASSERT_TRUE(pipeline.loadNAMModelFromMemory(reinterpret_cast<const uint8_t*>(full.data()), full.size()));
+    ASSERT_TRUE(pipeline.loadLightNAMModelFromMemory(reinterpret_cast<const uint8_t*>(light.data()), light.size()));
+    EXPECT_TRUE(pipeline.hasLightNAMModel());
+    
+    auto chain = std::make_shared<EffectChain>();
+    auto load = std::make_shared<LoadTestEffect>();
+    chain->addEffect(load);
+    pipeline.setEffectChain(chain);
+    pipeline.setAdaptiveQuality(enabledSettings());
+    
+    // Niveau nominal : modèle complet
+    pipeline.process(input.data(), output.data(), BLOCK);
+    EXPECT_NEAR(output.back(), fullOutput, 1e-5f);
+    
+    // Échéance dépassée : le niveau monte, l'ampli passe au modèle allégé
+    const double blockSeconds = static_cast<double>(BLOCK) / SAMPLE_RATE;
+    load->seconds_per_block = blockSeconds * 1.5;
+    pipeline.process(input.data(), output.data(), BLOCK);
+    load->seconds_per_block = 0.0;
+    ASSERT_GE(pipeline.getQualityLevel(), 1u);
+    pipeline.process(input.data(), output.data(), BLOCK);
+    EXPECT_NEAR(output.back(), lightOutput, 1e-5f);
+}
+
+TEST_F(QualityControllerTest, PipelineDegradesUnderLoadAndRecovers) {
+    DSPPipeline pipeline;
+    ASSERT_TRUE(pipeline.initialize(SAMPLE_RATE, BLOCK));
+    
+    auto chain = std::make_shared<EffectChain>();
+    auto load = std::make_shared<LoadTestEffect>();
+    auto parallel = std::make_shared<ParallelEffect>(1);
+    auto reverb = std::make_shared<ReverbEffect>();
+    parallel->addEffect(0, reverb);
+    chain->addEffect(load);
+    chain->addEffect(parallel);
+    pipeline.setEffectChain(chain);
+    pipeline.setAdaptiveQuality(enabledSettings());
+    
+    // Entrée non silencieuse : aucun effet n'est mis en veille
+    std::vector<float> input(BLOCK * 2, 0.1f);
+    std::vector<float> output(BLOCK * 2, 0.0f);
+    const double blockSeconds = static_cast<double>(BLOCK) / SAMPLE_RATE;
+    
+    // Échéance dépassée : un cran par bloc jusqu'à maxLevel
+    load->seconds_per_block = blockSeconds * 1.5;
+    for (int i = 0; i < 3; ++i) {
+        pipeline.process(input.data(), output.data(), BLOCK);
+    }
+    EXPECT_EQ(pipeline.getQualityLevel(), 2u);
+    EXPECT_EQ(pipeline.getStats().qualityLevel, 2u);
+    
+    // Niveau appliqué au bloc suivant, jusque dans les branches parallèles
+    load->seconds_per_block = 0.0;
+    pipeline.process(input.data(), output.data(), BLOCK);
+    EXPECT_EQ(load->getQualityTier(), 2u);
+    EXPECT_EQ(reverb->getQualityTier(), 2u);
+    
+    // Charge nulle : retour au niveau nominal après 2 x upSeconds
+    for (int i = 0; i < 40; ++i) {
+        pipeline.process(input.data(), output.data(), BLOCK);
+    }
+    EXPECT_EQ(pipeline.getQualityLevel(), 0u);
+    EXPECT_EQ(reverb->getQualityTier(), 0u);
+    
+    QualityController::Event events[QualityController::EVENT_QUEUE_CAPACITY];
+    EXPECT_EQ(pipeline.readQualityEvents(events, QualityController::EVENT_QUEUE_CAPACITY), 4u);
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "realtime_thread.h"
+#include "rt_worker_pool.h"
+#include "audio_engine.h"
+#include "null_driver.h"
+#include <cfloat>
+#include <thread>
+
+namespace webamp {
+namespace tests {
+
+TEST(RealtimeThreadTest, ParsesKernelCpuLists) {
+    EXPECT_EQ(RealtimeThread::parseCpuList("2-3,6\n"), (std::vector<int>{2, 3, 6}));
+    EXPECT_EQ(RealtimeThread::parseCpuList("5"), (std::vector<int>{5}));
+    EXPECT_EQ(RealtimeThread::parseCpuList(" 1 , 0-1 "), (std::vector<int>{0, 1}));
+    EXPECT_TRUE(RealtimeThread::parseCpuList("").empty());
+    EXPECT_TRUE(RealtimeThread::parseCpuList("a-b").empty());
+}
+
+TEST(RealtimeThreadTest, DisableDenormalsFlushesSubnormals) {
+    #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86) || defined(__aarch64__)
+    // Sur un thread dédié : le mode FTZ ne doit pas fuir dans les autres tests
+    std::thread([] {
+        ASSERT_TRUE(RealtimeThread::disableDenormals());
+        EXPECT_TRUE(RealtimeThread::areDenormalsDisabled());
+        
+        volatile float smallest = FLT_MIN;
+        volatile float half = 0.5f;
+        const float result = smallest * half;
+        EXPECT_EQ(result, 0.0f);
+    }).join();
+    #else
+    GTEST_SKIP() << "FTZ non pris en charge sur cette architecture";
+    #endif
+}
+
+TEST(RealtimeThreadTest, SetupReportsAppliedState) {
+    std::thread([] {
+        RealtimeThread::Settings settings;
+        settings.cpus = {0};
+        settings.prefaultStackBytes = 64 * 1024;
+        const auto state = RealtimeThread::setupCurrentThread(settings, 3);
+        
+        // Priorité et affinité dépendent des droits : seule la cohérence
+        // de l'état est vérifiée
+        EXPECT_TRUE(state.stackPrefaulted);
+        EXPECT_EQ(state.priority, state.priorityValue > 0);
+        EXPECT_EQ(state.affinity, state.cpu == 0);
+        #if defined(__x86_64__) || defined(__aarch64__)
+        EXPECT_TRUE(state.denormalsFlushed);
+        #endif
+    }).join();
+}
+
+TEST(RealtimeThreadTest, WorkerPoolConfiguresEveryThread) {
+    RTWorkerPool pool(3);
+    RealtimeThread::Settings settings;
+    settings.setAffinity = false;
+    const auto state = pool.configureThreads(settings, 5.0);
+    EXPECT_TRUE(state.stackPrefaulted);
+    EXPECT_EQ(pool.getThreadState().stackPrefaulted, state.stackPrefaulted);
+    
+    // Le pool reste utilisable après la reconfiguration
+    std::atomic<int> sum{0};
+    pool.run([](void* context, size_t index) {
+        static_cast<std::atomic<int>*>(context)->fetch_add(static_cast<int>(index));
+    }, &sum, 8);
+    EXPECT_EQ(sum.load(), 28);
+}
+
+TEST(RealtimeThreadTest, AudioEngineReportsHardeningInStats) {
+    AudioEngine engine;
+    ASSERT_TRUE(engine.initialize("null"));
+    
+    // Désactivé par défaut
+    EXPECT_FALSE(engine.getRealtimeSettings().enabled);
+    
+    RealtimeThread::Settings settings;
+    settings.enabled = true;
+    settings.lockMemory = false;
+    settings.setAffinity = false;
+    ASSERT_TRUE(engine.setRealtimeSettings(settings));
+    
+    auto* driver = dynamic_cast<NullDriver*>(engine.getDriver());
+    ASSERT_NE(driver, nullptr);
+    NullDriver::Options options;
+    options.clock = NullDriver::Clock::Freewheel;
+    options.totalFrames = engine.getSampleRate() / 10;
+    driver->setOptions(options);
+    
+    ASSERT_TRUE(engine.start());
+    EXPECT_FALSE(engine.setRealtimeSettings(settings));
+    ASSERT_TRUE(driver->waitUntilFinished(5.0));
+    
+    const auto stats = engine.getStats();
+    EXPECT_TRUE(stats.audioThread.stackPrefaulted);
+    EXPECT_TRUE(stats.workerThreads.stackPrefaulted);
+    EXPECT_FALSE(stats.audioThread.memoryLocked);
+    EXPECT_TRUE(engine.stop());
+}
+
+} // namespace tests
+} // namespace webamp
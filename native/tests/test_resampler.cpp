@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+#include "resampler.h"
+#include "ir_convolution.h"
+#include "ir_loader.h"
+#include "nam_effect.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class ResamplerTest : public ::testing::Test {
+protected:
+    static constexpr float FREQUENCY = 1000.0f;
+    
+    static float sine(double time) {
+        return 0.5f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * FREQUENCY * time));
+    }
+    
+    // Convertit une sinusoïde par blocs de tailles variables et compare la
+    // sortie à la sinusoïde idéale retardée de getLatency()
+    static void expectSinePreserved(uint32_t inputRate, uint32_t outputRate) {
+        Resampler resampler;
+        ASSERT_TRUE(resampler.init(inputRate, outputRate, 256));
+        
+        const uint32_t chunks[] = {256, 1, 100, 37, 255};
+        std::vector<float> input(256);
+        std::vector<float> output(resampler.getMaxOutputCount(256));
+        const double delay = resampler.getLatency() / inputRate;
+        uint64_t consumed = 0;
+        uint64_t produced = 0;
+        float maxError = 0.0f;
+        for (int block = 0; block < 100; ++block) {
+            const uint32_t count = chunks[block % 5];
+            for (uint32_t i = 0; i < count; ++i) {
+                input[i] = sine(static_cast<double>(consumed + i) / inputRate);
+            }
+            const uint32_t n = resampler.process(input.data(), count, output.data());
+            ASSERT_LE(n, resampler.getMaxOutputCount(count));
+            for (uint32_t k = 0; k < n; ++k) {
+                // Hors démarrage du filtre
+                const uint64_t index = produced + k;
+                if (index > 4 * resampler.getTapsPerPhase() * outputRate / inputRate) {
+                    const float expected = sine(static_cast<double>(index) / outputRate - delay);
+                    maxError = std::max(maxError, std::abs(output[k] - expected));
+                }
+            }
+            consumed += count;
+            produced += n;
+            
+            // ceil(N * out / in) sorties après N entrées
+            ASSERT_EQ(produced, (consumed * outputRate + inputRate - 1) / inputRate);
+        }
+        EXPECT_LT(maxError, 2e-3f) << inputRate << " -> " << outputRate;
+    }
+    
+    // Modèle NAM identité (un seul coefficient) entraîné à 48 kHz
+    static std::string identityModel(uint32_t sampleRate = 48000) {
+        return "{\"version\":\"0.5.2\",\"architecture\":\"Linear\",\"config\":{\"receptive_field\":1,\"bias\":true},"
+               "\"sample_rate\":" + std::to_string(sampleRate) + ",\"weights\":[1.0,0.0]}";
+    }
+};
+
+TEST_F(ResamplerTest, RatioReducedToPolyphaseBranches) {
+    Resampler resampler;
+    EXPECT_FALSE(resampler.isInitialized());
+    EXPECT_FALSE(resampler.init(0, 48000, 128));
+    
+    // 44.1k -> 48k : L / M = 160 / 147
+    ASSERT_TRUE(resampler.init(44100, 48000, 128, 12));
+    EXPECT_EQ(resampler.getTapsPerPhase(), 16u);
+    EXPECT_DOUBLE_EQ(resampler.getLatency(), 8.0);
+    EXPECT_EQ(resampler.getMaxOutputCount(147), 161u);
+    
+    // Rapport non réductible au-delà de MAX_PHASES branches
+    EXPECT_FALSE(resampler.init(44100, 48001, 128));
+    EXPECT_FALSE(resampler.isInitialized());
+}
+
+TEST_F(ResamplerTest, SinePreservedAcrossRates) {
+    expectSinePreserved(44100, 48000);
+    expectSinePreserved(48000, 44100);
+    expectSinePreserved(44100, 96000);
+    expectSinePreserved(96000, 48000);
+}
+
+TEST_F(ResamplerTest, OfflineResampleHasNoDelay) {
+    std::vector<float> impulse(1000, 0.0f);
+    impulse[100] = 1.0f;
+    
+    auto peakIndex = [](const std::vector<float>& signal) {
+        size_t peak = 0;
+        for (size_t i = 1; i < signal.size(); ++i) {
+            if (std::abs(signal[i]) > std::abs(signal[peak])) {
+                peak = i;
+            }
+        }
+        return peak;
+    };
+    
+    auto up = Resampler::resample(impulse.data(), impulse.size(), 48000, 96000);
+    EXPECT_EQ(up.size(), 2000u);
+    EXPECT_EQ(peakIndex(up), 200u);
+    
+    auto down = Resampler::resample(impulse.data(), impulse.size(), 48000, 44100);
+    EXPECT_EQ(down.size(), 919u);
+    EXPECT_EQ(peakIndex(down), 92u);
+}
+
+TEST_F(ResamplerTest, IRConvertedToStreamRate) {
+    // IR enregistrée à 48 kHz
+    std::vector<float> ir(2400);
+    for (size_t i = 0; i < ir.size(); ++i) {
+        ir[i] = 0.01f * std::exp(-static_cast<float>(i) / 300.0f);
+    }
+    IRLoader loader;
+    loader.loadIRFromSamples(ir.data(), ir.size(), 48000);
+    ASSERT_TRUE(loader.resample(44100));
+    EXPECT_EQ(loader.getSampleRate(), 44100u);
+    EXPECT_EQ(loader.getLength(), 2205u);
+    
+    // Même gain DC
+    double before = 0.0;
+    double after = 0.0;
+    for (float sample : ir) {
+        before += sample;
+    }
+    for (float sample : loader.getIRSamples()) {
+        after += sample;
+    }
+    EXPECT_NEAR(after, before, before * 0.01);
+    
+    // Impulsion unité retardée de 64 échantillons à 96 kHz dans un flux à
+    // 48 kHz : la sortie est l'entrée retardée de 32 échantillons
+    std::vector<float> unit(256, 0.0f);
+    unit[64] = 1.0f;
+    auto impulse = std::make_shared<IRLoader>();
+    impulse->loadIRFromSamples(unit.data(), unit.size(), 96000);
+    IRConvolution effect;
+    effect.setMaxBlockSize(128);
+    effect.setSampleRate(48000);
+    ASSERT_TRUE(effect.loadIR(impulse));
+    EXPECT_EQ(impulse->getSampleRate(), 96000u);
+    
+    std::vector<float> buffer(128 * 2);
+    float maxError = 0.0f;
+    for (int block = 0; block < 20; ++block) {
+        for (uint32_t i = 0; i < 128; ++i) {
+            buffer[i * 2] = buffer[i * 2 + 1] = sine(static_cast<double>(block * 128 + i) / 48000.0);
+        }
+        effect.process(buffer.data(), buffer.data(), 128);
+        if (block > 0) {
+            for (uint32_t i = 0; i < 128; ++i) {
+                const float expected = sine(static_cast<double>(block * 128 + i - 32) / 48000.0);
+                maxError = std::max(maxError, std::abs(buffer[i * 2] - expected));
+                maxError = std::max(maxError, std::abs(buffer[i * 2 + 1] - expected));
+            }
+        }
+    }
+    EXPECT_LT(maxError, 5e-3f);
+}
+
+TEST_F(ResamplerTest, NAMRunsAtTrainingRate) {
+    const std::string model = identityModel();
+    NAMEffect effect;
+    effect.setMaxBlockSize(128);
+    effect.setSampleRate(44100);
+    ASSERT_TRUE(effect.loadModelFromMemory(reinterpret_cast<const uint8_t*>(model.data()), model.size()));
+    EXPECT_TRUE(effect.isResampling());
+    
+    // Deux conversions de REALTIME_TAPS / 2 échantillons (au taux de chacune)
+    // et l'amorce de l'îlot : un échantillon du modèle, arrondi au flux
+    Resampler up;
+    Resampler down;
+    ASSERT_TRUE(up.init(44100, 48000, 128));
+    ASSERT_TRUE(down.init(48000, 44100, 128));
+    const double delay = up.getLatency() + down.getLatency() * 44100.0 / 48000.0 + 1.0;
+    EXPECT_EQ(effect.getLatency(), static_cast<uint32_t>(std::lround(delay)));
+    
+    // Modèle identité : la sortie est l'entrée retardée de la latence
+    const uint32_t blocks[] = {128, 64, 1, 127, 100};
+    std::vector<float> buffer(128 * 2);
+    uint64_t position = 0;
+    float maxError = 0.0f;
+    for (int block = 0; block < 60; ++block) {
+        const uint32_t count = blocks[block % 5];
+        for (uint32_t i = 0; i < count; ++i) {
+            buffer[i * 2] = buffer[i * 2 + 1] = sine(static_cast<double>(position + i) / 44100.0);
+        }
+        effect.process(buffer.data(), buffer.data(), count);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (position + i > 256) {
+                const float expected = sine((static_cast<double>(position + i) - delay) / 44100.0);
+                maxError = std::max(maxError, std::abs(buffer[i * 2] - expected));
+                ASSERT_EQ(buffer[i * 2], buffer[i * 2 + 1]);
+            }
+        }
+        position += count;
+    }
+    EXPECT_LT(maxError, 5e-3f);
+    
+    // Flux à la fréquence du modèle : pas d'îlot
+    effect.setSampleRate(48000);
+    EXPECT_FALSE(effect.isResampling());
+    EXPECT_EQ(effect.getLatency(), 0u);
+}
+
+TEST_F(ResamplerTest, NAMIslandNeverDropsSamples) {
+    // Entrée constante, modèle identité à 48 kHz : une fois l'amorce et les
+    // filtres traversés, chaque échantillon de sortie vaut l'entrée, quel
+    // que soit le découpage des blocs
+    const std::string model = identityModel();
+    const uint32_t rates[] = {22050, 32000, 44100, 88200, 96000, 192000};
+    const uint32_t blocks[] = {1, 7, 128, 33, 2, 127, 64, 100};
+    for (uint32_t rate : rates) {
+        NAMEffect effect;
+        effect.setMaxBlockSize(128);
+        effect.setSampleRate(rate);
+        ASSERT_TRUE(effect.loadModelFromMemory(reinterpret_cast<const uint8_t*>(model.data()), model.size()));
+        ASSERT_TRUE(effect.isResampling());
+        
+        const uint64_t settled = effect.getLatency() + 4 * Resampler::REALTIME_TAPS * (rate / 48000 + 1);
+        std::vector<float> buffer(128 * 2);
+        uint64_t position = 0;
+        float maxError = 0.0f;
+        for (int block = 0; block < 400; ++block) {
+            const uint32_t count = blocks[block % 8];
+            std::fill(buffer.begin(), buffer.begin() + count * 2, 0.5f);
+            effect.process(buffer.data(), buffer.data(), count);
+            for (uint32_t i = 0; i < count; ++i) {
+                if (position + i > settled) {
+                    maxError = std::max(maxError, std::abs(buffer[i * 2] - 0.5f));
+                }
+            }
+            position += count;
+        }
+        EXPECT_LT(maxError, 1e-2f) << rate << " Hz";
+        EXPECT_EQ(effect.getIslandUnderrunCount(), 0u) << rate << " Hz";
+    }
+}
+
+TEST_F(ResamplerTest, NAMIslandNeverUnderruns) {
+    // 44.1k <-> 48k dans les deux sens, blocs de tailles impaires et
+    // premières (phases successives des deux convertisseurs) : l'amorce
+    // couvre toujours le bloc, aucune sortie n'est complétée de silence
+    const uint32_t pairs[][2] = {{44100, 48000}, {48000, 44100}};
+    const uint32_t blocks[] = {1, 3, 127, 61, 5, 113, 17, 89, 31, 7};
+    for (const auto& pair : pairs) {
+        const std::string model = identityModel(pair[1]);
+        NAMEffect effect;
+        effect.setMaxBlockSize(128);
+        effect.setSampleRate(pair[0]);
+        ASSERT_TRUE(effect.loadModelFromMemory(reinterpret_cast<const uint8_t*>(model.data()), model.size()));
+        ASSERT_TRUE(effect.isResampling());
+        
+        std::vector<float> buffer(128 * 2);
+        uint64_t position = 0;
+        for (int block = 0; block < 2000; ++block) {
+            const uint32_t count = blocks[block % 10];
+            for (uint32_t i = 0; i < count; ++i) {
+                buffer[i * 2] = buffer[i * 2 + 1] = sine(static_cast<double>(position + i) / pair[0]);
+            }
+            effect.process(buffer.data(), buffer.data(), count);
+            position += count;
+            ASSERT_EQ(effect.getIslandUnderrunCount(), 0u) << pair[0] << " -> " << pair[1] << " Hz, bloc " << block;
+        }
+    }
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+// Mesures sur un buffer complet : le premier échantillon des sinus de test vaut 0,
+// un test sur output[0] seul ne prouve rien.
+inline float rms(const std::vector<float>& buffer) {
+    double sum = 0.0;
+    for (float sample : buffer) {
+        sum += static_cast<double>(sample) * sample;
+    }
+    return buffer.empty() ? 0.0f : static_cast<float>(std::sqrt(sum / buffer.size()));
+}
+
+inline float maxDifference(const std::vector<float>& a, const std::vector<float>& b) {
+    float diff = 0.0f;
+    const size_t count = std::min(a.size(), b.size());
+    for (size_t i = 0; i < count; ++i) {
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "effect_chain.h"
+#include "simd_helper.h"
+#include "effects/delay.h"
+#include "effects/distortion.h"
+#include "effects/reverb.h"
+#include <cmath>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class SilenceTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t BLOCK = 256;
+    
+    void SetUp() override {
+        left_.assign(BLOCK, 0.0f);
+        right_.assign(BLOCK, 0.0f);
+    }
+    
+    // Un bloc planaire en place : impulsion en tête ou silence
+    void processBlock(EffectChain& chain, bool impulse) {
+        std::fill(left_.begin(), left_.end(), 0.0f);
+        std::fill(right_.begin(), right_.end(), 0.0f);
+        if (impulse) {
+            left_[0] = right_[0] = 0.5f;
+        }
+        float* channels[2] = {left_.data(), right_.data()};
+        chain.process(channels, channels, 2, BLOCK);
+    }
+    
+    std::vector<float> left_;
+    std::vector<float> right_;
+};
+
+TEST_F(SilenceTest, SimdPeakMatchesScalar) {
+    std::vector<float> signal(1027);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        signal[i] = 0.001f * std::sin(static_cast<float>(i));
+    }
+    // Pic négatif dans le reste non vectorisé
+    signal[1025] = -0.75f;
+    EXPECT_FLOAT_EQ(SIMDHelper::peak(signal.data(), signal.size()), 0.75f);
+    
+    signal[1025] = 0.0f;
+    signal[17] = -0.5f;
+    EXPECT_FLOAT_EQ(SIMDHelper::peak(signal.data(), signal.size()), 0.5f);
+    EXPECT_EQ(SIMDHelper::peak(signal.data(), 0), 0.0f);
+}
+
+TEST_F(SilenceTest, ReverbSleepsAfterTailAndWakesOnSignal) {
+    auto reverb = std::make_shared<ReverbEffect>();
+    reverb->setSampleRate(48000);
+    EffectChain chain;
+    chain.prepare(BLOCK);
+    chain.addEffect(reverb);
+    
+    const uint32_t tail = reverb->getTailLength();
+    EXPECT_GT(tail, 48000u / 10);
+    
+    processBlock(chain, true);
+    EXPECT_FALSE(reverb->isSilent());
+    
+    // Pas de veille avant la fin de la queue
+    uint32_t silentFrames = 0;
+    while (!reverb->isSilent() && silentFrames < 10 * 48000) {
+        processBlock(chain, false);
+        silentFrames += BLOCK;
+    }
+    ASSERT_TRUE(reverb->isSilent());
+    EXPECT_GE(silentFrames, tail);
+    
+    // En veille, le silence traverse la chaîne
+    processBlock(chain, false);
+    EXPECT_TRUE(reverb->isSilent());
+    for (uint32_t i = 0; i < BLOCK; ++i) {
+        ASSERT_EQ(left_[i], 0.0f);
+    }
+    
+    // Réveil dès le premier bloc non silencieux : la réverb est traitée
+    processBlock(chain, true);
+    EXPECT_FALSE(reverb->isSilent());
+    EXPECT_NE(left_[0], 0.5f);
+}
+
+TEST_F(SilenceTest, TailLengthsFollowParameters) {
+    // Sans queue : veille au premier bloc silencieux dont la sortie l'est
+    auto distortion = std::make_shared<DistortionEffect>();
+    distortion->setSampleRate(48000);
+    EXPECT_EQ(distortion->getTailLength(), 0u);
+    
+    // Delay : échos plus longs avec le feedback, infinis à 100 %
+    auto delay = std::make_shared<DelayEffect>();
+    delay->setSampleRate(48000);
+    delay->setSmoothingTime(0.0f);
+    delay->setParameter("feedback", 20.0f);
+    const uint32_t shortTail = delay->getTailLength();
+    delay->setParameter("feedback", 80.0f);
+    EXPECT_GT(delay->getTailLength(), shortTail);
+    delay->setParameter("feedback", 100.0f);
+    EXPECT_EQ(delay->getTailLength(), EffectBase::INFINITE_TAIL);
+    
+    EffectChain chain;
+    chain.prepare(BLOCK);
+    chain.addEffect(distortion);
+    chain.addEffect(delay);
+    processBlock(chain, true);
+    for (int block = 0; block < 400; ++block) {
+        processBlock(chain, false);
+    }
+    EXPECT_TRUE(distortion->isSilent());
+    EXPECT_FALSE(delay->isSilent());
+}
+
+} // namespace tests
+} // namespace webamp
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "waveshaper.h"
+#include "fft_helper.h"
+#include "effects/distortion.h"
+#include "effects/overdrive.h"
+#include "effects/fuzz.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace webamp {
+namespace tests {
+
+class WaveshaperTest : public ::testing::Test {
+protected:
+    static constexpr uint32_t FFT_SIZE = 8192;
+    static constexpr uint32_t BLOCK_SIZE = 100;
+    
+    static constexpr Waveshaper::Curve CURVES[3] = {
+        Waveshaper::Curve::HardClip, Waveshaper::Curve::Tanh, Waveshaper::Curve::Fuzz
+    };
+    
+    static std::vector<float> sine(double cyclesPerSample, size_t length, float amplitude) {
+        std::vector<float> signal(length);
+        for (size_t i = 0; i < length; ++i) {
+            signal[i] = amplitude * static_cast<float>(std::sin(2.0 * 3.14159265358979 * cyclesPerSample * i));
+        }
+        return signal;
+    }
+    
+    // Traitement par blocs de 100 échantillons (état conservé entre blocs)
+    static std::vector<float> shape(Waveshaper::Curve curve, Waveshaper::Mode mode, std::vector<float> signal) {
+        Waveshaper shaper(curve);
+        shaper.setMode(mode);
+        for (size_t offset = 0; offset < signal.size(); offset += BLOCK_SIZE) {
+            const uint32_t count = static_cast<uint32_t>(std::min<size_t>(BLOCK_SIZE, signal.size() - offset));
+            shaper.process(0, signal.data() + offset, count);
+        }
+        return signal;
+    }
+    
+    // Énergie hors harmoniques de la fondamentale (bin), relative à celle-ci
+    static double aliasingDb(const std::vector<float>& signal, size_t start, uint32_t bin) {
+        FFTPlan plan(FFT_SIZE);
+        std::vector<float> windowed(FFT_SIZE);
+        for (uint32_t i = 0; i < FFT_SIZE; ++i) {
+            const float hann = 0.5f - 0.5f * std::cos(2.0f * 3.14159265f * i / FFT_SIZE);
+            windowed[i] = signal[start + i] * hann;
+        }
+        std::vector<float> re(FFT_SIZE / 2 + 1), im(FFT_SIZE / 2 + 1);
+        plan.forwardReal(windowed.data(), re.data(), im.data());
+        
+        double fundamental = 0.0;
+        double aliases = 0.0;
+        for (uint32_t k = 4; k < FFT_SIZE / 2; ++k) {
+            const double power = static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+            const uint32_t nearest = (k + bin / 2) / bin * bin;
+            const bool harmonic = (k > nearest ? k - nearest : nearest - k) <= 3;
+            if (k >= bin - 3 && k <= bin + 3) {
+                fundamental += power;
+            } else if (!harmonic) {
+                aliases += power;
+            }
+        }
+        return 10.0 * std::log10(aliases / fundamental + 1e-30);
+    }
+};
+
+constexpr Waveshaper::Curve WaveshaperTest::CURVES[3];
+
+TEST_F(WaveshaperTest, AntiderivativesMatchCurves) {
+    const double h = 1e-4;
+    for (auto curve : CURVES) {
+        EXPECT_DOUBLE_EQ(Waveshaper::antiderivative2(curve, 0.0), 0.0);
+        for (double x = -12.0; x <= 12.0; x += 0.0137) {
+            const double dF1 = (Waveshaper::antiderivative1(curve, x + h) - Waveshaper::antiderivative1(curve, x - h)) / (2.0 * h);
+            const double dF2 = (Waveshaper::antiderivative2(curve, x + h) - Waveshaper::antiderivative2(curve, x - h)) / (2.0 * h);
+            EXPECT_NEAR(dF1, Waveshaper::apply(curve, x), 1e-6) << static_cast<int>(curve) << " x=" << x;
+            EXPECT_NEAR(dF2, Waveshaper::antiderivative1(curve, x), 1e-6) << static_cast<int>(curve) << " x=" << x;
+        }
+    }
+}
+
+TEST_F(WaveshaperTest, NaiveModeMatchesPedalCurves) {
+    const auto input = sine(0.01, 1000, 3.0f);
+    const auto hard = shape(Waveshaper::Curve::HardClip, Waveshaper::Mode::Naive, input);
+    const auto soft = shape(Waveshaper::Curve::Tanh, Waveshaper::Mode::Naive, input);
+    const auto fuzz = shape(Waveshaper::Curve::Fuzz, Waveshaper::Mode::Naive, input);
+    for (size_t i = 0; i < input.size(); ++i) {
+        const float x = input[i];
+        const float clipped = std::max(-1.0f, std::min(1.0f, x));
+        EXPECT_EQ(hard[i], clipped);
+        EXPECT_EQ(soft[i], tanhf(x * 2.0f) * 0.5f);
+        EXPECT_EQ(fuzz[i], clipped * (1.0f - 0.3f * fabsf(clipped)));
+    }
+}
+
+TEST_F(WaveshaperTest, SlowSignalFollowsCurveWithReportedDelay) {
+    // Signal lent : ADAA ~ courbe appliquée au signal retardé de getLatency()
+    const double frequency = 0.002;
+    const auto input = sine(frequency, 2000, 2.0f);
+    for (auto curve : CURVES) {
+        for (auto mode : {Waveshaper::Mode::ADAA1, Waveshaper::Mode::ADAA2}) {
+            const auto output = shape(curve, mode, input);
+            const double delay = Waveshaper::getLatency(mode);
+            double maxError = 0.0;
+            for (size_t i = 10; i < input.size(); ++i) {
+                const double x = 2.0 * std::sin(2.0 * 3.14159265358979 * frequency * (i - delay));
+                maxError = std::max(maxError, std::fabs(output[i] - Waveshaper::apply(curve, x)));
+            }
+            EXPECT_LT(maxError, 0.01) << static_cast<int>(curve) << " ADAA" << static_cast<int>(mode);
+        }
+    }
+}
+
+TEST_F(WaveshaperTest, ReducesAliasing) {
+    // Sinusoïde de ~4.1 kHz à 48 kHz fortement saturée
+    const uint32_t bin = 700;
+    const auto input = sine(static_cast<double>(bin) / FFT_SIZE, 2 * FFT_SIZE, 8.0f);
+    for (auto curve : CURVES) {
+        const double naive = aliasingDb(shape(curve, Waveshaper::Mode::Naive, input), FFT_SIZE, bin);
+        const double adaa1 = aliasingDb(shape(curve, Waveshaper::Mode::ADAA1, input), FFT_SIZE, bin);
+        const double adaa2 = aliasingDb(shape(curve, Waveshaper::Mode::ADAA2, input), FFT_SIZE, bin);
+        EXPECT_LT(adaa1, naive - 6.0) << static_cast<int>(curve);
+        EXPECT_LT(adaa2, adaa1 - 3.0) << static_cast<int>(curve);
+    }
+}
+
+TEST_F(WaveshaperTest, PedalsExposeAntialiasing) {
+    DistortionEffect distortion;
+    OverdriveEffect overdrive;
+    FuzzEffect fuzz;
+    EffectBase* effects[3] = {&distortion, &overdrive, &fuzz};
+    
+    for (EffectBase* effect : effects) {
+        effect->setSampleRate(48000);
+        EXPECT_FLOAT_EQ(effect->getParameter("antialiasing"), 0.0f);
+        effect->setParameter("antialiasing", 2.0f);
+        EXPECT_FLOAT_EQ(effect->getParameter("antialiasing"), 2.0f);
+        
+        // Combinable avec le suréchantillonnage
+        effect->setParameter("oversampling", 2.0f);
+        auto buffer = sine(0.01, 512, 0.8f);
+        effect->process(buffer.data(), buffer.data(), 256);
+        for (float sample : buffer) {
+            EXPECT_TRUE(std::isfinite(sample));
+        }
+    }
+    EXPECT_EQ(distortion.getWaveshaper().getMode(), Waveshaper::Mode::ADAA2);
+}
+
+} // namespace tests
+} // namespace webamp